@@ -0,0 +1,176 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "benchelem.h"
+
+/* ------------------------------ benchmatrix start ---------------------------------------*/
+void
+benchmatrix::add(const VariableSubMatrixHandler& WM)
+{
+	if (WM.GetType() != VariableSubMatrixHandler::SPARSE) {
+		return;
+	}
+	const SparseSubMatrixHandler& SM = WM.GetSparse();
+	for (integer i = 1; i <= SM.iGetNumItems(); i++) {
+		piRow.push_back(SM.iGetRowIndex(i));
+		piCol.push_back(SM.iGetColIndex(i));
+		pdMat.push_back(SM.dGetCoef(i));
+	}
+}
+
+void
+benchmatrix::MultAdd(MyVectorHandler& JacY, const MyVectorHandler& Y) const
+{
+	for (std::size_t i = 0; i < pdMat.size(); i++) {
+		JacY(piRow[i]) += pdMat[i]*Y(piCol[i]);
+	}
+}
+/* ------------------------------ benchmatrix end -----------------------------------------*/
+
+/* ------------------------------ benchelem start ---------------------------------------*/
+benchelem::benchelem(scenario& s, const std::vector<Elem *>& elems, const doublereal& dC)
+: sc(s), pElems(elems), dCoef(dC), iNumItems(0)
+{
+	NO_OP;
+}
+
+benchelem::~benchelem(void)
+{
+	NO_OP;
+}
+
+/*--[0]1ステップの呼び出し---------------------------------------------------------------*/
+void
+benchelem::prepare(void)
+{
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		pElems[e]->AfterConvergence(sc.getX(), sc.getXP());
+	}
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		pElems[e]->AfterPredict(sc.getX(), sc.getXP());
+	}
+}
+
+void
+benchelem::assres(MyVectorHandler& R)
+{
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		pElems[e]->AssRes(WorkVec, dCoef, sc.getX(), sc.getXP()).AddTo(R);
+	}
+}
+
+void
+benchelem::assjac(void)
+{
+	iNumItems = 0;
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		iNumItems += pElems[e]->AssJac(WorkMat, dCoef, sc.getX(), sc.getXP()).iGetNumItems();
+	}
+}
+
+void
+benchelem::matvec(MyVectorHandler& JacY, const MyVectorHandler& Y)
+{
+	iNumItems = 0;
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		const VariableSubMatrixHandler& WM = pElems[e]->AssJac(WorkMat, dCoef, sc.getX(), sc.getXP());
+		iNumItems += WM.iGetNumItems();
+		WM.MultAdd(JacY, Y);
+	}
+}
+
+void
+benchelem::jvp(MyVectorHandler& JacY, const MyVectorHandler& Y)
+{
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		pElems[e]->AssJac(JacY, Y, dCoef, sc.getX(), sc.getXP(), WorkMat);
+	}
+}
+
+void
+benchelem::assemble(benchmatrix& A)
+{
+	A.clear();
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		A.add(pElems[e]->AssJac(WorkMat, dCoef, sc.getX(), sc.getXP()));
+	}
+}
+
+void
+benchelem::afterconvergence(void)
+{
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		pElems[e]->AfterConvergence(sc.getX(), sc.getXP());
+	}
+}
+
+/*--[1]private data, ヤコビ行列の確認--------------------------------------------------------*/
+doublereal
+benchelem::dGetPrivData(const char *s) const
+{
+	doublereal d = 0.0;
+	for (std::size_t e = 0; e < pElems.size(); e++) {
+		const unsigned int i = pElems[e]->iGetPrivDataIdx(s);
+		if (i > 0) {
+			d += pElems[e]->dGetPrivData(i);
+		}
+	}
+	return d;
+}
+
+void
+benchelem::direction(MyVectorHandler& Y, unsigned uSeed) const
+{
+	unsigned s = (uSeed == 0u) ? 1u : uSeed;
+	Y.Resize(sc.getX().iGetSize());
+	Y.Reset();
+	for (std::size_t i = 0; i < sc.iGetNumNodes(); i++) {
+		const integer iPos = sc.pGetNode(i)->iGetFirstPositionIndex();
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			s ^= s << 13;
+			s ^= s >> 17;
+			s ^= s << 5;
+			Y(iPos + iCnt) = 2.0*doublereal(s)/4294967295.0 - 1.0;
+		}
+	}
+}
+
+doublereal
+benchelem::dGetJacobianError(unsigned uSeed)
+{
+	MyVectorHandler& X = sc.getX();
+	MyVectorHandler& XP = sc.getXP();
+	const integer n = X.iGetSize();
+
+	MyVectorHandler Y, AY(n), Rp(n), Rm(n);
+	direction(Y, uSeed);
+	matvec(AY, Y);
+
+	//速度の刻み(位置は dCoef h)
+	const doublereal h = 1.0e-7;
+	const MyVectorHandler X0(X), XP0(XP);
+	for (integer i = 1; i <= n; i++) {
+		X(i) += dCoef*h*Y(i);
+		XP(i) += h*Y(i);
+	}
+	assres(Rp);
+	for (integer i = 1; i <= n; i++) {
+		X(i) = X0(i) - dCoef*h*Y(i);
+		XP(i) = XP0(i) - h*Y(i);
+	}
+	assres(Rm);
+	X = X0;
+	XP = XP0;
+
+	doublereal dErr = 0.0, dNorm = 0.0;
+	for (integer i = 1; i <= n; i++) {
+		const doublereal fd = -(Rp(i) - Rm(i))/(2.0*h);
+		dErr += (AY(i) - fd)*(AY(i) - fd);
+		dNorm += std::max(AY(i)*AY(i), fd*fd);
+	}
+	return (dNorm > 0.0) ? std::sqrt(dErr/dNorm) : 0.0;
+}
+
+/* ------------------------------ benchelem end -----------------------------------------*/
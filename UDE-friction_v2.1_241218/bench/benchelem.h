@@ -0,0 +1,83 @@
+#ifndef BENCHELEM_H
+#define BENCHELEM_H
+
+#include <cstddef>
+#include <vector>
+
+#include "dataman.h"
+#include "scenario.h"
+
+/* =================================================
+ * class Bench Matrix
+ *  全要素のAssJacを集めた大域のヤコビ行列(行, 列, 値の3つ組).
+ *  陽に行列を作る解法(直接法, 行列を持つKrylov法)の記憶量と A y の時間を測る.
+ * ================================================= */
+class benchmatrix
+{
+private:
+    std::vector<integer> piRow, piCol;
+    std::vector<doublereal> pdMat;
+
+public:
+    void clear(void) { piRow.clear(); piCol.clear(); pdMat.clear(); };
+    void add(const VariableSubMatrixHandler& WM);
+    integer iGetNumItems(void) const { return integer(pdMat.size()); };
+    //bytes of the stored entries (value, row and column index)
+    std::size_t iGetBytes(void) const {
+        return pdMat.size()*(sizeof(doublereal) + 2*sizeof(integer));
+    };
+    //JacY += A Y
+    void MultAdd(MyVectorHandler& JacY, const MyVectorHandler& Y) const;
+};
+
+/* =================================================
+ * class Bench Elem
+ *  scenarioの節点列に作った要素(1個以上)を, MBDynの1ステップと同じ順に呼ぶ.
+ *    prepare : AfterConvergence(前のステップの収束), AfterPredict(予測子)
+ *    assres  : 全要素のAssResを大域の残差Rに組み込む
+ *    assjac  : 全要素のAssJac (行列は要素ごとに作り直す)
+ *    matvec  : 全要素のAssJacとA y (MBDynが行列を作ってからかける場合)
+ *    jvp     : 全要素のAssJac(JacY, Y, ...) (行列を作らない場合)
+ *    assemble: 全要素のAssJacを大域の行列に集める
+ *
+ *  ヤコビ行列の確認(dGetJacobianError): 位置と速度を同じ向きyに
+ *    X + dCoef h y, XP + h y
+ *  だけずらすと R の変化は -h A y (A = -dR/dXP - dCoef dR/dX)なので,
+ *  中心差分との相対誤差 |A y + (R(+h) - R(-h))/(2h)| / |A y| を返す.
+ * ================================================= */
+class benchelem
+{
+private:
+    scenario& sc;
+    std::vector<Elem *> pElems;
+    doublereal dCoef;
+    SubVectorHandler WorkVec;
+    VariableSubMatrixHandler WorkMat;
+    integer iNumItems;
+
+public:
+    benchelem(scenario& s, const std::vector<Elem *>& elems, const doublereal& dC = 5.0e-4);
+    ~benchelem(void);
+
+    std::size_t iGetNumElems(void) const { return pElems.size(); };
+    const doublereal& dGetCoef(void) const { return dCoef; };
+
+    void prepare(void);
+    void assres(MyVectorHandler& R);
+    void assjac(void);
+    void matvec(MyVectorHandler& JacY, const MyVectorHandler& Y);
+    void jvp(MyVectorHandler& JacY, const MyVectorHandler& Y);
+    void assemble(benchmatrix& A);
+    void afterconvergence(void);
+
+    //entries of the last assjac (all elements)
+    integer iGetNumItems(void) const { return iNumItems; };
+    //sum of a private data over the elements (0 if an element has none of the name)
+    doublereal dGetPrivData(const char *s) const;
+    //relative error of A y against central differences (random y, seed uSeed)
+    doublereal dGetJacobianError(unsigned uSeed = 7u);
+    //random direction in the position rows of the nodes
+    void direction(MyVectorHandler& Y, unsigned uSeed) const;
+};
+
+#endif // BENCHELEM_H
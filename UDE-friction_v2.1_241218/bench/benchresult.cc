@@ -0,0 +1,163 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <thread>
+
+#include "benchresult.h"
+
+//JSONの文字列(引用符とバックスラッシュを逃がす)
+static std::string
+sJson(const std::string& s)
+{
+	std::string r;
+	for (std::size_t i = 0; i < s.size(); i++) {
+		if (s[i] == '"' || s[i] == '\\') {
+			r += '\\';
+		}
+		r += (s[i] == '\n') ? ' ' : s[i];
+	}
+	return r;
+}
+
+//CSVの欄(引用符で囲み, 中の引用符は2つ重ねる)
+static std::string
+sCsv(const std::string& s)
+{
+	std::string r("\"");
+	for (std::size_t i = 0; i < s.size(); i++) {
+		if (s[i] == '"') {
+			r += '"';
+		}
+		r += (s[i] == '\n') ? ' ' : s[i];
+	}
+	return r + "\"";
+}
+
+//NaN, infはJSONの数値にできないのでnullにする
+static void
+writeNumber(std::ostream& os, const doublereal& d)
+{
+	if (std::isfinite(d)) {
+		char buf[32];
+		std::snprintf(buf, sizeof(buf), "%.9g", d);
+		os << buf;
+	} else {
+		os << "null";
+	}
+}
+
+static const char *
+sCompiler(void)
+{
+#if defined(__clang__)
+	return "clang " __clang_version__;
+#elif defined(__GNUC__)
+	return "gcc " __VERSION__;
+#else
+	return "unknown";
+#endif
+}
+
+/* ------------------------------ benchresult start ---------------------------------------*/
+benchresult::benchresult(const std::string& tag)
+: sTag(tag)
+{
+	NO_OP;
+}
+
+benchresult::~benchresult(void)
+{
+	NO_OP;
+}
+
+void
+benchresult::add(const std::string& suite, const std::string& name, const std::string& scenario,
+	std::size_t nodes, unsigned threads,
+	const std::string& metric, const doublereal& value, const std::string& unit)
+{
+	benchrecord r;
+	r.suite = suite;
+	r.name = name;
+	r.scenario = scenario;
+	r.nodes = nodes;
+	r.threads = threads;
+	r.metric = metric;
+	r.value = value;
+	r.unit = unit;
+	records.push_back(r);
+}
+
+/*--[0]表-------------------------------------------------------------------------------*/
+void
+benchresult::print(std::ostream& os) const
+{
+	os << std::left
+		<< std::setw(14) << "suite" << " "
+		<< std::setw(32) << "name" << " "
+		<< std::setw(10) << "scenario" << " "
+		<< std::right << std::setw(8) << "nodes" << " "
+		<< std::setw(7) << "threads" << "  "
+		<< std::left << std::setw(30) << "metric" << " "
+		<< std::right << std::setw(14) << "value" << " "
+		<< std::left << "unit" << "\n";
+	for (std::size_t i = 0; i < records.size(); i++) {
+		const benchrecord& r = records[i];
+		os << std::left
+			<< std::setw(14) << r.suite << " "
+			<< std::setw(32) << r.name << " "
+			<< std::setw(10) << r.scenario << " "
+			<< std::right << std::setw(8) << r.nodes << " "
+			<< std::setw(7) << r.threads << "  "
+			<< std::left << std::setw(30) << r.metric << " "
+			<< std::right << std::setw(14) << std::setprecision(6) << r.value << " "
+			<< std::left << r.unit << "\n";
+	}
+	os << std::flush;
+}
+
+/*--[1]CSV, JSON--------------------------------------------------------------------------*/
+void
+benchresult::writeCsv(std::ostream& os) const
+{
+	os << "tag,suite,name,scenario,nodes,threads,metric,value,unit\n";
+	for (std::size_t i = 0; i < records.size(); i++) {
+		const benchrecord& r = records[i];
+		os << sCsv(sTag) << ","
+			<< sCsv(r.suite) << ","
+			<< sCsv(r.name) << ","
+			<< sCsv(r.scenario) << ","
+			<< r.nodes << ","
+			<< r.threads << ","
+			<< sCsv(r.metric) << ",";
+		writeNumber(os, r.value);
+		os << "," << sCsv(r.unit) << "\n";
+	}
+}
+
+void
+benchresult::writeJson(std::ostream& os) const
+{
+	os << "{\n"
+		<< "  \"tag\": \"" << sJson(sTag) << "\",\n"
+		<< "  \"compiler\": \"" << sJson(sCompiler()) << "\",\n"
+		<< "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+		<< "  \"results\": [";
+	for (std::size_t i = 0; i < records.size(); i++) {
+		const benchrecord& r = records[i];
+		os << (i == 0 ? "\n" : ",\n")
+			<< "    {\"suite\": \"" << sJson(r.suite) << "\""
+			<< ", \"name\": \"" << sJson(r.name) << "\""
+			<< ", \"scenario\": \"" << sJson(r.scenario) << "\""
+			<< ", \"nodes\": " << r.nodes
+			<< ", \"threads\": " << r.threads
+			<< ", \"metric\": \"" << sJson(r.metric) << "\""
+			<< ", \"value\": ";
+		writeNumber(os, r.value);
+		os << ", \"unit\": \"" << sJson(r.unit) << "\"}";
+	}
+	os << "\n  ]\n}\n";
+}
+
+/* ------------------------------ benchresult end -----------------------------------------*/
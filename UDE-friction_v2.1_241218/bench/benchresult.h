@@ -0,0 +1,55 @@
+#ifndef BENCHRESULT_H
+#define BENCHRESULT_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mbconfig.h"
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Bench Result
+ *  ベンチマークの結果を1行1指標で集め, 表(標準出力), CSV, JSONに書き出す.
+ *    suite    : 測定の種類 (helpers, elements, ...)
+ *    name     : 測定した関数や要素 (Contactlaw.AssRes など)
+ *    scenario : scenario.hの節点列 (関数だけの測定では空にしない)
+ *    nodes    : 節点数, threads: スレッド数
+ *    metric   : 指標 (ns_per_node など), value, unit
+ *  版ごとに比べられるよう, tag(版の名前)とCPU, コンパイラを一緒に書く.
+ * ================================================= */
+struct benchrecord
+{
+    std::string suite;
+    std::string name;
+    std::string scenario;
+    std::size_t nodes;
+    unsigned threads;
+    std::string metric;
+    doublereal value;
+    std::string unit;
+};
+
+class benchresult
+{
+private:
+    std::string sTag;
+    std::vector<benchrecord> records;
+
+public:
+    benchresult(const std::string& tag);
+    ~benchresult(void);
+
+    void add(const std::string& suite, const std::string& name, const std::string& scenario,
+        std::size_t nodes, unsigned threads,
+        const std::string& metric, const doublereal& value, const std::string& unit);
+    std::size_t iGetNumRecords(void) const { return records.size(); };
+
+    void print(std::ostream& os) const;
+    void writeCsv(std::ostream& os) const;
+    void writeJson(std::ostream& os) const;
+};
+
+#endif // BENCHRESULT_H
@@ -0,0 +1,200 @@
+/* -----------------------------------------------------------------------
+ * contactbench
+ *  接触要素とhelper classのベンチマーク(MBDynなしで動く).
+ *
+ *  usage: contactbench [--suite <name>[,...]] [--scenario <name>[,...]]
+ *                      [--nodes <n>[,...]] [--threads <n>[,...]] [--min-time <s>] [--seed <n>]
+ *                      [--tag <version>] [--csv <file>] [--json <file>] [--list]
+ *    既定: 全suite, 全scenario, 100,1000,10000節点, 1,2,4,...,64スレッド, 1ケース0.05秒
+ *  結果は表を標準出力に, --csv/--jsonのファイルにも書く.
+ * -----------------------------------------------------------------------*/
+
+#include "mbconfig.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "contactbench.h"
+
+volatile doublereal dBenchSink = 0.0;
+
+static const struct {
+	const char *name;
+	benchsuite f;
+	const char *desc;
+} suites[] = {
+	{ "helpers", suiteHelpers, "tanhfunc, exchangevector, contactforce, frictionforce, contactkernel (ns/node)" },
+	{ "elements", suiteElements, "Contactlaw per node pair: AssRes, AssJac, AfterConvergence, Newton metrics" },
+	{ "chain", suiteChain, "Contactlaw pairs vs ContactChain vs Seabed contact manager (ns/node per step, speedup)" },
+	{ "regularization", suiteRegularization, "friction regularizations: error against tanh vs cost, Contactlaw step" },
+	{ "jfnk", suiteJfnk, "Newton iteration with an assembled Jacobian vs matrix-free products, >= 10000 nodes (time, memory)" },
+	{ "ad", suiteAd, "Contactlaw Jacobian by automatic vs analytic differentiation (accepted within 1.5x)" },
+	{ "threads", suiteThreads, "ContactChain strong and weak scaling over threads, bitwise check against 1 thread" },
+	{ "trimesh", suiteTrimesh, "triangle mesh seabed (1M triangles): load time, cold vs coherent closest() per query" },
+};
+static const std::size_t iNumSuites = sizeof(suites)/sizeof(suites[0]);
+
+//"a,b,c" -> {a, b, c}
+static std::vector<std::string>
+split(const std::string& s)
+{
+	std::vector<std::string> v;
+	std::istringstream is(s);
+	std::string t;
+	while (std::getline(is, t, ',')) {
+		if (!t.empty()) {
+			v.push_back(t);
+		}
+	}
+	return v;
+}
+
+static void
+usage(std::ostream& os)
+{
+	os << "usage: contactbench [--suite <name>[,...]] [--scenario <name>[,...]]\n"
+		"                    [--nodes <n>[,...]] [--threads <n>[,...]] [--min-time <s>] [--seed <n>]\n"
+		"                    [--tag <version>] [--csv <file>] [--json <file>] [--list]\n";
+}
+
+int
+main(int argc, char *argv[])
+{
+	benchoptions opt;
+	opt.dMinTime = 0.05;
+	opt.uSeed = 1u;
+	std::vector<std::string> sSuites;
+	std::string sTag("unknown"), sCsvFile, sJsonFile;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string a(argv[i]);
+		if (a == "--list") {
+			for (std::size_t s = 0; s < iNumSuites; s++) {
+				std::cout << suites[s].name << ": " << suites[s].desc << "\n";
+			}
+			std::cout << "scenarios:";
+			for (int k = 0; k < int(scenario::LAST); k++) {
+				std::cout << " " << scenario::sName(scenario::Kind(k));
+			}
+			std::cout << std::endl;
+			return 0;
+		}
+		if (a == "--help" || a == "-h") {
+			usage(std::cout);
+			return 0;
+		}
+		if (i + 1 >= argc) {
+			usage(std::cerr);
+			return 1;
+		}
+		const std::string b(argv[++i]);
+		if (a == "--suite") {
+			sSuites = split(b);
+		} else if (a == "--scenario") {
+			const std::vector<std::string> v = split(b);
+			for (std::size_t k = 0; k < v.size(); k++) {
+				scenario::Kind kind;
+				if (!scenario::bParse(v[k], kind)) {
+					std::cerr << "contactbench: unknown scenario \"" << v[k] << "\"" << std::endl;
+					return 1;
+				}
+				opt.kinds.push_back(kind);
+			}
+		} else if (a == "--nodes") {
+			const std::vector<std::string> v = split(b);
+			for (std::size_t k = 0; k < v.size(); k++) {
+				const long n = std::strtol(v[k].c_str(), 0, 10);
+				if (n < 2) {
+					std::cerr << "contactbench: at least 2 nodes expected, got \"" << v[k] << "\"" << std::endl;
+					return 1;
+				}
+				opt.nodes.push_back(std::size_t(n));
+			}
+		} else if (a == "--threads") {
+			const std::vector<std::string> v = split(b);
+			for (std::size_t k = 0; k < v.size(); k++) {
+				const long n = std::strtol(v[k].c_str(), 0, 10);
+				if (n < 1) {
+					std::cerr << "contactbench: number of threads must be positive, got \"" << v[k] << "\"" << std::endl;
+					return 1;
+				}
+				opt.threads.push_back(unsigned(n));
+			}
+		} else if (a == "--min-time") {
+			opt.dMinTime = std::strtod(b.c_str(), 0);
+		} else if (a == "--seed") {
+			opt.uSeed = unsigned(std::strtoul(b.c_str(), 0, 10));
+		} else if (a == "--tag") {
+			sTag = b;
+		} else if (a == "--csv") {
+			sCsvFile = b;
+		} else if (a == "--json") {
+			sJsonFile = b;
+		} else {
+			usage(std::cerr);
+			return 1;
+		}
+	}
+
+	if (opt.nodes.empty()) {
+		opt.nodes.push_back(100);
+		opt.nodes.push_back(1000);
+		opt.nodes.push_back(10000);
+	}
+	if (opt.threads.empty()) {
+		for (unsigned t = 1; t <= 64; t *= 2) {
+			opt.threads.push_back(t);
+		}
+	}
+	if (opt.kinds.empty()) {
+		for (int k = 0; k < int(scenario::LAST); k++) {
+			opt.kinds.push_back(scenario::Kind(k));
+		}
+	}
+	if (sSuites.empty()) {
+		for (std::size_t s = 0; s < iNumSuites; s++) {
+			sSuites.push_back(suites[s].name);
+		}
+	}
+
+	benchresult res(sTag);
+	for (std::size_t k = 0; k < sSuites.size(); k++) {
+		std::size_t s = 0;
+		while (s < iNumSuites && sSuites[k] != suites[s].name) {
+			s++;
+		}
+		if (s == iNumSuites) {
+			std::cerr << "contactbench: unknown suite \"" << sSuites[k] << "\"" << std::endl;
+			return 1;
+		}
+		try {
+			suites[s].f(opt, res);
+		} catch (const MBDynErrBase& e) {
+			std::cerr << "contactbench: suite \"" << suites[s].name << "\" failed at "
+				<< e.sFile << ":" << e.iLine << std::endl;
+			return 1;
+		}
+	}
+
+	res.print(std::cout);
+	if (!sCsvFile.empty()) {
+		std::ofstream os(sCsvFile.c_str());
+		res.writeCsv(os);
+		if (!os) {
+			std::cerr << "contactbench: cannot write \"" << sCsvFile << "\"" << std::endl;
+			return 1;
+		}
+	}
+	if (!sJsonFile.empty()) {
+		std::ofstream os(sJsonFile.c_str());
+		res.writeJson(os);
+		if (!os) {
+			std::cerr << "contactbench: cannot write \"" << sJsonFile << "\"" << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef CONTACTBENCH_H
+#define CONTACTBENCH_H
+
+#include <cstddef>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "mbconfig.h"
+#include "matvec3.h"
+#include "scenario.h"
+#include "benchresult.h"
+
+/* =================================================
+ * contactbench
+ *  MBDynを使わずに接触要素とhelper classを測るベンチマーク.
+ *  suiteごとに関数を1つ置き, contactbench.ccの表に並べる.
+ *    helpers  : tanhfunc, exchangevector, contactforce, frictionforce, contactkernel
+ *    elements : Contactlaw(節点の組ごとの要素)のAssRes, AssJac, AfterConvergence
+ *    chain    : Contactlaw(節点の組ごと), ContactChain, Seabedのcontact managerの比較
+ *    regularization : 摩擦の正則化ごとのtanhに対する誤差と計算時間
+ *    jfnk     : ニュートン法1回の時間と記憶量(行列を作る場合と作らない場合)
+ *    ad       : Contactlawのヤコビ行列(自動微分と解析的な導関数)の時間の比と差
+ *    threads  : ContactChainのスレッド数によるstrong, weak scaling と結果の一致
+ *    trimesh  : 三角形メッシュの海底(1M三角形)の読み込みと最近接点の探索(hintなし, あり)
+ *
+ *  時間はdTimeで測る: 1回呼んでから, 1回がdMinTime/5以上になるまで回数を倍にし,
+ *  5回測った最小値を1回あたりのnsとする(他のプロセスの影響を除く).
+ * ================================================= */
+struct benchoptions
+{
+    std::vector<std::size_t> nodes;
+    std::vector<scenario::Kind> kinds;
+    //thread counts of the threads suite
+    std::vector<unsigned> threads;
+    //minimum measuring time of one case [s]
+    doublereal dMinTime;
+    unsigned uSeed;
+};
+
+typedef void (*benchsuite)(const benchoptions& opt, benchresult& res);
+
+//result of the functions timed by dTime (keeps the compiler from removing them)
+extern volatile doublereal dBenchSink;
+
+//ns per call of f()
+template <class F>
+doublereal
+dTime(F f, const doublereal& dMinTime)
+{
+    typedef std::chrono::steady_clock clock;
+    f();
+    unsigned long n = 1;
+    doublereal dBest = 0.0;
+    for (;;) {
+        const clock::time_point t0 = clock::now();
+        for (unsigned long i = 0; i < n; i++) {
+            f();
+        }
+        const doublereal dt = std::chrono::duration<doublereal>(clock::now() - t0).count();
+        if (dt >= 0.2*dMinTime || n >= (1ul << 30)) {
+            dBest = dt/doublereal(n);
+            break;
+        }
+        n *= 2;
+    }
+    for (int k = 1; k < 5; k++) {
+        const clock::time_point t0 = clock::now();
+        for (unsigned long i = 0; i < n; i++) {
+            f();
+        }
+        const doublereal dt = std::chrono::duration<doublereal>(clock::now() - t0).count()/doublereal(n);
+        dBest = (dt < dBest) ? dt : dBest;
+    }
+    return 1.0e9*dBest;
+}
+
+//suites
+void suiteHelpers(const benchoptions& opt, benchresult& res);
+void suiteElements(const benchoptions& opt, benchresult& res);
+void suiteChain(const benchoptions& opt, benchresult& res);
+void suiteRegularization(const benchoptions& opt, benchresult& res);
+void suiteJfnk(const benchoptions& opt, benchresult& res);
+void suiteAd(const benchoptions& opt, benchresult& res);
+void suiteThreads(const benchoptions& opt, benchresult& res);
+void suiteTrimesh(const benchoptions& opt, benchresult& res);
+
+#endif // CONTACTBENCH_H
@@ -0,0 +1,195 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "scenario.h"
+#include "module-seabed.h"
+#include "module-contactlaw.h"
+#include "contactchain.h"
+
+//Seabed: g, z, nu1d, nu1s, nu2d, nu2s, vt
+static const char *sSeabed = "9.81, 0.0, 0.5, 0.6, 0.5, 0.6, 0.01";
+//contact constants of all elements
+static const doublereal dK = 1.0e5;
+static const doublereal dC = 1.0e3;
+//regularization velocity (same as sSeabed)
+static const doublereal dVt = 0.01;
+
+static const char *sKindName[] = {
+	"airborne",
+	"resting",
+	"touchdown",
+	"sliding",
+	"stuck",
+};
+
+//xorshift (同じseedなら同じ節点列)
+static doublereal
+dJitter(unsigned& s)
+{
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	return 2.0*doublereal(s)/4294967295.0 - 1.0;
+}
+
+/* ------------------------------ scenario start ---------------------------------------*/
+scenario::scenario(Kind k, std::size_t n, unsigned uSeed)
+: kind(k), pSeabed(0), uNextLabel(1u), X(integer(12*n)), XP(integer(12*n))
+{
+	unsigned s = (uSeed == 0u) ? 1u : uSeed;
+	const doublereal ds = 1.0;
+	const doublereal L = ds*doublereal(n - 1);
+	//自重分のめり込み
+	const doublereal zRest = -0.01;
+
+	pNodes.resize(n);
+	for (std::size_t i = 0; i < n; i++) {
+		const doublereal x = ds*doublereal(i);
+		Vec3 r(x, 0.01*dJitter(s), zRest + 1.0e-3*dJitter(s));
+		Vec3 v(0.0, 0.0, 0.0);
+
+		switch (kind) {
+		case AIRBORNE:
+			r(3) = 5.0 + 0.1*dJitter(s);
+			break;
+
+		case RESTING:
+			break;
+
+		case TOUCHDOWN: {
+			//前半は着底してゆっくりすべる, 後半は放物線(終端で高さ20m)
+			const doublereal xTd = 0.4*L;
+			v = Vec3(2.0*dVt, 0.0, 0.0);
+			if (x > xTd) {
+				const doublereal t = (x - xTd)/(L - xTd);
+				r(3) = 20.0*t*t + zRest;
+				if (t < 0.1) {
+					v(3) = -0.2;
+				}
+			}
+			} break;
+
+		case SLIDING:
+			v = Vec3(0.5 + 0.05*dJitter(s), 0.1*dJitter(s), 0.0);
+			break;
+
+		case STUCK:
+			v = Vec3(0.01*dVt*(1.0 + 0.1*dJitter(s)), 0.005*dVt*dJitter(s), 0.0);
+			break;
+
+		default:
+			break;
+		}
+
+		pNodes[i] = new StructNode(unsigned(i + 1), integer(12*i));
+		pNodes[i]->SetState(r, v);
+		dm.InsertNode(pNodes[i]);
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			X(12*i + iCnt) = r(iCnt);
+			XP(12*i + iCnt) = v(iCnt);
+		}
+	}
+
+	//前のステップの時刻と時間刻み
+	dm.SetTime(1.0, 1.0e-3);
+
+	MBDynParser HP(sSeabed);
+	pSeabed = new Seabed(uSeabedLabel, &dof, &dm, HP);
+	pAdd(pSeabed);
+}
+
+scenario::~scenario(void)
+{
+	for (std::size_t i = pElems.size(); i > 0; i--) {
+		delete pElems[i - 1];
+	}
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		delete pNodes[i];
+	}
+}
+
+/*--[0]名前------------------------------------------------------------------------------*/
+const char *
+scenario::sName(Kind k)
+{
+	return (k < LAST) ? sKindName[k] : "unknown";
+}
+
+bool
+scenario::bParse(const std::string& s, Kind& k)
+{
+	for (int i = 0; i < int(LAST); i++) {
+		if (s == sKindName[i]) {
+			k = Kind(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*--[1]要素の入力--------------------------------------------------------------------------*/
+std::string
+scenario::sNodes(void) const
+{
+	std::ostringstream os;
+	os << "label range, 1, " << pNodes.size();
+	return os.str();
+}
+
+std::string
+scenario::sContact(void)
+{
+	std::ostringstream os;
+	os << "k, " << dK << ", c, " << dC;
+	return os.str();
+}
+
+Elem *
+scenario::pAdd(Elem *pElem)
+{
+	pElems.push_back(pElem);
+	dm.InsertElem(pElem);
+	return pElem;
+}
+
+std::vector<Elem *>
+scenario::addPairs(const std::string& sExtra)
+{
+	std::vector<Elem *> elems;
+	for (std::size_t i = 0; i + 1 < pNodes.size(); i++) {
+		std::ostringstream os;
+		os << i + 1 << ", " << i + 2 << ", " << uSeabedLabel << ", " << sContact();
+		if (!sExtra.empty()) {
+			os << ", " << sExtra;
+		}
+		MBDynParser HP(os.str());
+		elems.push_back(pAdd(new Contactlaw(uGetLabel(), &dof, &dm, HP)));
+	}
+	return elems;
+}
+
+Elem *
+scenario::pAddChain(const std::string& sExtra)
+{
+	std::ostringstream os;
+	os << sNodes() << ", " << uSeabedLabel << ", " << sContact();
+	if (!sExtra.empty()) {
+		os << ", " << sExtra;
+	}
+	MBDynParser HP(os.str());
+	return pAdd(new ContactChain(uGetLabel(), &dof, &dm, HP));
+}
+
+Seabed *
+scenario::pAddManager(const std::string& sExtra)
+{
+	MBDynParser HP(std::string(sSeabed) + ", contact, " + sContact() + ", nodes, " + sNodes()
+		+ (sExtra.empty() ? "" : ", " + sExtra));
+	Seabed *pManager = new Seabed(uGetLabel(), &dof, &dm, HP);
+	pAdd(pManager);
+	return pManager;
+}
+
+/* ------------------------------ scenario end -----------------------------------------*/
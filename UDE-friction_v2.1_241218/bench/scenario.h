@@ -0,0 +1,85 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "dataman.h"
+
+class Seabed;
+
+/* =================================================
+ * class Scenario
+ *  ベンチマーク用の節点列(係留索1本)と海底面を作る.
+ *  節点はx方向に間隔ds = 1で並び, 海底面は z = 0 の平面.
+ *  節点iのラベルは i + 1, 位置の添字は 12 i (MBDynの動的節点と同じ並び).
+ *
+ *    airborne  : 全節点が海底面の5m上で静止 (active setで計算を省ける)
+ *    resting   : 全節点が自重分(0.01m)めり込んで静止
+ *    touchdown : 前半40%は着底, 後半は放物線で立ち上がり, 着底点付近は下向きに動く
+ *    sliding   : 着底して 0.5m/s ですべる (摩擦は飽和, |v| >> vt)
+ *    stuck     : 着底して vt の1/100で動く (摩擦の正則化の線形域)
+ *
+ *  位置と速度には乱数(固定のseed)で小さなばらつきを加える.
+ *  要素はsTokens()の入力を読んで作り, scenarioが削除する.
+ * ================================================= */
+class scenario
+{
+public:
+    enum Kind {
+        AIRBORNE,
+        RESTING,
+        TOUCHDOWN,
+        SLIDING,
+        STUCK,
+        LAST
+    };
+
+    //label of the Seabed element of the scenario
+    static const unsigned uSeabedLabel = 1000000u;
+
+private:
+    Kind kind;
+    DataManager dm;
+    DofOwner dof;
+    std::vector<StructNode *> pNodes;
+    std::vector<Elem *> pElems;
+    Seabed *pSeabed;
+    unsigned uNextLabel;
+    MyVectorHandler X, XP;
+
+public:
+    //n nodes (n >= 2), contact constants k, c and Seabed friction of scenario.cc
+    scenario(Kind k, std::size_t n, unsigned uSeed = 1u);
+    ~scenario(void);
+
+    static const char *sName(Kind k);
+    static bool bParse(const std::string& s, Kind& k);
+
+    Kind getKind(void) const { return kind; };
+    std::size_t iGetNumNodes(void) const { return pNodes.size(); };
+    const StructNode *pGetNode(std::size_t i) const { return pNodes[i]; };
+    DataManager& getDataManager(void) { return dm; };
+    const DofOwner *pGetDofOwner(void) const { return &dof; };
+    Seabed *pGetSeabed(void) const { return pSeabed; };
+    //positions and velocities of all DOFs (12 per node)
+    MyVectorHandler& getX(void) { return X; };
+    MyVectorHandler& getXP(void) { return XP; };
+
+    //node label range "label range, 1, n", contact constants "k, <k>, c, <c>"
+    std::string sNodes(void) const;
+    static std::string sContact(void);
+    //next free element label
+    unsigned uGetLabel(void) { return uNextLabel++; };
+    //register an element with the DataManager (the scenario deletes it)
+    Elem *pAdd(Elem *pElem);
+    //Contactlaw for each pair of neighbouring nodes (n - 1 elements, options sExtra)
+    std::vector<Elem *> addPairs(const std::string& sExtra = std::string());
+    //ContactChain of all nodes (options sExtra)
+    Elem *pAddChain(const std::string& sExtra = std::string());
+    //Seabed with the contact manager of all nodes ("contact, ..." and sExtra)
+    Seabed *pAddManager(const std::string& sExtra);
+};
+
+#endif // SCENARIO_H
@@ -0,0 +1,304 @@
+#ifndef DATAMAN_H
+#define DATAMAN_H
+
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mbconfig.h"
+#include "myassert.h"
+#include "except.h"
+#include "matvec3.h"
+
+/* =================================================
+ * contactbench stub
+ *  MBDynのdataman.hの代わり. moduleが使うクラスとメンバだけを置く.
+ *    VectorHandler, SubVectorHandler : 添字は1から(MBDynと同じ)
+ *    VariableSubMatrixHandler        : null行列とsparse行列(moduleはfullを使わない)
+ *    StructNode                      : 位置の添字 iFirstIndex, 運動量の添字 iFirstIndex + 6
+ *    MBDynParser                     : ", "で区切った文字列から読む(keywordは空白と大文字小文字を無視)
+ *    DataManager                     : 節点と要素の表, 時刻と時間刻み
+ * ================================================= */
+
+/*--Vector-----------------------------------------------------------------------------*/
+class VectorHandler
+{
+public:
+    virtual ~VectorHandler(void) {};
+
+    virtual integer iGetSize(void) const = 0;
+    virtual const doublereal& operator()(integer i) const = 0;
+    virtual doublereal& operator()(integer i) = 0;
+    virtual doublereal dGetCoef(integer i) const { return (*this)(i); };
+    virtual void PutCoef(integer i, const doublereal& d) { (*this)(i) = d; };
+    virtual void IncCoef(integer i, const doublereal& d) { (*this)(i) += d; };
+};
+
+class MyVectorHandler : public VectorHandler
+{
+private:
+    std::vector<doublereal> pdVec;
+
+public:
+    MyVectorHandler(integer iSize = 0) : pdVec(iSize, 0.0) {};
+
+    void Resize(integer iSize) { pdVec.resize(iSize, 0.0); };
+    void Reset(void) { pdVec.assign(pdVec.size(), 0.0); };
+    integer iGetSize(void) const { return integer(pdVec.size()); };
+    const doublereal& operator()(integer i) const { return pdVec[i - 1]; };
+    doublereal& operator()(integer i) { return pdVec[i - 1]; };
+};
+
+//rows of one element (row index and coefficient)
+class SubVectorHandler : public VectorHandler
+{
+private:
+    std::vector<integer> piRow;
+    std::vector<doublereal> pdVec;
+
+public:
+    SubVectorHandler(void) {};
+
+    void ResizeReset(integer iSize) { piRow.assign(iSize, 0); pdVec.assign(iSize, 0.0); };
+    integer iGetSize(void) const { return integer(pdVec.size()); };
+    const doublereal& operator()(integer i) const { return pdVec[i - 1]; };
+    doublereal& operator()(integer i) { return pdVec[i - 1]; };
+    void PutRowIndex(integer i, integer iRow) { piRow[i - 1] = iRow; };
+    integer iGetRowIndex(integer i) const { return piRow[i - 1]; };
+    void PutItem(integer i, integer iRow, const doublereal& d) { piRow[i - 1] = iRow; pdVec[i - 1] = d; };
+    //rows i, i + 1, i + 2
+    void Put(integer i, const Vec3& v) { pdVec[i - 1] = v(1); pdVec[i] = v(2); pdVec[i + 1] = v(3); };
+    void Add(integer i, const Vec3& v) { pdVec[i - 1] += v(1); pdVec[i] += v(2); pdVec[i + 1] += v(3); };
+    void Sub(integer i, const Vec3& v) { pdVec[i - 1] -= v(1); pdVec[i] -= v(2); pdVec[i + 1] -= v(3); };
+
+    //V(row) += coefficient (assembly into the global residual)
+    void AddTo(VectorHandler& V) const;
+};
+
+/*--Matrix-----------------------------------------------------------------------------*/
+class SparseSubMatrixHandler
+{
+private:
+    std::vector<integer> piRow, piCol;
+    std::vector<doublereal> pdMat;
+
+public:
+    SparseSubMatrixHandler(void) {};
+
+    //iNumItems entries (iNumCols is always 1 in the modules)
+    void ResizeReset(integer iNumItems, integer iNumCols);
+    void PutItem(integer iEntry, integer iRow, integer iCol, const doublereal& d) {
+        piRow[iEntry - 1] = iRow;
+        piCol[iEntry - 1] = iCol;
+        pdMat[iEntry - 1] = d;
+    };
+    integer iGetNumItems(void) const { return integer(pdMat.size()); };
+    integer iGetRowIndex(integer i) const { return piRow[i - 1]; };
+    integer iGetColIndex(integer i) const { return piCol[i - 1]; };
+    const doublereal& dGetCoef(integer i) const { return pdMat[i - 1]; };
+
+    //Y(row) += d X(col)
+    void MultAdd(VectorHandler& Y, const VectorHandler& X) const;
+};
+
+class VariableSubMatrixHandler
+{
+public:
+    enum Type { NULLMATRIX, SPARSE };
+
+private:
+    Type eType;
+    SparseSubMatrixHandler SM;
+
+public:
+    VariableSubMatrixHandler(void) : eType(NULLMATRIX) {};
+
+    void SetNullMatrix(void) { eType = NULLMATRIX; };
+    SparseSubMatrixHandler& SetSparse(void) { eType = SPARSE; return SM; };
+    Type GetType(void) const { return eType; };
+    //entries of the last matrix (0 for the null matrix)
+    integer iGetNumItems(void) const { return (eType == SPARSE) ? SM.iGetNumItems() : 0; };
+    const SparseSubMatrixHandler& GetSparse(void) const { return SM; };
+
+    //Y += A X
+    void MultAdd(VectorHandler& Y, const VectorHandler& X) const;
+};
+
+/*--Node, Element------------------------------------------------------------------------*/
+namespace DofOrder { enum Order { ALGEBRAIC, DIFFERENTIAL }; }
+
+class DofOwner
+{
+public:
+    DofOwner(void) {};
+};
+
+class SimulationEntity
+{
+public:
+    struct Hints {};
+    virtual ~SimulationEntity(void) {};
+};
+
+class Node : public SimulationEntity
+{
+public:
+    enum Type { STRUCTURAL };
+
+protected:
+    unsigned uLabel;
+    integer iFirstIndex;
+
+public:
+    Node(unsigned uL, integer iFirst) : uLabel(uL), iFirstIndex(iFirst) {};
+    virtual ~Node(void) {};
+
+    unsigned GetLabel(void) const { return uLabel; };
+    virtual integer iGetFirstIndex(void) const { return iFirstIndex; };
+};
+
+//dynamic node: position (3), orientation (3), momentum (3), angular momentum (3)
+class StructNode : public Node
+{
+public:
+    enum Type { STATIC, DYNAMIC, MODAL, DUMMY };
+
+protected:
+    Type eType;
+    Vec3 XCurr, VCurr, XPrev, VPrev;
+
+public:
+    StructNode(unsigned uL, integer iFirst, Type t = DYNAMIC)
+    : Node(uL, iFirst), eType(t) {};
+
+    StructNode::Type GetStructNodeType(void) const { return eType; };
+    integer iGetFirstPositionIndex(void) const { return iFirstIndex; };
+    integer iGetFirstMomentumIndex(void) const { return iFirstIndex + 6; };
+    const Vec3& GetXCurr(void) const { return XCurr; };
+    const Vec3& GetVCurr(void) const { return VCurr; };
+    const Vec3& GetXPrev(void) const { return XPrev; };
+    const Vec3& GetVPrev(void) const { return VPrev; };
+    //position and velocity (scenario generator)
+    void SetState(const Vec3& X, const Vec3& V) { XPrev = XCurr = X; VPrev = VCurr = V; };
+};
+
+class OutputHandler
+{
+public:
+    enum OutFiles { LOADABLE };
+
+    bool UseText(int) const { return false; };
+    std::ostream& Loadable(void) { return std::cout; };
+};
+
+class Elem : public SimulationEntity
+{
+public:
+    enum Type { LOADABLE, BODY };
+    typedef unsigned flag;
+
+private:
+    unsigned uLabel;
+    flag fOutput;
+
+public:
+    Elem(unsigned uL, flag fOut) : uLabel(uL), fOutput(fOut) {};
+    virtual ~Elem(void) {};
+
+    unsigned GetLabel(void) const { return uLabel; };
+    bool bToBeOutput(void) const { return fOutput != 0; };
+    void SetOutputFlag(flag f) { fOutput = f; };
+    //first index of the element's own DOFs (no element of the benchmark has any)
+    integer iGetFirstIndex(void) const { return 0; };
+
+    virtual void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const = 0;
+    virtual SubVectorHandler&
+    AssRes(SubVectorHandler& WorkVec, doublereal dCoef,
+        const VectorHandler& XCurr, const VectorHandler& XPrimeCurr) = 0;
+    virtual VariableSubMatrixHandler&
+    AssJac(VariableSubMatrixHandler& WorkMat, doublereal dCoef,
+        const VectorHandler& XCurr, const VectorHandler& XPrimeCurr) = 0;
+    //JacY += A Y (MBDyn: assembles A and multiplies unless the element overrides it)
+    virtual void
+    AssJac(VectorHandler& JacY, const VectorHandler& Y, doublereal dCoef,
+        const VectorHandler& XCurr, const VectorHandler& XPrimeCurr,
+        VariableSubMatrixHandler& WorkMat);
+
+    virtual void AfterPredict(VectorHandler& X, VectorHandler& XP) {};
+    virtual void AfterConvergence(const VectorHandler& X, const VectorHandler& XP) {};
+
+    virtual unsigned int iGetNumPrivData(void) const { return 0; };
+    virtual unsigned int iGetPrivDataIdx(const char *s) const { return 0; };
+    virtual doublereal dGetPrivData(unsigned int i) const { return 0.0; };
+};
+typedef Elem::flag flag;
+
+/*--Parser, DataManager------------------------------------------------------------------*/
+class MBDynParser
+{
+private:
+    std::vector<std::string> sTokens;
+    std::size_t iNext;
+    std::string sFileName;
+
+    const std::string& sGetToken(void);
+
+public:
+    //tokens separated by ',' (a trailing ';' is ignored)
+    MBDynParser(const std::string& s);
+
+    bool IsKeyWord(const char *s);
+    bool IsArg(void) const { return iNext < sTokens.size(); };
+    integer GetInt(void);
+    doublereal GetReal(void);
+    const char *GetFileName(void);
+    const char *GetLineData(void) const { return "<contactbench>"; };
+};
+
+class DriveHandler
+{
+private:
+    doublereal dTime, dTimeStep;
+
+public:
+    DriveHandler(void) : dTime(0.0), dTimeStep(1.0e-3) {};
+
+    doublereal dGetTime(void) const { return dTime; };
+    doublereal dGetTimeStep(void) const { return dTimeStep; };
+    void Set(const doublereal& t, const doublereal& dt) { dTime = t; dTimeStep = dt; };
+};
+
+class DataManager
+{
+public:
+    typedef std::vector<Node *> NodeContainerType;
+
+private:
+    NodeContainerType nodes;
+    std::map<unsigned, Node *> nodemap;
+    std::map<unsigned, Elem *> elemmap;
+    DriveHandler drv;
+    std::ostream logfile;
+
+public:
+    DataManager(void);
+    ~DataManager(void);
+
+    //the DataManager does not own the nodes and elements
+    void InsertNode(Node *pNode);
+    void InsertElem(Elem *pElem);
+    void SetTime(const doublereal& t, const doublereal& dt) { drv.Set(t, dt); };
+
+    Node *ReadNode(MBDynParser& HP, Node::Type t);
+    Node *pFindNode(Node::Type t, unsigned uLabel) const;
+    Elem *pFindElem(Elem::Type t, unsigned uLabel) const;
+    const NodeContainerType& GetNodes(void) const { return nodes; };
+    std::ostream& GetLogFile(void) { return logfile; };
+    flag fReadOutput(MBDynParser& HP, Elem::Type t) const { return flag(0); };
+    const DriveHandler *pGetDrvHdl(void) const { return &drv; };
+    doublereal dGetTime(void) const { return drv.dGetTime(); };
+};
+
+#endif // DATAMAN_H
@@ -0,0 +1,39 @@
+#ifndef EXCEPT_H
+#define EXCEPT_H
+
+#include <string>
+
+/* =================================================
+ * contactbench stub
+ *  MBDynの例外(ErrGeneric, NoErr)の代わり.
+ * ================================================= */
+#define MBDYN_EXCEPT_ARGS __FILE__, __LINE__, __func__, std::string()
+
+class MBDynErrBase
+{
+public:
+    MBDynErrBase(const char *file, int line, const char *func, const std::string& r)
+    : sFile(file), iLine(line), sFunc(func), sWhat(r) {};
+    virtual ~MBDynErrBase(void) {};
+
+    const char *sFile;
+    int iLine;
+    const char *sFunc;
+    std::string sWhat;
+};
+
+class ErrGeneric : public MBDynErrBase
+{
+public:
+    ErrGeneric(const char *file, int line, const char *func, const std::string& r = std::string())
+    : MBDynErrBase(file, line, func, r) {};
+};
+
+class NoErr : public MBDynErrBase
+{
+public:
+    NoErr(const char *file, int line, const char *func, const std::string& r = std::string())
+    : MBDynErrBase(file, line, func, r) {};
+};
+
+#endif // EXCEPT_H
@@ -0,0 +1,87 @@
+#ifndef MATVEC3_H
+#define MATVEC3_H
+
+#include <cmath>
+
+/* =================================================
+ * contactbench stub
+ *  MBDynのmatvec3.hのうちmoduleが使うVec3, Mat3x3の演算だけを置く.
+ *  添字はMBDynと同じく1から始まる.
+ * ================================================= */
+typedef double doublereal;
+typedef int integer;
+
+class Vec3
+{
+private:
+    doublereal pdVec[3];
+
+public:
+    Vec3(void) { pdVec[0] = pdVec[1] = pdVec[2] = 0.0; };
+    Vec3(const doublereal& v1, const doublereal& v2, const doublereal& v3) {
+        pdVec[0] = v1; pdVec[1] = v2; pdVec[2] = v3;
+    };
+
+    const doublereal *pGetVec(void) const { return pdVec; };
+    const doublereal& dGet(unsigned short i) const { return pdVec[i - 1]; };
+    void Put(unsigned short i, const doublereal& d) { pdVec[i - 1] = d; };
+    const doublereal& operator()(unsigned short i) const { return pdVec[i - 1]; };
+    doublereal& operator()(unsigned short i) { return pdVec[i - 1]; };
+
+    doublereal Dot(void) const { return pdVec[0]*pdVec[0] + pdVec[1]*pdVec[1] + pdVec[2]*pdVec[2]; };
+    doublereal Dot(const Vec3& v) const { return pdVec[0]*v.pdVec[0] + pdVec[1]*v.pdVec[1] + pdVec[2]*v.pdVec[2]; };
+    doublereal Norm(void) const { return std::sqrt(Dot()); };
+    bool IsNull(void) const { return pdVec[0] == 0.0 && pdVec[1] == 0.0 && pdVec[2] == 0.0; };
+    Vec3 Cross(const Vec3& v) const {
+        return Vec3(pdVec[1]*v.pdVec[2] - pdVec[2]*v.pdVec[1],
+            pdVec[2]*v.pdVec[0] - pdVec[0]*v.pdVec[2],
+            pdVec[0]*v.pdVec[1] - pdVec[1]*v.pdVec[0]);
+    };
+
+    Vec3 operator+(const Vec3& v) const { return Vec3(pdVec[0] + v.pdVec[0], pdVec[1] + v.pdVec[1], pdVec[2] + v.pdVec[2]); };
+    Vec3 operator-(const Vec3& v) const { return Vec3(pdVec[0] - v.pdVec[0], pdVec[1] - v.pdVec[1], pdVec[2] - v.pdVec[2]); };
+    Vec3 operator-(void) const { return Vec3(-pdVec[0], -pdVec[1], -pdVec[2]); };
+    Vec3 operator*(const doublereal& d) const { return Vec3(pdVec[0]*d, pdVec[1]*d, pdVec[2]*d); };
+    Vec3 operator/(const doublereal& d) const { return Vec3(pdVec[0]/d, pdVec[1]/d, pdVec[2]/d); };
+    //scalar product (MBDyn: Vec3*Vec3)
+    doublereal operator*(const Vec3& v) const { return Dot(v); };
+
+    Vec3& operator+=(const Vec3& v) { pdVec[0] += v.pdVec[0]; pdVec[1] += v.pdVec[1]; pdVec[2] += v.pdVec[2]; return *this; };
+    Vec3& operator-=(const Vec3& v) { pdVec[0] -= v.pdVec[0]; pdVec[1] -= v.pdVec[1]; pdVec[2] -= v.pdVec[2]; return *this; };
+    Vec3& operator*=(const doublereal& d) { pdVec[0] *= d; pdVec[1] *= d; pdVec[2] *= d; return *this; };
+};
+
+inline Vec3 operator*(const doublereal& d, const Vec3& v) { return v*d; }
+
+extern const Vec3 Zero3;
+
+class Mat3x3
+{
+private:
+    //row major
+    doublereal pdMat[9];
+
+public:
+    Mat3x3(void) { for (int i = 0; i < 9; i++) { pdMat[i] = 0.0; } };
+    explicit Mat3x3(const doublereal& d) {
+        for (int i = 0; i < 9; i++) { pdMat[i] = 0.0; }
+        pdMat[0] = pdMat[4] = pdMat[8] = d;
+    };
+
+    const doublereal& dGet(unsigned short i, unsigned short j) const { return pdMat[3*(i - 1) + j - 1]; };
+    void Put(unsigned short i, unsigned short j, const doublereal& d) { pdMat[3*(i - 1) + j - 1] = d; };
+    const doublereal& operator()(unsigned short i, unsigned short j) const { return pdMat[3*(i - 1) + j - 1]; };
+    doublereal& operator()(unsigned short i, unsigned short j) { return pdMat[3*(i - 1) + j - 1]; };
+
+    Vec3 operator*(const Vec3& v) const {
+        return Vec3(pdMat[0]*v(1) + pdMat[1]*v(2) + pdMat[2]*v(3),
+            pdMat[3]*v(1) + pdMat[4]*v(2) + pdMat[5]*v(3),
+            pdMat[6]*v(1) + pdMat[7]*v(2) + pdMat[8]*v(3));
+    };
+    Mat3x3 operator*(const doublereal& d) const { Mat3x3 m(*this); for (int i = 0; i < 9; i++) { m.pdMat[i] *= d; } return m; };
+    Mat3x3 operator+(const Mat3x3& b) const { Mat3x3 m(*this); return m += b; };
+    Mat3x3 operator-(const Mat3x3& b) const { Mat3x3 m(*this); for (int i = 0; i < 9; i++) { m.pdMat[i] -= b.pdMat[i]; } return m; };
+    Mat3x3& operator+=(const Mat3x3& b) { for (int i = 0; i < 9; i++) { pdMat[i] += b.pdMat[i]; } return *this; };
+};
+
+#endif // MATVEC3_H
@@ -0,0 +1,9 @@
+#ifndef MBCONFIG_H
+#define MBCONFIG_H
+
+/* =================================================
+ * contactbench stub
+ *  MBDynのmbconfig.hの代わり(ベンチマークではconfigureの設定を使わない).
+ * ================================================= */
+
+#endif // MBCONFIG_H
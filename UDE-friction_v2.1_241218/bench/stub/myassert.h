@@ -0,0 +1,16 @@
+#ifndef MYASSERT_H
+#define MYASSERT_H
+
+#include <iostream>
+
+/* =================================================
+ * contactbench stub
+ *  MBDynのmyassert.hのうちmoduleが使うマクロだけを置く.
+ *  silent_coutはベンチマークの出力を乱さないよう捨て, silent_cerrはstderrに出す.
+ * ================================================= */
+#define NO_OP do {} while (0)
+#define silent_cout(arg) do {} while (0)
+#define silent_cerr(arg) do { std::cerr << arg; } while (0)
+#define pedantic_cout(arg) do {} while (0)
+
+#endif // MYASSERT_H
@@ -0,0 +1,190 @@
+#include "mbconfig.h"
+
+#include <cctype>
+#include <cstdlib>
+
+#include "dataman.h"
+#include "userelem.h"
+
+/* ------------------------------ contactbench stub start ---------------------------------------*/
+const Vec3 Zero3(0.0, 0.0, 0.0);
+
+/*--[0]SubVectorHandler, SubMatrixHandler---------------------------------------------*/
+void
+SubVectorHandler::AddTo(VectorHandler& V) const
+{
+	for (std::size_t i = 0; i < pdVec.size(); i++) {
+		V(piRow[i]) += pdVec[i];
+	}
+}
+
+void
+SparseSubMatrixHandler::ResizeReset(integer iNumItems, integer iNumCols)
+{
+	piRow.assign(iNumItems, 0);
+	piCol.assign(iNumItems, 0);
+	pdMat.assign(iNumItems, 0.0);
+}
+
+void
+SparseSubMatrixHandler::MultAdd(VectorHandler& Y, const VectorHandler& X) const
+{
+	for (std::size_t i = 0; i < pdMat.size(); i++) {
+		Y(piRow[i]) += pdMat[i]*X(piCol[i]);
+	}
+}
+
+void
+VariableSubMatrixHandler::MultAdd(VectorHandler& Y, const VectorHandler& X) const
+{
+	if (eType == SPARSE) {
+		SM.MultAdd(Y, X);
+	}
+}
+
+/*--[1]Elem---------------------------------------------------------------------------*/
+void
+Elem::AssJac(VectorHandler& JacY, const VectorHandler& Y, doublereal dCoef,
+	const VectorHandler& XCurr, const VectorHandler& XPrimeCurr,
+	VariableSubMatrixHandler& WorkMat)
+{
+	AssJac(WorkMat, dCoef, XCurr, XPrimeCurr).MultAdd(JacY, Y);
+}
+
+bool
+SetUDE(const std::string& s, UserDefinedElemRead *rf)
+{
+	return true;
+}
+
+/*--[2]MBDynParser--------------------------------------------------------------------*/
+MBDynParser::MBDynParser(const std::string& s)
+: iNext(0)
+{
+	std::string sToken;
+	for (std::size_t i = 0; i <= s.size(); i++) {
+		if (i == s.size() || s[i] == ',' || s[i] == ';') {
+			const std::size_t b = sToken.find_first_not_of(" \t\n");
+			const std::size_t e = sToken.find_last_not_of(" \t\n");
+			if (b != std::string::npos) {
+				sTokens.push_back(sToken.substr(b, e - b + 1));
+			}
+			sToken.clear();
+			continue;
+		}
+		sToken += s[i];
+	}
+}
+
+const std::string&
+MBDynParser::sGetToken(void)
+{
+	if (iNext >= sTokens.size()) {
+		silent_cerr("MBDynParser: unexpected end of input" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	return sTokens[iNext++];
+}
+
+//MBDynと同じく空白を除き, 大文字小文字を区別しない
+bool
+MBDynParser::IsKeyWord(const char *s)
+{
+	if (iNext >= sTokens.size()) {
+		return false;
+	}
+	const std::string& t = sTokens[iNext];
+	std::size_t j = 0;
+	for (std::size_t i = 0; i < t.size(); i++) {
+		if (std::isspace((unsigned char)t[i])) {
+			continue;
+		}
+		while (s[j] != '\0' && std::isspace((unsigned char)s[j])) {
+			j++;
+		}
+		if (s[j] == '\0' || std::tolower((unsigned char)t[i]) != std::tolower((unsigned char)s[j])) {
+			return false;
+		}
+		j++;
+	}
+	if (s[j] != '\0') {
+		return false;
+	}
+	iNext++;
+	return true;
+}
+
+integer
+MBDynParser::GetInt(void)
+{
+	return integer(std::strtol(sGetToken().c_str(), 0, 10));
+}
+
+doublereal
+MBDynParser::GetReal(void)
+{
+	return std::strtod(sGetToken().c_str(), 0);
+}
+
+const char *
+MBDynParser::GetFileName(void)
+{
+	sFileName = sGetToken();
+	if (sFileName.size() >= 2 && sFileName[0] == '"' && sFileName[sFileName.size() - 1] == '"') {
+		sFileName = sFileName.substr(1, sFileName.size() - 2);
+	}
+	return sFileName.c_str();
+}
+
+/*--[3]DataManager--------------------------------------------------------------------*/
+DataManager::DataManager(void)
+: logfile(0)
+{
+	NO_OP;
+}
+
+DataManager::~DataManager(void)
+{
+	NO_OP;
+}
+
+void
+DataManager::InsertNode(Node *pNode)
+{
+	nodes.push_back(pNode);
+	nodemap[pNode->GetLabel()] = pNode;
+}
+
+void
+DataManager::InsertElem(Elem *pElem)
+{
+	elemmap[pElem->GetLabel()] = pElem;
+}
+
+Node *
+DataManager::ReadNode(MBDynParser& HP, Node::Type t)
+{
+	const unsigned uLabel = unsigned(HP.GetInt());
+	Node *pNode = pFindNode(t, uLabel);
+	if (pNode == 0) {
+		silent_cerr("DataManager: node " << uLabel << " not found" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	return pNode;
+}
+
+Node *
+DataManager::pFindNode(Node::Type t, unsigned uLabel) const
+{
+	std::map<unsigned, Node *>::const_iterator i = nodemap.find(uLabel);
+	return (i == nodemap.end()) ? 0 : i->second;
+}
+
+Elem *
+DataManager::pFindElem(Elem::Type t, unsigned uLabel) const
+{
+	std::map<unsigned, Elem *>::const_iterator i = elemmap.find(uLabel);
+	return (i == elemmap.end()) ? 0 : i->second;
+}
+
+/* ------------------------------ contactbench stub end -----------------------------------------*/
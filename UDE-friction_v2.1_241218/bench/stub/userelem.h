@@ -0,0 +1,33 @@
+#ifndef USERELEM_H
+#define USERELEM_H
+
+#include <string>
+
+#include "dataman.h"
+
+/* =================================================
+ * contactbench stub
+ *  MBDynのuserelem.hの代わり. ベンチマークは要素を直接作るので
+ *  SetUDEは登録せずにtrueを返す.
+ * ================================================= */
+class UserDefinedElem
+: virtual public Elem
+{
+public:
+    UserDefinedElem(unsigned uLabel, const DofOwner *pDO) : Elem(uLabel, flag(0)) {};
+    virtual ~UserDefinedElem(void) {};
+};
+
+struct UserDefinedElemRead
+{
+    virtual ~UserDefinedElemRead(void) {};
+};
+
+template <class UDE>
+struct UDERead : public UserDefinedElemRead
+{
+};
+
+bool SetUDE(const std::string& s, UserDefinedElemRead *rf);
+
+#endif // USERELEM_H
@@ -0,0 +1,93 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "contactbench.h"
+#include "benchelem.h"
+
+//自動微分を既定にしてよい時間の比(automatic/analytic)の上限
+static const doublereal dAcceptRatio = 1.5;
+
+//AssJac 1回と A y 1回の時間[ns/節点], 最後の A y
+static void
+jacobian(scenario& sc, const std::string& sLaw, const benchoptions& opt,
+	doublereal& dJac, doublereal& dJvp, MyVectorHandler& AY)
+{
+	benchelem be(sc, sc.addPairs(sLaw));
+	const std::size_t N = sc.iGetNumNodes();
+	MyVectorHandler Y, JacY(sc.getX().iGetSize());
+
+	be.prepare();
+	be.direction(Y, opt.uSeed);
+	dJac = dTime([&]() { be.assjac(); }, opt.dMinTime)/N;
+	dJvp = dTime([&]() { be.jvp(JacY, Y); }, opt.dMinTime)/N;
+
+	AY.Resize(sc.getX().iGetSize());
+	AY.Reset();
+	be.matvec(AY, Y);
+}
+
+/*--ad------------------------------------------------------------------------------------
+ * Contactlawのヤコビ行列を解析的な導関数(analytic)と自動微分(automatic)で求めて比べる.
+ *   assjac_ratio, jvp_ratio : automaticの時間/analyticの時間 (AssJacと行列なしの A y)
+ *   accepted                : 両方の比がdAcceptRatio(1.5)以下なら1
+ *                             scenario "all" は全ケースの最大の比での判定
+ *   jacobian_difference     : 2つの A y の相対差 (丸め誤差の程度であること)
+ * 摩擦はprojectedとcoulomb(stick slipは自動微分がない), 正則化はtanh.
+ *---------------------------------------------------------------------------------------*/
+void
+suiteAd(const benchoptions& opt, benchresult& res)
+{
+	const char *sSuite = "ad";
+	static const char *sFriction[] = { "projected", "coulomb" };
+	doublereal dWorst = 0.0;
+
+	for (std::size_t ik = 0; ik < opt.kinds.size(); ik++) {
+		for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+			const std::size_t N = opt.nodes[in];
+			const std::string sKind = scenario::sName(opt.kinds[ik]);
+
+			for (int f = 0; f < 2; f++) {
+				const std::string sLaw = std::string("law, friction, ") + sFriction[f];
+				const std::string sName = std::string("Contactlaw ") + sFriction[f];
+				doublereal dJac, dJvp, dJacAd, dJvpAd;
+				MyVectorHandler AY, AYAd;
+				{
+					scenario sc(opt.kinds[ik], N, opt.uSeed);
+					jacobian(sc, sLaw + ", differentiation, analytic", opt, dJac, dJvp, AY);
+				}
+				{
+					scenario sc(opt.kinds[ik], N, opt.uSeed);
+					jacobian(sc, sLaw + ", differentiation, automatic", opt, dJacAd, dJvpAd, AYAd);
+				}
+
+				res.add(sSuite, sName + " analytic", sKind, N, 1, "assjac_ns_per_node", dJac, "ns");
+				res.add(sSuite, sName + " analytic", sKind, N, 1, "jvp_ns_per_node", dJvp, "ns");
+				res.add(sSuite, sName + " automatic", sKind, N, 1, "assjac_ns_per_node", dJacAd, "ns");
+				res.add(sSuite, sName + " automatic", sKind, N, 1, "jvp_ns_per_node", dJvpAd, "ns");
+
+				const doublereal dJacRatio = dJacAd/dJac;
+				const doublereal dJvpRatio = dJvpAd/dJvp;
+				res.add(sSuite, sName, sKind, N, 1, "assjac_ratio", dJacRatio, "x");
+				res.add(sSuite, sName, sKind, N, 1, "jvp_ratio", dJvpRatio, "x");
+				res.add(sSuite, sName, sKind, N, 1, "accepted",
+					(dJacRatio <= dAcceptRatio && dJvpRatio <= dAcceptRatio) ? 1.0 : 0.0, "bool");
+				dWorst = std::max(dWorst, std::max(dJacRatio, dJvpRatio));
+
+				doublereal dDiff = 0.0, dNorm = 0.0;
+				for (integer i = 1; i <= AY.iGetSize(); i++) {
+					dDiff += (AYAd(i) - AY(i))*(AYAd(i) - AY(i));
+					dNorm += AY(i)*AY(i);
+				}
+				res.add(sSuite, sName, sKind, N, 1, "jacobian_difference",
+					(dNorm > 0.0) ? std::sqrt(dDiff/dNorm) : std::sqrt(dDiff), "relative");
+			}
+		}
+	}
+
+	//全ケースの最大の比 (analyticを既定にしておくかの判断)
+	res.add(sSuite, "Contactlaw", "all", opt.nodes.back(), 1, "worst_ratio", dWorst, "x");
+	res.add(sSuite, "Contactlaw", "all", opt.nodes.back(), 1, "accepted", (dWorst <= dAcceptRatio) ? 1.0 : 0.0, "bool");
+}
@@ -0,0 +1,68 @@
+#include "mbconfig.h"
+
+#include <vector>
+
+#include "contactbench.h"
+#include "benchelem.h"
+#include "module-seabed.h"
+
+//1ステップ(AssRes 1回とAssJac 1回)の時間[ns/節点]を測って結果に加える
+static doublereal
+dStep(benchelem& be, scenario& sc, const benchoptions& opt, benchresult& res, const std::string& sName)
+{
+	const char *sSuite = "chain";
+	const std::string sKind = scenario::sName(sc.getKind());
+	const std::size_t N = sc.iGetNumNodes();
+	MyVectorHandler R(sc.getX().iGetSize());
+
+	be.prepare();
+	const doublereal dRes = dTime([&]() { be.assres(R); }, opt.dMinTime)/N;
+	const doublereal dJac = dTime([&]() { be.assjac(); }, opt.dMinTime)/N;
+	res.add(sSuite, sName, sKind, N, 1, "assres_ns_per_node", dRes, "ns");
+	res.add(sSuite, sName, sKind, N, 1, "assjac_ns_per_node", dJac, "ns");
+	res.add(sSuite, sName, sKind, N, 1, "step_ns_per_node", dRes + dJac, "ns");
+	be.assjac();
+	res.add(sSuite, sName, sKind, N, 1, "jacobian_items_per_node", doublereal(be.iGetNumItems())/N, "items");
+	res.add(sSuite, sName, sKind, N, 1, "jacobian_error", be.dGetJacobianError(opt.uSeed), "relative");
+	return dRes + dJac;
+}
+
+/*--chain---------------------------------------------------------------------------------
+ * 同じ節点列の海底接触を3通りに組んで, 1ステップの時間を比べる.
+ *   Contactlaw pairs : 節点の組ごとのContactlaw(N - 1要素, 内側の節点は2回評価)
+ *   ContactChain     : 節点列全体を1要素で
+ *   Seabed manager   : Seabedのcontact(全節点を格子で探す)
+ * speedupはContactlaw pairsの1ステップの時間との比(1より大きいほど速い).
+ *---------------------------------------------------------------------------------------*/
+void
+suiteChain(const benchoptions& opt, benchresult& res)
+{
+	const char *sSuite = "chain";
+
+	for (std::size_t ik = 0; ik < opt.kinds.size(); ik++) {
+		for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+			const std::size_t N = opt.nodes[in];
+			const std::string sKind = scenario::sName(opt.kinds[ik]);
+			doublereal dPairs, dChain, dManager;
+
+			{
+				scenario sc(opt.kinds[ik], N, opt.uSeed);
+				benchelem be(sc, sc.addPairs());
+				dPairs = dStep(be, sc, opt, res, "Contactlaw pairs");
+			}
+			{
+				scenario sc(opt.kinds[ik], N, opt.uSeed);
+				benchelem be(sc, std::vector<Elem *>(1, sc.pAddChain()));
+				dChain = dStep(be, sc, opt, res, "ContactChain");
+			}
+			{
+				scenario sc(opt.kinds[ik], N, opt.uSeed);
+				benchelem be(sc, std::vector<Elem *>(1, sc.pAddManager(std::string())));
+				dManager = dStep(be, sc, opt, res, "Seabed manager");
+			}
+
+			res.add(sSuite, "ContactChain", sKind, N, 1, "speedup", dPairs/dChain, "x");
+			res.add(sSuite, "Seabed manager", sKind, N, 1, "speedup", dPairs/dManager, "x");
+		}
+	}
+}
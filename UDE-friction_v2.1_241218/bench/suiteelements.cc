@@ -0,0 +1,45 @@
+#include "mbconfig.h"
+
+#include <vector>
+
+#include "contactbench.h"
+#include "benchelem.h"
+
+/*--elements------------------------------------------------------------------------------
+ * 節点列の隣り合う節点の組ごとにContactlawを置き(N - 1要素), 1ステップ分を測る.
+ *   assres, assjac, afterconvergence : 全要素の1回あたりの時間を節点数で割ったもの
+ *   active_nodes                     : 最後のAssResで評価した節点数(要素の合計)
+ *   jacobian_items_per_node          : AssJacの非零要素数/節点
+ *   jacobian_error                   : A y と中心差分の相対誤差(ニュートン法の収束に効く)
+ *---------------------------------------------------------------------------------------*/
+void
+suiteElements(const benchoptions& opt, benchresult& res)
+{
+	const char *sSuite = "elements";
+	const char *sName = "Contactlaw";
+
+	for (std::size_t ik = 0; ik < opt.kinds.size(); ik++) {
+		for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+			const std::size_t N = opt.nodes[in];
+			scenario sc(opt.kinds[ik], N, opt.uSeed);
+			const std::string sKind = scenario::sName(opt.kinds[ik]);
+
+			benchelem be(sc, sc.addPairs());
+			be.prepare();
+			MyVectorHandler R(sc.getX().iGetSize());
+
+			doublereal ns = dTime([&]() { be.assres(R); }, opt.dMinTime);
+			res.add(sSuite, sName, sKind, N, 1, "assres_ns_per_node", ns/N, "ns");
+			ns = dTime([&]() { be.assjac(); }, opt.dMinTime);
+			res.add(sSuite, sName, sKind, N, 1, "assjac_ns_per_node", ns/N, "ns");
+			ns = dTime([&]() { be.afterconvergence(); }, opt.dMinTime);
+			res.add(sSuite, sName, sKind, N, 1, "afterconvergence_ns_per_node", ns/N, "ns");
+
+			be.assres(R);
+			res.add(sSuite, sName, sKind, N, 1, "active_nodes", be.dGetPrivData("active_nodes"), "nodes");
+			be.assjac();
+			res.add(sSuite, sName, sKind, N, 1, "jacobian_items_per_node", doublereal(be.iGetNumItems())/N, "items");
+			res.add(sSuite, sName, sKind, N, 1, "jacobian_error", be.dGetJacobianError(opt.uSeed), "relative");
+		}
+	}
+}
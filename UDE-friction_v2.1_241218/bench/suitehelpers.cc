@@ -0,0 +1,161 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <vector>
+
+#include "contactbench.h"
+#include "tanhfunc.h"
+#include "exchangevector.h"
+#include "contactforce.h"
+#include "contactkernel.h"
+#include "contactpolicy.h"
+#include "frictionforce.h"
+
+//scenario.ccの接触の値
+static const doublereal dK = 1.0e5;
+static const doublereal dC = 1.0e3;
+static const doublereal dNu = 0.5;
+static const doublereal dVt = 0.01;
+
+/*--helpers-------------------------------------------------------------------------------
+ * 節点列の位置と速度をそのまま入力にして, helper classを全節点について1回ずつ呼ぶ.
+ * 結果は1節点あたりのns (scenarioによって tanh の飽和やめり込みの有無が変わる).
+ *---------------------------------------------------------------------------------------*/
+void
+suiteHelpers(const benchoptions& opt, benchresult& res)
+{
+	const char *sSuite = "helpers";
+	tanhfunc tf;
+	exchangevector ev;
+	contactforce cf;
+	frictionforce ff;
+
+	for (std::size_t ik = 0; ik < opt.kinds.size(); ik++) {
+		for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+			const std::size_t N = opt.nodes[in];
+			scenario sc(opt.kinds[ik], N, opt.uSeed);
+			const std::string sKind = scenario::sName(opt.kinds[ik]);
+
+			std::vector<Vec3> r(N), v(N), n(N), a(N), l(N);
+			std::vector<doublereal> x(N);
+			for (std::size_t i = 0; i < N; i++) {
+				r[i] = sc.pGetNode(i)->GetXCurr();
+				v[i] = sc.pGetNode(i)->GetVCurr();
+				x[i] = v[i].Norm()/dVt;
+			}
+			//Contactlawと同じ座標系(最後の節点は1つ前の線分)
+			for (std::size_t i = 0; i < N; i++) {
+				const std::size_t j = (i + 1 < N) ? i : i - 1;
+				Vec3 u;
+				ev.normal_vec(n[i]);
+				ev.internode_vec(u, r[j], r[j + 1]);
+				ev.lateral_vec(l[i], n[i], u, r[j], r[j + 1]);
+				ev.axial_vec(a[i], n[i], l[i], r[j], r[j + 1]);
+			}
+
+			doublereal dcrit = CONTACTPOLICY_DCRIT;
+			doublereal ns;
+
+			ns = dTime([&]() {
+				doublereal s = 0.0;
+				for (std::size_t i = 0; i < N; i++) {
+					s += tf.tanh(x[i], dcrit);
+				}
+				dBenchSink = s;
+			}, opt.dMinTime);
+			res.add(sSuite, "tanhfunc::tanh", sKind, N, 1, "ns_per_node", ns/N, "ns");
+
+			ns = dTime([&]() {
+				doublereal s = 0.0;
+				for (std::size_t i = 0; i < N; i++) {
+					s += tf.dtanh(x[i], dcrit);
+				}
+				dBenchSink = s;
+			}, opt.dMinTime);
+			res.add(sSuite, "tanhfunc::dtanh", sKind, N, 1, "ns_per_node", ns/N, "ns");
+
+			ns = dTime([&]() {
+				doublereal s = 0.0;
+				for (std::size_t j = 0; j + 1 < N; j++) {
+					Vec3 nv, u, lv, av;
+					ev.normal_vec(nv);
+					ev.internode_vec(u, r[j], r[j + 1]);
+					ev.lateral_vec(lv, nv, u, r[j], r[j + 1]);
+					ev.axial_vec(av, nv, lv, r[j], r[j + 1]);
+					s += av(1) + lv(2);
+				}
+				dBenchSink = s;
+			}, opt.dMinTime);
+			res.add(sSuite, "exchangevector frame", sKind, N, 1, "ns_per_node", ns/N, "ns");
+
+			ns = dTime([&]() {
+				doublereal s = 0.0;
+				for (std::size_t i = 0; i < N; i++) {
+					Vec3 f;
+					cf.force(f, r[i], v[i], n[i], a[i], l[i], 0.0, dK, dC, dNu, dVt);
+					s += f(3);
+				}
+				dBenchSink = s;
+			}, opt.dMinTime);
+			res.add(sSuite, "contactforce::force", sKind, N, 1, "ns_per_node", ns/N, "ns");
+
+			ns = dTime([&]() {
+				doublereal s = 0.0;
+				for (std::size_t i = 0; i < N; i++) {
+					doublereal J[3][3];
+					cf.jacobian(J, r[i], v[i], n[i], a[i], l[i], 0.0, dK, dC, dNu, dVt, 5.0e-4);
+					s += J[2][2];
+				}
+				dBenchSink = s;
+			}, opt.dMinTime);
+			res.add(sSuite, "contactforce::jacobian", sKind, N, 1, "ns_per_node", ns/N, "ns");
+
+			ns = dTime([&]() {
+				doublereal s = 0.0;
+				for (std::size_t i = 0; i < N; i++) {
+					Vec3 f;
+					ff.f_friction_axial(f, dNu*dK*0.01, a[i]*v[i].Dot(a[i]));
+					s += f(1);
+				}
+				dBenchSink = s;
+			}, opt.dMinTime);
+			res.add(sSuite, "frictionforce::f_friction_axial", sKind, N, 1, "ns_per_node", ns/N, "ns");
+
+			//contactkernel: 命令セットごと(使えないものは測らない)
+			std::vector<doublereal> rz(N), vx(N), vy(N), vz(N), zs(N, 0.0), nx(N, 0.0), ny(N, 0.0), nz(N, 1.0);
+			std::vector<doublereal> ks(N, dK), cs(N, dC), nus(N, dNu);
+			std::vector<doublereal> ax(N), ay(N), az(N), lx(N), ly(N), lz(N), fx(N), fy(N), fz(N);
+			for (std::size_t i = 0; i < N; i++) {
+				rz[i] = r[i](3);
+				vx[i] = v[i](1); vy[i] = v[i](2); vz[i] = v[i](3);
+				ax[i] = a[i](1); ay[i] = a[i](2); az[i] = a[i](3);
+				lx[i] = l[i](1); ly[i] = l[i](2); lz[i] = l[i](3);
+			}
+			contactbatch b;
+			b.n = N;
+			b.rz = &rz[0];
+			b.vx = &vx[0]; b.vy = &vy[0]; b.vz = &vz[0];
+			b.zs = &zs[0];
+			b.nx = &nx[0]; b.ny = &ny[0]; b.nz = &nz[0];
+			b.k = &ks[0]; b.c = &cs[0]; b.nu = &nus[0];
+			b.ax = &ax[0]; b.ay = &ay[0]; b.az = &az[0];
+			b.lx = &lx[0]; b.ly = &ly[0]; b.lz = &lz[0];
+			b.fx = &fx[0]; b.fy = &fy[0]; b.fz = &fz[0];
+
+			const contactkernel::Isa isa[] = {
+				contactkernel::ISA_SCALAR, contactkernel::ISA_AVX2, contactkernel::ISA_AVX512 };
+			for (int k = 0; k < 3; k++) {
+				if (!contactkernel::bSupported(isa[k])) {
+					continue;
+				}
+				const contactkernel ck(isa[k]);
+				ns = dTime([&]() {
+					ck.force(b, dVt, CONTACTPOLICY_DCRIT);
+					dBenchSink = fz[N - 1];
+				}, opt.dMinTime);
+				res.add(sSuite, std::string("contactkernel::force ") + contactkernel::sIsaName(isa[k]),
+					sKind, N, 1, "ns_per_node", ns/N, "ns");
+			}
+		}
+	}
+}
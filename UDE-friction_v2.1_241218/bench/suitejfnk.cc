@@ -0,0 +1,103 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <vector>
+
+#include "contactbench.h"
+#include "benchelem.h"
+
+//ニュートン法1回あたりのKrylov反復(A yの回数)
+static const int iKrylov = 20;
+//これより少ない節点数は測らない(行列の記憶量が問題になる規模)
+static const std::size_t iMinNodes = 10000;
+
+static void
+newton(benchelem& be, scenario& sc, const benchoptions& opt, benchresult& res, const std::string& sName)
+{
+	const char *sSuite = "jfnk";
+	const std::string sKind = scenario::sName(sc.getKind());
+	const std::size_t N = sc.iGetNumNodes();
+	const integer n = sc.getX().iGetSize();
+	MyVectorHandler R(n), Y, JacY(n), AY(n);
+	benchmatrix A;
+
+	be.prepare();
+	be.direction(Y, opt.uSeed);
+	be.assemble(A);
+
+	//Krylov法の基底(iKrylov + 1本)は両方の解法で同じ
+	const doublereal dKrylovBytes = doublereal(iKrylov + 1)*n*sizeof(doublereal);
+	const doublereal dMatrixBytes = doublereal(A.iGetBytes());
+
+	const doublereal dRes = dTime([&]() { be.assres(R); }, opt.dMinTime);
+	const doublereal dAsm = dTime([&]() { be.assemble(A); }, opt.dMinTime);
+	const doublereal dMv = dTime([&]() { A.MultAdd(JacY, Y); }, opt.dMinTime);
+	const doublereal dJvp = dTime([&]() { be.jvp(JacY, Y); }, opt.dMinTime);
+	const doublereal dExplicit = dRes + dAsm + iKrylov*dMv;
+	const doublereal dJfnk = dRes + iKrylov*dJvp;
+
+	const std::string sExplicit = sName + " explicit";
+	res.add(sSuite, sExplicit, sKind, N, 1, "assemble_ns_per_node", dAsm/N, "ns");
+	res.add(sSuite, sExplicit, sKind, N, 1, "matvec_ns_per_node", dMv/N, "ns");
+	res.add(sSuite, sExplicit, sKind, N, 1, "newton_ns_per_node", dExplicit/N, "ns");
+	res.add(sSuite, sExplicit, sKind, N, 1, "matrix_bytes", dMatrixBytes, "bytes");
+	res.add(sSuite, sExplicit, sKind, N, 1, "matrix_bytes_per_node", dMatrixBytes/N, "bytes");
+
+	const std::string sJfnk = sName + " matrix-free";
+	res.add(sSuite, sJfnk, sKind, N, 1, "jvp_ns_per_node", dJvp/N, "ns");
+	res.add(sSuite, sJfnk, sKind, N, 1, "newton_ns_per_node", dJfnk/N, "ns");
+	res.add(sSuite, sJfnk, sKind, N, 1, "matrix_bytes", 0.0, "bytes");
+	res.add(sSuite, sJfnk, sKind, N, 1, "matrix_bytes_per_node", 0.0, "bytes");
+	res.add(sSuite, sJfnk, sKind, N, 1, "krylov_bytes_per_node", dKrylovBytes/N, "bytes");
+	res.add(sSuite, sJfnk, sKind, N, 1, "speedup", dExplicit/dJfnk, "x");
+
+	//行列を作らない A y と組み立てた行列の A y の差
+	JacY.Reset();
+	AY.Reset();
+	be.jvp(JacY, Y);
+	be.assemble(A);
+	A.MultAdd(AY, Y);
+	doublereal dDiff = 0.0, dNorm = 0.0;
+	for (integer i = 1; i <= n; i++) {
+		dDiff += (JacY(i) - AY(i))*(JacY(i) - AY(i));
+		dNorm += AY(i)*AY(i);
+	}
+	res.add(sSuite, sJfnk, sKind, N, 1, "jvp_error", (dNorm > 0.0) ? std::sqrt(dDiff/dNorm) : std::sqrt(dDiff), "relative");
+}
+
+/*--jfnk----------------------------------------------------------------------------------
+ * ニュートン法1回(残差1回とKrylov反復iKrylov回)を2通りで比べる. 10000節点以上だけ測る
+ * (--nodesに10000以上がなければ10000節点).
+ *   explicit    : AssJacを大域の行列に集めてから A y (行列の値と行, 列の添字を持つ)
+ *   matrix-free : AssJac(JacY, Y, ...)で A y を直接求める (JFNK, 行列を持たない)
+ * matrix_bytesは接触要素の行列の記憶量(直接法の分解のfill-inは含まない).
+ * krylov_bytes_per_nodeはKrylov法の基底(iKrylov + 1本, 全自由度)で, 両方の解法に要る.
+ *---------------------------------------------------------------------------------------*/
+void
+suiteJfnk(const benchoptions& opt, benchresult& res)
+{
+	std::vector<std::size_t> nodes;
+	for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+		if (opt.nodes[in] >= iMinNodes) {
+			nodes.push_back(opt.nodes[in]);
+		}
+	}
+	if (nodes.empty()) {
+		nodes.push_back(iMinNodes);
+	}
+
+	for (std::size_t ik = 0; ik < opt.kinds.size(); ik++) {
+		for (std::size_t in = 0; in < nodes.size(); in++) {
+			{
+				scenario sc(opt.kinds[ik], nodes[in], opt.uSeed);
+				benchelem be(sc, sc.addPairs());
+				newton(be, sc, opt, res, "Contactlaw pairs");
+			}
+			{
+				scenario sc(opt.kinds[ik], nodes[in], opt.uSeed);
+				benchelem be(sc, std::vector<Elem *>(1, sc.pAddChain()));
+				newton(be, sc, opt, res, "ContactChain");
+			}
+		}
+	}
+}
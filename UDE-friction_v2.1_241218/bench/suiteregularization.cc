@@ -0,0 +1,157 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "contactbench.h"
+#include "benchelem.h"
+#include "contactpolicy.h"
+
+//scenario.ccのSeabedの値(nu1d, nu1s, vt)とStribeck速度
+static const doublereal dNu1d = 0.5;
+static const doublereal dNu1s = 0.6;
+static const doublereal dVt = 0.01;
+static const doublereal dVs = 0.1;
+static const char *sStribeck = "0.1";
+
+//tanhとの差を測る格子 (0 <= x <= 2 dcrit, 飽和の前後を含む)
+static const std::size_t iGridSize = 4096;
+
+static frictionparam
+fpBench(void)
+{
+	frictionparam fp;
+	fp.nu1d = fp.nu2d = dNu1d;
+	fp.nu1s = fp.nu2s = dNu1s;
+	fp.vt = dVt;
+	fp.vs = dVs;
+	return fp;
+}
+
+//x[i]での値と導関数のtanhに対する最大誤差
+template <class Regularization>
+static void
+error(const std::vector<doublereal>& x, const frictionparam& fp, doublereal& dErr, doublereal& dErrD)
+{
+	dErr = dErrD = 0.0;
+	for (std::size_t i = 0; i < x.size(); i++) {
+		doublereal T, dT, T0, dT0;
+		Regularization::Td(x[i], fp, T, dT);
+		tanhregularization::Td(x[i], fp, T0, dT0);
+		dErr = std::max(dErr, std::abs(T - T0));
+		dErrD = std::max(dErrD, std::abs(dT - dT0));
+	}
+}
+
+template <class Regularization>
+static void
+regularization(const char *sName, const std::string& sKind, const std::vector<doublereal>& x,
+	const std::vector<doublereal>& grid, const benchoptions& opt, benchresult& res)
+{
+	const char *sSuite = "regularization";
+	const frictionparam fp = fpBench();
+	const std::size_t N = x.size();
+	doublereal dErr, dErrD;
+
+	const doublereal ns = dTime([&]() {
+		doublereal s = 0.0;
+		for (std::size_t i = 0; i < N; i++) {
+			doublereal T, dT;
+			Regularization::Td(x[i], fp, T, dT);
+			s += T + dT;
+		}
+		dBenchSink = s;
+	}, opt.dMinTime);
+	res.add(sSuite, sName, sKind, N, 1, "td_ns_per_call", ns/N, "ns");
+
+	error<Regularization>(x, fp, dErr, dErrD);
+	res.add(sSuite, sName, sKind, N, 1, "value_error", dErr, "absolute");
+	res.add(sSuite, sName, sKind, N, 1, "derivative_error", dErrD, "absolute");
+
+	//格子の誤差はscenarioによらないので最初のscenarioだけ
+	if (sKind == scenario::sName(opt.kinds.front()) && N == opt.nodes.front()) {
+		error<Regularization>(grid, fp, dErr, dErrD);
+		res.add(sSuite, sName, "grid", grid.size(), 1, "value_error", dErr, "absolute");
+		res.add(sSuite, sName, "grid", grid.size(), 1, "derivative_error", dErrD, "absolute");
+	}
+}
+
+/*--regularization------------------------------------------------------------------------
+ * 摩擦の正則化T(x)ごとの精度と計算時間.
+ *   td_ns_per_call    : Td(値と導関数)1回の時間. xはscenarioの節点の |v|/vt
+ *   value_error       : tanh(x)との差の最大値 (derivative_errorは導関数)
+ *                       scenario "grid" は 0 <= x <= 2 dcrit の格子での値
+ *   step_ns_per_node  : Contactlaw(law, regularization, ...)のAssResとAssJac 1回
+ *   residual_error    : tanhのContactlawとの残差の相対差 (摩擦力の差)
+ *   jacobian_error    : A y と中心差分の相対誤差
+ * stribeckは静摩擦の分だけtanhと違うのが正しい(誤差ではない).
+ *---------------------------------------------------------------------------------------*/
+void
+suiteRegularization(const benchoptions& opt, benchresult& res)
+{
+	const char *sSuite = "regularization";
+	static const char *sNames[] = {
+		"tanh", "linear", "rational", "table", "cubic", "smoothstep", "arctan", "stribeck"
+	};
+	const std::size_t iNum = sizeof(sNames)/sizeof(sNames[0]);
+
+	std::vector<doublereal> grid(iGridSize);
+	for (std::size_t i = 0; i < iGridSize; i++) {
+		grid[i] = 2.0*CONTACTPOLICY_DCRIT*doublereal(i)/doublereal(iGridSize - 1);
+	}
+
+	for (std::size_t ik = 0; ik < opt.kinds.size(); ik++) {
+		for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+			const std::size_t N = opt.nodes[in];
+			const std::string sKind = scenario::sName(opt.kinds[ik]);
+
+			std::vector<doublereal> x(N);
+			{
+				scenario sc(opt.kinds[ik], N, opt.uSeed);
+				for (std::size_t i = 0; i < N; i++) {
+					x[i] = sc.pGetNode(i)->GetVCurr().Norm()/dVt;
+				}
+			}
+			regularization<tanhregularization>(sNames[0], sKind, x, grid, opt, res);
+			regularization<linearregularization>(sNames[1], sKind, x, grid, opt, res);
+			regularization<rationalregularization>(sNames[2], sKind, x, grid, opt, res);
+			regularization<tableregularization>(sNames[3], sKind, x, grid, opt, res);
+			regularization<cubicregularization>(sNames[4], sKind, x, grid, opt, res);
+			regularization<smoothstepregularization>(sNames[5], sKind, x, grid, opt, res);
+			regularization<arctanregularization>(sNames[6], sKind, x, grid, opt, res);
+			regularization<stribeckregularization>(sNames[7], sKind, x, grid, opt, res);
+
+			//Contactlawの1ステップと, tanhの残差との差
+			MyVectorHandler R0;
+			for (std::size_t r = 0; r < iNum; r++) {
+				std::string sLaw = std::string("law, regularization, ") + sNames[r];
+				if (r == 7) {
+					sLaw += std::string(", ") + sStribeck;
+				}
+				scenario sc(opt.kinds[ik], N, opt.uSeed);
+				benchelem be(sc, sc.addPairs(sLaw));
+				MyVectorHandler R(sc.getX().iGetSize());
+				be.prepare();
+
+				const doublereal dRes = dTime([&]() { be.assres(R); }, opt.dMinTime);
+				const doublereal dJac = dTime([&]() { be.assjac(); }, opt.dMinTime);
+				res.add(sSuite, sNames[r], sKind, N, 1, "step_ns_per_node", (dRes + dJac)/N, "ns");
+
+				R.Reset();
+				be.assres(R);
+				if (r == 0) {
+					R0 = R;
+				}
+				doublereal dDiff = 0.0, dNorm = 0.0;
+				for (integer i = 1; i <= R.iGetSize(); i++) {
+					dDiff += (R(i) - R0(i))*(R(i) - R0(i));
+					dNorm += R0(i)*R0(i);
+				}
+				res.add(sSuite, sNames[r], sKind, N, 1, "residual_error",
+					(dNorm > 0.0) ? std::sqrt(dDiff/dNorm) : std::sqrt(dDiff), "relative");
+				res.add(sSuite, sNames[r], sKind, N, 1, "jacobian_error", be.dGetJacobianError(opt.uSeed), "relative");
+			}
+		}
+	}
+}
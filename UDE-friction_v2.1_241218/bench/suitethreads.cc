@@ -0,0 +1,103 @@
+#include "mbconfig.h"
+
+#include <sstream>
+#include <vector>
+
+#include "contactbench.h"
+#include "benchelem.h"
+
+//ContactChain(threads, T)の1ステップの時間[ns]と, 残差と A y
+static doublereal
+dStep(scenario::Kind kind, std::size_t N, unsigned T, const benchoptions& opt,
+	MyVectorHandler& R, MyVectorHandler& AY)
+{
+	scenario sc(kind, N, opt.uSeed);
+	std::ostringstream os;
+	os << "threads, " << T;
+	benchelem be(sc, std::vector<Elem *>(1, sc.pAddChain(os.str())));
+	MyVectorHandler Y;
+
+	be.prepare();
+	R.Resize(sc.getX().iGetSize());
+	const doublereal dRes = dTime([&]() { be.assres(R); }, opt.dMinTime);
+	const doublereal dJac = dTime([&]() { be.assjac(); }, opt.dMinTime);
+
+	R.Reset();
+	be.assres(R);
+	be.direction(Y, opt.uSeed);
+	AY.Resize(sc.getX().iGetSize());
+	AY.Reset();
+	be.matvec(AY, Y);
+	return dRes + dJac;
+}
+
+//ビット単位で同じなら1
+static doublereal
+dIdentical(const MyVectorHandler& A, const MyVectorHandler& B)
+{
+	if (A.iGetSize() != B.iGetSize()) {
+		return 0.0;
+	}
+	for (integer i = 1; i <= A.iGetSize(); i++) {
+		if (!(A(i) == B(i))) {
+			return 0.0;
+		}
+	}
+	return 1.0;
+}
+
+/*--threads-------------------------------------------------------------------------------
+ * ContactChainのthreadsによるスケーリング(AssRes 1回とAssJac 1回).
+ *   strong : 節点数を--nodesに固定してスレッド数Tを増やす
+ *   weak   : 1スレッドあたり--nodesの最初の値の節点数 (N = T n0)
+ *   speedup, efficiency : 1スレッドとの時間の比(weakは節点あたり), speedup/T
+ *   residual_identical, jacobian_identical : 残差と A y が1スレッドとビット単位で同じなら1
+ *                                           (contactpoolの集計は節点の順なので1になるはず)
+ * スレッド数は--threads(既定1, 2, 4, ..., 64). コア数より多いと時間は参考にならない
+ * (JSONのhardware_threads).
+ *---------------------------------------------------------------------------------------*/
+void
+suiteThreads(const benchoptions& opt, benchresult& res)
+{
+	const char *sSuite = "threads";
+
+	for (std::size_t ik = 0; ik < opt.kinds.size(); ik++) {
+		const scenario::Kind kind = opt.kinds[ik];
+		const std::string sKind = scenario::sName(kind);
+
+		//strong scaling
+		for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+			const std::size_t N = opt.nodes[in];
+			MyVectorHandler R1, AY1;
+			const doublereal d1 = dStep(kind, N, 1u, opt, R1, AY1);
+			for (std::size_t it = 0; it < opt.threads.size(); it++) {
+				const unsigned T = opt.threads[it];
+				MyVectorHandler R, AY;
+				const doublereal d = (T == 1u) ? d1 : dStep(kind, N, T, opt, R, AY);
+				res.add(sSuite, "ContactChain strong", sKind, N, T, "step_ns_per_node", d/N, "ns");
+				res.add(sSuite, "ContactChain strong", sKind, N, T, "speedup", d1/d, "x");
+				res.add(sSuite, "ContactChain strong", sKind, N, T, "efficiency", d1/d/T, "ratio");
+				if (T != 1u) {
+					res.add(sSuite, "ContactChain strong", sKind, N, T, "residual_identical", dIdentical(R, R1), "bool");
+					res.add(sSuite, "ContactChain strong", sKind, N, T, "jacobian_identical", dIdentical(AY, AY1), "bool");
+				}
+			}
+		}
+
+		//weak scaling
+		const std::size_t n0 = opt.nodes.front();
+		doublereal d1 = 0.0;
+		for (std::size_t it = 0; it < opt.threads.size(); it++) {
+			const unsigned T = opt.threads[it];
+			const std::size_t N = n0*T;
+			MyVectorHandler R, AY;
+			const doublereal d = dStep(kind, N, T, opt, R, AY)/N;
+			if (it == 0) {
+				//最初のスレッド数を基準にする(既定は1)
+				d1 = d*opt.threads[0];
+			}
+			res.add(sSuite, "ContactChain weak", sKind, N, T, "step_ns_per_node", d, "ns");
+			res.add(sSuite, "ContactChain weak", sKind, N, T, "efficiency", d1/(d*T), "ratio");
+		}
+	}
+}
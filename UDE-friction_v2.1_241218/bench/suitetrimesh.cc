@@ -0,0 +1,211 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "contactbench.h"
+#include "trimesh.h"
+
+//格子の一辺のセル数(2三角形/セル, 708 x 708 x 2 = 1002528 >= 1M三角形)とセルの大きさ[m]
+static const int iGrid = 708;
+static const doublereal dCell = 1.0;
+//合成したSTLの一時ファイル(終わったら消す)
+static const char *sStlFile = "contactbench-trimesh.stl";
+//loadを測る最大回数(最小値をとる)
+static const int iMaxLoads = 3;
+//coherentな探索で節点が1回に動く距離[m]と, 往復する回数
+static const doublereal dStep = 0.01;
+static const unsigned iStrokes = 64;
+
+//xorshift (-1, 1)
+static doublereal
+dJitter(unsigned& s)
+{
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	return 2.0*doublereal(s)/4294967295.0 - 1.0;
+}
+
+//起伏のある海底 (波長の違う2つの正弦波)
+static doublereal
+dHeight(const doublereal& x, const doublereal& y)
+{
+	return 2.0*std::sin(0.05*x)*std::cos(0.04*y) + 0.3*std::sin(0.7*x + 0.2)*std::sin(0.6*y);
+}
+
+//k回目の節点の位置 (iStrokes回ごとに往復する)
+static Vec3
+pWalk(const Vec3& p0, const Vec3& d, unsigned k)
+{
+	const unsigned m = k % (2*iStrokes);
+	return p0 + d*doublereal((m < iStrokes) ? m : 2*iStrokes - m);
+}
+
+//格子の海底面をbinary STLで書く(三角形の数を返す, 失敗なら0)
+static std::size_t
+iWriteStl(const char *sFileName)
+{
+	FILE *fp = std::fopen(sFileName, "wb");
+	if (fp == 0) {
+		return 0;
+	}
+
+	//頂点は格子点ごとに1回だけ計算する(weldで同じ座標として統合される)
+	const int nv = iGrid + 1;
+	std::vector<float> z(std::size_t(nv)*nv);
+	for (int j = 0; j < nv; j++) {
+		for (int i = 0; i < nv; i++) {
+			z[std::size_t(j)*nv + i] = float(dHeight(i*dCell, j*dCell));
+		}
+	}
+
+	char header[80];
+	std::memset(header, 0, sizeof(header));
+	std::strncpy(header, "contactbench synthetic seabed", sizeof(header) - 1);
+	const uint32_t n = uint32_t(2*iGrid*iGrid);
+	bool bOk = (std::fwrite(header, 1, sizeof(header), fp) == sizeof(header))
+		&& (std::fwrite(&n, sizeof(n), 1, fp) == 1);
+
+	for (int j = 0; bOk && j < iGrid; j++) {
+		for (int i = 0; bOk && i < iGrid; i++) {
+			const float x0 = float(i*dCell), x1 = float((i + 1)*dCell);
+			const float y0 = float(j*dCell), y1 = float((j + 1)*dCell);
+			const float z00 = z[std::size_t(j)*nv + i], z10 = z[std::size_t(j)*nv + i + 1];
+			const float z01 = z[std::size_t(j + 1)*nv + i], z11 = z[std::size_t(j + 1)*nv + i + 1];
+			const float v[2][9] = {
+				{ x0, y0, z00, x1, y0, z10, x1, y1, z11 },
+				{ x0, y0, z00, x1, y1, z11, x0, y1, z01 }
+			};
+			for (int t = 0; bOk && t < 2; t++) {
+				//rec: normal(3 float, loadは使わない), vertices(9 float), attribute(uint16)
+				char rec[50];
+				std::memset(rec, 0, sizeof(rec));
+				std::memcpy(rec + 3*sizeof(float), v[t], sizeof(v[t]));
+				bOk = (std::fwrite(rec, 1, sizeof(rec), fp) == sizeof(rec));
+			}
+		}
+	}
+	bOk = (std::fclose(fp) == 0) && bOk;
+	return bOk ? std::size_t(n) : 0;
+}
+
+/*--trimesh-------------------------------------------------------------------------------
+ * 三角形メッシュの海底(trimesh)の読み込みと最近接点の探索.
+ * 起伏のある格子(1002528三角形)の海底をbinary STLに書いて使う.
+ *   load_s, load_ns_per_triangle : load()(頂点の統合とBVHの構築)の時間
+ *   cold_ns_per_query     : hintなし(毎回BVHを2回たどる)のclosest()
+ *   coherent_ns_per_query : 節点ごとのhintで, 節点が1回にdStep(1cm)ずつ動くときのclosest()
+ *   speedup               : cold/coherent
+ *   distance_error        : coherentとcoldの最近接距離の差の最大値 (0であること)
+ * --nodesは探索する節点の数. 節点は海底面の-0.05 .. 0.5m上に一様に置く.
+ *---------------------------------------------------------------------------------------*/
+void
+suiteTrimesh(const benchoptions& opt, benchresult& res)
+{
+	typedef std::chrono::steady_clock clock;
+	const char *sSuite = "trimesh";
+	const std::string sKind = "mesh";
+
+	const std::size_t iNumTri = iWriteStl(sStlFile);
+	if (iNumTri == 0) {
+		std::remove(sStlFile);
+		silent_cerr("contactbench: unable to write \"" << sStlFile << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	//load (最初の1回は必ず, 合計がdMinTimeになるまでiMaxLoads回まで)
+	trimesh mesh;
+	doublereal dLoad = 0.0, dTotal = 0.0;
+	try {
+		for (int l = 0; l < iMaxLoads && (l == 0 || dTotal < opt.dMinTime); l++) {
+			trimesh m;
+			const clock::time_point t0 = clock::now();
+			m.load(sStlFile);
+			const doublereal dt = std::chrono::duration<doublereal>(clock::now() - t0).count();
+			dLoad = (l == 0) ? dt : std::min(dLoad, dt);
+			dTotal += dt;
+		}
+		mesh.load(sStlFile);
+	}
+	catch (...) {
+		std::remove(sStlFile);
+		throw;
+	}
+	std::remove(sStlFile);
+
+	const std::size_t iLoaded = mesh.iGetNumTriangles();
+	res.add(sSuite, "trimesh load", sKind, iLoaded, 1, "triangles", doublereal(iLoaded), "count");
+	res.add(sSuite, "trimesh load", sKind, iLoaded, 1, "load_s", dLoad, "s");
+	res.add(sSuite, "trimesh load", sKind, iLoaded, 1, "load_ns_per_triangle", 1.0e9*dLoad/iLoaded, "ns");
+
+	for (std::size_t in = 0; in < opt.nodes.size(); in++) {
+		const std::size_t N = opt.nodes[in];
+
+		//節点の位置と動く向き(dStepの長さ)
+		unsigned s = (opt.uSeed == 0u) ? 1u : opt.uSeed;
+		std::vector<Vec3> p0(N), d(N);
+		const doublereal dSize = iGrid*dCell;
+		for (std::size_t i = 0; i < N; i++) {
+			const doublereal x = 0.5*dSize*(1.0 + 0.9*dJitter(s));
+			const doublereal y = 0.5*dSize*(1.0 + 0.9*dJitter(s));
+			p0[i] = Vec3(x, y, dHeight(x, y) + 0.225 + 0.275*dJitter(s));
+			const doublereal a = M_PI*dJitter(s);
+			d[i] = Vec3(dStep*std::cos(a), dStep*std::sin(a), 0.1*dStep*dJitter(s));
+		}
+
+		//cold: hintなし
+		unsigned kCold = 0;
+		const doublereal dCold = dTime([&]() {
+			doublereal sum = 0.0;
+			for (std::size_t i = 0; i < N; i++) {
+				trimeshhint hint;
+				Vec3 q;
+				int iTri;
+				mesh.closest(pWalk(p0[i], d[i], kCold), hint, q, iTri);
+				sum += q.dGet(3);
+			}
+			kCold++;
+			dBenchSink = sum;
+		}, opt.dMinTime)/N;
+
+		//coherent: 節点ごとのhintを使い続ける
+		std::vector<trimeshhint> hints(N);
+		unsigned kCoherent = 0;
+		const doublereal dCoherent = dTime([&]() {
+			doublereal sum = 0.0;
+			for (std::size_t i = 0; i < N; i++) {
+				Vec3 q;
+				int iTri;
+				mesh.closest(pWalk(p0[i], d[i], kCoherent), hints[i], q, iTri);
+				sum += q.dGet(3);
+			}
+			kCoherent++;
+			dBenchSink = sum;
+		}, opt.dMinTime)/N;
+
+		//coherentの結果はcoldと同じ最近接点の距離になる(1往復分を比べる)
+		doublereal dErr = 0.0;
+		std::vector<trimeshhint> check(N);
+		for (unsigned k = 0; k < 2*iStrokes; k++) {
+			for (std::size_t i = 0; i < N; i++) {
+				const Vec3 p = pWalk(p0[i], d[i], k);
+				trimeshhint hint;
+				Vec3 q, qc;
+				int iTri, iTric;
+				mesh.closest(p, hint, q, iTri);
+				mesh.closest(p, check[i], qc, iTric);
+				dErr = std::max(dErr, std::abs((p - q).Norm() - (p - qc).Norm()));
+			}
+		}
+
+		res.add(sSuite, "trimesh closest", sKind, N, 1, "cold_ns_per_query", dCold, "ns");
+		res.add(sSuite, "trimesh closest", sKind, N, 1, "coherent_ns_per_query", dCoherent, "ns");
+		res.add(sSuite, "trimesh closest", sKind, N, 1, "speedup", dCold/dCoherent, "x");
+		res.add(sSuite, "trimesh closest", sKind, N, 1, "distance_error", dErr, "absolute");
+	}
+}
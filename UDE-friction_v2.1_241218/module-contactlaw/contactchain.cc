@@ -0,0 +1,987 @@
+/* -----------------------------------------------------------------------
+* MBDyn (C) is a multibody analysis code.
+* http://www.mbdyn.org
+*
+* Copyright (C) 1996-2017
+*
+* Pierangelo Masarati  <masarati@aero.polimi.it>
+*
+* Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+* via La Masa, 34 - 20156 Milano, Italy
+* http://www.aero.polimi.it
+*
+* Changing this copyright notice is forbidden.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation (version 2 of the License).
+*
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* -----------------------------------------------------------------------*/
+
+/* -----------------------------------------------------------------------
+* Module - contactlaw (ContactChain)
+*
+* Implemented by
+* Ryoya Hisamatsu <hisamatsu@nams.kyushu-u.ac.jp>
+* Department of Marine Systems Engineering, Kyushu University
+* Motooka 744, Nishi-ku, Fukuoka 819-0395, Fukuoka, Japan
+* -----------------------------------------------------------------------*/
+
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+#include <sstream>
+
+#include "contactchain.h"
+#include "contacttrace.h"
+
+
+/* ----------------------------- ContactChain start ------------------------------------*/
+
+/*=======================================================================================
+* Constructor and Destructor
+*=======================================================================================*/
+//constructor
+ContactChain::ContactChain (
+	unsigned uLabel,
+	const DofOwner *pDO,
+	DataManager* pDM,
+	MBDynParser& HP
+)
+: Elem(uLabel, flag(0)), UserDefinedElem(uLabel, pDO),
+pDataManager(pDM)
+{
+	// help message or no arg error
+	if (HP.IsKeyWord("help")) {
+		silent_cout(
+			"help message\n"
+			"==== Module: ContactChain ====\n"
+			"- Note: \n"
+			"\tseabed contact of a whole mooring line in one element\n"
+			"\tseabed height and normal are taken below each node (flat, bathymetry or mesh)\n"
+			"\tsoil zones of the Seabed override k, c and the friction coefficient per node\n"
+			"\tthreads: nodes are split into chunks shared by the threads of this element;\n"
+			"\tuse 1 (default) when MBDyn itself assembles on several threads\n"
+			"- Usage: \n"
+			"\tContactChain,\n"
+			"\t{ nodes, <num_nodes>, <node_label_1>, ... |\n"
+			"\t  label range, <first_node_label>, <last_node_label> },\n"
+			"\t<seabed_label>,\n"
+			"\tk, <k>,\n"
+			"\tc, <c>\n"
+			"\t[, kernel, { auto | scalar | avx2 | avx512 }]\n"
+			"\t[, active set, { no | <acceleration_bound> [, margin, <margin>] }]\n"
+			"\t[, jacobian reuse, <tolerance>]\n"
+			"\t[, threads, <num_threads> [, chunk, <num_nodes>]]\n"
+			"\t[, swept contact [, max penetration, <depth>] [, samples, <num_samples>]]\n"
+			"\t[, stable step, { mass, <node_mass> | masses, <mass_1>, ..., <mass_N> } [, factor, <factor>]]\n"
+			"\t[, performance summary];\n"
+			"- Private data: \n"
+			"\tassres_calls, assres_cycles, assjac_calls, assjac_cycles,\n"
+			"\tactive_nodes, active_nodes_total, flips, degenerate_frames,\n"
+			"\tjacobian_unchanged, jacobian_unchanged_total,\n"
+			"\timpact_fraction, impact_velocity, step_hint, tunnelled_total,\n"
+			"\tpredicted_penetration, predicted_clamped_total,\n"
+			"\tstable_step, stable_step_node\n"
+			<< std::endl);
+		if (!HP.IsArg()) {
+			throw NoErr(MBDYN_EXCEPT_ARGS);
+		}
+	}
+
+	// read nodes
+	ReadNodes(pDM, HP);
+
+	// read seabed object
+	unsigned int uElemLabel = (unsigned int)HP.GetInt();
+	pSeabed = dynamic_cast<Seabed *>(pDM->pFindElem(Elem::LOADABLE, uElemLabel));
+	if (pSeabed == 0) {
+		silent_cerr("ContactChain(" << GetLabel() << "): Seabed(" << uElemLabel << ") not found at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	// read k
+	if (!HP.IsKeyWord("k")) {
+		silent_cerr("ContactChain(" << GetLabel() << "): keyword \"k\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	k = HP.GetReal();
+
+	// read c
+	if (!HP.IsKeyWord("c")) {
+		silent_cerr("ContactChain(" << GetLabel() << "): keyword \"c\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	c = HP.GetReal();
+
+	// read kernel (optional)
+	contactkernel::Isa isa = contactkernel::ISA_AUTO;
+	if (HP.IsKeyWord("kernel")) {
+		if (HP.IsKeyWord("auto")) {
+			isa = contactkernel::ISA_AUTO;
+		} else if (HP.IsKeyWord("scalar")) {
+			isa = contactkernel::ISA_SCALAR;
+		} else if (HP.IsKeyWord("avx2")) {
+			isa = contactkernel::ISA_AVX2;
+		} else if (HP.IsKeyWord("avx512")) {
+			isa = contactkernel::ISA_AVX512;
+		} else {
+			silent_cerr("ContactChain(" << GetLabel() << "): unknown kernel at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		if (!contactkernel::bSupported(isa)) {
+			silent_cerr("ContactChain(" << GetLabel() << "): kernel \"" << contactkernel::sIsaName(isa) << "\" not supported by this CPU, using scalar" << std::endl);
+		}
+	}
+	pck.setIsa(isa);
+
+	// read active set (optional)
+	//既定では重力加速度の2倍を下向き加速度の上限とする
+	doublereal g, Zs, nu1d, nu1s, nu2d, nu2s, vt;
+	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
+	bool bActiveSet = true;
+	doublereal dAccMax = 2.0*std::abs(g);
+	doublereal dMargin = 0.0;
+	if (HP.IsKeyWord("active" "set")) {
+		if (HP.IsKeyWord("no")) {
+			bActiveSet = false;
+		} else {
+			dAccMax = HP.GetReal();
+			if (dAccMax <= 0.0) {
+				silent_cerr("ContactChain(" << GetLabel() << "): acceleration bound must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			if (HP.IsKeyWord("margin")) {
+				dMargin = HP.GetReal();
+			}
+		}
+	}
+
+	// allocate SoA storage
+	const std::size_t N = pNodes.size();
+	pas.setValue(N, bActiveSet, dAccMax, dMargin);
+	iActive.resize(N);
+	iPositionIndex.resize(N);
+	iMomentumIndex.resize(N);
+	rx.resize(N); ry.resize(N); rz.resize(N);
+	vx.resize(N); vy.resize(N); vz.resize(N);
+	zs.resize(N); nx.resize(N); ny.resize(N); nz.resize(N);
+	ks.resize(N); cs.resize(N); nus.resize(N);
+	pSoilHint.assign(N, soilhint());
+	pMeshHint.assign(N, trimeshhint());
+	ax.resize(N); ay.resize(N); az.resize(N);
+	lx.resize(N); ly.resize(N); lz.resize(N);
+	fx.resize(N); fy.resize(N); fz.resize(N);
+	bContact.assign(N, 0);
+	pFrameCache.resize(N);
+	bDegenerate.resize(N);
+	jac.resize(9*N);
+
+	// read jacobian reuse (optional)
+	//AssJacの寄与が前回と同じとみなす差(最大の要素に対する比, 既定は0: 完全に一致)
+	doublereal dReuseTol = 0.0;
+	if (HP.IsKeyWord("jacobian" "reuse")) {
+		dReuseTol = HP.GetReal();
+		if (dReuseTol < 0.0) {
+			silent_cerr("ContactChain(" << GetLabel() << "): jacobian reuse tolerance must be non-negative at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	pjr.setValue(dReuseTol);
+
+	// read threads (optional)
+	//既定は1スレッド(chunkは入力と出力がL2に収まる256節点)
+	integer iThreads = 1;
+	integer iChunk = 256;
+	if (HP.IsKeyWord("threads")) {
+		iThreads = HP.GetInt();
+		if (iThreads < 1) {
+			silent_cerr("ContactChain(" << GetLabel() << "): number of threads must be positive at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		if (HP.IsKeyWord("chunk")) {
+			iChunk = HP.GetInt();
+			if (iChunk < 1) {
+				silent_cerr("ContactChain(" << GetLabel() << "): chunk size must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	pcp.setValue(unsigned(iThreads), std::size_t(iChunk));
+
+	// read swept contact (optional)
+	//収束解の間と予測解までの軌跡で衝突を調べる(Contactlawと同じ, 予測解は貫入の見積もりを報告)
+	bool bSwept = false;
+	doublereal dMaxPen = std::numeric_limits<doublereal>::max();
+	integer iSamples = 4;
+	if (HP.IsKeyWord("swept" "contact")) {
+		bSwept = true;
+		if (HP.IsKeyWord("max" "penetration")) {
+			dMaxPen = HP.GetReal();
+			if (dMaxPen <= 0.0) {
+				silent_cerr("ContactChain(" << GetLabel() << "): max penetration must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("samples")) {
+			iSamples = HP.GetInt();
+			if (iSamples < 1) {
+				silent_cerr("ContactChain(" << GetLabel() << "): number of samples must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	psw.setValue(N, bSwept, dMaxPen, unsigned(iSamples));
+
+	// read stable step (optional)
+	//接触の剛性, 減衰と節点の質量から次の時間刻みの目安をprivate dataに出す
+	//(mass: 全節点で同じ質量, masses: 節点ごとの質量をnodesの順に並べる)
+	bool bStable = false;
+	std::vector<doublereal> dMass(N, 0.0);
+	doublereal dFactor = 0.1;
+	if (HP.IsKeyWord("stable" "step")) {
+		bStable = true;
+		if (HP.IsKeyWord("mass")) {
+			dMass.assign(N, HP.GetReal());
+		} else if (HP.IsKeyWord("masses")) {
+			for (std::size_t i = 0; i < N; i++) {
+				dMass[i] = HP.GetReal();
+			}
+		} else {
+			silent_cerr("ContactChain(" << GetLabel() << "): keyword \"mass\" or \"masses\" expected at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		for (std::size_t i = 0; i < N; i++) {
+			if (dMass[i] <= 0.0) {
+				silent_cerr("ContactChain(" << GetLabel() << "): mass of node " << pNodes[i]->GetLabel()
+					<< " must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("factor")) {
+			dFactor = HP.GetReal();
+			if (dFactor <= 0.0) {
+				silent_cerr("ContactChain(" << GetLabel() << "): factor must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	pss.setValue(N, bStable, 0.0, dAccMax, dFactor);
+	for (std::size_t i = 0; i < N; i++) {
+		pss.setMass(i, dMass[i]);
+	}
+
+	// read performance summary (optional)
+	pcc.setSummary(HP.IsKeyWord("performance" "summary"));
+
+	//output flag
+	SetOutputFlag(pDM->fReadOutput(HP, Elem::LOADABLE));
+	//export log file
+	pDM->GetLogFile()
+		<< "ContactChain: " << uLabel
+		<< " " << pNodes.front()->GetLabel()
+		<< " " << pNodes.back()->GetLabel()
+		<< " " << N
+		<< " " << pSeabed->GetLabel()
+		<< " " << contactkernel::sIsaName(pck.getIsa())
+		<< " " << pcp.getThreads()
+		<< (bSwept ? " swept contact" : "")
+		<< (bStable ? " stable step" : "")
+		<< std::endl;
+}
+
+//destructor
+ContactChain::~ContactChain (void)
+{
+	if (pcc.bGetSummary()) {
+		std::ostringstream os;
+		pcc.summary(os);
+		silent_cout("ContactChain(" << GetLabel() << "): " << os.str() << std::endl);
+	}
+}
+
+//read node list
+void
+ContactChain::ReadNodes(DataManager* pDM, MBDynParser& HP)
+{
+	if (HP.IsKeyWord("nodes")) {
+		integer iNumNodes = HP.GetInt();
+		if (iNumNodes < 2) {
+			silent_cerr("ContactChain(" << GetLabel() << "): at least 2 nodes expected at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		pNodes.resize(iNumNodes);
+		for (integer i = 0; i < iNumNodes; i++) {
+			pNodes[i] = dynamic_cast<const StructNode *>(pDM->ReadNode(HP, Node::STRUCTURAL));
+		}
+
+	} else if (HP.IsKeyWord("label" "range")) {
+		integer iFirst = HP.GetInt();
+		integer iLast = HP.GetInt();
+		if (iLast - iFirst < 1) {
+			silent_cerr("ContactChain(" << GetLabel() << "): invalid label range " << iFirst << ":" << iLast << " at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		pNodes.resize(iLast - iFirst + 1);
+		for (integer l = iFirst; l <= iLast; l++) {
+			const StructNode *pNode = dynamic_cast<const StructNode *>(pDM->pFindNode(Node::STRUCTURAL, l));
+			if (pNode == 0) {
+				silent_cerr("ContactChain(" << GetLabel() << "): StructNode(" << l << ") not found at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			pNodes[l - iFirst] = pNode;
+		}
+
+	} else {
+		silent_cerr("ContactChain(" << GetLabel() << "): keyword \"nodes\" or \"label range\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+
+
+/*=======================================================================================
+* Intial Assembly Process
+*=======================================================================================*/
+//set number of DOF
+unsigned int
+ContactChain::iGetInitialNumDof(void) const
+{
+	return 0;
+}
+
+//set initial value
+void
+ContactChain::SetInitialValue(VectorHandler& XCurr)
+{
+	return;
+}
+
+//set initial assembly matrix dimension
+void
+ContactChain::InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const
+{
+	*piNumRows = 0;
+	*piNumCols = 0;
+}
+
+//calculate residual vector for initial assembly analysis
+SubVectorHandler&
+ContactChain::InitialAssRes(
+	SubVectorHandler& WorkVec,
+	const VectorHandler& XCurr)
+{
+	WorkVec.ResizeReset(0);
+	return WorkVec;
+}
+
+//calculate Jaconbian for initial assembly analysis
+VariableSubMatrixHandler&
+ContactChain::InitialAssJac(
+	VariableSubMatrixHandler& WorkMat,
+	const VectorHandler& XCurr)
+{
+	WorkMat.SetNullMatrix();
+	return WorkMat;
+}
+
+/*=======================================================================================
+* Initial Value Problem
+*=======================================================================================*/
+//set number of DOF
+unsigned int
+ContactChain::iGetNumDof(void) const
+{
+	return 0;
+}
+
+//set DOF type
+DofOrder::Order
+ContactChain::GetDofType(unsigned int i) const
+{
+	return DofOrder::DIFFERENTIAL;
+}
+
+//set initial value
+void
+ContactChain::SetValue(
+	DataManager *pDM,
+	VectorHandler& X,
+	VectorHandler& XP,
+	SimulationEntity::Hints *ph)
+{
+	return;
+}
+
+//set matrix dimension
+void
+ContactChain::WorkSpaceDim(integer* piNumRows, integer* piNumCols) const
+{
+	//residual: 3 rows per node
+	//Jacobian: 3x3 block per node (sparse, 3 columns per row)
+	*piNumRows = 3*pNodes.size();
+	*piNumCols = 3;
+}
+
+//gather active node positions and velocities
+std::size_t
+ContactChain::GatherNodes(const VectorHandler& XCurr, const VectorHandler& XPrimeCurr)
+{
+	//海底面に届きうる節点だけを詰めて格納する
+	const doublereal t = pDataManager->dGetTime();
+	const std::size_t N = pNodes.size();
+	std::size_t n = 0;
+	for (std::size_t i = 0; i < N; i++) {
+		if (!pas.bActive(i, t)) {
+			continue;
+		}
+
+		const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+		iActive[n] = i;
+		iPositionIndex[n] = iPos;
+		iMomentumIndex[n] = pNodes[i]->iGetFirstMomentumIndex();
+
+		rx[n] = XCurr(iPos + 1);
+		ry[n] = XCurr(iPos + 2);
+		rz[n] = XCurr(iPos + 3);
+		vx[n] = XPrimeCurr(iPos + 1);
+		vy[n] = XPrimeCurr(iPos + 2);
+		vz[n] = XPrimeCurr(iPos + 3);
+		n++;
+	}
+	return n;
+}
+
+//seabed below the active nodes
+void
+ContactChain::Surface(std::size_t iBegin, std::size_t iEnd)
+{
+	//chunkごとにまとめて問い合わせる(平らな海底面では z と (0, 0, 1))
+	//メッシュのhintは節点ごとなのでchunkで共有しない
+	pSeabed->surface(iEnd - iBegin, &rx[iBegin], &ry[iBegin], &rz[iBegin],
+		&iActive[iBegin], &pMeshHint[0],
+		&zs[iBegin], &nx[iBegin], &ny[iBegin], &nz[iBegin]);
+}
+
+void
+ContactChain::SweepSurface(const void *pCtx, std::size_t i, const Vec3& r,
+	doublereal& zs, Vec3& normal_vec)
+{
+	//メッシュの探索は節点の前回の三角形から始める(軌跡の標本は近いのでほぼ周囲で決まる)
+	const ContactChain *pChain = static_cast<const ContactChain *>(pCtx);
+	pChain->pSeabed->surface(r, zs, normal_vec, pChain->pMeshHint[i]);
+}
+
+//soil below the active nodes
+void
+ContactChain::Soil(std::size_t iBegin, std::size_t iEnd, const doublereal& nu)
+{
+	//土質区分をまたがない限り前回の区分を使う(hintは節点ごとなのでchunkで共有しない)
+	for (std::size_t a = iBegin; a < iEnd; a++) {
+		const soilprop *p = pSeabed->soil(rx[a], ry[a], pSoilHint[iActive[a]]);
+		if (p == 0) {
+			//区分外はContactChainとSeabedの値
+			ks[a] = k;
+			cs[a] = c;
+			nus[a] = nu;
+			continue;
+		}
+		ks[a] = p->k;
+		cs[a] = p->c;
+		//バッチ計算の摩擦は等方(axialの動摩擦係数)
+		nus[a] = p->nu1d;
+	}
+}
+
+//segment frame
+void
+ContactChain::SegmentFrames(const VectorHandler& XCurr, std::size_t iBegin, std::size_t iEnd)
+{
+	/*セグメントごとに座標系を作り, 向きが変わらない間は使い回す(contactpolicy.h, cachedframe)*/
+	//chunkから呼ばれるので, 書くのは節点ごとの領域だけ
+	const std::size_t N = pNodes.size();
+	for (std::size_t a = iBegin; a < iEnd; a++) {
+		//節点iはセグメントi(最後の節点は最後のセグメント)の座標系を使う
+		const std::size_t s = (iActive[a] < N - 1) ? iActive[a] : N - 2;
+		const integer iPos1 = pNodes[s]->iGetFirstPositionIndex();
+		const integer iPos2 = pNodes[s + 1]->iGetFirstPositionIndex();
+		const Vec3 internode_vec(
+			XCurr(iPos2 + 1) - XCurr(iPos1 + 1),
+			XCurr(iPos2 + 2) - XCurr(iPos1 + 2),
+			XCurr(iPos2 + 3) - XCurr(iPos1 + 3));
+
+		//法線と節点間方向が平行なときは代わりの座標系(縮退として数える)
+		const Vec3 normal_vec(nx[a], ny[a], nz[a]);
+		Vec3 axial_unitvec, lateral_unitvec;
+		bDegenerate[a] = !cachedframe::build(normal_vec, internode_vec, pFrameCache[iActive[a]],
+			axial_unitvec, lateral_unitvec);
+
+		lx[a] = lateral_unitvec(1); ly[a] = lateral_unitvec(2); lz[a] = lateral_unitvec(3);
+		ax[a] = axial_unitvec(1); ay[a] = axial_unitvec(2); az[a] = axial_unitvec(3);
+	}
+}
+
+void
+ContactChain::CountDegenerate(std::size_t n)
+{
+	for (std::size_t a = 0; a < n; a++) {
+		if (bDegenerate[a]) {
+			pcc.degenerate();
+		}
+	}
+}
+
+/*--chunk tasks(節点ごとの領域にだけ書く)--------------------------------------------*/
+void
+ContactChain::ForceChunk(void *pCtx, std::size_t iBegin, std::size_t iEnd)
+{
+	const chunkdata& d = *static_cast<const chunkdata *>(pCtx);
+	ContactChain& e = *d.pElem;
+	e.Surface(iBegin, iEnd);
+	e.Soil(iBegin, iEnd, d.nu);
+	e.SegmentFrames(*d.pXCurr, iBegin, iEnd);
+
+	//反力, 摩擦力をまとめて計算
+	contactbatch b;
+	b.n = iEnd - iBegin;
+	b.rz = &e.rz[iBegin];
+	b.vx = &e.vx[iBegin]; b.vy = &e.vy[iBegin]; b.vz = &e.vz[iBegin];
+	b.zs = &e.zs[iBegin];
+	b.nx = &e.nx[iBegin]; b.ny = &e.ny[iBegin]; b.nz = &e.nz[iBegin];
+	b.k = &e.ks[iBegin]; b.c = &e.cs[iBegin]; b.nu = &e.nus[iBegin];
+	b.ax = &e.ax[iBegin]; b.ay = &e.ay[iBegin]; b.az = &e.az[iBegin];
+	b.lx = &e.lx[iBegin]; b.ly = &e.ly[iBegin]; b.lz = &e.lz[iBegin];
+	b.fx = &e.fx[iBegin]; b.fy = &e.fy[iBegin]; b.fz = &e.fz[iBegin];
+
+	e.pck.force(b, d.vt, CONTACTPOLICY_DCRIT);
+}
+
+void
+ContactChain::JacobianChunk(void *pCtx, std::size_t iBegin, std::size_t iEnd)
+{
+	const chunkdata& d = *static_cast<const chunkdata *>(pCtx);
+	ContactChain& e = *d.pElem;
+	e.Surface(iBegin, iEnd);
+	e.Soil(iBegin, iEnd, d.nu);
+	e.SegmentFrames(*d.pXCurr, iBegin, iEnd);
+
+	for (std::size_t i = iBegin; i < iEnd; i++) {
+		if (!e.bContactNode(i)) {
+			continue;
+		}
+
+		const Vec3 r(e.rx[i], e.ry[i], e.rz[i]);
+		const Vec3 v(e.vx[i], e.vy[i], e.vz[i]);
+		const Vec3 normal_vec(e.nx[i], e.ny[i], e.nz[i]);
+		const Vec3 axial_unitvec(e.ax[i], e.ay[i], e.az[i]);
+		const Vec3 lateral_unitvec(e.lx[i], e.ly[i], e.lz[i]);
+
+		doublereal J[3][3];
+		e.pcf.jacobian(J, r, v, normal_vec, axial_unitvec, lateral_unitvec, e.zs[i], e.ks[i], e.cs[i], e.nus[i], d.vt, d.dCoef);
+		for (int iRow = 0; iRow < 3; iRow++) {
+			for (int iCol = 0; iCol < 3; iCol++) {
+				e.jac[9*i + 3*iRow + iCol] = J[iRow][iCol];
+			}
+		}
+	}
+}
+
+void
+ContactChain::JacobianVectorChunk(void *pCtx, std::size_t iBegin, std::size_t iEnd)
+{
+	const chunkdata& d = *static_cast<const chunkdata *>(pCtx);
+	ContactChain& e = *d.pElem;
+	e.Surface(iBegin, iEnd);
+	e.Soil(iBegin, iEnd, d.nu);
+	e.SegmentFrames(*d.pXCurr, iBegin, iEnd);
+
+	const VectorHandler& Y = *d.pY;
+	for (std::size_t i = iBegin; i < iEnd; i++) {
+		if (!e.bContactNode(i)) {
+			continue;
+		}
+
+		const Vec3 r(e.rx[i], e.ry[i], e.rz[i]);
+		const Vec3 v(e.vx[i], e.vy[i], e.vz[i]);
+		const Vec3 normal_vec(e.nx[i], e.ny[i], e.nz[i]);
+		const Vec3 axial_unitvec(e.ax[i], e.ay[i], e.az[i]);
+		const Vec3 lateral_unitvec(e.lx[i], e.ly[i], e.lz[i]);
+		const integer iPos = e.iPositionIndex[i];
+		const Vec3 y(Y(iPos + 1), Y(iPos + 2), Y(iPos + 3));
+
+		Vec3 Jy;
+		e.pcf.jacobianvector(Jy, r, v, normal_vec, axial_unitvec, lateral_unitvec, e.zs[i], e.ks[i], e.cs[i], e.nus[i], d.vt, y, d.dCoef);
+		for (int iCnt = 0; iCnt < 3; iCnt++) {
+			e.jac[9*i + iCnt] = Jy(iCnt + 1);
+		}
+	}
+}
+
+//calculate residual vector
+SubVectorHandler&
+ContactChain::AssRes(
+	SubVectorHandler& WorkVec,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	contacttimer timer(pcc, contactcounters::ASSRES);
+
+	//海底面に届く節点がなければ何もしない
+	const std::size_t N = GatherNodes(XCurr, XPrimeCurr);
+	pcc.active(N);
+	CONTACT_TRACE(CONTACT_TRACE_VERBOSE, TRACE_ASSEMBLY, "ContactChain active nodes", GetLabel(), double(N));
+	if (N == 0) {
+		WorkVec.ResizeReset(0);
+		return WorkVec;
+	}
+
+	//seabedの定数定義(要素ごとに1回)
+	doublereal g, Zs, nu1d, nu1s, nu2d, nu2s, vt;
+	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
+
+	//座標系と接触力をchunkごとに計算(threads > 1ではスレッドで分担)
+	chunkdata d;
+	d.pElem = this;
+	d.pXCurr = &XCurr;
+	d.pY = 0;
+	d.nu = nu1d;
+	d.vt = vt;
+	d.dCoef = 0.0;
+	pcp.run(N, &ContactChain::ForceChunk, &d);
+	CountDegenerate(N);
+
+	/*configuring workvec------------------------------------------*/
+	WorkVec.ResizeReset(3*N);
+	for (std::size_t i = 0; i < N; i++) {
+		const integer iRow = 3*i;
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			WorkVec.PutRowIndex(iRow + iCnt, iMomentumIndex[i] + iCnt);
+		}
+		WorkVec.PutCoef(iRow + 1, fx[i]);
+		WorkVec.PutCoef(iRow + 2, fy[i]);
+		WorkVec.PutCoef(iRow + 3, fz[i]);
+
+		//反復間の接触状態の切り替わり
+		const char bC = bContactNode(i);
+		if (bC != bContact[iActive[i]]) {
+			bContact[iActive[i]] = bC;
+			pcc.flip();
+		}
+	}
+
+	return WorkVec;
+}
+
+//calculate Jacobian matrix
+VariableSubMatrixHandler&
+ContactChain::AssJac(
+	VariableSubMatrixHandler& WorkMat,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	contacttimer timer(pcc, contactcounters::ASSJAC);
+	//組み込んだ要素を記録し, 前回のAssJacと同じかを判定する(private data)
+	pjr.begin();
+
+	const std::size_t N = GatherNodes(XCurr, XPrimeCurr);
+	if (N == 0) {
+		pcc.unchanged(pjr.end());
+		WorkMat.SetNullMatrix();
+		return WorkMat;
+	}
+
+	doublereal g, Zs, nu1d, nu1s, nu2d, nu2s, vt;
+	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
+
+	//海底面, 座標系と3x3ブロックをchunkごとに計算し, 組み込みは節点の順に1スレッドで行う
+	chunkdata d;
+	d.pElem = this;
+	d.pXCurr = &XCurr;
+	d.pY = 0;
+	d.nu = nu1d;
+	d.vt = vt;
+	d.dCoef = dCoef;
+	pcp.run(N, &ContactChain::JacobianChunk, &d);
+	CountDegenerate(N);
+
+	//接触している節点の3x3ブロックだけを疎行列として組み込む
+	//(節点間の連成項と海底面の曲率は省略, contactforce::jacobian参照)
+	integer iNumContact = 0;
+	for (std::size_t i = 0; i < N; i++) {
+		if (bContactNode(i)) {
+			iNumContact++;
+		}
+	}
+	if (iNumContact == 0) {
+		pcc.unchanged(pjr.end());
+		WorkMat.SetNullMatrix();
+		return WorkMat;
+	}
+
+	SparseSubMatrixHandler& WM = WorkMat.SetSparse();
+	WM.ResizeReset(9*iNumContact, 1);
+
+	integer iEntry = 1;
+	for (std::size_t i = 0; i < N; i++) {
+		if (!bContactNode(i)) {
+			continue;
+		}
+
+		for (int iRow = 1; iRow <= 3; iRow++) {
+			for (int iCol = 1; iCol <= 3; iCol++) {
+				const doublereal& dJ = jac[9*i + 3*(iRow - 1) + iCol - 1];
+				WM.PutItem(iEntry++, iMomentumIndex[i] + iRow, iPositionIndex[i] + iCol, dJ);
+				pjr.put(iMomentumIndex[i] + iRow, iPositionIndex[i] + iCol, dJ);
+			}
+		}
+	}
+
+	pcc.unchanged(pjr.end());
+	return WorkMat;
+}
+
+//Jacobian-vector product (3x3ブロックと索引を作らずに JacY += A Y)
+void
+ContactChain::AssJac(
+	VectorHandler& JacY,
+	const VectorHandler& Y,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr,
+	VariableSubMatrixHandler& WorkMat)
+{
+	contacttimer timer(pcc, contactcounters::ASSJAC);
+
+	const std::size_t N = GatherNodes(XCurr, XPrimeCurr);
+	if (N == 0) {
+		return;
+	}
+
+	doublereal g, Zs, nu1d, nu1s, nu2d, nu2s, vt;
+	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
+
+	chunkdata d;
+	d.pElem = this;
+	d.pXCurr = &XCurr;
+	d.pY = &Y;
+	d.nu = nu1d;
+	d.vt = vt;
+	d.dCoef = dCoef;
+	pcp.run(N, &ContactChain::JacobianVectorChunk, &d);
+	CountDegenerate(N);
+
+	for (std::size_t i = 0; i < N; i++) {
+		if (!bContactNode(i)) {
+			continue;
+		}
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			JacY.IncCoef(iMomentumIndex[i] + iCnt, jac[9*i + iCnt - 1]);
+		}
+	}
+}
+
+
+/*=======================================================================================
+* Private Data
+*=======================================================================================*/
+//set number of private data
+unsigned int
+ContactChain::iGetNumPrivData(void) const
+{
+	return contactcounters::iGetNumPrivData() + contactsweep::iGetNumPrivData()
+		+ stablestep::iGetNumPrivData();
+}
+//set index of private data
+unsigned int
+ContactChain::iGetPrivDataIdx(const char *s) const
+{
+	unsigned int i = pcc.iGetPrivDataIdx(s);
+	if (i == 0) {
+		//swept contact follows the counters
+		i = psw.iGetPrivDataIdx(s);
+		i = (i == 0) ? 0 : contactcounters::iGetNumPrivData() + i;
+	}
+	if (i == 0) {
+		//stable step follows swept contact
+		i = pss.iGetPrivDataIdx(s);
+		i = (i == 0) ? 0 : contactcounters::iGetNumPrivData() + contactsweep::iGetNumPrivData() + i;
+	}
+	if (i == 0) {
+		silent_cerr("ContactChain(" << GetLabel() << "): no private data \"" << s << "\"" << std::endl);
+	}
+	return i;
+}
+//function to get private data
+doublereal
+ContactChain::dGetPrivData(unsigned int i) const
+{
+	const unsigned int iSweep = contactcounters::iGetNumPrivData();
+	const unsigned int iStable = iSweep + contactsweep::iGetNumPrivData();
+	if (i > iStable) {
+		return pss.dGetPrivData(i - iStable);
+	}
+	if (i > iSweep) {
+		return psw.dGetPrivData(i - iSweep);
+	}
+	return pcc.dGetPrivData(i);
+}
+
+
+/*=======================================================================================
+* Configure runtime processing
+*=======================================================================================*/
+//process after prediction (each time step)
+void
+ContactChain::AfterPredict(VectorHandler& X, VectorHandler& XP)
+{
+	if (!psw.bGetEnabled()) {
+		return;
+	}
+
+	//前回の収束解から予測解までの軌跡で衝突する節点の貫入を, 衝突と整合する見積もりで報告する
+	//(予測解は変えない, private data predicted_penetration. 置き換えないのでpredicted_clamped_totalは0)
+	const doublereal dt = pDataManager->pGetDrvHdl()->dGetTimeStep();
+	psw.beginPredict();
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		if (!psw.bSweep(i)) {
+			continue;
+		}
+		const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+		const Vec3 r(X(iPos + 1), X(iPos + 2), X(iPos + 3));
+		const Vec3 v(XP(iPos + 1), XP(iPos + 2), XP(iPos + 3));
+		doublereal zs;
+		Vec3 normal_vec;
+		pSeabed->surface(r, zs, normal_vec, pMeshHint[i]);
+		psw.estimate(i, r, v, (r.dGet(3) - zs)*normal_vec.dGet(3), dt, &ContactChain::SweepSurface, this);
+	}
+}
+
+//process after convergence (each time step)
+void
+ContactChain::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
+{
+	//浮いている節点の再評価時刻を更新
+	doublereal g, Zs, nu1d, nu1s, nu2d, nu2s, vt;
+	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
+
+	const doublereal t = pDataManager->dGetTime();
+	const doublereal dt = pDataManager->pGetDrvHdl()->dGetTimeStep();
+
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+		const Vec3 r(X(iPos + 1), X(iPos + 2), X(iPos + 3));
+		const Vec3 v(XP(iPos + 1), XP(iPos + 2), XP(iPos + 3));
+		pas.update(i, r, v, t, dt, Seabed::UpperBound, pSeabed);
+	}
+
+	//このステップの軌跡での衝突(Contactlaw::Sweepと同じ)
+	if (psw.bGetEnabled()) {
+		psw.begin(dt);
+		for (std::size_t i = 0; i < pNodes.size(); i++) {
+			const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+			const Vec3 r(X(iPos + 1), X(iPos + 2), X(iPos + 3));
+			const Vec3 v(XP(iPos + 1), XP(iPos + 2), XP(iPos + 3));
+			doublereal zs;
+			Vec3 normal_vec;
+			pSeabed->surface(r, zs, normal_vec, pMeshHint[i]);
+			const doublereal gap = (r.dGet(3) - zs)*normal_vec.dGet(3);
+
+			doublereal tau, vn;
+			if (psw.find(i, r, v, gap, dt, &ContactChain::SweepSurface, this, tau, vn)) {
+				psw.impact(tau, vn, gap, dt);
+				CONTACT_TRACE(CONTACT_TRACE_DEBUG, TRACE_CONTACT,
+					gap > 0.0 ? "node tunnelled" : "node impact", pNodes[i]->GetLabel(), tau);
+			}
+			psw.commit(i, r, v, gap);
+		}
+	}
+
+	//収束解の接触力(節点の下の海底面の法線方向)から次の時間刻みの目安
+	if (pss.bGetEnabled()) {
+		pss.begin();
+		for (std::size_t i = 0; i < pNodes.size(); i++) {
+			const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+			const Vec3 r(X(iPos + 1), X(iPos + 2), X(iPos + 3));
+			const Vec3 v(XP(iPos + 1), XP(iPos + 2), XP(iPos + 3));
+			doublereal zs;
+			Vec3 normal_vec;
+			pSeabed->surface(r, zs, normal_vec, pMeshHint[i]);
+			const doublereal gap = (r.dGet(3) - zs)*normal_vec.dGet(3);
+
+			//節点の下の土質(区分外はContactChainとSeabedの値)
+			doublereal kn = k, cn = c;
+			doublereal nu = std::max(std::max(nu1d, nu1s), std::max(nu2d, nu2s));
+			const soilprop *p = pSeabed->soil(r.dGet(1), r.dGet(2), pSoilHint[i]);
+			if (p != 0) {
+				kn = p->k;
+				cn = p->c;
+				nu = std::max(std::max(p->nu1d, p->nu1s), std::max(p->nu2d, p->nu2s));
+			}
+
+			const doublereal fn = (gap < 0.0) ? std::max(-kn*gap - cn*v.Dot(normal_vec), 0.0) : 0.0;
+			pss.update(i, pNodes[i]->GetLabel(), r, v, gap, kn, cn, 0.0, 0.0, fn, nu, vt,
+				Seabed::UpperBound, pSeabed);
+		}
+	}
+}
+
+
+/*=======================================================================================
+* Output
+*=======================================================================================*/
+//output file
+void
+ContactChain::Output(OutputHandler& OH) const
+{
+	if (bToBeOutput()) {
+		if (OH.UseText(OutputHandler::LOADABLE)) {
+			OH.Loadable() << GetLabel()
+				<< std::endl;
+		}
+	}
+}
+
+
+/*=======================================================================================
+* etc
+*=======================================================================================*/
+//print information of connected nodes
+int
+ContactChain::iGetNumConnectedNodes(void) const
+{
+	return pNodes.size();
+}
+void
+ContactChain::GetConnectedNodes(std::vector<const Node *>& connectedNodes) const
+{
+	connectedNodes.resize(pNodes.size());
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		connectedNodes[i] = pNodes[i];
+	}
+}
+//output restart file
+std::ostream&
+ContactChain::Restart(std::ostream& out) const
+{
+	return out << "# ContactChain (" << GetLabel() << "): not implemented yet" << std::endl;
+}
+
+/* ----------------------------- ContactChain end -------------------------------------- */
@@ -0,0 +1,266 @@
+/* -----------------------------------------------------------------------
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2017
+ *
+ * Pierangelo Masarati  <masarati@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * -----------------------------------------------------------------------*/
+
+/* -----------------------------------------------------------------------
+ * Module - Contactlaw (ContactChain)
+ *
+ * Implemented by
+ * Ryoya Hisamatsu <hisamatsu@nams.kyushu-u.ac.jp>
+ * Department of Marine Systems Engineering, Kyushu University
+ * Motooka 744, Nishi-ku, Fukuoka 819-0395, Fukuoka, Japan
+ * -----------------------------------------------------------------------*/
+
+#ifndef CONTACTCHAIN_H
+#define CONTACTCHAIN_H
+
+#include <vector>
+
+#include "dataman.h"
+#include "userelem.h"
+#include "module-seabed.h"
+#include "tanhfunc.h"
+#include "contactforce.h"
+#include "contactpolicy.h"
+#include "contactkernel.h"
+#include "activeset.h"
+#include "contactcounters.h"
+#include "jacobianreuse.h"
+#include "contactpool.h"
+#include "contactsweep.h"
+#include "stablestep.h"
+
+/* =================================================
+ * class ContactChain
+ *  係留索1本分の節点列(N節点)と海底面の接触を1要素で計算する.
+ *  Contactlawを節点ペアごとに並べる代わりに使う.
+ *  海底面の高さと法線は節点ごとにSeabedから求める(bathymetry, 三角形メッシュも可).
+ *  土質区分図があれば k, c と摩擦係数も節点ごと(区分外は k, c と Seabed の nu1d).
+ *  threadsを指定すると, 接触しうる節点をchunkに分けて複数のスレッドで計算する
+ *  (contactpool, 結果はスレッド数によらない).
+ * ================================================= */
+class ContactChain
+: virtual public Elem, public UserDefinedElem
+{
+private:
+	/*===================================================================
+	 * Private Member Variables
+	 *===================================================================*/
+	//connected nodes (ordered along the line)
+	std::vector<const StructNode *> pNodes;
+	const Seabed 			*pSeabed;
+	const DataManager 		*pDataManager;
+	const contactforce		pcf;
+	contactkernel 			pck;
+	doublereal 				k;
+	doublereal 				c;
+	//airborne node culling
+	activeset 				pas;
+
+	//active node data (structure of arrays, first n of N entries used)
+	std::vector<std::size_t> iActive;
+	std::vector<integer> 	iPositionIndex;
+	std::vector<integer> 	iMomentumIndex;
+	std::vector<doublereal> rx, ry, rz;
+	std::vector<doublereal> vx, vy, vz;
+
+	//seabed height and unit normal below each active node (Seabed::surface per chunk)
+	std::vector<doublereal> zs, nx, ny, nz;
+	//soil constants and friction coefficient of each active node (Seabed::soil)
+	std::vector<doublereal> ks, cs, nus;
+	//soil zone of each node at the last query (indexed by node, not by active node)
+	std::vector<soilhint> 	pSoilHint;
+	//mesh triangle of each node at the last query (indexed by node, mutable for SweepSurface)
+	mutable std::vector<trimeshhint> pMeshHint;
+
+	//frame of each active node
+	//node i uses segment i, the last node uses the last segment
+	std::vector<doublereal> ax, ay, az;
+	std::vector<doublereal> lx, ly, lz;
+
+	//forces of each active node
+	std::vector<doublereal> fx, fy, fz;
+
+	//frame of each node reused while its segment direction does not change
+	//(the last node keeps its own copy of the last segment, chunks never share a cache)
+	std::vector<framecache> pFrameCache;
+	//degenerate frame of each active node (counted after the chunks)
+	std::vector<char> 		bDegenerate;
+	//3x3 Jacobian block of each active node (J y in the first 3 entries for the product)
+	std::vector<doublereal> jac;
+
+	//contact of each node at the last iteration (flip counter)
+	std::vector<char> 		bContact;
+	//performance counters (private data)
+	contactcounters 		pcc;
+	//entries of the last AssJac (unchanged flag)
+	jacobianreuse 			pjr;
+	//worker threads sharing the chunks of active nodes
+	contactpool 			pcp;
+	//impacts on the path of each step (continuous collision detection)
+	contactsweep 			psw;
+	//time step bound from the contact stiffness and the nodal mass
+	stablestep 				pss;
+
+	//arguments of the chunk tasks
+	struct chunkdata
+	{
+		ContactChain *pElem;
+		const VectorHandler *pXCurr;
+		const VectorHandler *pY;
+		doublereal nu, vt, dCoef;
+	};
+
+private:
+	//read node list ("nodes, N, ..." or "label range, first, last")
+	void ReadNodes(DataManager* pDM, MBDynParser& HP);
+	//gather active node positions and velocities into SoA storage
+	std::size_t GatherNodes(const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+	//seabed height and normal below the active nodes [iBegin, iEnd)
+	void Surface(std::size_t iBegin, std::size_t iEnd);
+	//soil constants of the active nodes [iBegin, iEnd) (nu: friction outside the soil zones)
+	void Soil(std::size_t iBegin, std::size_t iEnd, const doublereal& nu);
+	//active node a touches the seabed
+	bool bContactNode(std::size_t a) const { return (rz[a] - zs[a])*nz[a] <= 0.0; };
+	//calculate axial/lateral unit vectors of the active nodes [iBegin, iEnd)
+	void SegmentFrames(const VectorHandler& XCurr, std::size_t iBegin, std::size_t iEnd);
+	//count degenerate frames of the n active nodes (in node order)
+	void CountDegenerate(std::size_t n);
+	//chunk tasks of contactpool: frames and forces, Jacobian blocks or J y of [iBegin, iEnd)
+	static void ForceChunk(void *pCtx, std::size_t iBegin, std::size_t iEnd);
+	static void JacobianChunk(void *pCtx, std::size_t iBegin, std::size_t iEnd);
+	static void JacobianVectorChunk(void *pCtx, std::size_t iBegin, std::size_t iEnd);
+	//seabed below the point r for contactsweep (pCtx: the ContactChain)
+	static void SweepSurface(const void *pCtx, std::size_t i, const Vec3& r,
+		doublereal& zs, Vec3& normal_vec);
+
+public:
+	/*===================================================================
+	 * Constructor and Destructor
+	 *===================================================================*/
+	//constructor
+	ContactChain(unsigned uLabel, const DofOwner *pDO,
+		DataManager* pDM, MBDynParser& HP);
+	//destructor
+	virtual ~ContactChain(void);
+
+
+	/*===================================================================
+	 * Intial Assembly Process
+	 *===================================================================*/
+	//set number of DOF
+	virtual unsigned int iGetInitialNumDof(void) const;
+	//set initial value
+	virtual void SetInitialValue(VectorHandler& XCurr);
+	//set initial assembly matrix dimension
+	virtual void
+	InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const;
+	//calculate residual vector for initial assembly analysis
+   	SubVectorHandler&
+	InitialAssRes(SubVectorHandler& WorkVec, const VectorHandler& XCurr);
+	//calculate Jaconbian for initial assembly analysis
+   	VariableSubMatrixHandler&
+	InitialAssJac(VariableSubMatrixHandler& WorkMat,
+		      const VectorHandler& XCurr);
+
+
+	/*===================================================================
+	 * Initial Value Problem
+	 *===================================================================*/
+	//set number of DOF
+	virtual unsigned int iGetNumDof(void) const;
+	//set DOF type
+	virtual DofOrder::Order GetDofType(unsigned int i) const;
+	//set initial value
+	void SetValue(DataManager *pDM, VectorHandler& X, VectorHandler& XP,
+		SimulationEntity::Hints *ph);
+
+	//set matrix dimension
+	virtual void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const;
+	//calculate residual vector, b
+	SubVectorHandler&
+	AssRes(SubVectorHandler& WorkVec,
+		doublereal dCoef,
+		const VectorHandler& XCurr,
+		const VectorHandler& XPrimeCurr);
+	//calculate Jacobian matrix, A
+	VariableSubMatrixHandler&
+	AssJac(VariableSubMatrixHandler& WorkMat,
+		doublereal dCoef,
+		const VectorHandler& XCurr,
+		const VectorHandler& XPrimeCurr);
+	//calculate JacY += A Y without assembling A (matrix-free solvers)
+	virtual void
+	AssJac(VectorHandler& JacY,
+		const VectorHandler& Y,
+		doublereal dCoef,
+		const VectorHandler& XCurr,
+		const VectorHandler& XPrimeCurr,
+		VariableSubMatrixHandler& WorkMat);
+
+
+	/*===================================================================
+	 * Private Data
+	 *===================================================================*/
+	//set number of private data
+	virtual unsigned int iGetNumPrivData(void) const;
+	//set index of private data
+	virtual unsigned int iGetPrivDataIdx(const char *s) const;
+	//function to get private data
+	virtual doublereal dGetPrivData(unsigned int i) const;
+
+
+	/*===================================================================
+	 * Configure runtime processing
+	 *===================================================================*/
+	//process after prediction (each time step)
+	virtual void
+	AfterPredict(VectorHandler& X, VectorHandler& XP);
+	//process after convergence (each time step)
+	virtual void
+	AfterConvergence(const VectorHandler& X, const VectorHandler& XP);
+
+
+	/*===================================================================
+	 * Output
+	 *===================================================================*/
+	//output file
+	virtual void Output(OutputHandler& OH) const;
+
+
+	/*===================================================================
+	 * etc
+	 *===================================================================*/
+	//print information of connected nodes
+	virtual int iGetNumConnectedNodes(void) const;
+	virtual void GetConnectedNodes(std::vector<const Node *>& connectedNodes) const;
+	//output restart file
+	virtual std::ostream& Restart(std::ostream& out) const;
+};
+
+#endif // CONTACTCHAIN_H
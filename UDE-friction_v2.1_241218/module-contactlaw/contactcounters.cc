@@ -0,0 +1,125 @@
+#include "mbconfig.h"
+
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#include "except.h"
+#include "contactcounters.h"
+
+/* ------------------------------ contactcounters start ---------------------------------------*/
+static const struct {
+	unsigned int index;
+	const char *name;
+} contactcounters_data[] = {
+	{ 1, "assres_calls" },
+	{ 2, "assres_cycles" },
+	{ 3, "assjac_calls" },
+	{ 4, "assjac_cycles" },
+	{ 5, "active_nodes" },
+	{ 6, "active_nodes_total" },
+	{ 7, "flips" },
+	{ 8, "degenerate_frames" },
+	{ 9, "jacobian_unchanged" },
+	{ 10, "jacobian_unchanged_total" },
+};
+
+contactcounters::contactcounters(void)
+: iActive(0), iActiveTotal(0), iFlips(0), iDegenerate(0),
+bUnchanged(false), iUnchangedTotal(0), bSummary(false)
+{
+	iCalls[ASSRES] = iCalls[ASSJAC] = 0;
+	iCycles[ASSRES] = iCycles[ASSJAC] = 0;
+}
+
+contactcounters::~contactcounters(void)
+{
+	NO_OP;
+}
+
+/*--[0]cycles(経過時間の計測)---------------------------------------------------------*/
+unsigned long long
+contactcounters::iGetCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	//rdtscは命令の並びを保証しないが, 数千サイクルの区間の計測には十分
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*--[1]private data-------------------------------------------------------------------*/
+unsigned int
+contactcounters::iGetNumPrivData(void)
+{
+	return sizeof(contactcounters_data)/sizeof(contactcounters_data[0]);
+}
+
+unsigned int
+contactcounters::iGetPrivDataIdx(const char *s)
+{
+	for (unsigned int i = 0; i < iGetNumPrivData(); i++) {
+		if (std::strcmp(contactcounters_data[i].name, s) == 0) {
+			return contactcounters_data[i].index;
+		}
+	}
+	return 0;
+}
+
+doublereal
+contactcounters::dGetPrivData(unsigned int i) const
+{
+	switch (i) {
+	case 1:
+		return doublereal(iCalls[ASSRES]);
+	case 2:
+		return doublereal(iCycles[ASSRES]);
+	case 3:
+		return doublereal(iCalls[ASSJAC]);
+	case 4:
+		return doublereal(iCycles[ASSJAC]);
+	case 5:
+		return doublereal(iActive);
+	case 6:
+		return doublereal(iActiveTotal);
+	case 7:
+		return doublereal(iFlips);
+	case 8:
+		return doublereal(iDegenerate);
+	case 9:
+		return bUnchanged ? 1.0 : 0.0;
+	case 10:
+		return doublereal(iUnchangedTotal);
+	}
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+}
+
+/*--[2]summary(解析終了時の集計)-----------------------------------------------------*/
+void
+contactcounters::summary(std::ostream& out) const
+{
+	const char *sPhase[2] = { "AssRes", "AssJac" };
+	for (int p = ASSRES; p <= ASSJAC; p++) {
+		out << sPhase[p] << " " << iCalls[p] << " calls, " << iCycles[p] << " cycles";
+		if (iCalls[p] > 0) {
+			out << " (" << std::fixed << std::setprecision(1)
+				<< double(iCycles[p])/double(iCalls[p]) << "/call)";
+			out.unsetf(std::ios_base::floatfield);
+		}
+		out << "; ";
+	}
+	out << "active nodes " << iActiveTotal
+		<< ", flips " << iFlips
+		<< ", degenerate frames " << iDegenerate
+		<< ", unchanged jacobians " << iUnchangedTotal;
+}
+
+/* ------------------------------ contactcounters end -----------------------------------------*/
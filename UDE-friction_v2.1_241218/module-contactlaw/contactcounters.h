@@ -0,0 +1,103 @@
+#ifndef CONTACTCOUNTERS_H
+#define CONTACTCOUNTERS_H
+
+#include <cstddef>
+#include <iostream>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Contact Counters
+ *  要素ごとの計算量の記録(private dataで読み出す).
+ *  AssRes/AssJacの呼び出し回数と経過サイクル数(x86ではrdtsc, それ以外はns),
+ *  評価した節点数, 反復中の接触状態の切り替わり, 座標系が作れなかった回数.
+ *
+ *  private data
+ *    1 assres_calls        AssResの呼び出し回数
+ *    2 assres_cycles       AssResの累積サイクル数
+ *    3 assjac_calls        AssJacの呼び出し回数
+ *    4 assjac_cycles       AssJacの累積サイクル数
+ *    5 active_nodes        最後のAssResで評価した節点数
+ *    6 active_nodes_total  評価した節点数の累計
+ *    7 flips               反復中の接触状態の切り替わりの累計
+ *    8 degenerate_frames   法線と節点間方向が平行で座標系が作れなかった回数
+ *    9 jacobian_unchanged  最後のAssJacの寄与が前回と同じなら1 (係数行列を分解し直さなくてよい)
+ *   10 jacobian_unchanged_total  寄与が前回と同じだったAssJacの回数
+ * ================================================= */
+class contactcounters
+{
+public:
+    enum Phase {
+        ASSRES = 0,
+        ASSJAC = 1
+    };
+
+private:
+    unsigned long iCalls[2];
+    unsigned long long iCycles[2];
+    unsigned long iActive;
+    unsigned long iActiveTotal;
+    unsigned long iFlips;
+    unsigned long iDegenerate;
+    bool bUnchanged;
+    unsigned long iUnchangedTotal;
+    bool bSummary;
+
+public:
+    contactcounters(void);
+    ~contactcounters(void);
+
+    //print the summary when the element is destroyed
+    void setSummary(bool b) { bSummary = b; };
+    bool bGetSummary(void) const { return bSummary; };
+
+    //time stamp counter (cycles on x86, ns otherwise)
+    static unsigned long long iGetCycles(void);
+
+    void call(Phase p, unsigned long long iElapsed) {
+        iCalls[p]++;
+        iCycles[p] += iElapsed;
+    };
+    void active(std::size_t n) {
+        iActive = n;
+        iActiveTotal += n;
+    };
+    void flip(void) { iFlips++; };
+    void degenerate(void) { iDegenerate++; };
+    void unchanged(bool b) {
+        bUnchanged = b;
+        iUnchangedTotal += b ? 1 : 0;
+    };
+
+    //private data (index 1 ... iGetNumPrivData(), 0 if the name is unknown)
+    static unsigned int iGetNumPrivData(void);
+    static unsigned int iGetPrivDataIdx(const char *s);
+    doublereal dGetPrivData(unsigned int i) const;
+
+    //one line summary (calls, cycles per call, ...)
+    void summary(std::ostream& out) const;
+};
+
+/* =================================================
+ * class Contact Timer
+ *  スコープを抜けるまでのサイクル数をcontactcountersに加える.
+ *  AssRes/AssJacの先頭に置く.
+ * ================================================= */
+class contacttimer
+{
+private:
+    contactcounters& cc;
+    contactcounters::Phase phase;
+    unsigned long long iStart;
+
+public:
+    contacttimer(contactcounters& c, contactcounters::Phase p)
+    : cc(c), phase(p), iStart(contactcounters::iGetCycles()) {};
+    ~contacttimer(void) {
+        cc.call(phase, contactcounters::iGetCycles() - iStart);
+    };
+};
+
+#endif // CONTACTCOUNTERS_H
@@ -0,0 +1,402 @@
+#ifndef CONTACTDUAL_H
+#define CONTACTDUAL_H
+
+#include <cmath>
+#include <limits>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+#include "contactpolicy.h"
+
+/* =================================================
+ * class Dual
+ *  前進モードの自動微分に使う双対数 x = v + sum_i d_i e_i (e_i e_j = 0).
+ *  偏微分の数Nはコンパイル時に決まり, 配列はスタック上に置く(ヒープを使わない).
+ *  接触力の式をdualで1回計算すると, 力と選んだ方向(seed)への微分が同時に求まる.
+ * ================================================= */
+template <int N>
+class dual
+{
+public:
+    doublereal v;
+    doublereal d[N];
+
+    dual(void) : v(0.0) {
+        for (int i = 0; i < N; i++) { d[i] = 0.0; }
+    };
+    //constant
+    dual(const doublereal& x) : v(x) {
+        for (int i = 0; i < N; i++) { d[i] = 0.0; }
+    };
+    //independent variable with dx/dseed_i = 1
+    dual(const doublereal& x, int i) : v(x) {
+        for (int j = 0; j < N; j++) { d[j] = 0.0; }
+        d[i] = 1.0;
+    };
+
+    dual& operator+=(const dual& b) {
+        v += b.v;
+        for (int i = 0; i < N; i++) { d[i] += b.d[i]; }
+        return *this;
+    };
+    dual& operator-=(const dual& b) {
+        v -= b.v;
+        for (int i = 0; i < N; i++) { d[i] -= b.d[i]; }
+        return *this;
+    };
+    dual& operator*=(const dual& b) {
+        for (int i = 0; i < N; i++) { d[i] = d[i]*b.v + v*b.d[i]; }
+        v *= b.v;
+        return *this;
+    };
+    dual& operator*=(const doublereal& b) {
+        v *= b;
+        for (int i = 0; i < N; i++) { d[i] *= b; }
+        return *this;
+    };
+};
+
+/*--[0]四則演算---------------------------------------------------------------------*/
+template <int N>
+inline dual<N> operator-(const dual<N>& a)
+{
+    dual<N> c;
+    c.v = -a.v;
+    for (int i = 0; i < N; i++) { c.d[i] = -a.d[i]; }
+    return c;
+}
+
+template <int N>
+inline dual<N> operator+(const dual<N>& a, const dual<N>& b) { dual<N> c(a); return c += b; }
+template <int N>
+inline dual<N> operator+(const dual<N>& a, const doublereal& b) { dual<N> c(a); c.v += b; return c; }
+template <int N>
+inline dual<N> operator+(const doublereal& a, const dual<N>& b) { dual<N> c(b); c.v += a; return c; }
+
+template <int N>
+inline dual<N> operator-(const dual<N>& a, const dual<N>& b) { dual<N> c(a); return c -= b; }
+template <int N>
+inline dual<N> operator-(const dual<N>& a, const doublereal& b) { dual<N> c(a); c.v -= b; return c; }
+template <int N>
+inline dual<N> operator-(const doublereal& a, const dual<N>& b) { dual<N> c(-b); c.v += a; return c; }
+
+template <int N>
+inline dual<N> operator*(const dual<N>& a, const dual<N>& b) { dual<N> c(a); return c *= b; }
+template <int N>
+inline dual<N> operator*(const dual<N>& a, const doublereal& b) { dual<N> c(a); return c *= b; }
+template <int N>
+inline dual<N> operator*(const doublereal& a, const dual<N>& b) { dual<N> c(b); return c *= a; }
+
+//(a/b)' = (a' - (a/b) b')/b
+template <int N>
+inline dual<N> operator/(const dual<N>& a, const dual<N>& b)
+{
+    const doublereal invb = 1.0/b.v;
+    dual<N> c;
+    c.v = a.v*invb;
+    for (int i = 0; i < N; i++) { c.d[i] = (a.d[i] - c.v*b.d[i])*invb; }
+    return c;
+}
+template <int N>
+inline dual<N> operator/(const dual<N>& a, const doublereal& b) { return a*(1.0/b); }
+template <int N>
+inline dual<N> operator/(const doublereal& a, const dual<N>& b) { return dual<N>(a)/b; }
+
+//比較は値だけで行う(分岐の両側で微分は連続とは限らない)
+template <int N>
+inline bool operator<(const dual<N>& a, const doublereal& b) { return a.v < b; }
+template <int N>
+inline bool operator>(const dual<N>& a, const doublereal& b) { return a.v > b; }
+template <int N>
+inline bool operator<=(const dual<N>& a, const doublereal& b) { return a.v <= b; }
+template <int N>
+inline bool operator>=(const dual<N>& a, const doublereal& b) { return a.v >= b; }
+
+/*--[1]関数(f(a)' = f'(a) a')-------------------------------------------------------*/
+template <int N>
+inline dual<N> contactdual_chain(const doublereal& f, const doublereal& df, const dual<N>& a)
+{
+    dual<N> c;
+    c.v = f;
+    for (int i = 0; i < N; i++) { c.d[i] = df*a.d[i]; }
+    return c;
+}
+
+template <int N>
+inline dual<N> sqrt(const dual<N>& a)
+{
+    const doublereal s = std::sqrt(a.v);
+    //sqrt(0)では微分を0とする(|v| -> 0 の扱いはcontactpolicy.hと同じ)
+    return contactdual_chain(s, (s > 0.0) ? 0.5/s : 0.0, a);
+}
+
+template <int N>
+inline dual<N> exp(const dual<N>& a)
+{
+    const doublereal e = std::exp(a.v);
+    return contactdual_chain(e, e, a);
+}
+
+template <int N>
+inline dual<N> tanh(const dual<N>& a)
+{
+    const doublereal t = std::tanh(a.v);
+    return contactdual_chain(t, 1.0 - t*t, a);
+}
+
+template <int N>
+inline dual<N> atan(const dual<N>& a)
+{
+    return contactdual_chain(std::atan(a.v), 1.0/(1.0 + a.v*a.v), a);
+}
+
+template <int N>
+inline dual<N> abs(const dual<N>& a)
+{
+    return (a.v < 0.0) ? -a : a;
+}
+
+//doublerealでもdualでも同じ式で書くための値の取り出し
+inline doublereal contactdual_value(const doublereal& a) { return a; }
+template <int N>
+inline doublereal contactdual_value(const dual<N>& a) { return a.v; }
+
+/*--[2]Regularization(Tdが値と導関数を返すので, 連鎖律で双対数にする)---------------*/
+template <class Regularization>
+inline doublereal contactdual_T(const doublereal& x, const frictionparam& fp)
+{
+    doublereal T, dT;
+    Regularization::Td(x, fp, T, dT);
+    return T;
+}
+
+template <class Regularization, int N>
+inline dual<N> contactdual_T(const dual<N>& x, const frictionparam& fp)
+{
+    doublereal T, dT;
+    Regularization::Td(x.v, fp, T, dT);
+    return contactdual_chain(T, dT, x);
+}
+
+/* =================================================
+ * class Dual Vec3
+ *  成分がdual<N>の3次元ベクトル. Vec3と同じ書き方(1始まりの添字, Dot, Cross, Norm)で,
+ *  Vec3(定数)との演算はdualvec3になる. exchangevectorのinner, crossに当たるのはDot, Cross.
+ * ================================================= */
+template <int N>
+class dualvec3
+{
+private:
+    dual<N> x[3];
+
+public:
+    dualvec3(void) {};
+    //constant
+    dualvec3(const Vec3& a) {
+        for (int i = 0; i < 3; i++) { x[i] = dual<N>(a(i + 1)); }
+    };
+    dualvec3(const dual<N>& a1, const dual<N>& a2, const dual<N>& a3) {
+        x[0] = a1; x[1] = a2; x[2] = a3;
+    };
+    //independent variables, d(component i)/d(seed iFirst + i) = s
+    static dualvec3 seed(const Vec3& a, const doublereal& s, int iFirst) {
+        dualvec3 c(a);
+        for (int i = 0; i < 3; i++) {
+            c.x[i].d[iFirst + i] = s;
+        }
+        return c;
+    };
+    //a + h b (seed 0 is h)
+    static dualvec3 direction(const Vec3& a, const Vec3& b) {
+        dualvec3 c(a);
+        for (int i = 0; i < 3; i++) {
+            c.x[i].d[0] = b(i + 1);
+        }
+        return c;
+    };
+
+    const dual<N>& operator()(int i) const { return x[i - 1]; };
+    dual<N>& operator()(int i) { return x[i - 1]; };
+
+    //value part
+    Vec3 value(void) const { return Vec3(x[0].v, x[1].v, x[2].v); };
+    //derivative of each component by seed i
+    Vec3 derivative(int i) const { return Vec3(x[0].d[i], x[1].d[i], x[2].d[i]); };
+
+    dualvec3& operator+=(const dualvec3& b) {
+        for (int i = 0; i < 3; i++) { x[i] += b.x[i]; }
+        return *this;
+    };
+    dualvec3& operator-=(const dualvec3& b) {
+        for (int i = 0; i < 3; i++) { x[i] -= b.x[i]; }
+        return *this;
+    };
+
+    dualvec3 operator+(const dualvec3& b) const { dualvec3 c(*this); return c += b; };
+    dualvec3 operator-(const dualvec3& b) const { dualvec3 c(*this); return c -= b; };
+    dualvec3 operator*(const dual<N>& s) const { return dualvec3(x[0]*s, x[1]*s, x[2]*s); };
+    dualvec3 operator*(const doublereal& s) const { return dualvec3(x[0]*s, x[1]*s, x[2]*s); };
+
+    dual<N> Dot(const dualvec3& b) const { return x[0]*b.x[0] + x[1]*b.x[1] + x[2]*b.x[2]; };
+    dual<N> Dot(const Vec3& b) const { return x[0]*b(1) + x[1]*b(2) + x[2]*b(3); };
+    dual<N> Dot(void) const { return Dot(*this); };
+    dual<N> Norm(void) const { return sqrt(Dot()); };
+    dualvec3 Cross(const dualvec3& b) const {
+        return dualvec3(x[1]*b.x[2] - x[2]*b.x[1], x[2]*b.x[0] - x[0]*b.x[2], x[0]*b.x[1] - x[1]*b.x[0]);
+    };
+};
+
+//Vec3(定数) * dual
+template <int N>
+inline dualvec3<N> operator*(const Vec3& a, const dual<N>& s)
+{
+    return dualvec3<N>(s*a(1), s*a(2), s*a(3));
+}
+
+template <int N>
+inline dualvec3<N> operator+(const Vec3& a, const dualvec3<N>& b) { return dualvec3<N>(a) + b; }
+
+/* =================================================
+ * Dual Friction
+ *  摩擦力をdoublerealでもdualでも同じ式で書いたもの(微分は自動微分に任せる).
+ *  新しい摩擦モデルは, ここにforceを1つ書けばdualcontactlawでヤコビ行列が得られる.
+ *  状態を持つモデル(stick slip)はない.
+ * ================================================= */
+template <class FrictionModel>
+struct dualfriction;
+
+//ft = -T(|v|/vt) nu F P v (projectedfriction)
+template <>
+struct dualfriction<projectedfriction>
+{
+    template <class Regularization, class S, class V>
+    static inline V force(const V& v, const Vec3& a, const Vec3& l, const S& F, const frictionparam& fp)
+    {
+        const V u = a*v.Dot(a) + l*v.Dot(l);
+        const S T = contactdual_T<Regularization>(v.Norm()/fp.vt, fp);
+        return u*(-(T*fp.nu1d*F));
+    };
+};
+
+//ft = -nu F T(|u|/vt)/|u| u (coulombfriction, |u| -> 0 では T(|u|/vt)/|u| -> T'(0)/vt)
+template <>
+struct dualfriction<coulombfriction>
+{
+    template <class Regularization, class S, class V>
+    static inline V force(const V& v, const Vec3& a, const Vec3& l, const S& F, const frictionparam& fp)
+    {
+        const V u = a*v.Dot(a) + l*v.Dot(l);
+        const S w = u.Norm();
+        if (!(contactdual_value(w) > std::numeric_limits<doublereal>::epsilon()*fp.vt)) {
+            doublereal T, dT;
+            Regularization::Td(0.0, fp, T, dT);
+            return u*(-fp.nu1d*dT/fp.vt*F);
+        }
+        return u*(-fp.nu1d*contactdual_T<Regularization>(w/fp.vt, fp)/w*F);
+    };
+};
+
+/* =================================================
+ * class Dual Contact Law
+ *  dualcontactlaw<Law>: Lawの力の式を双対数で計算し, ヤコビ行列を自動微分で求める.
+ *  力(force, multiplierforce)と座標系はLawのものをそのまま使う.
+ *  J = -(df/dv + dCoef df/dr) は r + dCoef h e_j, v + h e_j の h微分なので,
+ *  seedは3個で足りる(Lagrange乗数の反力を加えて4個).
+ *  Jy は seed 1個(r + dCoef h y, v + h y).
+ * ================================================= */
+template <class Law>
+class dualcontactlaw : public Law
+{
+public:
+    typedef typename Law::normalmodel normalmodel;
+    typedef typename Law::frictionmodel frictionmodel;
+    typedef typename Law::regularization regularization;
+
+    //f(r, v) (z <= 0)
+    template <int N>
+    static inline dualvec3<N> residual(const dualvec3<N>& r, const dualvec3<N>& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c, const frictionparam& fp)
+    {
+        //海底面は節点の下で局所的に平面とみなす(dz/dr = n, contactlawと同じ)
+        const Vec3 r0 = r.value();
+        const dual<N> z = r.Dot(normal_vec) + ((r0.dGet(3) - Zs)*normal_vec.dGet(3) - r0.Dot(normal_vec));
+        const dual<N> F = normalmodel::F(z, v.Dot(normal_vec), k, c);
+        return normal_vec*F + dualfriction<frictionmodel>::template force<regularization>(
+            v, axial_unitvec, lateral_unitvec, F, fp);
+    };
+
+    static inline void jacobian(doublereal J[3][3], const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const frictionparam& fp, const frictionstate& fs0, const doublereal& dCoef)
+    {
+        if ((r.dGet(3) - Zs)*normal_vec.dGet(3) > 0.0) {
+            contactpolicy_zero(J);
+            return;
+        }
+
+        const dualvec3<3> f = residual(dualvec3<3>::seed(r, dCoef, 0), dualvec3<3>::seed(v, 1.0, 0),
+            normal_vec, axial_unitvec, lateral_unitvec, Zs, k, c, fp);
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                J[i][j] = -f(i + 1).d[j];
+            }
+        }
+    };
+
+    static inline void jacobianvector(Vec3& Jy, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const frictionparam& fp, const frictionstate& fs0, const Vec3& y, const doublereal& dCoef)
+    {
+        if ((r.dGet(3) - Zs)*normal_vec.dGet(3) > 0.0) {
+            Jy = Vec3(0.0, 0.0, 0.0);
+            return;
+        }
+
+        const dualvec3<1> f = residual(dualvec3<1>::direction(r, y*dCoef), dualvec3<1>::direction(v, y),
+            normal_vec, axial_unitvec, lateral_unitvec, Zs, k, c, fp);
+        Jy = f.derivative(0)*(-1.0);
+    };
+
+    //f = F n + ft(F), seeds 0-2: r + dCoef h e_j, v + h e_j, seed 3: F
+    static inline void multiplierjacobian(doublereal J[3][3], Vec3& df_dF, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0, const doublereal& dCoef)
+    {
+        df_dF = normal_vec;
+        if (F <= 0.0) {
+            contactpolicy_zero(J);
+            return;
+        }
+
+        //dualfrictionはrによらない
+        const dualvec3<4> v_h = dualvec3<4>::seed(v, 1.0, 0);
+        const dual<4> F_h(F, 3);
+        const dualvec3<4> f = normal_vec*F_h + dualfriction<frictionmodel>::template force<regularization>(
+            v_h, axial_unitvec, lateral_unitvec, F_h, fp);
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                J[i][j] = -f(i + 1).d[j];
+            }
+        }
+        df_dF = f.derivative(3);
+    };
+
+    static inline void multiplierjacobianvector(Vec3& Jy, Vec3& df_dF, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0,
+        const Vec3& y, const doublereal& dCoef)
+    {
+        doublereal J[3][3];
+        multiplierjacobian(J, df_dF, r, v, normal_vec, axial_unitvec, lateral_unitvec, F, fp, fs0, dCoef);
+        for (int i = 0; i < 3; i++) {
+            Jy(i + 1) = J[i][0]*y(1) + J[i][1]*y(2) + J[i][2]*y(3);
+        }
+    };
+};
+
+#endif // CONTACTDUAL_H
@@ -0,0 +1,74 @@
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+
+#include "contactforce.h"
+#include "contactpolicy.h"
+
+/* ------------------------------ contactforce start ---------------------------------------*/
+//状態を持たない摩擦(動摩擦係数nuのみ)
+static inline frictionparam
+param(const doublereal& nu, const doublereal& vt)
+{
+	frictionparam fp;
+	fp.nu1d = fp.nu1s = fp.nu2d = fp.nu2s = nu;
+	fp.vt = vt;
+	fp.dcrit = CONTACTPOLICY_DCRIT;
+	fp.kt = fp.ct = 0.0;
+	fp.vs = vt;
+	return fp;
+}
+
+contactforce::contactforce(void)
+{
+	NO_OP;
+}
+
+contactforce::~contactforce(void)
+{
+	NO_OP;
+}
+
+/*--[1]force_calc(接触力計算)-------------------------------------------------------*/
+//式はcontactpolicy.h(元のContactlawと同じ組み合わせ)
+void
+contactforce::force(Vec3& f, const Vec3& r, const Vec3& v,
+	const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+	const doublereal& Zs, const doublereal& k, const doublereal& c,
+	const doublereal& nu, const doublereal& vt) const
+{
+	frictionstate fs;
+	contactlawdefault::force(f, fs, r, v, normal_vec, axial_unitvec, lateral_unitvec,
+		Zs, k, c, param(nu, vt), frictionstate());
+}
+
+/*--[2]jacobian_calc(接触力のヤコビ行列計算)-----------------------------------------*/
+void
+contactforce::jacobian(doublereal J[3][3], const Vec3& r, const Vec3& v,
+	const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+	const doublereal& Zs, const doublereal& k, const doublereal& c,
+	const doublereal& nu, const doublereal& vt, const doublereal& dCoef) const
+{
+	contactlawdefault::jacobian(J, r, v, normal_vec, axial_unitvec, lateral_unitvec,
+		Zs, k, c, param(nu, vt), frictionstate(), dCoef);
+}
+
+/*--[3]jacobianvector_calc(ヤコビ行列とベクトルの積, 行列は作らない)----------------*/
+void
+contactforce::jacobianvector(Vec3& Jy, const Vec3& r, const Vec3& v,
+	const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+	const doublereal& Zs, const doublereal& k, const doublereal& c,
+	const doublereal& nu, const doublereal& vt, const Vec3& y, const doublereal& dCoef) const
+{
+	contactlawdefault::jacobianvector(Jy, r, v, normal_vec, axial_unitvec, lateral_unitvec,
+		Zs, k, c, param(nu, vt), frictionstate(), y, dCoef);
+}
+
+/* ------------------------------ contactforce end -----------------------------------------*/
@@ -0,0 +1,36 @@
+#ifndef CONTACTFORCE_H
+#define CONTACTFORCE_H
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Contact Force
+ *  節点1個分の海底面接触力(弾性床反力 + tanh摩擦)と
+ *  そのヤコビ行列 J = -(df/dv + dCoef*df/dr)
+ * ================================================= */
+class contactforce
+{
+public:
+    contactforce(void);
+    ~contactforce(void);
+
+    //force acting on the node
+    virtual void force(Vec3& f, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const doublereal& nu, const doublereal& vt) const;
+    //3x3 Jacobian block of the node (rows: momentum, cols: position)
+    virtual void jacobian(doublereal J[3][3], const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const doublereal& nu, const doublereal& vt, const doublereal& dCoef) const;
+    //Jy = J y without forming J (matrix-free solvers)
+    virtual void jacobianvector(Vec3& Jy, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const doublereal& nu, const doublereal& vt, const Vec3& y, const doublereal& dCoef) const;
+};
+
+#endif // CONTACTFORCE_H
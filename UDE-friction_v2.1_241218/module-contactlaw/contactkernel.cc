@@ -0,0 +1,452 @@
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+#include "contactkernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CONTACTKERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * scalarとSIMDでbit単位の一致を保つため, a*b + cをFMAに縮約させない
+ */
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+/* ------------------------------ contactkernel start ---------------------------------------*/
+
+/*--exp()の定数(Cody-Waite法による範囲縮小 + 12次多項式)----------------------------*/
+static const doublereal KERNEL_LOG2E 	= 1.4426950408889634074;
+static const doublereal KERNEL_LN2HI 	= 6.93145751953125e-1;
+static const doublereal KERNEL_LN2LO 	= 1.42860682030941723212e-6;
+static const doublereal KERNEL_ROUND 	= 6755399441055744.0;	// 1.5*2^52
+static const doublereal KERNEL_BIAS 	= 4503599627370496.0;	// 2^52
+static const doublereal KERNEL_XMAX 	= 700.0;
+static const doublereal KERNEL_EXPC[13] = {
+	1.0,
+	1.0,
+	1.0/2.0,
+	1.0/6.0,
+	1.0/24.0,
+	1.0/120.0,
+	1.0/720.0,
+	1.0/5040.0,
+	1.0/40320.0,
+	1.0/362880.0,
+	1.0/3628800.0,
+	1.0/39916800.0,
+	1.0/479001600.0
+};
+
+/*--[0]scalar--------------------------------------------------------------------------*/
+static inline doublereal
+kernel_exp(doublereal x)
+{
+	x = std::min(std::max(x, -KERNEL_XMAX), KERNEL_XMAX);
+
+	//x = n*ln2 + r
+	doublereal t = x*KERNEL_LOG2E;
+	t = t + KERNEL_ROUND;
+	doublereal n = t - KERNEL_ROUND;
+	doublereal r = x - n*KERNEL_LN2HI;
+	r = r - n*KERNEL_LN2LO;
+
+	doublereal p = KERNEL_EXPC[12];
+	for (int i = 11; i >= 0; i--) {
+		p = p*r;
+		p = p + KERNEL_EXPC[i];
+	}
+
+	//2^n
+	doublereal e = n + 1023.0;
+	e = e + KERNEL_BIAS;
+	uint64_t bits;
+	std::memcpy(&bits, &e, sizeof(bits));
+	bits <<= 52;
+	doublereal scale;
+	std::memcpy(&scale, &bits, sizeof(scale));
+
+	return p*scale;
+}
+
+static inline doublereal
+kernel_tanh(doublereal x, doublereal dcrit)
+{
+	doublereal exp2x = kernel_exp(2.0*x);
+	doublereal func_tanh = (exp2x - 1.0)/(exp2x + 1.0);
+	if (x > dcrit) {
+		func_tanh = 1.0;
+	}
+	if (x < -dcrit) {
+		func_tanh = -1.0;
+	}
+	return func_tanh;
+}
+
+static void
+kernel_force_scalar(const contactbatch& b, std::size_t iBegin,
+	doublereal vt, doublereal dcrit)
+{
+	for (std::size_t i = iBegin; i < b.n; i++) {
+		doublereal z 		= b.rz[i] - b.zs[i];
+		z = z*b.nz[i];
+		doublereal cf 		= (z > 0.0) ? 0.0 : 1.0;
+		doublereal delta 	= std::abs(z);
+
+		//法線方向の速度
+		doublereal vn 		= b.vx[i]*b.nx[i];
+		vn = vn + b.vy[i]*b.ny[i];
+		vn = vn + b.vz[i]*b.nz[i];
+
+		//弾性床からの反力
+		doublereal F 		= b.k[i]*delta;
+		F = F - b.c[i]*vn;
+		F = F*cf;
+
+		//速度のaxial, lateral成分
+		doublereal va 		= b.vx[i]*b.ax[i];
+		va = va + b.vy[i]*b.ay[i];
+		va = va + b.vz[i]*b.az[i];
+		doublereal vl 		= b.vx[i]*b.lx[i];
+		vl = vl + b.vy[i]*b.ly[i];
+		vl = vl + b.vz[i]*b.lz[i];
+
+		//tanhで静摩擦から動摩擦への推移を表現
+		doublereal v2 		= b.vx[i]*b.vx[i];
+		v2 = v2 + b.vy[i]*b.vy[i];
+		v2 = v2 + b.vz[i]*b.vz[i];
+		doublereal x_tanh 	= std::sqrt(v2)/vt;
+		doublereal fa 		= kernel_tanh(x_tanh, dcrit)*b.nu[i];
+		fa = fa*F;
+
+		doublereal ux 		= va*b.ax[i] + vl*b.lx[i];
+		doublereal uy 		= va*b.ay[i] + vl*b.ly[i];
+		doublereal uz 		= va*b.az[i] + vl*b.lz[i];
+
+		b.fx[i] = F*b.nx[i] - fa*ux;
+		b.fy[i] = F*b.ny[i] - fa*uy;
+		b.fz[i] = F*b.nz[i] - fa*uz;
+	}
+}
+
+#ifdef CONTACTKERNEL_X86
+/*--[1]AVX2 (4 nodes)------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static inline __m256d
+kernel_exp_avx2(__m256d x)
+{
+	x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-KERNEL_XMAX)), _mm256_set1_pd(KERNEL_XMAX));
+
+	__m256d t = _mm256_mul_pd(x, _mm256_set1_pd(KERNEL_LOG2E));
+	t = _mm256_add_pd(t, _mm256_set1_pd(KERNEL_ROUND));
+	__m256d n = _mm256_sub_pd(t, _mm256_set1_pd(KERNEL_ROUND));
+	__m256d r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(KERNEL_LN2HI)));
+	r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(KERNEL_LN2LO)));
+
+	__m256d p = _mm256_set1_pd(KERNEL_EXPC[12]);
+	for (int i = 11; i >= 0; i--) {
+		p = _mm256_mul_pd(p, r);
+		p = _mm256_add_pd(p, _mm256_set1_pd(KERNEL_EXPC[i]));
+	}
+
+	__m256d e = _mm256_add_pd(n, _mm256_set1_pd(1023.0));
+	e = _mm256_add_pd(e, _mm256_set1_pd(KERNEL_BIAS));
+	__m256i bits = _mm256_slli_epi64(_mm256_castpd_si256(e), 52);
+
+	return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+}
+
+__attribute__((target("avx2")))
+static std::size_t
+kernel_force_avx2(const contactbatch& b,
+	doublereal vt, doublereal dcrit)
+{
+	const __m256d vvt 		= _mm256_set1_pd(vt);
+	const __m256d vdcrit 	= _mm256_set1_pd(dcrit);
+	const __m256d vmdcrit 	= _mm256_set1_pd(-dcrit);
+	const __m256d vzero 	= _mm256_setzero_pd();
+	const __m256d vone 		= _mm256_set1_pd(1.0);
+	const __m256d vmone 	= _mm256_set1_pd(-1.0);
+	const __m256d vtwo 		= _mm256_set1_pd(2.0);
+	const __m256d vsign 	= _mm256_set1_pd(-0.0);
+
+	std::size_t i = 0;
+	for (; i + 4 <= b.n; i += 4) {
+		__m256d rz 		= _mm256_loadu_pd(b.rz + i);
+		__m256d vx 		= _mm256_loadu_pd(b.vx + i);
+		__m256d vy 		= _mm256_loadu_pd(b.vy + i);
+		__m256d vz 		= _mm256_loadu_pd(b.vz + i);
+		__m256d zs 		= _mm256_loadu_pd(b.zs + i);
+		__m256d nx 		= _mm256_loadu_pd(b.nx + i);
+		__m256d ny 		= _mm256_loadu_pd(b.ny + i);
+		__m256d nz 		= _mm256_loadu_pd(b.nz + i);
+		__m256d vk 		= _mm256_loadu_pd(b.k + i);
+		__m256d vc 		= _mm256_loadu_pd(b.c + i);
+		__m256d vnu 		= _mm256_loadu_pd(b.nu + i);
+		__m256d ax 		= _mm256_loadu_pd(b.ax + i);
+		__m256d ay 		= _mm256_loadu_pd(b.ay + i);
+		__m256d az 		= _mm256_loadu_pd(b.az + i);
+		__m256d lx 		= _mm256_loadu_pd(b.lx + i);
+		__m256d ly 		= _mm256_loadu_pd(b.ly + i);
+		__m256d lz 		= _mm256_loadu_pd(b.lz + i);
+
+		__m256d z 		= _mm256_sub_pd(rz, zs);
+		z = _mm256_mul_pd(z, nz);
+		__m256d cf 		= _mm256_blendv_pd(vone, vzero, _mm256_cmp_pd(z, vzero, _CMP_GT_OQ));
+		__m256d delta 	= _mm256_andnot_pd(vsign, z);
+
+		__m256d vn 		= _mm256_mul_pd(vx, nx);
+		vn = _mm256_add_pd(vn, _mm256_mul_pd(vy, ny));
+		vn = _mm256_add_pd(vn, _mm256_mul_pd(vz, nz));
+
+		__m256d F 		= _mm256_mul_pd(vk, delta);
+		F = _mm256_sub_pd(F, _mm256_mul_pd(vc, vn));
+		F = _mm256_mul_pd(F, cf);
+
+		__m256d va 		= _mm256_mul_pd(vx, ax);
+		va = _mm256_add_pd(va, _mm256_mul_pd(vy, ay));
+		va = _mm256_add_pd(va, _mm256_mul_pd(vz, az));
+		__m256d vl 		= _mm256_mul_pd(vx, lx);
+		vl = _mm256_add_pd(vl, _mm256_mul_pd(vy, ly));
+		vl = _mm256_add_pd(vl, _mm256_mul_pd(vz, lz));
+
+		__m256d v2 		= _mm256_mul_pd(vx, vx);
+		v2 = _mm256_add_pd(v2, _mm256_mul_pd(vy, vy));
+		v2 = _mm256_add_pd(v2, _mm256_mul_pd(vz, vz));
+		__m256d x_tanh 	= _mm256_div_pd(_mm256_sqrt_pd(v2), vvt);
+
+		__m256d exp2x 	= kernel_exp_avx2(_mm256_mul_pd(vtwo, x_tanh));
+		__m256d th 		= _mm256_div_pd(_mm256_sub_pd(exp2x, vone), _mm256_add_pd(exp2x, vone));
+		th = _mm256_blendv_pd(th, vone, _mm256_cmp_pd(x_tanh, vdcrit, _CMP_GT_OQ));
+		th = _mm256_blendv_pd(th, vmone, _mm256_cmp_pd(x_tanh, vmdcrit, _CMP_LT_OQ));
+
+		__m256d fa 		= _mm256_mul_pd(th, vnu);
+		fa = _mm256_mul_pd(fa, F);
+
+		__m256d ux 		= _mm256_add_pd(_mm256_mul_pd(va, ax), _mm256_mul_pd(vl, lx));
+		__m256d uy 		= _mm256_add_pd(_mm256_mul_pd(va, ay), _mm256_mul_pd(vl, ly));
+		__m256d uz 		= _mm256_add_pd(_mm256_mul_pd(va, az), _mm256_mul_pd(vl, lz));
+
+		_mm256_storeu_pd(b.fx + i, _mm256_sub_pd(_mm256_mul_pd(F, nx), _mm256_mul_pd(fa, ux)));
+		_mm256_storeu_pd(b.fy + i, _mm256_sub_pd(_mm256_mul_pd(F, ny), _mm256_mul_pd(fa, uy)));
+		_mm256_storeu_pd(b.fz + i, _mm256_sub_pd(_mm256_mul_pd(F, nz), _mm256_mul_pd(fa, uz)));
+	}
+
+	return i;
+}
+
+/*--[2]AVX-512 (8 nodes)---------------------------------------------------------------*/
+//全レーンのmask. sqrt, min, max, shiftはmaskz形で呼ぶ(mask無しの形はGCCのヘッダで
+//_mm512_undefined_*を使い, -Wmaybe-uninitializedの誤検出が出る)
+static const __mmask8 KERNEL_ALL8 = 0xff;
+
+__attribute__((target("avx512f")))
+static inline __m512d
+kernel_exp_avx512(__m512d x)
+{
+	x = _mm512_maskz_min_pd(KERNEL_ALL8, _mm512_maskz_max_pd(KERNEL_ALL8, x, _mm512_set1_pd(-KERNEL_XMAX)), _mm512_set1_pd(KERNEL_XMAX));
+
+	__m512d t = _mm512_mul_pd(x, _mm512_set1_pd(KERNEL_LOG2E));
+	t = _mm512_add_pd(t, _mm512_set1_pd(KERNEL_ROUND));
+	__m512d n = _mm512_sub_pd(t, _mm512_set1_pd(KERNEL_ROUND));
+	__m512d r = _mm512_sub_pd(x, _mm512_mul_pd(n, _mm512_set1_pd(KERNEL_LN2HI)));
+	r = _mm512_sub_pd(r, _mm512_mul_pd(n, _mm512_set1_pd(KERNEL_LN2LO)));
+
+	__m512d p = _mm512_set1_pd(KERNEL_EXPC[12]);
+	for (int i = 11; i >= 0; i--) {
+		p = _mm512_mul_pd(p, r);
+		p = _mm512_add_pd(p, _mm512_set1_pd(KERNEL_EXPC[i]));
+	}
+
+	__m512d e = _mm512_add_pd(n, _mm512_set1_pd(1023.0));
+	e = _mm512_add_pd(e, _mm512_set1_pd(KERNEL_BIAS));
+	__m512i bits = _mm512_maskz_slli_epi64(KERNEL_ALL8, _mm512_castpd_si512(e), 52);
+
+	return _mm512_mul_pd(p, _mm512_castsi512_pd(bits));
+}
+
+__attribute__((target("avx512f")))
+static std::size_t
+kernel_force_avx512(const contactbatch& b,
+	doublereal vt, doublereal dcrit)
+{
+	const __m512d vvt 		= _mm512_set1_pd(vt);
+	const __m512d vdcrit 	= _mm512_set1_pd(dcrit);
+	const __m512d vmdcrit 	= _mm512_set1_pd(-dcrit);
+	const __m512d vzero 	= _mm512_setzero_pd();
+	const __m512d vone 		= _mm512_set1_pd(1.0);
+	const __m512d vmone 	= _mm512_set1_pd(-1.0);
+	const __m512d vtwo 		= _mm512_set1_pd(2.0);
+	const __m512i vsign 	= _mm512_set1_epi64(0x8000000000000000LL);
+
+	std::size_t i = 0;
+	for (; i + 8 <= b.n; i += 8) {
+		__m512d rz 		= _mm512_loadu_pd(b.rz + i);
+		__m512d vx 		= _mm512_loadu_pd(b.vx + i);
+		__m512d vy 		= _mm512_loadu_pd(b.vy + i);
+		__m512d vz 		= _mm512_loadu_pd(b.vz + i);
+		__m512d zs 		= _mm512_loadu_pd(b.zs + i);
+		__m512d nx 		= _mm512_loadu_pd(b.nx + i);
+		__m512d ny 		= _mm512_loadu_pd(b.ny + i);
+		__m512d nz 		= _mm512_loadu_pd(b.nz + i);
+		__m512d vk 		= _mm512_loadu_pd(b.k + i);
+		__m512d vc 		= _mm512_loadu_pd(b.c + i);
+		__m512d vnu 		= _mm512_loadu_pd(b.nu + i);
+		__m512d ax 		= _mm512_loadu_pd(b.ax + i);
+		__m512d ay 		= _mm512_loadu_pd(b.ay + i);
+		__m512d az 		= _mm512_loadu_pd(b.az + i);
+		__m512d lx 		= _mm512_loadu_pd(b.lx + i);
+		__m512d ly 		= _mm512_loadu_pd(b.ly + i);
+		__m512d lz 		= _mm512_loadu_pd(b.lz + i);
+
+		__m512d z 		= _mm512_sub_pd(rz, zs);
+		z = _mm512_mul_pd(z, nz);
+		__m512d cf 		= _mm512_mask_blend_pd(_mm512_cmp_pd_mask(z, vzero, _CMP_GT_OQ), vone, vzero);
+		__m512d delta 	= _mm512_castsi512_pd(_mm512_maskz_andnot_epi64(KERNEL_ALL8, vsign, _mm512_castpd_si512(z)));
+
+		__m512d vn 		= _mm512_mul_pd(vx, nx);
+		vn = _mm512_add_pd(vn, _mm512_mul_pd(vy, ny));
+		vn = _mm512_add_pd(vn, _mm512_mul_pd(vz, nz));
+
+		__m512d F 		= _mm512_mul_pd(vk, delta);
+		F = _mm512_sub_pd(F, _mm512_mul_pd(vc, vn));
+		F = _mm512_mul_pd(F, cf);
+
+		__m512d va 		= _mm512_mul_pd(vx, ax);
+		va = _mm512_add_pd(va, _mm512_mul_pd(vy, ay));
+		va = _mm512_add_pd(va, _mm512_mul_pd(vz, az));
+		__m512d vl 		= _mm512_mul_pd(vx, lx);
+		vl = _mm512_add_pd(vl, _mm512_mul_pd(vy, ly));
+		vl = _mm512_add_pd(vl, _mm512_mul_pd(vz, lz));
+
+		__m512d v2 		= _mm512_mul_pd(vx, vx);
+		v2 = _mm512_add_pd(v2, _mm512_mul_pd(vy, vy));
+		v2 = _mm512_add_pd(v2, _mm512_mul_pd(vz, vz));
+		__m512d x_tanh 	= _mm512_div_pd(_mm512_maskz_sqrt_pd(KERNEL_ALL8, v2), vvt);
+
+		__m512d exp2x 	= kernel_exp_avx512(_mm512_mul_pd(vtwo, x_tanh));
+		__m512d th 		= _mm512_div_pd(_mm512_sub_pd(exp2x, vone), _mm512_add_pd(exp2x, vone));
+		th = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x_tanh, vdcrit, _CMP_GT_OQ), th, vone);
+		th = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x_tanh, vmdcrit, _CMP_LT_OQ), th, vmone);
+
+		__m512d fa 		= _mm512_mul_pd(th, vnu);
+		fa = _mm512_mul_pd(fa, F);
+
+		__m512d ux 		= _mm512_add_pd(_mm512_mul_pd(va, ax), _mm512_mul_pd(vl, lx));
+		__m512d uy 		= _mm512_add_pd(_mm512_mul_pd(va, ay), _mm512_mul_pd(vl, ly));
+		__m512d uz 		= _mm512_add_pd(_mm512_mul_pd(va, az), _mm512_mul_pd(vl, lz));
+
+		_mm512_storeu_pd(b.fx + i, _mm512_sub_pd(_mm512_mul_pd(F, nx), _mm512_mul_pd(fa, ux)));
+		_mm512_storeu_pd(b.fy + i, _mm512_sub_pd(_mm512_mul_pd(F, ny), _mm512_mul_pd(fa, uy)));
+		_mm512_storeu_pd(b.fz + i, _mm512_sub_pd(_mm512_mul_pd(F, nz), _mm512_mul_pd(fa, uz)));
+	}
+
+	return i;
+}
+#endif // CONTACTKERNEL_X86
+
+/*--[3]dispatch------------------------------------------------------------------------*/
+contactkernel::contactkernel(Isa i)
+{
+	setIsa(i);
+}
+
+contactkernel::~contactkernel(void)
+{
+	NO_OP;
+}
+
+bool
+contactkernel::bSupported(Isa i)
+{
+	switch (i) {
+	case ISA_AUTO:
+	case ISA_SCALAR:
+		return true;
+#ifdef CONTACTKERNEL_X86
+	case ISA_AVX2:
+		return __builtin_cpu_supports("avx2");
+	case ISA_AVX512:
+		return __builtin_cpu_supports("avx512f");
+#endif
+	default:
+		return false;
+	}
+}
+
+const char *
+contactkernel::sIsaName(Isa i)
+{
+	switch (i) {
+	case ISA_AUTO:
+		return "auto";
+	case ISA_SCALAR:
+		return "scalar";
+	case ISA_AVX2:
+		return "avx2";
+	case ISA_AVX512:
+		return "avx512";
+	}
+	return "unknown";
+}
+
+void
+contactkernel::setIsa(Isa i)
+{
+	if (i == ISA_AUTO) {
+		if (bSupported(ISA_AVX512)) {
+			i = ISA_AVX512;
+		} else if (bSupported(ISA_AVX2)) {
+			i = ISA_AVX2;
+		} else {
+			i = ISA_SCALAR;
+		}
+	} else if (!bSupported(i)) {
+		i = ISA_SCALAR;
+	}
+	isa = i;
+}
+
+contactkernel::Isa
+contactkernel::getIsa(void) const
+{
+	return isa;
+}
+
+void
+contactkernel::force(const contactbatch& b, const doublereal& vt, const doublereal& dcrit) const
+{
+	std::size_t iDone = 0;
+
+#ifdef CONTACTKERNEL_X86
+	switch (isa) {
+	case ISA_AVX512:
+		iDone = kernel_force_avx512(b, vt, dcrit);
+		break;
+	case ISA_AVX2:
+		iDone = kernel_force_avx2(b, vt, dcrit);
+		break;
+	default:
+		break;
+	}
+#endif
+
+	//残りの節点(またはscalar指定時は全節点)
+	kernel_force_scalar(b, iDone, vt, dcrit);
+}
+
+/* ------------------------------ contactkernel end -----------------------------------------*/
@@ -0,0 +1,64 @@
+#ifndef CONTACTKERNEL_H
+#define CONTACTKERNEL_H
+
+#include <cstddef>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * struct Contact Batch
+ *  バッチ計算用の節点データ(structure of arrays)
+ *  海底面の高さzs, 法線n, 土質定数(k, c, nu), frame(axial, lateral)は節点ごと
+ * ================================================= */
+struct contactbatch
+{
+    std::size_t n;
+    //input
+    const doublereal *rz;
+    const doublereal *vx, *vy, *vz;
+    const doublereal *zs;
+    const doublereal *nx, *ny, *nz;
+    const doublereal *k, *c, *nu;
+    const doublereal *ax, *ay, *az;
+    const doublereal *lx, *ly, *lz;
+    //output
+    doublereal *fx, *fy, *fz;
+};
+
+/* =================================================
+ * class Contact Kernel
+ *  弾性床反力とtanh摩擦力を4/8節点ずつまとめて計算する.
+ *  (隙間 z = (rz - zs)*nz, 法線方向の速度 v.n はcontactlawdefaultと同じ)
+ *  AVX2/AVX-512は実行時に選択し, 使えない場合はscalarで計算する.
+ *  scalarは同じ演算順序で計算するので, どの命令セットでも結果はbit単位で一致する.
+ * ================================================= */
+class contactkernel
+{
+public:
+    enum Isa {
+        ISA_AUTO,
+        ISA_SCALAR,
+        ISA_AVX2,
+        ISA_AVX512
+    };
+
+private:
+    Isa isa;
+
+public:
+    contactkernel(Isa i = ISA_AUTO);
+    ~contactkernel(void);
+
+    //select instruction set (ISA_AUTO: best one supported by the CPU)
+    void setIsa(Isa i);
+    Isa getIsa(void) const;
+    static bool bSupported(Isa i);
+    static const char *sIsaName(Isa i);
+
+    //friction and normal forces of all nodes in the batch
+    void force(const contactbatch& b, const doublereal& vt, const doublereal& dcrit) const;
+};
+
+#endif // CONTACTKERNEL_H
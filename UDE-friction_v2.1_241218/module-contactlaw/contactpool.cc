@@ -0,0 +1,138 @@
+#include "mbconfig.h"
+
+#include "contactpool.h"
+
+/* ------------------------------ contactpool start ---------------------------------------*/
+contactpool::contactpool(void)
+: iThreads(1), iChunk(256), task(0), pCtx(0), n(0),
+iGeneration(0), iBusy(0), bStop(false)
+{
+	NO_OP;
+}
+
+contactpool::~contactpool(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		bStop = true;
+	}
+	cvStart.notify_all();
+	for (std::size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+}
+
+/*--[0]setValue(スレッドを作る)------------------------------------------------------*/
+void
+contactpool::setValue(unsigned iThreads, std::size_t iChunk)
+{
+	this->iThreads = (iThreads > 0) ? iThreads : 1;
+	this->iChunk = (iChunk > 0) ? iChunk : 1;
+	std::vector<queue>(this->iThreads).swap(queues);
+
+	//呼び出したスレッドが0番
+	for (unsigned t = 1; t < this->iThreads; t++) {
+		workers.push_back(std::thread(&contactpool::loop, this, t));
+	}
+}
+
+/*--[1]chunkの取り出し----------------------------------------------------------------*/
+bool
+contactpool::pop(unsigned iSelf, std::size_t& iChunkIndex)
+{
+	//自分の範囲は前から
+	std::atomic<unsigned long long>& own = queues[iSelf].range;
+	unsigned long long r = own.load(std::memory_order_relaxed);
+	while ((r >> 32) < (r & 0xffffffffULL)) {
+		if (own.compare_exchange_weak(r, r + (1ULL << 32), std::memory_order_acq_rel)) {
+			iChunkIndex = std::size_t(r >> 32);
+			return true;
+		}
+	}
+
+	//他のスレッドの範囲は後ろから(持ち主と取り合う位置を離す)
+	for (unsigned i = 1; i < iThreads; i++) {
+		std::atomic<unsigned long long>& victim = queues[(iSelf + i) % iThreads].range;
+		r = victim.load(std::memory_order_relaxed);
+		while ((r >> 32) < (r & 0xffffffffULL)) {
+			if (victim.compare_exchange_weak(r, r - 1, std::memory_order_acq_rel)) {
+				iChunkIndex = std::size_t(r & 0xffffffffULL) - 1;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void
+contactpool::work(unsigned iSelf)
+{
+	std::size_t iChunkIndex;
+	while (pop(iSelf, iChunkIndex)) {
+		const std::size_t iBegin = iChunkIndex*iChunk;
+		const std::size_t iEnd = (iBegin + iChunk < n) ? iBegin + iChunk : n;
+		task(pCtx, iBegin, iEnd);
+	}
+}
+
+void
+contactpool::loop(unsigned iSelf)
+{
+	unsigned long iSeen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			cvStart.wait(lock, [&]{ return bStop || iGeneration != iSeen; });
+			if (bStop) {
+				return;
+			}
+			iSeen = iGeneration;
+		}
+
+		work(iSelf);
+
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			iBusy--;
+		}
+		cvDone.notify_one();
+	}
+}
+
+/*--[2]run---------------------------------------------------------------------------*/
+void
+contactpool::run(std::size_t n, Task task, void *pCtx)
+{
+	const std::size_t iNumChunks = (n + iChunk - 1)/iChunk;
+	if (workers.empty() || iNumChunks <= 1) {
+		for (std::size_t iBegin = 0; iBegin < n; iBegin += iChunk) {
+			task(pCtx, iBegin, (iBegin + iChunk < n) ? iBegin + iChunk : n);
+		}
+		return;
+	}
+
+	//chunkを連続した範囲に分けて各スレッドに配る
+	this->task = task;
+	this->pCtx = pCtx;
+	this->n = n;
+	for (unsigned t = 0; t < iThreads; t++) {
+		const unsigned long long iFront = (iNumChunks*t)/iThreads;
+		const unsigned long long iBack = (iNumChunks*(t + 1))/iThreads;
+		queues[t].range.store((iFront << 32) | iBack, std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		iBusy = unsigned(workers.size());
+		iGeneration++;
+	}
+	cvStart.notify_all();
+
+	work(0);
+
+	//全てのスレッドがこのjobを抜けるまで待つ(次のjobの範囲を書き換えないため)
+	std::unique_lock<std::mutex> lock(mtx);
+	cvDone.wait(lock, [&]{ return iBusy == 0; });
+}
+
+/* ------------------------------ contactpool end -----------------------------------------*/
@@ -0,0 +1,85 @@
+#ifndef CONTACTPOOL_H
+#define CONTACTPOOL_H
+
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Contact Pool
+ *  要素内の節点をchunk(キャッシュに収まる節点数)に分け, スレッドで分担して計算する.
+ *  各スレッドは連続したchunkの範囲を持ち, 自分の範囲は前から取り,
+ *  空になったら他のスレッドの範囲を後ろから取る(work stealing).
+ *  着底点が移動して接触する節点が偏っても, 空いたスレッドが残りを引き受ける.
+ *
+ *  taskは節点ごとの領域にだけ書く. 合計(接触の切り替わりなど)はrunの後に
+ *  節点の順に1スレッドで求めるので, 結果はスレッド数とchunkの割り当てによらない.
+ *  taskは例外を投げてはならない.
+ *
+ *  usage
+ *    pcp.setValue(iThreads, iChunk);
+ *    pcp.run(n, task, pCtx);   (task(pCtx, iBegin, iEnd)を[0, n)のchunkごとに呼ぶ)
+ * ================================================= */
+class contactpool
+{
+public:
+    typedef void (*Task)(void *pCtx, std::size_t iBegin, std::size_t iEnd);
+
+private:
+    //range of chunks of a thread, front (upper 32 bits) and back (lower 32 bits)
+    struct queue
+    {
+        std::atomic<unsigned long long> range;
+        //one cache line per queue
+        char pad[64 - sizeof(std::atomic<unsigned long long>)];
+
+        queue(void) : range(0) {};
+    };
+
+    unsigned iThreads;
+    std::size_t iChunk;
+    std::vector<queue> queues;
+    std::vector<std::thread> workers;
+
+    //current job
+    Task task;
+    void *pCtx;
+    std::size_t n;
+
+    //start and end of a job
+    std::mutex mtx;
+    std::condition_variable cvStart;
+    std::condition_variable cvDone;
+    unsigned long iGeneration;
+    unsigned iBusy;
+    bool bStop;
+
+    //take a chunk from the own range (front) or steal one (back)
+    bool pop(unsigned iSelf, std::size_t& iChunkIndex);
+    //process chunks until all ranges are empty
+    void work(unsigned iSelf);
+    //worker thread
+    void loop(unsigned iSelf);
+
+public:
+    contactpool(void);
+    ~contactpool(void);
+
+    //iThreads: threads including the caller (1: no worker thread), iChunk: nodes per chunk
+    //(called once, before the first run)
+    virtual void setValue(unsigned iThreads, std::size_t iChunk);
+    unsigned getThreads(void) const { return iThreads; };
+    std::size_t getChunk(void) const { return iChunk; };
+
+    //call task for all chunks of [0, n) and wait for them
+    void run(std::size_t n, Task task, void *pCtx);
+};
+
+#endif // CONTACTPOOL_H
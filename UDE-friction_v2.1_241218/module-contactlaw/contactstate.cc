@@ -0,0 +1,128 @@
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+
+#include "contactstate.h"
+
+/* ------------------------------ contactstate start ---------------------------------------*/
+contactstate::contactstate(void)
+: iFlips(0), iFlipsLastStep(0), iPredicted(0), iPredictedLastStep(0), iFlipsTotal(0)
+{
+	NO_OP;
+}
+
+contactstate::~contactstate(void)
+{
+	NO_OP;
+}
+
+void
+contactstate::setValue(std::size_t n)
+{
+	contactnodestate s;
+	s.bContact 			= false;
+	s.dPenetration 		= 0.0;
+	s.normal_vec 		= Vec3(0.0, 0.0, 1.0);
+	s.axial_unitvec 	= Vec3(0.0, 0.0, 0.0);
+	s.lateral_unitvec 	= Vec3(0.0, 0.0, 0.0);
+	s.bFrame 			= false;
+	s.slip_unitvec 		= Vec3(0.0, 0.0, 0.0);
+
+	committed.assign(n, s);
+	current.assign(n, s);
+}
+
+/*--[1]predict(次ステップの接触状態の予測)------------------------------------------*/
+void
+contactstate::predict(std::size_t i, const doublereal& z)
+{
+	contactnodestate& s = current[i];
+	s = committed[i];
+	s.bContact 		= (z <= 0.0);
+	s.dPenetration 	= (z <= 0.0) ? -z : 0.0;
+	if (s.bContact != committed[i].bContact) {
+		iPredicted++;
+	}
+}
+
+/*--[2]update(反復中の接触状態の更新)------------------------------------------------*/
+bool
+contactstate::update(std::size_t i, const doublereal& z)
+{
+	contactnodestate& s = current[i];
+	bool bContact 	= (z <= 0.0);
+	s.dPenetration 	= bContact ? -z : 0.0;
+	if (bContact == s.bContact) {
+		return false;
+	}
+
+	//状態が切り替わったら座標系を作り直す
+	s.bContact 		= bContact;
+	s.bFrame 		= false;
+	iFlips++;
+	return true;
+}
+
+bool
+contactstate::bFrame(std::size_t i) const
+{
+	return current[i].bFrame;
+}
+
+void
+contactstate::setFrame(std::size_t i,
+	const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec)
+{
+	current[i].normal_vec 		= normal_vec;
+	current[i].axial_unitvec 	= axial_unitvec;
+	current[i].lateral_unitvec 	= lateral_unitvec;
+	current[i].bFrame 			= true;
+}
+
+void
+contactstate::invalidateFrame(void)
+{
+	for (std::size_t i = 0; i < current.size(); i++) {
+		current[i].bFrame = false;
+	}
+}
+
+void
+contactstate::setSlip(std::size_t i, const Vec3& v)
+{
+	contactnodestate& s = current[i];
+	//接線方向の速度成分の単位ベクトル
+	Vec3 vt = s.axial_unitvec*v.Dot(s.axial_unitvec) + s.lateral_unitvec*v.Dot(s.lateral_unitvec);
+	doublereal dvt = vt.Norm();
+	if (dvt > std::numeric_limits<doublereal>::epsilon()) {
+		s.slip_unitvec = vt/dvt;
+	}
+}
+
+void
+contactstate::setFriction(std::size_t i, const frictionstate& fs)
+{
+	current[i].friction = fs;
+}
+
+/*--[3]commit(収束時の状態の確定)-----------------------------------------------------*/
+void
+contactstate::commit(void)
+{
+	committed = current;
+
+	iFlipsTotal 		+= iFlips;
+	iFlipsLastStep 		= iFlips;
+	iPredictedLastStep 	= iPredicted;
+	iFlips 				= 0;
+	iPredicted 			= 0;
+}
+
+/* ------------------------------ contactstate end -----------------------------------------*/
@@ -0,0 +1,84 @@
+#ifndef CONTACTSTATE_H
+#define CONTACTSTATE_H
+
+#include <vector>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+#include "contactpolicy.h"
+
+/* =================================================
+ * struct Contact Node State
+ *  節点ごとの接触状態
+ * ================================================= */
+struct contactnodestate
+{
+    //in contact with the seabed
+    bool bContact;
+    //penetration depth (>= 0)
+    doublereal dPenetration;
+    //local frame
+    Vec3 normal_vec;
+    Vec3 axial_unitvec;
+    Vec3 lateral_unitvec;
+    bool bFrame;
+    //slip direction (unit vector opposite to friction)
+    Vec3 slip_unitvec;
+    //stick/slip state and anchor of the friction
+    frictionstate friction;
+};
+
+/* =================================================
+ * class Contact State
+ *  接触状態をNewton反復間で保持する.
+ *  収束時(AfterConvergence)に確定した状態から次ステップの接触状態を予測し(AfterPredict),
+ *  反復中は状態が切り替わった節点だけ座標系を作り直す.
+ * ================================================= */
+class contactstate
+{
+private:
+    //last converged state
+    std::vector<contactnodestate> committed;
+    //state of the current iteration
+    std::vector<contactnodestate> current;
+
+    //contact flips during the current step (between iterations)
+    unsigned int iFlips;
+    //contact flips during the last converged step
+    unsigned int iFlipsLastStep;
+    //predicted flips of the current step (committed -> predicted)
+    unsigned int iPredicted;
+    unsigned int iPredictedLastStep;
+    //total flips
+    unsigned long iFlipsTotal;
+public:
+    contactstate(void);
+    ~contactstate(void);
+
+    virtual void setValue(std::size_t n);
+
+    //predict contact of node i for the next step
+    virtual void predict(std::size_t i, const doublereal& z);
+    //set contact of node i at the current iteration; returns true if it flipped
+    virtual bool update(std::size_t i, const doublereal& z);
+    //frame cache
+    virtual bool bFrame(std::size_t i) const;
+    virtual void setFrame(std::size_t i,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec);
+    virtual void invalidateFrame(void);
+    //slip direction at the current iteration
+    virtual void setSlip(std::size_t i, const Vec3& v);
+    //friction state at the converged solution (committed with the contact state)
+    virtual void setFriction(std::size_t i, const frictionstate& fs);
+    //commit the current state (after convergence)
+    virtual void commit(void);
+
+    const contactnodestate& get(std::size_t i) const { return current[i]; };
+    const contactnodestate& getCommitted(std::size_t i) const { return committed[i]; };
+    unsigned int iGetFlips(void) const { return iFlipsLastStep; };
+    unsigned int iGetPredicted(void) const { return iPredictedLastStep; };
+    unsigned long iGetFlipsTotal(void) const { return iFlipsTotal; };
+};
+
+#endif // CONTACTSTATE_H
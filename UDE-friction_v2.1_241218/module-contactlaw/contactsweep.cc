@@ -0,0 +1,255 @@
+#include "mbconfig.h"
+
+#include <cstring>
+#include <cfloat>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+#include "except.h"
+#include "contactsweep.h"
+
+//step hint when no node exceeds the penetration limit (ratio to the last step)
+static const doublereal SWEEP_GROWTH = 2.0;
+
+/* ------------------------------ contactsweep start ---------------------------------------*/
+static const struct {
+	unsigned int index;
+	const char *name;
+} contactsweep_data[] = {
+	{ 1, "impact_fraction" },
+	{ 2, "impact_velocity" },
+	{ 3, "step_hint" },
+	{ 4, "tunnelled_total" },
+	{ 5, "predicted_penetration" },
+	{ 6, "predicted_clamped_total" },
+};
+
+contactsweep::contactsweep(void)
+: bEnabled(false), dMaxPen(std::numeric_limits<doublereal>::max()), iSamples(1),
+dImpact(1.0), dImpactVelocity(0.0), dHint(0.0), iTunnelledTotal(0),
+dPredicted(0.0), iClampedTotal(0)
+{
+	NO_OP;
+}
+
+contactsweep::~contactsweep(void)
+{
+	NO_OP;
+}
+
+/*--[0]setValue-------------------------------------------------------------------------*/
+void
+contactsweep::setValue(std::size_t n, bool bEnable,
+	const doublereal& maxpen, unsigned samples)
+{
+	//最初の収束までは軌跡がない
+	nodestate s;
+	s.r = s.v = Vec3(0.0, 0.0, 0.0);
+	s.gap = 0.0;
+	s.bValid = false;
+	nodes.assign(n, s);
+	bEnabled = bEnable;
+	dMaxPen = maxpen;
+	iSamples = (samples < 1) ? 1 : samples;
+}
+
+/*--[1]path(3次Hermite曲線)---------------------------------------------------------------*/
+void
+contactsweep::path(std::size_t i, const doublereal& tau, const Vec3& r1, const Vec3& v1,
+	const doublereal& dt, Vec3& r, Vec3& v) const
+{
+	const nodestate& s = nodes[i];
+	const doublereal t2 = tau*tau;
+	const doublereal t3 = t2*tau;
+	const doublereal h00 = 2.0*t3 - 3.0*t2 + 1.0;
+	const doublereal h10 = t3 - 2.0*t2 + tau;
+	const doublereal h01 = -2.0*t3 + 3.0*t2;
+	const doublereal h11 = t3 - t2;
+	r = s.r*h00 + s.v*(h10*dt) + r1*h01 + v1*(h11*dt);
+
+	//dr/dt = (dr/dtau)/dt
+	const doublereal d00 = 6.0*t2 - 6.0*tau;
+	const doublereal d10 = 3.0*t2 - 4.0*tau + 1.0;
+	const doublereal d11 = 3.0*t2 - 2.0*tau;
+	v = (s.r - r1)*(d00/dt) + s.v*d10 + v1*d11;
+}
+
+/*--[2]衝突時刻(前回浮いていた節点だけ)------------------------------------------------------*/
+bool
+contactsweep::find(std::size_t i, const Vec3& r1, const Vec3& v1, const doublereal& gap1,
+	const doublereal& dt, Surface surface, const void *pCtx,
+	doublereal& tau, doublereal& vn) const
+{
+	if (!bSweep(i) || !(dt > 0.0)) {
+		return false;
+	}
+
+	/*
+	 * 軌跡上の点の隙間 g(tau) を等間隔に調べ, 最初に g <= 0 となる区間を
+	 * 二分法で詰める. 終点の隙間が正でも途中で負になれば海底面を通り抜けている.
+	 */
+	doublereal tau0 = 0.0, tau1 = -1.0;
+	Vec3 rt, vt;
+	doublereal Zs;
+	Vec3 normal_vec;
+	for (unsigned k = 1; k <= iSamples; k++) {
+		const doublereal t = doublereal(k)/iSamples;
+		doublereal g = gap1;
+		if (k < iSamples) {
+			path(i, t, r1, v1, dt, rt, vt);
+			surface(pCtx, i, rt, Zs, normal_vec);
+			g = (rt.dGet(3) - Zs)*normal_vec.dGet(3);
+		}
+		if (g <= 0.0) {
+			tau1 = t;
+			break;
+		}
+		tau0 = t;
+	}
+	if (tau1 < 0.0) {
+		return false;
+	}
+
+	//衝突時刻の分解能は区間の1/2^16
+	for (int iter = 0; iter < 16; iter++) {
+		const doublereal t = 0.5*(tau0 + tau1);
+		path(i, t, r1, v1, dt, rt, vt);
+		surface(pCtx, i, rt, Zs, normal_vec);
+		if ((rt.dGet(3) - Zs)*normal_vec.dGet(3) <= 0.0) {
+			tau1 = t;
+		} else {
+			tau0 = t;
+		}
+	}
+
+	//衝突点での法線方向の接近速度
+	path(i, tau1, r1, v1, dt, rt, vt);
+	surface(pCtx, i, rt, Zs, normal_vec);
+	tau = tau1;
+	vn = -vt.Dot(normal_vec);
+	return true;
+}
+
+/*--[3]予測解の貫入の見積もり---------------------------------------------------------------*/
+void
+contactsweep::beginPredict(void)
+{
+	dPredicted = 0.0;
+}
+
+doublereal
+contactsweep::estimate(std::size_t i, const Vec3& r1, const Vec3& v1, const doublereal& gap1,
+	const doublereal& dt, Surface surface, const void *pCtx)
+{
+	doublereal tau, vn;
+	if (!find(i, r1, v1, gap1, dt, surface, pCtx, tau, vn)) {
+		return gap1;
+	}
+
+	//衝突後も同じ接近速度で進んだときの貫入まで(通り抜けた予測解は貫入0の接触)
+	const doublereal dPen = std::max(vn, 0.0)*(1.0 - tau)*dt;
+	const doublereal gap = std::max(std::min(gap1, 0.0), -dPen);
+	dPredicted = std::max(dPredicted, -gap);
+	return gap;
+}
+
+doublereal
+contactsweep::predict(std::size_t i, const Vec3& r1, const Vec3& v1, const doublereal& gap1,
+	const doublereal& dt, Surface surface, const void *pCtx)
+{
+	//見積もりを呼び出し側が使うときだけ置き換えた数に数える
+	const doublereal gap = estimate(i, r1, v1, gap1, dt, surface, pCtx);
+	if (gap != gap1) {
+		iClampedTotal++;
+	}
+	return gap;
+}
+
+/*--[4]衝突時刻と時間刻みの目安------------------------------------------------------------*/
+void
+contactsweep::begin(const doublereal& dt)
+{
+	dImpact = 1.0;
+	dImpactVelocity = 0.0;
+	dHint = SWEEP_GROWTH*dt;
+}
+
+void
+contactsweep::impact(const doublereal& tau, const doublereal& vn, const doublereal& gap1,
+	const doublereal& dt)
+{
+	if (tau < dImpact) {
+		dImpact = tau;
+		dImpactVelocity = vn;
+	}
+
+	//通り抜けた節点は衝突時刻まで, 奥まで入った節点は
+	//衝突後の接近速度が一定として貫入が上限に達する時刻まで
+	doublereal dFraction;
+	if (gap1 > 0.0) {
+		iTunnelledTotal++;
+		dFraction = tau;
+	} else if (-gap1 > dMaxPen) {
+		dFraction = tau + (1.0 - tau)*dMaxPen/(-gap1);
+	} else {
+		return;
+	}
+
+	//衝突時刻が0に近くても時間刻みを0にはしない
+	const doublereal dMin = std::numeric_limits<doublereal>::epsilon();
+	dFraction = (dFraction > dMin) ? dFraction : dMin;
+	if (dFraction*dt < dHint) {
+		dHint = dFraction*dt;
+	}
+}
+
+void
+contactsweep::commit(std::size_t i, const Vec3& r, const Vec3& v, const doublereal& gap)
+{
+	nodestate& s = nodes[i];
+	s.r = r;
+	s.v = v;
+	s.gap = gap;
+	s.bValid = true;
+}
+
+/*--[5]private data-------------------------------------------------------------------*/
+unsigned int
+contactsweep::iGetNumPrivData(void)
+{
+	return sizeof(contactsweep_data)/sizeof(contactsweep_data[0]);
+}
+
+unsigned int
+contactsweep::iGetPrivDataIdx(const char *s)
+{
+	for (unsigned int i = 0; i < iGetNumPrivData(); i++) {
+		if (std::strcmp(contactsweep_data[i].name, s) == 0) {
+			return contactsweep_data[i].index;
+		}
+	}
+	return 0;
+}
+
+doublereal
+contactsweep::dGetPrivData(unsigned int i) const
+{
+	switch (i) {
+	case 1:
+		return dImpact;
+	case 2:
+		return dImpactVelocity;
+	case 3:
+		return dHint;
+	case 4:
+		return doublereal(iTunnelledTotal);
+	case 5:
+		return dPredicted;
+	case 6:
+		return doublereal(iClampedTotal);
+	}
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+}
+
+/* ------------------------------ contactsweep end -----------------------------------------*/
@@ -0,0 +1,121 @@
+#ifndef CONTACTSWEEP_H
+#define CONTACTSWEEP_H
+
+#include <cstddef>
+#include <vector>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Contact Sweep
+ *  1ステップの間の節点の軌跡で海底面との衝突を調べる(continuous collision detection).
+ *  現在の反復の位置だけでは, 大きな時間刻みで速く落ちる節点が海底面の奥まで
+ *  入り込んだり, 起伏を通り抜けたりしても分からない.
+ *
+ *  前回の収束解(r0, v0)と今回の収束解(r1, v1)を結ぶ3次Hermite曲線
+ *    r(tau) = h00 r0 + h10 dt v0 + h01 r1 + h11 dt v1  (0 <= tau <= 1)
+ *  を軌跡とし, 前回浮いていた節点について隙間が最初に0になる時刻(衝突時刻)を求める.
+ *
+ *  衝突後も同じ接近速度で進んだとして, 貫入が上限に達する時刻までを
+ *  次のステップの時間刻みの目安(step_hint)とする. 軌跡が海底面を通り抜けた節点は
+ *  衝突時刻までを目安とする. 目安は要素のprivate dataとして
+ *  時間刻みのdrive (strategy: change) から読み出す.
+ *  上限を超えない場合の目安は時間刻みのSWEEP_GROWTH倍.
+ *
+ *  予測(AfterPredict)でも前回の収束解から予測解までの軌跡を調べる.
+ *  衝突があれば, 衝突後も同じ接近速度で進んだときの貫入 vn*(1 - tau)*dt を
+ *  予測解の貫入の見積もりとする(通り抜けた予測解は接触, より深い予測解は
+ *  この深さに抑える). 予測解の位置は変えない(積分公式との整合を保つ).
+ *  見積もりで予測解の隙間を置き換える要素はpredict, 報告だけの要素はestimateを使う
+ *  (estimateはpredicted_clamped_totalを数えない).
+ *
+ *  private data
+ *    1 impact_fraction  最後のステップの最初の衝突時刻(ステップに対する比, 衝突なしは1)
+ *    2 impact_velocity  その衝突時の法線方向の接近速度
+ *    3 step_hint        次のステップの時間刻みの目安
+ *    4 tunnelled_total  海底面を通り抜けた節点の数の累計
+ *    5 predicted_penetration  最後の予測での貫入の見積もりの最大値
+ *    6 predicted_clamped_total 見積もりで置き換えた予測解の数の累計(predictだけが数える)
+ * ================================================= */
+class contactsweep
+{
+public:
+    //seabed height and unit normal below the point r of node i
+    typedef void (*Surface)(const void *pCtx, std::size_t i, const Vec3& r,
+        doublereal& zs, Vec3& normal_vec);
+
+private:
+    //converged state of each node at the beginning of the step
+    struct nodestate
+    {
+        Vec3 r, v;
+        doublereal gap;
+        bool bValid;
+    };
+    std::vector<nodestate> nodes;
+    bool bEnabled;
+    //penetration allowed at the end of a step
+    doublereal dMaxPen;
+    //samples of the path before the root is refined
+    unsigned iSamples;
+
+    //last step
+    doublereal dImpact;
+    doublereal dImpactVelocity;
+    doublereal dHint;
+    unsigned long iTunnelledTotal;
+    //last prediction
+    doublereal dPredicted;
+    unsigned long iClampedTotal;
+
+public:
+    contactsweep(void);
+    ~contactsweep(void);
+
+    virtual void setValue(std::size_t n, bool bEnable,
+        const doublereal& maxpen, unsigned samples);
+    bool bGetEnabled(void) const { return bEnabled; };
+    unsigned iGetNumSamples(void) const { return iSamples; };
+
+    //node i has a converged state to sweep from, and was above the seabed
+    bool bSweep(std::size_t i) const { return nodes[i].bValid && nodes[i].gap > 0.0; };
+    const doublereal& dGetGap(std::size_t i) const { return nodes[i].gap; };
+    //point and velocity of the path of node i at tau (r1, v1: end of the step)
+    void path(std::size_t i, const doublereal& tau, const Vec3& r1, const Vec3& v1,
+        const doublereal& dt, Vec3& r, Vec3& v) const;
+
+    //first impact of node i on its path to (r1, v1) (gap1 at the end of the step):
+    //fraction tau of the step and normal approach velocity vn, false if none
+    bool find(std::size_t i, const Vec3& r1, const Vec3& v1, const doublereal& gap1,
+        const doublereal& dt, Surface surface, const void *pCtx,
+        doublereal& tau, doublereal& vn) const;
+
+    //begin the check of a predicted state
+    void beginPredict(void);
+    //impact-consistent gap of the predicted state (r1, v1, gap1) of node i
+    //(gap1 itself when the path does not touch the seabed); the caller uses it in
+    //place of gap1, counted in predicted_clamped_total when it differs
+    doublereal predict(std::size_t i, const Vec3& r1, const Vec3& v1, const doublereal& gap1,
+        const doublereal& dt, Surface surface, const void *pCtx);
+    //same, reported in predicted_penetration only (the predicted state is kept as it is)
+    doublereal estimate(std::size_t i, const Vec3& r1, const Vec3& v1, const doublereal& gap1,
+        const doublereal& dt, Surface surface, const void *pCtx);
+
+    //begin a step of length dt (after convergence)
+    void begin(const doublereal& dt);
+    //node impacted at tau with normal approach velocity vn, gap1 at the end of the step
+    //(gap1 > 0: the path went through the seabed)
+    void impact(const doublereal& tau, const doublereal& vn, const doublereal& gap1,
+        const doublereal& dt);
+    //converged state of node i for the next step
+    void commit(std::size_t i, const Vec3& r, const Vec3& v, const doublereal& gap);
+
+    //private data (index 1 ... iGetNumPrivData(), 0 if the name is unknown)
+    static unsigned int iGetNumPrivData(void);
+    static unsigned int iGetPrivDataIdx(const char *s);
+    doublereal dGetPrivData(unsigned int i) const;
+};
+
+#endif // CONTACTSWEEP_H
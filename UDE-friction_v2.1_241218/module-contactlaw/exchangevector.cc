@@ -11,6 +11,7 @@
 
 
 #include "exchangevector.h"
+#include "contactpolicy.h"
 
 
 
@@ -27,7 +28,7 @@ exchangevector::~exchangevector(void)
 
 /*--[0A-1]inner_calc(内積計算)-----------------------------------------------------*/
 doublereal
-exchangevector::inner(Vec3 a, Vec3 b) const
+exchangevector::inner(const Vec3& a, const Vec3& b) const
 {
     doublereal ax 	= a.dGet(1);
 	doublereal ay 	= a.dGet(2);
@@ -48,7 +49,7 @@ exchangevector::inner(Vec3 a, Vec3 b) const
 
 /*--[0B-2]cross_calc(外積計算)----------------------------------------------------*/
 Vec3
-exchangevector::cross(Vec3 a, Vec3 b) const
+exchangevector::cross(const Vec3& a, const Vec3& b) const
 {
     doublereal ax 	= a.dGet(1);
 	doublereal ay 	= a.dGet(2);
@@ -72,9 +73,9 @@ exchangevector::cross(Vec3 a, Vec3 b) const
 
 /*--[0B-2]orthographic_projection_vec_calc(正射影ベクトル計算)--------------------*/
 Vec3
-exchangevector::op_vec(Vec3 r, Vec3 x) const
+exchangevector::op_vec(const Vec3& r, const Vec3& x) const
 {
-	doublereal op_coef 	= (inner(r, x)/(x.Norm()*x.Norm()));
+	doublereal op_coef 	= inner(r, x)/x.Dot();
 	Vec3 	op_vec		= Vec3(
 						op_coef*x.dGet(1),
 						op_coef*x.dGet(2),
@@ -102,8 +103,10 @@ exchangevector::internode_vec(Vec3& internode_unitvec, const Vec3& r1, const Vec
 void
 exchangevector::lateral_vec(Vec3& lateral_unitvec, Vec3& normal_vec, Vec3& internode_unitvec, const Vec3& r1, const Vec3& r2) const
 {
-	Vec3 lateral_vec 	= cross(normal_vec, internode_unitvec);
-	lateral_unitvec 	= lateral_vec/lateral_vec.Norm();
+	//法線と節点間方向が平行なときは代わりの向き(contactpolicy.h, segmentframe)
+	framecache cache;
+	Vec3 axial_unitvec;
+	segmentframe::build(normal_vec, internode_unitvec, cache, axial_unitvec, lateral_unitvec);
 }
 
 /*--[1D]axial_vec_calc(係留軸方向ベクトル計算)------------------------------------*/
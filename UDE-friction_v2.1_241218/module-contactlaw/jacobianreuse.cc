@@ -0,0 +1,71 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+#include "jacobianreuse.h"
+
+/* ------------------------------ jacobianreuse start ---------------------------------------*/
+jacobianreuse::jacobianreuse(void)
+: dTol(0.0), bValid(false)
+{
+	NO_OP;
+}
+
+jacobianreuse::~jacobianreuse(void)
+{
+	NO_OP;
+}
+
+void
+jacobianreuse::setValue(const doublereal& tol)
+{
+	dTol = tol;
+	bValid = false;
+}
+
+/*--[1]begin(記録の開始)------------------------------------------------------------*/
+void
+jacobianreuse::begin(void)
+{
+	iRows.clear();
+	iCols.clear();
+	d.clear();
+}
+
+/*--[2]end(基準との比較)--------------------------------------------------------------*/
+bool
+jacobianreuse::end(void)
+{
+	bool bUnchanged = bValid
+		&& iRows == iRowsPrev
+		&& iCols == iColsPrev;
+	if (bUnchanged) {
+		doublereal dMax = 0.0;
+		doublereal dErr = 0.0;
+		for (std::size_t i = 0; i < d.size(); i++) {
+			dMax = std::max(dMax, std::abs(dPrev[i]));
+			dErr = std::max(dErr, std::abs(d[i] - dPrev[i]));
+		}
+		bUnchanged = (dErr <= dTol*dMax);
+	}
+
+	//同じなら基準はそのまま(差を積み重ねない), 変わったら今回を基準にする
+	//記録の領域は入れ替えて使い回す
+	if (!bUnchanged) {
+		iRowsPrev.swap(iRows);
+		iColsPrev.swap(iCols);
+		dPrev.swap(d);
+		bValid = true;
+	}
+	return bUnchanged;
+}
+
+void
+jacobianreuse::invalidate(void)
+{
+	bValid = false;
+}
+
+/* ------------------------------ jacobianreuse end -----------------------------------------*/
@@ -0,0 +1,55 @@
+#ifndef JACOBIANREUSE_H
+#define JACOBIANREUSE_H
+
+#include <vector>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Jacobian Reuse
+ *  AssJacで組み込んだ疎行列の要素(行, 列, 値)を記録し,
+ *  基準の行列と同じ(非零の位置が同じで, 値の差が許容値以下)かを判定する.
+ *  基準は最後に「変わった」と判定した(分解し直したはずの)行列で,
+ *  「同じ」と判定した間は入れ替えない. 許容値以下の差が呼び出しごとに
+ *  積み重なっても, 分解した行列からの差は常に許容値以下に保たれる.
+ *  接触している節点, 海底面の法線, 線形の反力が変わらず,
+ *  摩擦力の大きさだけが変わったステップでは, 係数行列を分解し直さなくてよい.
+ *
+ *  usage
+ *    pjr.begin();
+ *    pjr.put(iRow, iCol, d);   (WM.PutItemと同じ順で)
+ *    bool bUnchanged = pjr.end();
+ * ================================================= */
+class jacobianreuse
+{
+private:
+    //entries of the reference (last changed) and the current assembly
+    std::vector<integer> iRowsPrev, iColsPrev;
+    std::vector<doublereal> dPrev;
+    std::vector<integer> iRows, iCols;
+    std::vector<doublereal> d;
+    //tolerance relative to the largest entry
+    doublereal dTol;
+    bool bValid;
+public:
+    jacobianreuse(void);
+    ~jacobianreuse(void);
+
+    virtual void setValue(const doublereal& tol);
+
+    virtual void begin(void);
+    void put(integer iRow, integer iCol, const doublereal& dCoef) {
+        iRows.push_back(iRow);
+        iCols.push_back(iCol);
+        d.push_back(dCoef);
+    };
+    //true if the entries equal those of the reference (the reference is kept);
+    //false: the current assembly becomes the reference
+    virtual bool end(void);
+    //forget the reference (e.g. the matrix was refactorized for another reason)
+    virtual void invalidate(void);
+};
+
+#endif // JACOBIANREUSE_H
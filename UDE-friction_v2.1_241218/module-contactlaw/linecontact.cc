@@ -0,0 +1,791 @@
+/* -----------------------------------------------------------------------
+* MBDyn (C) is a multibody analysis code.
+* http://www.mbdyn.org
+*
+* Copyright (C) 1996-2017
+*
+* Pierangelo Masarati  <masarati@aero.polimi.it>
+*
+* Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+* via La Masa, 34 - 20156 Milano, Italy
+* http://www.aero.polimi.it
+*
+* Changing this copyright notice is forbidden.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation (version 2 of the License).
+*
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+* -----------------------------------------------------------------------*/
+
+/* -----------------------------------------------------------------------
+* Module - contactlaw (LineContact)
+*
+* Implemented by
+* Ryoya Hisamatsu <hisamatsu@nams.kyushu-u.ac.jp>
+* Department of Marine Systems Engineering, Kyushu University
+* Motooka 744, Nishi-ku, Fukuoka 819-0395, Fukuoka, Japan
+* -----------------------------------------------------------------------*/
+
+#include "mbconfig.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#include "linecontact.h"
+#include "contacttrace.h"
+
+//線分どうしの接触力(反力は引っ張らない, 座標系は毎回作る)
+typedef contactlaw<clampednormal, projectedfriction, tanhregularization, segmentframe> linecontactlaw;
+
+
+/* ----------------------------- LineContact start ------------------------------------*/
+
+/*=======================================================================================
+* Constructor and Destructor
+*=======================================================================================*/
+//constructor
+LineContact::LineContact (
+	unsigned uLabel,
+	const DofOwner *pDO,
+	DataManager* pDM,
+	MBDynParser& HP
+)
+: Elem(uLabel, flag(0)), UserDefinedElem(uLabel, pDO),
+iNumLines(0), iMaxContacts(4), iOverflow(0)
+{
+	// help message or no arg error
+	if (HP.IsKeyWord("help")) {
+		silent_cout(
+			"help message\n"
+			"==== Module: LineContact ====\n"
+			"- Note: \n"
+			"\tcontact between the segments (capsules of radius R) of several lines\n"
+			"\tcell: broadphase grid size on the seabed plane, default the longest segment + 2R\n"
+			"\tmax contacts: average contacts per segment the Jacobian work space holds;\n"
+			"\tall contacts act in the residual, the Jacobian of the shallowest ones beyond\n"
+			"\tthe work space is left out and reported (private data jacobian_overflow)\n"
+			"\tstable step: next time step hint of the nodes in contact; masses are given\n"
+			"\tin the order of the nodes of all lines\n"
+			"- Usage: \n"
+			"\tLineContact,\n"
+			"\tlines, <num_lines>,\n"
+			"\t{ nodes, <num_nodes>, <node_label_1>, ... |\n"
+			"\t  label range, <first_node_label>, <last_node_label> }, radius, <R>,\n"
+			"\t...,\n"
+			"\tk, <k>,\n"
+			"\tc, <c>,\n"
+			"\tfriction, <nu>, <vt>\n"
+			"\t[, cell, <cell_size>]\n"
+			"\t[, max contacts, <num_contacts>]\n"
+			"\t[, stable step, { mass, <node_mass> | masses, <mass_1>, ..., <mass_N> } [, factor, <factor>]];\n"
+			"- Private data: \n"
+			"\tcandidate_pairs, contacts, jacobian_overflow,\n"
+			"\tstable_step, stable_step_node\n"
+			<< std::endl);
+		if (!HP.IsArg()) {
+			throw NoErr(MBDYN_EXCEPT_ARGS);
+		}
+	}
+
+	// read lines
+	if (!HP.IsKeyWord("lines")) {
+		silent_cerr("LineContact(" << GetLabel() << "): keyword \"lines\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	integer iLines = HP.GetInt();
+	if (iLines < 1) {
+		silent_cerr("LineContact(" << GetLabel() << "): at least 1 line expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	for (integer i = 0; i < iLines; i++) {
+		ReadLine(pDM, HP);
+	}
+	iNumLines = std::size_t(iLines);
+
+	// read k, c
+	if (!HP.IsKeyWord("k")) {
+		silent_cerr("LineContact(" << GetLabel() << "): keyword \"k\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	k = HP.GetReal();
+	if (!HP.IsKeyWord("c")) {
+		silent_cerr("LineContact(" << GetLabel() << "): keyword \"c\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	c = HP.GetReal();
+
+	// read friction
+	if (!HP.IsKeyWord("friction")) {
+		silent_cerr("LineContact(" << GetLabel() << "): keyword \"friction\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	doublereal nu = HP.GetReal();
+	doublereal vt = HP.GetReal();
+	if (nu < 0.0 || !(vt > 0.0)) {
+		silent_cerr("LineContact(" << GetLabel() << "): invalid friction at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	fp.nu1d = fp.nu1s = fp.nu2d = fp.nu2s = nu;
+	fp.vt = vt;
+	fp.dcrit = CONTACTPOLICY_DCRIT;
+	fp.kt = fp.ct = 0.0;
+	fp.vs = vt;
+
+	// read cell (optional)
+	//既定は最も長い線分 + 2R (箱は高々2x2のセルに入る)
+	doublereal h = 0.0;
+	for (std::size_t s = 0; s < segments.size(); s++) {
+		const Vec3 d = pNodes[segments[s].iNode2]->GetXCurr() - pNodes[segments[s].iNode1]->GetXCurr();
+		const doublereal hs = d.Norm() + 2.0*segments[s].R;
+		h = (hs > h) ? hs : h;
+	}
+	if (HP.IsKeyWord("cell")) {
+		h = HP.GetReal();
+		if (!(h > 0.0)) {
+			silent_cerr("LineContact(" << GetLabel() << "): cell size must be positive at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	if (!(h > 0.0)) {
+		silent_cerr("LineContact(" << GetLabel() << "): zero length segments, cell size expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	psg.setValue(h);
+
+	// read max contacts (optional)
+	if (HP.IsKeyWord("max" "contacts")) {
+		integer iMax = HP.GetInt();
+		if (iMax < 1) {
+			silent_cerr("LineContact(" << GetLabel() << "): max contacts must be positive at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		iMaxContacts = unsigned(iMax);
+	}
+
+	// read stable step (optional)
+	//接触の剛性, 減衰と節点の質量から次の時間刻みの目安をprivate dataに出す
+	//(mass: 全節点で同じ質量, masses: 節点ごとの質量をlinesの節点の順に並べる)
+	const std::size_t N = pNodes.size();
+	bool bStable = false;
+	std::vector<doublereal> dMass(N, 0.0);
+	doublereal dFactor = 0.1;
+	if (HP.IsKeyWord("stable" "step")) {
+		bStable = true;
+		if (HP.IsKeyWord("mass")) {
+			dMass.assign(N, HP.GetReal());
+		} else if (HP.IsKeyWord("masses")) {
+			for (std::size_t i = 0; i < N; i++) {
+				dMass[i] = HP.GetReal();
+			}
+		} else {
+			silent_cerr("LineContact(" << GetLabel() << "): keyword \"mass\" or \"masses\" expected at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		for (std::size_t i = 0; i < N; i++) {
+			if (dMass[i] <= 0.0) {
+				silent_cerr("LineContact(" << GetLabel() << "): mass of node " << pNodes[i]->GetLabel()
+					<< " must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("factor")) {
+			dFactor = HP.GetReal();
+			if (dFactor <= 0.0) {
+				silent_cerr("LineContact(" << GetLabel() << "): factor must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	//接触している節点だけを調べる(浮いている節点の到達時間は使わない)
+	pss.setValue(N, bStable, 0.0, 0.0, dFactor);
+	for (std::size_t i = 0; i < N; i++) {
+		pss.setMass(i, dMass[i]);
+	}
+
+	// allocate storage
+	r.resize(N);
+	v.resize(N);
+	fNode.resize(N);
+	bNode.assign(N, 0);
+	lo.resize(segments.size());
+	hi.resize(segments.size());
+	if (bStable) {
+		kNode.resize(N);
+		cNode.resize(N);
+		fnNode.resize(N);
+		zNode.resize(N);
+	}
+
+	//output flag
+	SetOutputFlag(pDM->fReadOutput(HP, Elem::LOADABLE));
+	//export log file
+	pDM->GetLogFile()
+		<< "LineContact: " << uLabel
+		<< " " << iNumLines
+		<< " " << N
+		<< " " << segments.size()
+		<< " " << psg.getCellSize()
+		<< (bStable ? " stable step" : "")
+		<< std::endl;
+}
+
+//destructor
+LineContact::~LineContact (void)
+{
+	NO_OP;
+}
+
+//read a line
+void
+LineContact::ReadLine(DataManager* pDM, MBDynParser& HP)
+{
+	const std::size_t iFirst = pNodes.size();
+	if (HP.IsKeyWord("nodes")) {
+		integer iNumNodes = HP.GetInt();
+		if (iNumNodes < 2) {
+			silent_cerr("LineContact(" << GetLabel() << "): at least 2 nodes per line expected at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		for (integer i = 0; i < iNumNodes; i++) {
+			pNodes.push_back(dynamic_cast<const StructNode *>(pDM->ReadNode(HP, Node::STRUCTURAL)));
+		}
+
+	} else if (HP.IsKeyWord("label" "range")) {
+		integer iFirstLabel = HP.GetInt();
+		integer iLastLabel = HP.GetInt();
+		if (iLastLabel - iFirstLabel < 1) {
+			silent_cerr("LineContact(" << GetLabel() << "): invalid label range " << iFirstLabel << ":" << iLastLabel << " at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		for (integer l = iFirstLabel; l <= iLastLabel; l++) {
+			const StructNode *pNode = dynamic_cast<const StructNode *>(pDM->pFindNode(Node::STRUCTURAL, l));
+			if (pNode == 0) {
+				silent_cerr("LineContact(" << GetLabel() << "): StructNode(" << l << ") not found at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			pNodes.push_back(pNode);
+		}
+
+	} else {
+		silent_cerr("LineContact(" << GetLabel() << "): keyword \"nodes\" or \"label range\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	// read radius
+	if (!HP.IsKeyWord("radius")) {
+		silent_cerr("LineContact(" << GetLabel() << "): keyword \"radius\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	doublereal R = HP.GetReal();
+	if (!(R > 0.0)) {
+		silent_cerr("LineContact(" << GetLabel() << "): radius must be positive at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	for (std::size_t i = iFirst; i + 1 < pNodes.size(); i++) {
+		segment s;
+		s.iNode1 = i;
+		s.iNode2 = i + 1;
+		s.R = R;
+		segments.push_back(s);
+	}
+}
+
+
+
+/*=======================================================================================
+* Intial Assembly Process
+*=======================================================================================*/
+//set number of DOF
+unsigned int
+LineContact::iGetInitialNumDof(void) const
+{
+	return 0;
+}
+
+//set initial value
+void
+LineContact::SetInitialValue(VectorHandler& XCurr)
+{
+	return;
+}
+
+//set initial assembly matrix dimension
+void
+LineContact::InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const
+{
+	*piNumRows = 0;
+	*piNumCols = 0;
+}
+
+//calculate residual vector for initial assembly analysis
+SubVectorHandler&
+LineContact::InitialAssRes(
+	SubVectorHandler& WorkVec,
+	const VectorHandler& XCurr)
+{
+	WorkVec.ResizeReset(0);
+	return WorkVec;
+}
+
+//calculate Jaconbian for initial assembly analysis
+VariableSubMatrixHandler&
+LineContact::InitialAssJac(
+	VariableSubMatrixHandler& WorkMat,
+	const VectorHandler& XCurr)
+{
+	WorkMat.SetNullMatrix();
+	return WorkMat;
+}
+
+/*=======================================================================================
+* Initial Value Problem
+*=======================================================================================*/
+//set number of DOF
+unsigned int
+LineContact::iGetNumDof(void) const
+{
+	return 0;
+}
+
+//set DOF type
+DofOrder::Order
+LineContact::GetDofType(unsigned int i) const
+{
+	return DofOrder::DIFFERENTIAL;
+}
+
+//set initial value
+void
+LineContact::SetValue(
+	DataManager *pDM,
+	VectorHandler& X,
+	VectorHandler& XP,
+	SimulationEntity::Hints *ph)
+{
+	return;
+}
+
+//set matrix dimension
+void
+LineContact::WorkSpaceDim(integer* piNumRows, integer* piNumCols) const
+{
+	//residual: 3 rows per node (forces summed per node)
+	//Jacobian: 12x12 per contact (sparse), iMaxContacts per segment on average,
+	//i.e. 144*S*iMaxContacts/2 <= 3N*24*iMaxContacts entries (AssJac reports the rest)
+	*piNumRows = 3*pNodes.size();
+	*piNumCols = 24*iMaxContacts;
+}
+
+//closest points of two segments
+bool
+LineContact::Closest(std::size_t i, std::size_t j, contactpair& p) const
+{
+	/*
+	 * 線分 p1 = r11 + s d1, p2 = r21 + t d2 (s, t in [0, 1]) の最近接点
+	 * (Ericson, Real-Time Collision Detection 5.1.9)
+	 */
+	const segment& s1 = segments[i];
+	const segment& s2 = segments[j];
+	const Vec3 d1 = r[s1.iNode2] - r[s1.iNode1];
+	const Vec3 d2 = r[s2.iNode2] - r[s2.iNode1];
+	const Vec3 r12 = r[s1.iNode1] - r[s2.iNode1];
+	const doublereal a = d1.Dot(d1);
+	const doublereal e = d2.Dot(d2);
+	const doublereal f = d2.Dot(r12);
+	const doublereal eps = std::numeric_limits<doublereal>::epsilon();
+
+	doublereal s = 0.0, t = 0.0;
+	if (a <= eps && e <= eps) {
+		s = t = 0.0;
+	} else if (a <= eps) {
+		s = 0.0;
+		t = std::max(0.0, std::min(1.0, f/e));
+	} else {
+		const doublereal c = d1.Dot(r12);
+		if (e <= eps) {
+			t = 0.0;
+			s = std::max(0.0, std::min(1.0, -c/a));
+		} else {
+			//平行な線分(denom = 0)では s = 0 から始める
+			const doublereal b = d1.Dot(d2);
+			const doublereal denom = a*e - b*b;
+			s = (denom > eps*a*e) ? std::max(0.0, std::min(1.0, (b*f - c*e)/denom)) : 0.0;
+			t = (b*s + f)/e;
+			if (t < 0.0) {
+				t = 0.0;
+				s = std::max(0.0, std::min(1.0, -c/a));
+			} else if (t > 1.0) {
+				t = 1.0;
+				s = std::max(0.0, std::min(1.0, (b - c)/a));
+			}
+		}
+	}
+
+	const Vec3 p1 = r[s1.iNode1] + d1*s;
+	const Vec3 p2 = r[s2.iNode1] + d2*t;
+	const Vec3 dr = p1 - p2;
+	const doublereal d = dr.Norm();
+	const doublereal z = d - (s1.R + s2.R);
+	if (z > 0.0) {
+		return false;
+	}
+
+	//法線は線分2から線分1の向き, 軸が交わるときは2本の軸に直交する向き
+	Vec3 normal_vec;
+	if (d > eps*(s1.R + s2.R)) {
+		normal_vec = dr*(1.0/d);
+	} else {
+		normal_vec = d1.Cross(d2);
+		const doublereal dN = normal_vec.Norm();
+		normal_vec = (dN > eps*std::sqrt(a*e)) ? normal_vec*(1.0/dN) : Vec3(0.0, 0.0, 1.0);
+		if (normal_vec.dGet(3) < 0.0) {
+			normal_vec = normal_vec*(-1.0);
+		}
+	}
+
+	p.iSeg1 = i;
+	p.iSeg2 = j;
+	p.s = s;
+	p.t = t;
+	p.z = z;
+	p.dr = dr;
+	p.dv = (v[s1.iNode1]*(1.0 - s) + v[s1.iNode2]*s) - (v[s2.iNode1]*(1.0 - t) + v[s2.iNode2]*t);
+	p.normal_vec = normal_vec;
+	//線分1の向きをaxialとする
+	framecache cache;
+	linecontactlaw::frame(normal_vec, d1, cache, p.axial_unitvec, p.lateral_unitvec);
+	return true;
+}
+
+//broadphase and narrowphase
+void
+LineContact::Find(const VectorHandler& XCurr, const VectorHandler& XPrimeCurr)
+{
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+		r[i] = Vec3(XCurr(iPos + 1), XCurr(iPos + 2), XCurr(iPos + 3));
+		v[i] = Vec3(XPrimeCurr(iPos + 1), XPrimeCurr(iPos + 2), XPrimeCurr(iPos + 3));
+	}
+
+	//capsuleの外接箱
+	for (std::size_t s = 0; s < segments.size(); s++) {
+		const Vec3& r1 = r[segments[s].iNode1];
+		const Vec3& r2 = r[segments[s].iNode2];
+		const doublereal R = segments[s].R;
+		for (unsigned short k = 1; k <= 3; k++) {
+			lo[s](k) = std::min(r1.dGet(k), r2.dGet(k)) - R;
+			hi[s](k) = std::max(r1.dGet(k), r2.dGet(k)) + R;
+		}
+	}
+	psg.pairs(segments.size(), &lo[0], &hi[0], candidates);
+
+	contacts.clear();
+	for (std::size_t c = 0; c < candidates.size(); c++) {
+		const std::size_t i = candidates[c].first;
+		const std::size_t j = candidates[c].second;
+
+		//節点を共有する線分は調べない
+		const segment& s1 = segments[i];
+		const segment& s2 = segments[j];
+		if (s1.iNode1 == s2.iNode1 || s1.iNode1 == s2.iNode2
+			|| s1.iNode2 == s2.iNode1 || s1.iNode2 == s2.iNode2) {
+			continue;
+		}
+
+		contactpair p;
+		if (!Closest(i, j, p)) {
+			continue;
+		}
+		contacts.push_back(p);
+	}
+}
+
+//calculate residual vector
+SubVectorHandler&
+LineContact::AssRes(
+	SubVectorHandler& WorkVec,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	Find(XCurr, XPrimeCurr);
+	CONTACT_TRACE(CONTACT_TRACE_VERBOSE, TRACE_ASSEMBLY, "LineContact contacts", GetLabel(), double(contacts.size()));
+	if (contacts.empty()) {
+		WorkVec.ResizeReset(0);
+		return WorkVec;
+	}
+
+	//接触点の力を線分の両端の節点に配り, 節点ごとに合計する
+	integer iNumNodes = 0;
+	for (std::size_t n = 0; n < contacts.size(); n++) {
+		const contactpair& p = contacts[n];
+		Vec3 f;
+		frictionstate fs;
+		linecontactlaw::gapforce(f, fs, p.z, p.dr, p.dv,
+			p.normal_vec, p.axial_unitvec, p.lateral_unitvec, k, c, fp, frictionstate());
+
+		const std::size_t iNode[4] = {
+			segments[p.iSeg1].iNode1, segments[p.iSeg1].iNode2,
+			segments[p.iSeg2].iNode1, segments[p.iSeg2].iNode2 };
+		const doublereal w[4] = { 1.0 - p.s, p.s, -(1.0 - p.t), -p.t };
+		for (int a = 0; a < 4; a++) {
+			if (!bNode[iNode[a]]) {
+				bNode[iNode[a]] = 1;
+				fNode[iNode[a]] = Vec3(0.0, 0.0, 0.0);
+				iNumNodes++;
+			}
+			fNode[iNode[a]] += f*w[a];
+		}
+	}
+
+	//節点の順に組み込む
+	WorkVec.ResizeReset(3*iNumNodes);
+	integer iRow = 0;
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		if (!bNode[i]) {
+			continue;
+		}
+		bNode[i] = 0;
+		const integer iMom = pNodes[i]->iGetFirstMomentumIndex();
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			WorkVec.PutRowIndex(iRow + iCnt, iMom + iCnt);
+			WorkVec.PutCoef(iRow + iCnt, fNode[i](iCnt));
+		}
+		iRow += 3;
+	}
+
+	return WorkVec;
+}
+
+//calculate Jacobian matrix
+VariableSubMatrixHandler&
+LineContact::AssJac(
+	VariableSubMatrixHandler& WorkMat,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	Find(XCurr, XPrimeCurr);
+	if (contacts.empty()) {
+		iOverflow = 0;
+		WorkMat.SetNullMatrix();
+		return WorkMat;
+	}
+
+	//作業領域に収まらない分は隙間の浅い接触のヤコビ行列を省く(残差には入っている)
+	integer iNumRows, iNumCols;
+	WorkSpaceDim(&iNumRows, &iNumCols);
+	const std::size_t iCapacity = std::size_t(iNumRows)*std::size_t(iNumCols)/144;
+	const std::size_t iNumJac = std::min(contacts.size(), iCapacity);
+	iJacOrder.resize(contacts.size());
+	for (std::size_t n = 0; n < contacts.size(); n++) {
+		iJacOrder[n] = n;
+	}
+	if (iNumJac < contacts.size()) {
+		std::nth_element(iJacOrder.begin(), iJacOrder.begin() + iNumJac, iJacOrder.end(),
+			deeper(contacts));
+		if (iOverflow == 0) {
+			silent_cerr("LineContact(" << GetLabel() << "): " << contacts.size() << " contacts, "
+				"Jacobian of " << contacts.size() - iNumJac << " left out; increase max contacts" << std::endl);
+		}
+	}
+	iOverflow = contacts.size() - iNumJac;
+
+	/*
+	 * 接触点の相対位置 dr = sum_b w_b x_b, 節点aの力 f_a = w_a f より
+	 *  J_ab = w_a w_b J (J: 相対位置と相対速度に対する3x3, gapjacobian)
+	 */
+	SparseSubMatrixHandler& WM = WorkMat.SetSparse();
+	WM.ResizeReset(144*iNumJac, 1);
+
+	integer iEntry = 1;
+	for (std::size_t n = 0; n < iNumJac; n++) {
+		const contactpair& p = contacts[iJacOrder[n]];
+		doublereal J[3][3];
+		linecontactlaw::gapjacobian(J, p.z, p.dr, p.dv,
+			p.normal_vec, p.axial_unitvec, p.lateral_unitvec, k, c, fp, frictionstate(), dCoef);
+
+		const std::size_t iNode[4] = {
+			segments[p.iSeg1].iNode1, segments[p.iSeg1].iNode2,
+			segments[p.iSeg2].iNode1, segments[p.iSeg2].iNode2 };
+		const doublereal w[4] = { 1.0 - p.s, p.s, -(1.0 - p.t), -p.t };
+		for (int a = 0; a < 4; a++) {
+			const integer iMom = pNodes[iNode[a]]->iGetFirstMomentumIndex();
+			for (int b = 0; b < 4; b++) {
+				const integer iPos = pNodes[iNode[b]]->iGetFirstPositionIndex();
+				const doublereal wab = w[a]*w[b];
+				for (int iRow = 1; iRow <= 3; iRow++) {
+					for (int iCol = 1; iCol <= 3; iCol++) {
+						WM.PutItem(iEntry++, iMom + iRow, iPos + iCol, wab*J[iRow - 1][iCol - 1]);
+					}
+				}
+			}
+		}
+	}
+
+	return WorkMat;
+}
+
+
+/*=======================================================================================
+* Private Data
+*=======================================================================================*/
+//set number of private data
+unsigned int
+LineContact::iGetNumPrivData(void) const
+{
+	return 3 + stablestep::iGetNumPrivData();
+}
+//set index of private data
+unsigned int
+LineContact::iGetPrivDataIdx(const char *s) const
+{
+	static const struct {
+		unsigned int index;
+		const char *name;
+	} data[] = {
+		{ 1, "candidate_pairs" },
+		{ 2, "contacts" },
+		{ 3, "jacobian_overflow" },
+	};
+
+	for (unsigned i = 0; i < sizeof(data)/sizeof(data[0]); i++) {
+		if (std::strcmp(data[i].name, s) == 0) {
+			return data[i].index;
+		}
+	}
+	//stable step follows
+	const unsigned int i = pss.iGetPrivDataIdx(s);
+	if (i != 0) {
+		return 3 + i;
+	}
+
+	silent_cerr("LineContact(" << GetLabel() << "): no private data \"" << s << "\"" << std::endl);
+	return 0;
+}
+//function to get private data
+doublereal
+LineContact::dGetPrivData(unsigned int i) const
+{
+	switch (i) {
+	case 1:
+		return doublereal(candidates.size());
+	case 2:
+		return doublereal(contacts.size());
+	case 3:
+		return doublereal(iOverflow);
+	}
+	if (i > 3 && i <= iGetNumPrivData()) {
+		return pss.dGetPrivData(i - 3);
+	}
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+}
+
+
+/*=======================================================================================
+* Configure runtime processing
+*=======================================================================================*/
+//process after convergence (each time step)
+void
+LineContact::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
+{
+	if (!pss.bGetEnabled()) {
+		return;
+	}
+
+	/*
+	 * 節点aの力 f_a = w_a f, 相対位置 dr = sum_b w_b x_b より, 節点aだけが動くときの
+	 * 剛性, 減衰, 摩擦の正則化の傾きは接触の値の w_a^2 倍. 節点を共有する接触は合計する.
+	 */
+	Find(X, XP);
+	for (std::size_t n = 0; n < contacts.size(); n++) {
+		const contactpair& p = contacts[n];
+		const doublereal F = std::max(-k*p.z - c*p.dv.Dot(p.normal_vec), 0.0);
+
+		const std::size_t iNode[4] = {
+			segments[p.iSeg1].iNode1, segments[p.iSeg1].iNode2,
+			segments[p.iSeg2].iNode1, segments[p.iSeg2].iNode2 };
+		const doublereal w[4] = { 1.0 - p.s, p.s, -(1.0 - p.t), -p.t };
+		for (int a = 0; a < 4; a++) {
+			const std::size_t i = iNode[a];
+			if (!bNode[i]) {
+				bNode[i] = 1;
+				kNode[i] = cNode[i] = fnNode[i] = 0.0;
+				zNode[i] = p.z;
+			}
+			const doublereal w2 = w[a]*w[a];
+			kNode[i] += w2*k;
+			cNode[i] += w2*c;
+			fnNode[i] += w2*F;
+			zNode[i] = std::min(zNode[i], p.z);
+		}
+	}
+
+	//接触している節点の最小値(隙間は0以下なので海底面の上限は使わない)
+	pss.begin();
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		if (!bNode[i]) {
+			continue;
+		}
+		bNode[i] = 0;
+		pss.update(i, pNodes[i]->GetLabel(), r[i], v[i], zNode[i], kNode[i], cNode[i], 0.0, 0.0,
+			fnNode[i], fp.nu1d, fp.vt, 0, 0);
+	}
+}
+
+
+/*=======================================================================================
+* Output
+*=======================================================================================*/
+//output file
+void
+LineContact::Output(OutputHandler& OH) const
+{
+	if (bToBeOutput()) {
+		if (OH.UseText(OutputHandler::LOADABLE)) {
+			OH.Loadable() << GetLabel()
+				<< std::endl;
+		}
+	}
+}
+
+
+/*=======================================================================================
+* etc
+*=======================================================================================*/
+//print information of connected nodes
+int
+LineContact::iGetNumConnectedNodes(void) const
+{
+	return pNodes.size();
+}
+void
+LineContact::GetConnectedNodes(std::vector<const Node *>& connectedNodes) const
+{
+	connectedNodes.resize(pNodes.size());
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		connectedNodes[i] = pNodes[i];
+	}
+}
+//output restart file
+std::ostream&
+LineContact::Restart(std::ostream& out) const
+{
+	return out << "# LineContact (" << GetLabel() << "): not implemented yet" << std::endl;
+}
+
+/* ----------------------------- LineContact end -------------------------------------- */
@@ -0,0 +1,238 @@
+/* -----------------------------------------------------------------------
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2017
+ *
+ * Pierangelo Masarati  <masarati@aero.polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * -----------------------------------------------------------------------*/
+
+/* -----------------------------------------------------------------------
+ * Module - Contactlaw (LineContact)
+ *
+ * Implemented by
+ * Ryoya Hisamatsu <hisamatsu@nams.kyushu-u.ac.jp>
+ * Department of Marine Systems Engineering, Kyushu University
+ * Motooka 744, Nishi-ku, Fukuoka 819-0395, Fukuoka, Japan
+ * -----------------------------------------------------------------------*/
+
+#ifndef LINECONTACT_H
+#define LINECONTACT_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "dataman.h"
+#include "userelem.h"
+#include "contactpolicy.h"
+#include "segmentgrid.h"
+#include "stablestep.h"
+
+/* =================================================
+ * class LineContact
+ *  複数の係留索(節点列)の線分どうしの接触を1要素で計算する.
+ *  線分は半径Rのcapsuleとし, 2本の線分の最近接点の距離dから
+ *  隙間 z = d - (R1 + R2) (z <= 0で接触)を求める.
+ *
+ *  broadphase : segmentgridで外接箱が重なる線分の組だけを候補にする.
+ *  narrowphase: 候補の組の最近接点(線分上の比率s, t)と隙間を求める.
+ *  接触力は海底面と同じpolicy(反力は引っ張らないclampednormal, 摩擦はprojectedfriction)で,
+ *  法線は最近接点を結ぶ向き, 接線方向の基底は線分1の向きから作る(axial, lateral).
+ *  力は最近接点から線分の両端の節点に s, 1 - s で配る.
+ *  ヤコビ行列では法線と最近接点の移動(s, tの変化)を省略する.
+ *
+ *  同じ節点を共有する線分(隣り合う線分)の組は調べない.
+ *
+ *  接触はすべて残差に入れる(数を打ち切ると残差が不連続になる).
+ *  ヤコビ行列の作業領域は平均 max contacts 個/線分の接触の分だけなので,
+ *  それを超えた分は隙間の深い接触から組み込み, 残りは省いて報告する.
+ *
+ *  stable step: 収束後, 接触している節点ごとに重み w の2乗をかけた剛性, 減衰,
+ *  摩擦の正則化の傾きを合計し, 節点の質量から次の時間刻みの目安を求める.
+ * ================================================= */
+class LineContact
+: virtual public Elem, public UserDefinedElem
+{
+private:
+	/*===================================================================
+	 * Private Member Variables
+	 *===================================================================*/
+	//segment between nodes iNode1 and iNode2 (indices into pNodes)
+	struct segment
+	{
+		std::size_t iNode1;
+		std::size_t iNode2;
+		doublereal R;
+	};
+
+	//contact of segments iSeg1 and iSeg2 at the last pass
+	struct contactpair
+	{
+		std::size_t iSeg1;
+		std::size_t iSeg2;
+		//closest points p1 = (1 - s) r11 + s r12, p2 = (1 - t) r21 + t r22
+		doublereal s, t;
+		//gap, relative position p1 - p2 and relative velocity
+		doublereal z;
+		Vec3 dr, dv;
+		Vec3 normal_vec, axial_unitvec, lateral_unitvec;
+	};
+
+	//orders contact indices by gap (deepest first)
+	struct deeper
+	{
+		const std::vector<contactpair>& c;
+		deeper(const std::vector<contactpair>& contacts) : c(contacts) {};
+		bool operator()(std::size_t a, std::size_t b) const { return c[a].z < c[b].z; };
+	};
+
+	//nodes of all lines (each line ordered along the line)
+	std::vector<const StructNode *> pNodes;
+	std::vector<segment> 	segments;
+	std::size_t 			iNumLines;
+	doublereal 				k;
+	doublereal 				c;
+	frictionparam 			fp;
+	segmentgrid 			psg;
+	//average contacts per segment the Jacobian work space is sized for
+	unsigned int 			iMaxContacts;
+
+	//positions and velocities of the nodes, boxes of the segments
+	std::vector<Vec3> 		r, v;
+	std::vector<Vec3> 		lo, hi;
+	//candidate pairs and contacts of the last pass
+	std::vector<std::pair<std::size_t, std::size_t> > candidates;
+	std::vector<contactpair> contacts;
+	//contacts in the order their Jacobian is assembled, and those left out of the last one
+	std::vector<std::size_t> iJacOrder;
+	std::size_t 			iOverflow;
+	//force of each node (residual)
+	std::vector<Vec3> 		fNode;
+	std::vector<char> 		bNode;
+	//stable step (contact stiffness, damping, normal force and deepest gap of each node)
+	stablestep 				pss;
+	std::vector<doublereal> kNode, cNode, fnNode, zNode;
+
+private:
+	//read a line ("nodes, N, ..." or "label range, first, last", then "radius, R")
+	void ReadLine(DataManager* pDM, MBDynParser& HP);
+	//broadphase and narrowphase of all segments
+	void Find(const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+	//closest points of segments i and j (false if farther than the sum of the radii)
+	bool Closest(std::size_t i, std::size_t j, contactpair& p) const;
+
+public:
+	/*===================================================================
+	 * Constructor and Destructor
+	 *===================================================================*/
+	//constructor
+	LineContact(unsigned uLabel, const DofOwner *pDO,
+		DataManager* pDM, MBDynParser& HP);
+	//destructor
+	virtual ~LineContact(void);
+
+
+	/*===================================================================
+	 * Intial Assembly Process
+	 *===================================================================*/
+	//set number of DOF
+	virtual unsigned int iGetInitialNumDof(void) const;
+	//set initial value
+	virtual void SetInitialValue(VectorHandler& XCurr);
+	//set initial assembly matrix dimension
+	virtual void
+	InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const;
+	//calculate residual vector for initial assembly analysis
+   	SubVectorHandler&
+	InitialAssRes(SubVectorHandler& WorkVec, const VectorHandler& XCurr);
+	//calculate Jaconbian for initial assembly analysis
+   	VariableSubMatrixHandler&
+	InitialAssJac(VariableSubMatrixHandler& WorkMat,
+		      const VectorHandler& XCurr);
+
+
+	/*===================================================================
+	 * Initial Value Problem
+	 *===================================================================*/
+	//set number of DOF
+	virtual unsigned int iGetNumDof(void) const;
+	//set DOF type
+	virtual DofOrder::Order GetDofType(unsigned int i) const;
+	//set initial value
+	void SetValue(DataManager *pDM, VectorHandler& X, VectorHandler& XP,
+		SimulationEntity::Hints *ph);
+
+	//set matrix dimension
+	virtual void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const;
+	//calculate residual vector, b
+	SubVectorHandler&
+	AssRes(SubVectorHandler& WorkVec,
+		doublereal dCoef,
+		const VectorHandler& XCurr,
+		const VectorHandler& XPrimeCurr);
+	//calculate Jacobian matrix, A
+	VariableSubMatrixHandler&
+	AssJac(VariableSubMatrixHandler& WorkMat,
+		doublereal dCoef,
+		const VectorHandler& XCurr,
+		const VectorHandler& XPrimeCurr);
+
+
+	/*===================================================================
+	 * Private Data
+	 *===================================================================*/
+	//set number of private data
+	virtual unsigned int iGetNumPrivData(void) const;
+	//set index of private data
+	virtual unsigned int iGetPrivDataIdx(const char *s) const;
+	//function to get private data
+	virtual doublereal dGetPrivData(unsigned int i) const;
+
+
+	/*===================================================================
+	 * Configure runtime processing
+	 *===================================================================*/
+	//process after convergence (each time step)
+	virtual void
+	AfterConvergence(const VectorHandler& X, const VectorHandler& XP);
+
+
+	/*===================================================================
+	 * Output
+	 *===================================================================*/
+	//output file
+	virtual void Output(OutputHandler& OH) const;
+
+
+	/*===================================================================
+	 * etc
+	 *===================================================================*/
+	//print information of connected nodes
+	virtual int iGetNumConnectedNodes(void) const;
+	virtual void GetConnectedNodes(std::vector<const Node *>& connectedNodes) const;
+	//output restart file
+	virtual std::ostream& Restart(std::ostream& out) const;
+};
+
+#endif // LINECONTACT_H
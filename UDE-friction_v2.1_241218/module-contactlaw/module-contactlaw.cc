@@ -45,14 +45,104 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
+#include <sstream>
 
 #include "module-contactlaw.h"
-#include "exchangevector.h"
-#include "tanhfunc.h"
+#include "contactdual.h"
+#include "contactchain.h"
+#include "linecontact.h"
+#include "contacttrace.h"
 
 
 /* ----------------------------- contactlaw start --------------------------------------*/
 
+//keywords of the contact law (index = iNormal, iFriction, iRegularization)
+static const char *contactlaw_normal[] = { "kelvin", "clamped" };
+static const char *contactlaw_friction[] = { "projected", "coulomb", "stick slip" };
+static const char *contactlaw_regularization[] = {
+	"tanh", "linear", "rational", "table", "cubic", "smoothstep", "arctan", "stribeck"
+};
+
+/*=======================================================================================
+* Contact Law
+*=======================================================================================*/
+//set Frame, ContactForce, ContactJacobian and ContactJacobianVector to the instantiations of Law
+template <class Law>
+void
+Contactlaw::SetLaw(void)
+{
+	pFrame 				= &Contactlaw::LawFrame<Law>;
+	pContactForce 		= &Contactlaw::LawContactForce<Law>;
+	pContactJacobian 	= &Contactlaw::LawContactJacobian<Law>;
+	pContactJacobianVector 	= &Contactlaw::LawContactJacobianVector<Law>;
+}
+
+//ヤコビ行列を自動微分で求める場合はdualcontactlaw<Law>
+template <class Law>
+void
+Contactlaw::SetLaw(bool bAutomatic)
+{
+	if (bAutomatic) {
+		SetLaw<dualcontactlaw<Law> >();
+	} else {
+		SetLaw<Law>();
+	}
+}
+
+//iRegularizationはcontactlaw_regularizationの順
+template <class NormalModel, class FrictionModel>
+void
+Contactlaw::SetLaw(int iRegularization, bool bAutomatic)
+{
+	switch (iRegularization) {
+	case 1:
+		SetLaw<contactlaw<NormalModel, FrictionModel, linearregularization, cachedframe> >(bAutomatic);
+		break;
+	case 2:
+		SetLaw<contactlaw<NormalModel, FrictionModel, rationalregularization, cachedframe> >(bAutomatic);
+		break;
+	case 3:
+		SetLaw<contactlaw<NormalModel, FrictionModel, tableregularization, cachedframe> >(bAutomatic);
+		break;
+	case 4:
+		SetLaw<contactlaw<NormalModel, FrictionModel, cubicregularization, cachedframe> >(bAutomatic);
+		break;
+	case 5:
+		SetLaw<contactlaw<NormalModel, FrictionModel, smoothstepregularization, cachedframe> >(bAutomatic);
+		break;
+	case 6:
+		SetLaw<contactlaw<NormalModel, FrictionModel, arctanregularization, cachedframe> >(bAutomatic);
+		break;
+	case 7:
+		SetLaw<contactlaw<NormalModel, FrictionModel, stribeckregularization, cachedframe> >(bAutomatic);
+		break;
+	default:
+		SetLaw<contactlaw<NormalModel, FrictionModel, tanhregularization, cachedframe> >(bAutomatic);
+		break;
+	}
+}
+
+//組み合わせはここで実体化するものに限る(実行時には切り替えない)
+template <class NormalModel>
+void
+Contactlaw::SetLaw(int iFriction, int iRegularization, bool bAutomatic)
+{
+	switch (iFriction) {
+	case 1:
+		SetLaw<NormalModel, coulombfriction>(iRegularization, bAutomatic);
+		break;
+	case 2:
+		//stick slipは正則化, 自動微分を使わない
+		SetLaw<contactlaw<NormalModel, stickslipfriction, tanhregularization, cachedframe> >();
+		break;
+	default:
+		SetLaw<NormalModel, projectedfriction>(iRegularization, bAutomatic);
+		break;
+	}
+}
+
+
 /*=======================================================================================
 * Constructor and Destructor
 *=======================================================================================*/
@@ -63,7 +153,8 @@ Contactlaw::Contactlaw (
 	DataManager* pDM,
 	MBDynParser& HP
 )
-: Elem(uLabel, flag(0)), UserDefinedElem(uLabel, pDO)
+: Elem(uLabel, flag(0)), UserDefinedElem(uLabel, pDO),
+pDataManager(pDM)
 {
 	// help message or no arg error
 	if (HP.IsKeyWord("help")) {
@@ -72,18 +163,41 @@ Contactlaw::Contactlaw (
 			"==== Module: Contactlaw ====\n"
 			"- Note: \n"
 			"\ttest\n"
+			"\tprojected and coulomb friction are isotropic with the axial coefficients;\n"
+			"\tstribeck uses the axial ratio nu1s/nu1d, the lateral ones are used by stick slip only\n"
 			"- Usage: \n"
 			"\tContactlaw,\n"
 			"\t<node_label_1>,\n"
-			"\t<node_label_2>;\n"
+			"\t<node_label_2>,\n"
+			"\t<seabed_label>,\n"
+			"\tk, <k>,\n"
+			"\tc, <c>\n"
+			"\t[, jacobian check, <tolerance>]\n"
+			"\t[, active set, { no | <acceleration_bound> [, margin, <margin>] }]\n"
+			"\t[, enforcement, { penalty | lagrange multiplier }]\n"
+			"\t[, law,\n"
+			"\t\t[ normal, { kelvin | clamped } ]\n"
+			"\t\t[ friction, { projected | coulomb | stick slip, <kt> [, damping, <ct>] } ]\n"
+			"\t\t[ regularization, { tanh | linear | rational | table | cubic\n"
+			"\t\t\t| smoothstep | arctan | stribeck, <stribeck_velocity> } ]\n"
+			"\t\t[ differentiation, { analytic | automatic } ] ]\n"
+			"\t[, jacobian reuse, <tolerance>]\n"
+			"\t[, swept contact [, max penetration, <depth>] [, samples, <num_samples>]]\n"
+			"\t[, stable step, mass, <mass_1>, <mass_2> [, factor, <factor>]]\n"
+			"\t[, performance summary];\n"
+			"- Private data: \n"
+			"\tassres_calls, assres_cycles, assjac_calls, assjac_cycles,\n"
+			"\tactive_nodes, active_nodes_total, flips, degenerate_frames,\n"
+			"\tjacobian_unchanged, jacobian_unchanged_total,\n"
+			"\timpact_fraction, impact_velocity, step_hint, tunnelled_total,\n"
+			"\tpredicted_penetration, predicted_clamped_total,\n"
+			"\tstable_step, stable_step_node\n"
 			<< std::endl);
 		if (!HP.IsArg()) {
 			throw NoErr(MBDYN_EXCEPT_ARGS);
 		}
 	}
 
-	std:: cout << "1" << std::endl;
-
 	// read node1
 	pNode1 = dynamic_cast<const StructNode *>(pDM->ReadNode(HP, Node::STRUCTURAL));
 
@@ -94,8 +208,6 @@ Contactlaw::Contactlaw (
 	unsigned int uElemLabel = (unsigned int)HP.GetInt();
 	pSeabed = dynamic_cast<Seabed *>(pDM->pFindElem(Elem::LOADABLE, uElemLabel));
 
-	std:: cout << "2" << std::endl;
-
 	
 	// read k
 	if (!HP.IsKeyWord("k")) {
@@ -111,7 +223,218 @@ Contactlaw::Contactlaw (
 	}
 	c = HP.GetReal();
 
-	std ::cout << "3" << std::endl;
+	// read jacobian check (optional)
+	bJacCheck = false;
+	dJacCheckTol = 0.0;
+	if (HP.IsKeyWord("jacobian" "check")) {
+		bJacCheck = true;
+		dJacCheckTol = HP.GetReal();
+	}
+
+	// read active set (optional)
+	//既定では重力加速度の2倍を下向き加速度の上限とする
+	doublereal g, Zs, nu1d, nu1s, nu2d, nu2s, vt;
+	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
+	bool bActiveSet = true;
+	doublereal dAccMax = 2.0*std::abs(g);
+	doublereal dMargin = 0.0;
+	if (HP.IsKeyWord("active" "set")) {
+		if (HP.IsKeyWord("no")) {
+			bActiveSet = false;
+		} else {
+			dAccMax = HP.GetReal();
+			if (dAccMax <= 0.0) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): acceleration bound must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			if (HP.IsKeyWord("margin")) {
+				dMargin = HP.GetReal();
+			}
+		}
+	}
+	pas.setValue(2, bActiveSet, dAccMax, dMargin);
+	pcs.setValue(2);
+
+	// read enforcement (optional)
+	//lagrange multiplier: 節点ごとに法線方向の反力を自由度とし, 貫入を0に拘束する.
+	//kは接触/離脱の判定(active set)にだけ使い, cとnormalの指定は使わない.
+	bMultiplier = false;
+	dLambda[0] = dLambda[1] = 0.0;
+	if (HP.IsKeyWord("enforcement")) {
+		if (HP.IsKeyWord("lagrange" "multiplier")) {
+			bMultiplier = true;
+		} else if (!HP.IsKeyWord("penalty")) {
+			silent_cerr("Contactlaw(" << GetLabel() << "): unknown enforcement at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	if (bMultiplier && k <= 0.0) {
+		silent_cerr("Contactlaw(" << GetLabel() << "): k must be positive with lagrange multiplier enforcement" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	// read contact law (optional)
+	//既定は元のContactlawと同じ(kelvin, projected, tanh)
+	//iFriction: 0 projected, 1 coulomb, 2 stick slip
+	bool bClamped = false;
+	int iFriction = 0;
+	int iRegularization = 0;
+	bool bAutomatic = false;
+	kt = 0.0;
+	ct = 0.0;
+	vs = 0.0;
+	if (HP.IsKeyWord("law")) {
+		if (HP.IsKeyWord("normal")) {
+			if (HP.IsKeyWord("clamped")) {
+				bClamped = true;
+			} else if (!HP.IsKeyWord("kelvin")) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): unknown normal model at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("friction")) {
+			if (HP.IsKeyWord("coulomb")) {
+				iFriction = 1;
+			} else if (HP.IsKeyWord("stick" "slip")) {
+				//固着点との間の接線方向のばね, ダンパ
+				iFriction = 2;
+				kt = HP.GetReal();
+				if (kt <= 0.0) {
+					silent_cerr("Contactlaw(" << GetLabel() << "): tangential stiffness must be positive at line " << HP.GetLineData() << std::endl);
+					throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+				}
+				if (HP.IsKeyWord("damping")) {
+					ct = HP.GetReal();
+					if (ct < 0.0) {
+						silent_cerr("Contactlaw(" << GetLabel() << "): tangential damping must be non-negative at line " << HP.GetLineData() << std::endl);
+						throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+				}
+			} else if (!HP.IsKeyWord("projected")) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): unknown friction model at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("regularization")) {
+			const int iNum = sizeof(contactlaw_regularization)/sizeof(contactlaw_regularization[0]);
+			for (iRegularization = 0; iRegularization < iNum; iRegularization++) {
+				if (HP.IsKeyWord(contactlaw_regularization[iRegularization])) {
+					break;
+				}
+			}
+			if (iRegularization == iNum) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): unknown regularization at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			if (iRegularization == 7) {
+				//静摩擦から動摩擦へ移る速度
+				vs = HP.GetReal();
+				if (vs <= 0.0) {
+					silent_cerr("Contactlaw(" << GetLabel() << "): Stribeck velocity must be positive at line " << HP.GetLineData() << std::endl);
+					throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+				}
+			}
+		}
+		//ヤコビ行列を力の式の自動微分で求める(既定は手で導いた式)
+		if (HP.IsKeyWord("differentiation")) {
+			if (HP.IsKeyWord("automatic")) {
+				bAutomatic = true;
+			} else if (!HP.IsKeyWord("analytic")) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): unknown differentiation at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			if (bAutomatic && iFriction == 2) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): automatic differentiation is not available for stick slip friction at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	sLaw = std::string(contactlaw_normal[bClamped]) + " " + contactlaw_friction[iFriction];
+	if (iFriction == 2) {
+		//stick slipは正則化を使わない(名前にも含めない)
+		iRegularization = 0;
+	} else {
+		sLaw += std::string(" ") + contactlaw_regularization[iRegularization];
+	}
+	if (bAutomatic) {
+		sLaw += " automatic";
+	}
+	if (bClamped) {
+		SetLaw<clampednormal>(iFriction, iRegularization, bAutomatic);
+	} else {
+		SetLaw<kelvinnormal>(iFriction, iRegularization, bAutomatic);
+	}
+
+	// read jacobian reuse (optional)
+	//AssJacの寄与が前回と同じとみなす差(最大の要素に対する比, 既定は0: 完全に一致)
+	doublereal dReuseTol = 0.0;
+	if (HP.IsKeyWord("jacobian" "reuse")) {
+		dReuseTol = HP.GetReal();
+		if (dReuseTol < 0.0) {
+			silent_cerr("Contactlaw(" << GetLabel() << "): jacobian reuse tolerance must be non-negative at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	pjr.setValue(dReuseTol);
+
+	// read swept contact (optional)
+	//収束解の間の軌跡で衝突時刻を求め, 次の時間刻みの目安をprivate dataに出す
+	//(既定では貫入の上限なし: 海底面を通り抜けた節点だけが目安を小さくする)
+	bool bSwept = false;
+	doublereal dMaxPen = std::numeric_limits<doublereal>::max();
+	integer iSamples = 4;
+	if (HP.IsKeyWord("swept" "contact")) {
+		bSwept = true;
+		if (HP.IsKeyWord("max" "penetration")) {
+			dMaxPen = HP.GetReal();
+			if (dMaxPen <= 0.0) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): max penetration must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("samples")) {
+			iSamples = HP.GetInt();
+			if (iSamples < 1) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): number of samples must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	psw.setValue(2, bSwept, dMaxPen, unsigned(iSamples));
+
+	// read stable step (optional)
+	//接触の剛性, 減衰と節点の質量から次の時間刻みの目安をprivate dataに出す
+	//(factor: 安定限界に対する比, 既定0.1は接触の固有周期あたり約30ステップ)
+	bool bStable = false;
+	doublereal dMass[2] = { 0.0, 0.0 };
+	doublereal dFactor = 0.1;
+	if (HP.IsKeyWord("stable" "step")) {
+		bStable = true;
+		if (!HP.IsKeyWord("mass")) {
+			silent_cerr("Contactlaw(" << GetLabel() << "): keyword \"mass\" expected at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		for (int i = 0; i < 2; i++) {
+			dMass[i] = HP.GetReal();
+			if (dMass[i] <= 0.0) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): mass must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("factor")) {
+			dFactor = HP.GetReal();
+			if (dFactor <= 0.0) {
+				silent_cerr("Contactlaw(" << GetLabel() << "): factor must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	pss.setValue(2, bStable, dMass[0], dAccMax, dFactor);
+	pss.setMass(1, dMass[1]);
+
+	// read performance summary (optional)
+	//解析終了時に計算量の集計を表示する
+	pcc.setSummary(HP.IsKeyWord("performance" "summary"));
 
 	//output flag
 	SetOutputFlag(pDM->fReadOutput(HP, Elem::LOADABLE));
@@ -121,9 +444,13 @@ Contactlaw::Contactlaw (
 		<< " " << pNode1->GetLabel()
 		<< " " << pNode2->GetLabel()
 		<< " " << pSeabed->GetLabel()
+		<< " " << sLaw
+		<< (bMultiplier ? " lagrange multiplier" : " penalty")
+		<< (bSwept ? " swept" : "")
+		<< (bStable ? " stable step" : "")
 		<< std::endl;
 
-	std ::cout << "4" << std::endl;		
+	CONTACT_TRACE(CONTACT_TRACE_INFO, TRACE_LIFECYCLE, "Contactlaw created", uLabel, 0.0);
 }
 
 
@@ -131,8 +458,12 @@ Contactlaw::Contactlaw (
 //destructor
 Contactlaw::~Contactlaw (void)
 {
-	NO_OP;
-	std ::cout << "5" << std::endl;
+	if (pcc.bGetSummary()) {
+		std::ostringstream os;
+		pcc.summary(os);
+		silent_cout("Contactlaw(" << GetLabel() << "): " << os.str() << std::endl);
+	}
+	CONTACT_TRACE(CONTACT_TRACE_INFO, TRACE_LIFECYCLE, "Contactlaw destroyed", GetLabel(), 0.0);
 }
 
 
@@ -144,25 +475,26 @@ Contactlaw::~Contactlaw (void)
 unsigned int
 Contactlaw::iGetInitialNumDof(void) const
 {
-	return 0;
-	std ::cout << "6" << std::endl;
+	return iGetNumDof();
 }
 
 //set initial value
 void
 Contactlaw::SetInitialValue(VectorHandler& XCurr)
 {
-	return;
-	std ::cout << "7" << std::endl;
+	//初期値解析では接触を拘束しない(反力0)
+	const integer iFirstIndex = iGetFirstIndex();
+	for (unsigned int i = 1; i <= iGetInitialNumDof(); i++) {
+		XCurr.PutCoef(iFirstIndex + i, 0.0);
+	}
 }
 
 //set initial assembly matrix dimension
 void 
 Contactlaw::InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const
 {
-	*piNumRows = 0;
-	*piNumCols = 0;
-	std ::cout << "8" << std::endl;
+	*piNumRows = iGetInitialNumDof();
+	*piNumCols = iGetInitialNumDof();
 }
 
 //calculate residual vector for initial assembly analysis
@@ -171,9 +503,13 @@ Contactlaw::InitialAssRes(
 	SubVectorHandler& WorkVec,
 	const VectorHandler& XCurr)
 {
-	WorkVec.ResizeReset(0);
+	//lambda = 0
+	const integer iFirstIndex = iGetFirstIndex();
+	WorkVec.ResizeReset(iGetInitialNumDof());
+	for (unsigned int i = 1; i <= iGetInitialNumDof(); i++) {
+		WorkVec.PutItem(i, iFirstIndex + i, -XCurr(iFirstIndex + i));
+	}
 	return WorkVec;
-	std ::cout << "9" << std::endl;
 }
 
 //calculate Jaconbian for initial assembly analysis
@@ -182,9 +518,18 @@ Contactlaw::InitialAssJac(
 	VariableSubMatrixHandler& WorkMat, 
 	const VectorHandler& XCurr)
 {
-	WorkMat.SetNullMatrix();
+	if (iGetInitialNumDof() == 0) {
+		WorkMat.SetNullMatrix();
+		return WorkMat;
+	}
+
+	const integer iFirstIndex = iGetFirstIndex();
+	SparseSubMatrixHandler& WM = WorkMat.SetSparse();
+	WM.ResizeReset(iGetInitialNumDof(), 0);
+	for (unsigned int i = 1; i <= iGetInitialNumDof(); i++) {
+		WM.PutItem(i, iFirstIndex + i, iFirstIndex + i, 1.0);
+	}
 	return WorkMat;
-	std ::cout << "10" << std::endl;
 }
 
 /*=======================================================================================
@@ -194,16 +539,22 @@ Contactlaw::InitialAssJac(
 unsigned int
 Contactlaw::iGetNumDof(void) const
 {
-	return 0;
-	std ::cout << "11" << std::endl;
+	//lagrange multiplier: 節点ごとの法線方向の反力
+	return bMultiplier ? 2 : 0;
 }
 
 //set DOF type
 DofOrder::Order
 Contactlaw::GetDofType(unsigned int i) const
 {
-	return DofOrder::DIFFERENTIAL;
-	std ::cout << "12" << std::endl;
+	return DofOrder::ALGEBRAIC;
+}
+
+//set equation type
+DofOrder::Order
+Contactlaw::GetEqType(unsigned int i) const
+{
+	return DofOrder::ALGEBRAIC;
 }
 
 //set initial value
@@ -214,18 +565,35 @@ Contactlaw::SetValue(
 	VectorHandler& XP,
 	SimulationEntity::Hints *ph)
 {
-	return;
-	std ::cout << "13" << std::endl;
+	//前ステップで確定した反力から始める
+	const integer iFirstIndex = iGetFirstIndex();
+	for (unsigned int i = 1; i <= iGetNumDof(); i++) {
+		X.PutCoef(iFirstIndex + i, dLambda[i - 1]);
+		XP.PutCoef(iFirstIndex + i, 0.0);
+	}
 }
 
 //print explanation of variables and equations
 std::ostream&
 Contactlaw::DescribeDof(std::ostream& out, const char *prefix, bool bInitial) const
 {
+	if (iGetNumDof() > 0) {
+		const integer iFirstIndex = iGetFirstIndex();
+		out << prefix << iFirstIndex + 1 << "->" << iFirstIndex + 2 << ": "
+			"normal reactions [lambda1, lambda2]" << std::endl;
+	}
+	return out;
 }
 std::ostream&
 Contactlaw::DescribeEq(std::ostream& out, const char *prefix, bool bInitial) const
 {
+	if (iGetNumDof() > 0) {
+		const integer iFirstIndex = iGetFirstIndex();
+		out << prefix << iFirstIndex + 1 << "->" << iFirstIndex + 2 << ": "
+			<< (bInitial ? "zero reactions [lambda1, lambda2]" : "non-penetration or zero reaction [gap1, gap2]")
+			<< std::endl;
+	}
+	return out;
 }
 
 
@@ -233,9 +601,545 @@ Contactlaw::DescribeEq(std::ostream& out, const char *prefix, bool bInitial) con
 void
 Contactlaw::WorkSpaceDim(integer* piNumRows, integer* piNumCols) const
 {
-	*piNumRows = 6;
-	*piNumCols = 6;	
-	//std ::cout << "14" << std::endl;
+	//residual: 3 rows per node (+ 1 per multiplier)
+	//Jacobian: sparse, at most 18 (penalty) or 30 (multiplier) entries
+	*piNumRows = 6 + iGetNumDof();
+	*piNumCols = bMultiplier ? 4 : 3;
+}
+
+
+//seabed height and unit normal below the node
+void
+Contactlaw::Surface(int i, const Vec3& r, doublereal& Zs, Vec3& normal_vec) const
+{
+	//メッシュの探索は前回の三角形から始める
+	pSeabed->surface(r, Zs, normal_vec, pHint[i]);
+}
+
+void
+Contactlaw::SweepSurface(const void *pCtx, std::size_t i, const Vec3& r,
+	doublereal& Zs, Vec3& normal_vec)
+{
+	static_cast<const Contactlaw *>(pCtx)->Surface(int(i), r, Zs, normal_vec);
+}
+
+//soil constants and friction parameters below the node
+void
+Contactlaw::Soil(int i, const Vec3& r, doublereal& ks, doublereal& cs, frictionparam& fp) const
+{
+	doublereal g, z;
+	pSeabed->get(g, z, fp.nu1d, fp.nu1s, fp.nu2d, fp.nu2s, fp.vt);
+	fp.dcrit 	= CONTACTPOLICY_DCRIT;
+	fp.kt 		= kt;
+	fp.ct 		= ct;
+	fp.vs 		= vs;
+
+	//土質区分をまたがない限り前回の区分を使う
+	const soilprop *p = pSeabed->soil(r.dGet(1), r.dGet(2), pSoilHint[i]);
+	if (p == 0) {
+		//区分外はContactlawとSeabedの値
+		ks = k;
+		cs = c;
+		return;
+	}
+	ks = p->k;
+	cs = p->c;
+	fp.nu1d = p->nu1d;
+	fp.nu1s = p->nu1s;
+	fp.nu2d = p->nu2d;
+	fp.nu2s = p->nu2s;
+}
+
+//calculate local frame of node1 and node2
+void
+Contactlaw::Frame(
+	const Vec3& r1, const Vec3& r2,
+	const Vec3 normal_vec[2], Vec3 axial_unitvec[2], Vec3 lateral_unitvec[2]) const
+{
+	(this->*pFrame)(r1, r2, normal_vec, axial_unitvec, lateral_unitvec);
+}
+
+template <class Law>
+void
+Contactlaw::LawFrame(
+	const Vec3& r1, const Vec3& r2,
+	const Vec3 normal_vec[2], Vec3 axial_unitvec[2], Vec3 lateral_unitvec[2]) const
+{
+	//係留軸を含むように座標返還(法線は節点ごとの海底面の法線)
+	const Vec3 internode_vec = r2 - r1;
+	for (int i = 0; i < 2; i++) {
+		//法線と節点間方向が平行なときは代わりの座標系(縮退として数える)
+		if (!Law::frame(normal_vec[i], internode_vec, pFrameCache[i], axial_unitvec[i], lateral_unitvec[i])) {
+			pcc.degenerate();
+		}
+	}
+}
+
+//local frame reused across iterations
+void
+Contactlaw::CachedFrame(
+	const Vec3& r1, const Vec3& r2,
+	Vec3 normal_vec[2], Vec3 axial_unitvec[2], Vec3 lateral_unitvec[2])
+{
+	//接触状態が切り替わらない限り, 予測時(AfterPredict)に作った座標系を使い回す
+	if (pcs.bFrame(0) && pcs.bFrame(1)) {
+		for (int i = 0; i < 2; i++) {
+			normal_vec[i] 		= pcs.get(i).normal_vec;
+			axial_unitvec[i] 	= pcs.get(i).axial_unitvec;
+			lateral_unitvec[i] 	= pcs.get(i).lateral_unitvec;
+		}
+		return;
+	}
+
+	doublereal Zs;
+	Surface(0, r1, Zs, normal_vec[0]);
+	Surface(1, r2, Zs, normal_vec[1]);
+	Frame(r1, r2, normal_vec, axial_unitvec, lateral_unitvec);
+	for (int i = 0; i < 2; i++) {
+		pcs.setFrame(i, normal_vec[i], axial_unitvec[i], lateral_unitvec[i]);
+	}
+}
+
+//calculate contact forces of node1 and node2
+void
+Contactlaw::ContactForce(
+	const Vec3& r1, const Vec3& v1,
+	const Vec3& r2, const Vec3& v2,
+	const doublereal Zs[2],
+	const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+	Vec3& f1, Vec3& f2, frictionstate fs[2], const doublereal *pReaction) const
+{
+	(this->*pContactForce)(r1, v1, r2, v2, Zs, normal_vec, axial_unitvec, lateral_unitvec, f1, f2, fs, pReaction);
+}
+
+template <class Law>
+void
+Contactlaw::LawContactForce(
+	const Vec3& r1, const Vec3& v1,
+	const Vec3& r2, const Vec3& v2,
+	const doublereal Zs[2],
+	const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+	Vec3& f1, Vec3& f2, frictionstate fs[2], const doublereal *pReaction) const
+{
+	//節点位置の土質(弾性床定数, 摩擦係数)
+	doublereal k1, c1, k2, c2;
+	frictionparam fp1, fp2;
+	Soil(0, r1, k1, c1, fp1);
+	Soil(1, r2, k2, c2, fp2);
+
+	//摩擦の状態は前ステップで確定したものから求める(反復中は確定しない)
+	frictionstate fs_tmp[2];
+	if (fs == 0) {
+		fs = fs_tmp;
+	}
+	if (pReaction != 0) {
+		//法線方向の反力はLagrange乗数
+		Law::multiplierforce(f1, fs[0], r1, v1, normal_vec[0], axial_unitvec[0], lateral_unitvec[0],
+			pReaction[0], fp1, pcs.getCommitted(0).friction);
+		Law::multiplierforce(f2, fs[1], r2, v2, normal_vec[1], axial_unitvec[1], lateral_unitvec[1],
+			pReaction[1], fp2, pcs.getCommitted(1).friction);
+		return;
+	}
+	//node1
+	Law::force(f1, fs[0], r1, v1, normal_vec[0], axial_unitvec[0], lateral_unitvec[0], Zs[0], k1, c1,
+		fp1, pcs.getCommitted(0).friction);
+	//node2
+	Law::force(f2, fs[1], r2, v2, normal_vec[1], axial_unitvec[1], lateral_unitvec[1], Zs[1], k2, c2,
+		fp2, pcs.getCommitted(1).friction);
+}
+
+//calculate 6x6 Jacobian
+void
+Contactlaw::ContactJacobian(
+	const Vec3& r1, const Vec3& v1,
+	const Vec3& r2, const Vec3& v2,
+	const doublereal Zs[2],
+	const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+	doublereal dCoef, doublereal J[6][6], const doublereal *pReaction, Vec3 *pdf_dR) const
+{
+	(this->*pContactJacobian)(r1, v1, r2, v2, Zs, normal_vec, axial_unitvec, lateral_unitvec, dCoef, J,
+		pReaction, pdf_dR);
+}
+
+template <class Law>
+void
+Contactlaw::LawContactJacobian(
+	const Vec3& r1, const Vec3& v1,
+	const Vec3& r2, const Vec3& v2,
+	const doublereal Zs[2],
+	const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+	doublereal dCoef, doublereal J[6][6], const doublereal *pReaction, Vec3 *pdf_dR) const
+{
+	doublereal k1, c1, k2, c2;
+	frictionparam fp1, fp2;
+	Soil(0, r1, k1, c1, fp1);
+	Soil(1, r2, k2, c2, fp2);
+
+	/*
+	 * 平らな海底面では接線方向の射影 P = a a^T + l l^T が節点位置によらないため,
+	 * node1-node2間の連成ブロックは0になる(回転自由度とも連成しない).
+	 * 海底地形がある場合も, 海底面は節点の下で局所的に平面とみなし,
+	 * 法線と座標系の位置微分(曲率の項)は省略する.
+	 */
+	doublereal J1[3][3], J2[3][3];
+	if (pReaction != 0) {
+		Law::multiplierjacobian(J1, pdf_dR[0], r1, v1, normal_vec[0], axial_unitvec[0], lateral_unitvec[0],
+			pReaction[0], fp1, pcs.getCommitted(0).friction, dCoef);
+		Law::multiplierjacobian(J2, pdf_dR[1], r2, v2, normal_vec[1], axial_unitvec[1], lateral_unitvec[1],
+			pReaction[1], fp2, pcs.getCommitted(1).friction, dCoef);
+	} else {
+		Law::jacobian(J1, r1, v1, normal_vec[0], axial_unitvec[0], lateral_unitvec[0], Zs[0], k1, c1,
+			fp1, pcs.getCommitted(0).friction, dCoef);
+		Law::jacobian(J2, r2, v2, normal_vec[1], axial_unitvec[1], lateral_unitvec[1], Zs[1], k2, c2,
+			fp2, pcs.getCommitted(1).friction, dCoef);
+	}
+
+	for (int i = 0; i < 6; i++) {
+		for (int j = 0; j < 6; j++) {
+			J[i][j] = 0.0;
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			J[i][j] 		= J1[i][j];
+			J[i + 3][j + 3] = J2[i][j];
+		}
+	}
+}
+
+//Jacobian-vector product of node1 and node2
+void
+Contactlaw::ContactJacobianVector(
+	const Vec3& r1, const Vec3& v1,
+	const Vec3& r2, const Vec3& v2,
+	const doublereal Zs[2],
+	const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+	doublereal dCoef, const Vec3 y[2], Vec3 Jy[2], const doublereal *pReaction, Vec3 *pdf_dR) const
+{
+	(this->*pContactJacobianVector)(r1, v1, r2, v2, Zs, normal_vec, axial_unitvec, lateral_unitvec,
+		dCoef, y, Jy, pReaction, pdf_dR);
+}
+
+template <class Law>
+void
+Contactlaw::LawContactJacobianVector(
+	const Vec3& r1, const Vec3& v1,
+	const Vec3& r2, const Vec3& v2,
+	const doublereal Zs[2],
+	const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+	doublereal dCoef, const Vec3 y[2], Vec3 Jy[2], const doublereal *pReaction, Vec3 *pdf_dR) const
+{
+	doublereal k1, c1, k2, c2;
+	frictionparam fp1, fp2;
+	Soil(0, r1, k1, c1, fp1);
+	Soil(1, r2, k2, c2, fp2);
+
+	//LawContactJacobianと同じ3x3ブロックの方向微分(連成ブロックは0)
+	if (pReaction != 0) {
+		Law::multiplierjacobianvector(Jy[0], pdf_dR[0], r1, v1, normal_vec[0], axial_unitvec[0], lateral_unitvec[0],
+			pReaction[0], fp1, pcs.getCommitted(0).friction, y[0], dCoef);
+		Law::multiplierjacobianvector(Jy[1], pdf_dR[1], r2, v2, normal_vec[1], axial_unitvec[1], lateral_unitvec[1],
+			pReaction[1], fp2, pcs.getCommitted(1).friction, y[1], dCoef);
+		return;
+	}
+	Law::jacobianvector(Jy[0], r1, v1, normal_vec[0], axial_unitvec[0], lateral_unitvec[0], Zs[0], k1, c1,
+		fp1, pcs.getCommitted(0).friction, y[0], dCoef);
+	Law::jacobianvector(Jy[1], r2, v2, normal_vec[1], axial_unitvec[1], lateral_unitvec[1], Zs[1], k2, c2,
+		fp2, pcs.getCommitted(1).friction, y[1], dCoef);
+}
+
+//first impact of node i on the path of the last step
+void
+Contactlaw::Sweep(int i, const Vec3& r, const Vec3& v, const doublereal& gap, const doublereal& dt)
+{
+	//前回の収束解で浮いていた節点だけ調べる
+	doublereal tau, vn;
+	if (!psw.find(i, r, v, gap, dt, &Contactlaw::SweepSurface, this, tau, vn)) {
+		return;
+	}
+	psw.impact(tau, vn, gap, dt);
+	CONTACT_TRACE(CONTACT_TRACE_DEBUG, TRACE_CONTACT,
+		gap > 0.0 ? "node tunnelled" : "node impact",
+		(i == 0 ? pNode1 : pNode2)->GetLabel(), tau);
+}
+
+//compare analytic Jacobian with central differences of ContactForce
+void
+Contactlaw::CheckJacobian(
+	const Vec3& r1, const Vec3& v1,
+	const Vec3& r2, const Vec3& v2,
+	doublereal dCoef, const doublereal J[6][6]) const
+{
+	//x = [r1, r2], xp = [v1, v2]
+	doublereal x[6] 	= { r1(1), r1(2), r1(3), r2(1), r2(2), r2(3) };
+	doublereal xp[6] 	= { v1(1), v1(2), v1(3), v2(1), v2(2), v2(3) };
+
+	doublereal Jfd[6][6];
+	for (int j = 0; j < 6; j++) {
+		doublereal res[2][2][6];
+		for (int iVar = 0; iVar < 2; iVar++) {
+			//iVar = 0: position, iVar = 1: velocity
+			doublereal *p = (iVar == 0) ? x : xp;
+			doublereal p0 = p[j];
+			doublereal h = std::sqrt(std::numeric_limits<doublereal>::epsilon())*std::max(1.0, std::abs(p0));
+			for (int iSide = 0; iSide < 2; iSide++) {
+				p[j] = (iSide == 0) ? p0 + h : p0 - h;
+				//座標系の変化も含めて差分をとる
+				Vec3 f1, f2;
+				doublereal Zs[2];
+				Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+				Surface(0, Vec3(x[0], x[1], x[2]), Zs[0], normal_vec[0]);
+				Surface(1, Vec3(x[3], x[4], x[5]), Zs[1], normal_vec[1]);
+				Frame(Vec3(x[0], x[1], x[2]), Vec3(x[3], x[4], x[5]),
+					normal_vec, axial_unitvec, lateral_unitvec);
+				ContactForce(Vec3(x[0], x[1], x[2]), Vec3(xp[0], xp[1], xp[2]),
+					Vec3(x[3], x[4], x[5]), Vec3(xp[3], xp[4], xp[5]),
+					Zs, normal_vec, axial_unitvec, lateral_unitvec, f1, f2);
+				for (int i = 0; i < 3; i++) {
+					res[iVar][iSide][i] 	= f1(i + 1);
+					res[iVar][iSide][i + 3] = f2(i + 1);
+				}
+			}
+			p[j] = p0;
+			for (int i = 0; i < 6; i++) {
+				res[iVar][0][i] = (res[iVar][0][i] - res[iVar][1][i])/(2.0*h);
+			}
+		}
+		for (int i = 0; i < 6; i++) {
+			Jfd[i][j] = -(res[1][0][i] + dCoef*res[0][0][i]);
+		}
+	}
+
+	doublereal dErrMax = 0.0;
+	doublereal dJMax = 0.0;
+	int iErr = 0, jErr = 0;
+	for (int i = 0; i < 6; i++) {
+		for (int j = 0; j < 6; j++) {
+			doublereal dErr = std::abs(J[i][j] - Jfd[i][j]);
+			if (dErr > dErrMax) {
+				dErrMax = dErr;
+				iErr = i;
+				jErr = j;
+			}
+			dJMax = std::max(dJMax, std::abs(Jfd[i][j]));
+		}
+	}
+
+	if (dErrMax > dJacCheckTol*std::max(1.0, dJMax)) {
+		//AssJacは複数のスレッドから呼ばれうるので, 1行をまとめて書く
+		std::ostringstream os;
+		os << "Contactlaw(" << GetLabel() << "): jacobian check failed, "
+			"J(" << iErr + 1 << "," << jErr + 1 << ")=" << J[iErr][jErr]
+			<< " fd=" << Jfd[iErr][jErr]
+			<< " max error=" << dErrMax << "\n";
+		silent_cerr(os.str() << std::flush);
+	}
+}
+
+
+/*
+ * Lagrange乗数による接触(enforcement, lagrange multiplier)
+ *  自由度: 節点ごとの法線方向の反力 lambda_i (algebraic)
+ *  接触中(active set):  f_i = lambda_i n_i + ft(lambda_i),  gap_i/dCoef = 0
+ *  離脱中:              f_i = 0,                           lambda_i = 0
+ *  active setは反復ごとに lambda_i - k gap_i > 0 で決める(半平滑Newton法).
+ *  収束解ではlambda >= 0, gap >= 0, lambda gap = 0 となり, 貫入量はkによらない.
+ */
+bool
+Contactlaw::bMultiplierActive(const doublereal& gap, const doublereal& lambda) const
+{
+	return lambda - k*gap > 0.0;
+}
+
+SubVectorHandler&
+Contactlaw::MultiplierAssRes(
+	SubVectorHandler& WorkVec,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	const integer iFirstIndex = iGetFirstIndex();
+	const integer iPositionIndex[2] = {
+		pNode1->iGetFirstPositionIndex(),
+		pNode2->iGetFirstPositionIndex()
+	};
+	const integer iMomentumIndex[2] = {
+		pNode1->iGetFirstMomentumIndex(),
+		pNode2->iGetFirstMomentumIndex()
+	};
+	pcc.active(2);
+
+	integer iNumRows;
+	integer iNumCols;
+	WorkSpaceDim(&iNumRows, &iNumCols);
+	WorkVec.ResizeReset(iNumRows);
+
+	Vec3 r[2], v[2];
+	doublereal Zs[2], gap[2], lambda[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	for (int i = 0; i < 2; i++) {
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			WorkVec.PutRowIndex(3*i + iCnt, iMomentumIndex[i] + iCnt);
+		}
+		WorkVec.PutRowIndex(7 + i, iFirstIndex + 1 + i);
+
+		r[i] = Vec3(XCurr(iPositionIndex[i]+1), XCurr(iPositionIndex[i]+2), XCurr(iPositionIndex[i]+3));
+		v[i] = Vec3(XPrimeCurr(iPositionIndex[i]+1), XPrimeCurr(iPositionIndex[i]+2), XPrimeCurr(iPositionIndex[i]+3));
+		Surface(i, r[i], Zs[i], normal_vec[i]);
+		gap[i] = (r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3);
+		lambda[i] = XCurr(iFirstIndex + 1 + i);
+		if (pcs.update(i, gap[i])) {
+			pcc.flip();
+		}
+	}
+	CachedFrame(r[0], r[1], normal_vec, axial_unitvec, lateral_unitvec);
+
+	//離脱中の節点は反力0
+	doublereal dReaction[2];
+	for (int i = 0; i < 2; i++) {
+		if (bMultiplierActive(gap[i], lambda[i])) {
+			dReaction[i] = lambda[i];
+			WorkVec.PutCoef(7 + i, gap[i]/dCoef);
+		} else {
+			dReaction[i] = 0.0;
+			WorkVec.PutCoef(7 + i, -lambda[i]);
+		}
+	}
+
+	Vec3 f[2];
+	ContactForce(r[0], v[0], r[1], v[1], Zs, normal_vec, axial_unitvec, lateral_unitvec,
+		f[0], f[1], 0, dReaction);
+	WorkVec.Put(1, f[0]);
+	WorkVec.Put(4, f[1]);
+	return WorkVec;
+}
+
+VariableSubMatrixHandler&
+Contactlaw::MultiplierAssJac(
+	VariableSubMatrixHandler& WorkMat,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	const integer iFirstIndex = iGetFirstIndex();
+	const integer iPositionIndex[2] = {
+		pNode1->iGetFirstPositionIndex(),
+		pNode2->iGetFirstPositionIndex()
+	};
+	const integer iMomentumIndex[2] = {
+		pNode1->iGetFirstMomentumIndex(),
+		pNode2->iGetFirstMomentumIndex()
+	};
+
+	Vec3 r[2], v[2];
+	doublereal Zs[2], gap[2], lambda[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	for (int i = 0; i < 2; i++) {
+		r[i] = Vec3(XCurr(iPositionIndex[i]+1), XCurr(iPositionIndex[i]+2), XCurr(iPositionIndex[i]+3));
+		v[i] = Vec3(XPrimeCurr(iPositionIndex[i]+1), XPrimeCurr(iPositionIndex[i]+2), XPrimeCurr(iPositionIndex[i]+3));
+		Surface(i, r[i], Zs[i], normal_vec[i]);
+		gap[i] = (r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3);
+		lambda[i] = XCurr(iFirstIndex + 1 + i);
+	}
+	CachedFrame(r[0], r[1], normal_vec, axial_unitvec, lateral_unitvec);
+
+	bool bActive[2];
+	doublereal dReaction[2];
+	for (int i = 0; i < 2; i++) {
+		bActive[i] = bMultiplierActive(gap[i], lambda[i]);
+		dReaction[i] = bActive[i] ? lambda[i] : 0.0;
+	}
+
+	doublereal J[6][6];
+	Vec3 df_dR[2];
+	ContactJacobian(r[0], v[0], r[1], v[1], Zs, normal_vec, axial_unitvec, lateral_unitvec,
+		dCoef, J, dReaction, df_dR);
+
+	//接触中: 3x3ブロック, 反力の列と拘束の行(15), 離脱中: lambda_i = 0 (1)
+	SparseSubMatrixHandler& WM = WorkMat.SetSparse();
+	WM.ResizeReset((bActive[0] ? 15 : 1) + (bActive[1] ? 15 : 1), 1);
+	integer iEntry = 1;
+	for (int i = 0; i < 2; i++) {
+		const integer iLambda = iFirstIndex + 1 + i;
+		if (!bActive[i]) {
+			WM.PutItem(iEntry++, iLambda, iLambda, 1.0);
+			pjr.put(iLambda, iLambda, 1.0);
+			continue;
+		}
+		for (int iRow = 1; iRow <= 3; iRow++) {
+			for (int iCol = 1; iCol <= 3; iCol++) {
+				const doublereal& d = J[3*i + iRow - 1][3*i + iCol - 1];
+				WM.PutItem(iEntry++, iMomentumIndex[i] + iRow, iPositionIndex[i] + iCol, d);
+				pjr.put(iMomentumIndex[i] + iRow, iPositionIndex[i] + iCol, d);
+			}
+		}
+		//d(gap/dCoef)/dr = n/dCoef (海底面の曲率は省略), df/dlambda = n + dft/dF
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			WM.PutItem(iEntry++, iMomentumIndex[i] + iCnt, iLambda, -df_dR[i](iCnt));
+			pjr.put(iMomentumIndex[i] + iCnt, iLambda, -df_dR[i](iCnt));
+			WM.PutItem(iEntry++, iLambda, iPositionIndex[i] + iCnt, -normal_vec[i](iCnt));
+			pjr.put(iLambda, iPositionIndex[i] + iCnt, -normal_vec[i](iCnt));
+		}
+	}
+
+	return WorkMat;
+}
+
+//MultiplierAssJacと同じ行列とYの積
+void
+Contactlaw::MultiplierAssJac(
+	VectorHandler& JacY,
+	const VectorHandler& Y,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	const integer iFirstIndex = iGetFirstIndex();
+	const integer iPositionIndex[2] = {
+		pNode1->iGetFirstPositionIndex(),
+		pNode2->iGetFirstPositionIndex()
+	};
+	const integer iMomentumIndex[2] = {
+		pNode1->iGetFirstMomentumIndex(),
+		pNode2->iGetFirstMomentumIndex()
+	};
+
+	Vec3 r[2], v[2], y[2];
+	doublereal Zs[2], gap[2], lambda[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	for (int i = 0; i < 2; i++) {
+		r[i] = Vec3(XCurr(iPositionIndex[i]+1), XCurr(iPositionIndex[i]+2), XCurr(iPositionIndex[i]+3));
+		v[i] = Vec3(XPrimeCurr(iPositionIndex[i]+1), XPrimeCurr(iPositionIndex[i]+2), XPrimeCurr(iPositionIndex[i]+3));
+		y[i] = Vec3(Y(iPositionIndex[i]+1), Y(iPositionIndex[i]+2), Y(iPositionIndex[i]+3));
+		Surface(i, r[i], Zs[i], normal_vec[i]);
+		gap[i] = (r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3);
+		lambda[i] = XCurr(iFirstIndex + 1 + i);
+	}
+	CachedFrame(r[0], r[1], normal_vec, axial_unitvec, lateral_unitvec);
+
+	bool bActive[2];
+	doublereal dReaction[2];
+	for (int i = 0; i < 2; i++) {
+		bActive[i] = bMultiplierActive(gap[i], lambda[i]);
+		dReaction[i] = bActive[i] ? lambda[i] : 0.0;
+	}
+
+	Vec3 Jy[2], df_dR[2];
+	ContactJacobianVector(r[0], v[0], r[1], v[1], Zs, normal_vec, axial_unitvec, lateral_unitvec,
+		dCoef, y, Jy, dReaction, df_dR);
+
+	for (int i = 0; i < 2; i++) {
+		const integer iLambda = iFirstIndex + 1 + i;
+		const doublereal dY = Y(iLambda);
+		if (!bActive[i]) {
+			JacY.IncCoef(iLambda, dY);
+			continue;
+		}
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			JacY.IncCoef(iMomentumIndex[i] + iCnt, Jy[i](iCnt) - df_dR[i](iCnt)*dY);
+		}
+		JacY.IncCoef(iLambda, -normal_vec[i].Dot(y[i]));
+	}
 }
 
 
@@ -247,6 +1151,20 @@ Contactlaw::AssRes(
 	const VectorHandler& XCurr, 
 	const VectorHandler& XPrimeCurr)
 {
+	contacttimer timer(pcc, contactcounters::ASSRES);
+
+	if (bMultiplier) {
+		return MultiplierAssRes(WorkVec, dCoef, XCurr, XPrimeCurr);
+	}
+
+	//どちらの節点も海底面に届かない場合は何もしない
+	const std::size_t iNumActive = pas.iGetNumActive(pDataManager->dGetTime());
+	pcc.active(iNumActive);
+	if (iNumActive == 0) {
+		WorkVec.ResizeReset(0);
+		return WorkVec;
+	}
+
 	/*configuring current vector deta------------------------------------------*/
 	/*current node data--------------------------------------------------*/
 	//node1
@@ -256,11 +1174,6 @@ Contactlaw::AssRes(
 	const integer iPositionIndex2 = pNode2->iGetFirstPositionIndex();
 	const integer iMomentumIndex2 = pNode2->iGetFirstMomentumIndex();
 
-	/*calculate refrecionforces------------------------------------*/
-	//seabedの定数定義
-	doublereal g,Zs, nu1d, nu1s, nu2d, nu2s, vt;
-	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
-
 	/*nodedata_config-----------------------------------------------*/
 	const Vec3 r1 = Vec3(
 			XCurr(iPositionIndex1+1),
@@ -296,134 +1209,36 @@ Contactlaw::AssRes(
 		WorkVec.PutRowIndex(iCnt+3, iMomentumIndex2+iCnt);
 	}
 
-	//node1===================================================================
-
-	doublereal c1;
-	/*ベクトルの初期値定義------------------------------------------------*/  
-
-	Vec3 normal_vec_1 			= Vec3(0.0,0.0,0.0);
-	Vec3 internode_unitvec_1 	= Vec3(0.0,0.0,0.0);
-	Vec3 axial_unitvec_1 		= Vec3(0.0,0.0,0.0);
-	Vec3 lateral_unitvec_1 		= Vec3(0.0,0.0,0.0);
+	/*接触状態の更新------------------------------------------------*/
+	//海底面の高さは反復ごとに現在位置で求める
+	doublereal Zs[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	Surface(0, r1, Zs[0], normal_vec[0]);
+	Surface(1, r2, Zs[1], normal_vec[1]);
+	const doublereal gap[2] = {
+		(r1.dGet(3) - Zs[0])*normal_vec[0].dGet(3),
+		(r2.dGet(3) - Zs[1])*normal_vec[1].dGet(3)
+	};
+	for (int i = 0; i < 2; i++) {
+		if (pcs.update(i, gap[i])) {
+			pcc.flip();
+			CONTACT_TRACE(CONTACT_TRACE_DEBUG, TRACE_CONTACT,
+				pcs.get(i).bContact ? "node touchdown" : "node liftoff",
+				(i == 0 ? pNode1 : pNode2)->GetLabel(), gap[i]);
+		}
+	}
 
-	doublereal z1    	= r1.dGet(3) - Zs;
-	doublereal vz1   	= v1.dGet(3);
-	doublereal delta1 	= std::abs(z1);
+	CachedFrame(r1, r2, normal_vec, axial_unitvec, lateral_unitvec);
 
-	/*反力計算-----------------------------------------------------------*/
-	if (z1>0.0) {
-		c1 = 0.0;
-		std::cout << "Res00" << std::endl;
-	} else {
-		c1 = 1.0;
-		//tanh(x)を使って静摩擦から動摩擦の移行を表現
-	}
-
-	//弾性床からの反力計算
-	doublereal F1  = (k*delta1 -c*vz1)*c1;
-
-	/*摩擦力計算----------------------------------------------------------*/
-	//摩擦係数
-	doublereal nu1 = nu1d;
-	/*ベクトル------------------------------------------------------------*/
-
-	//係留軸を含むように座標返還
-	////normal_vec
-	pexv.normal_vec(normal_vec_1);
-	////internode_vec
-	pexv.internode_vec(internode_unitvec_1, r1, r2);
-	////lateralnode_vec
-	pexv.lateral_vec(lateral_unitvec_1, normal_vec_1, internode_unitvec_1, r1, r2);
-	////axialnode_vec
-	pexv.axial_vec(axial_unitvec_1, normal_vec_1, lateral_unitvec_1, r1, r2);
-
-	//摩擦力の負荷方向を質点の速度ベクトルをaxial(係留軸),lateral(係留軸横方向)で分解してそれぞれの反対方向に負荷させる
-	////axial(axial_unitvecとv1の正射影)
-	Vec3 friction_axialvec_1 		=  -pexv.op_vec(v1, axial_unitvec_1);
-	////lateral(lateral_unitvecとv1の正射影)
-	Vec3 friction_lateralvec_1 		=  -pexv.op_vec(v1, lateral_unitvec_1);
-
-	//step関数で摩擦力の推移表現
-	doublereal dcrit 			= 2.5; 
-	doublereal x_tanh_1   		= v1.Norm()/vt;
-	doublereal friction_abs_1	= ptanhf.tanh(x_tanh_1, dcrit)*nu1*F1;
-	Vec3 f_friction_axial_1 	= Vec3(
-							friction_abs_1*friction_axialvec_1.dGet(1),
-							friction_abs_1*friction_axialvec_1.dGet(2),
-							friction_abs_1*friction_axialvec_1.dGet(3) + F1
-	);
-	Vec3 f_friction_lateral_1 	= Vec3(
-							friction_abs_1*friction_lateralvec_1.dGet(1),
-							friction_abs_1*friction_lateralvec_1.dGet(2),
-							friction_abs_1*friction_lateralvec_1.dGet(3) 
-	);
-
-	//node2===================================================================
-	doublereal c2;
-	///摩擦力計算時のFと摩擦係数定義
-	doublereal F2;
-
-	Vec3 normal_vec_2 			= Vec3(0.0,0.0,0.0);
-
-	doublereal z2    	= r2.dGet(3) - Zs;
-	doublereal vz2   	= v2.dGet(3);
-	doublereal delta2 	= std::abs(z2);
-
-	/*反力計算-----------------------------------------------------------*/
-	if (z2>0.0) {
-		c2 = 0.0;
-		std::cout << "Res00" << std::endl;
-	} else {
-		c2 = 1.0;
-		//tanh(x)を使って静摩擦から動摩擦の移行を表現
-	}
-
-	//弾性床からの反力計算
-	F2           = (k*delta2 -c*vz2)*c2;
-
-	/*摩擦力計算----------------------------------------------------------*/
-	//摩擦係数
-	doublereal nu2 = nu1d;
-	/*ベクトル------------------------------------------------------------*/
-
-	//係留軸を含むように座標返還
-	////normal_vec
-	pexv.normal_vec(normal_vec_2);
-	/*以下はnode1と共有している内容なので計算の重複を避けるため省略*/
-	////internode_vec
-	//pexv.internode_vec(internode_unitvec_1, r1, r2);
-	////lateralnode_vec
-	//pexv.lateral_vec(lateral_unitvec_1, normal_vec_1, internode_unitvec_1, r1, r2);
-	////axialnode_vec
-	//pexv.axial_vec(axial_unitvec_1, normal_vec_1, lateral_unitvec_1, r1, r2);
-
-
-	//摩擦力の負荷方向を質点の速度ベクトルをaxial(係留軸),lateral(係留軸横方向)で分解してそれぞれの反対方向に負荷させる
-	////axial(axial_unitvecとv1の正射影)
-	Vec3 friction_axialvec_2 		=  -pexv.op_vec(v2, axial_unitvec_1);
-	////lateral(lateral_unitvecとv1の正射影)
-	Vec3 friction_lateralvec_2 		=  -pexv.op_vec(v2, lateral_unitvec_1);
-
-	//step関数で摩擦力の推移表現
-	//doublereal dcrit 			= 2.5; 
-	doublereal x_tanh_2   		= v2.Norm()/vt;
-	doublereal friction_abs_2	= ptanhf.tanh(x_tanh_2, dcrit)*nu2*F2;
-	Vec3 f_friction_axial_2 	= Vec3(
-								friction_abs_2*friction_axialvec_2.dGet(1),
-								friction_abs_2*friction_axialvec_2.dGet(2),
-								friction_abs_2*friction_axialvec_2.dGet(3) + F2
-	);
-	Vec3 f_friction_lateral_2 	= Vec3(
-								friction_abs_2*friction_lateralvec_2.dGet(1),
-								friction_abs_2*friction_lateralvec_2.dGet(2),
-								friction_abs_2*friction_lateralvec_2.dGet(3)
-	);
+	/*反力, 摩擦力計算------------------------------------------------*/
+	Vec3 f1, f2;
+	ContactForce(r1, v1, r2, v2, Zs, normal_vec, axial_unitvec, lateral_unitvec, f1, f2);
+	CONTACT_TRACE(CONTACT_TRACE_VERBOSE, TRACE_ASSEMBLY, "Contactlaw AssRes", GetLabel(), f1.dGet(3) + f2.dGet(3));
 
 	//WorkVecに代入
-	WorkVec.Put(1, f_friction_axial_1 + f_friction_lateral_1);
-	WorkVec.Put(4, f_friction_axial_2 + f_friction_lateral_2);
+	WorkVec.Put(1, f1);
+	WorkVec.Put(4, f2);
 	return WorkVec;
-	std ::cout << "15" << std::endl;
 }
 
 
@@ -435,66 +1250,173 @@ Contactlaw::AssJac(
 	const VectorHandler& XCurr,
 	const VectorHandler& XPrimeCurr)
 {
-	FullSubMatrixHandler& WM = WorkMat.SetFull();
+	contacttimer timer(pcc, contactcounters::ASSJAC);
 
-	//node1 current data
-	const integer iMomentumIndex1 = pNode1->iGetFirstMomentumIndex();
-	const integer iPositionIndex1 = pNode1->iGetFirstPositionIndex();
-	const Vec3& r1 = pNode1->GetXCurr();
-
-
-	//node2 current data
-	const integer iMomentumIndex2 = pNode2->iGetFirstMomentumIndex();
-	const integer iPositionIndex2 = pNode2->iGetFirstPositionIndex();
-	const Vec3& r2 = pNode2->GetXCurr();
+	//組み込んだ要素を記録し, 前回のAssJacと同じかを判定する(private data)
+	pjr.begin();
+	if (bMultiplier) {
+		MultiplierAssJac(WorkMat, dCoef, XCurr, XPrimeCurr);
+	} else {
+		PenaltyAssJac(WorkMat, dCoef, XCurr, XPrimeCurr);
+	}
+	pcc.unchanged(pjr.end());
 
+	return WorkMat;
+}
 
-	//obtain vector dimension
-	integer iNumRows;
-	integer iNumCols;
-	WorkSpaceDim(&iNumRows, &iNumCols);
-	WM.ResizeReset(iNumRows, iNumCols);
+/*
+ * Jacobian-vector product (matrix-free solvers)
+ *  AssJacと同じ行列Aを作らずに JacY += A Y を求める.
+ *  節点ごとに方向微分 -(df/dv y + dCoef df/dr y) を計算するので,
+ *  必要な記憶領域は節点あたりVec3数個で, 3x3ブロックと行列の索引を持たない.
+ *  行列を作らないのでjacobian check, jacobian reuseの対象外.
+ */
+void
+Contactlaw::AssJac(
+	VectorHandler& JacY,
+	const VectorHandler& Y,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr,
+	VariableSubMatrixHandler& WorkMat)
+{
+	contacttimer timer(pcc, contactcounters::ASSJAC);
 
-	for(int iCnt = 1; iCnt<=3; iCnt++){
-		WM.PutRowIndex(iCnt, iMomentumIndex1+iCnt);
-		WM.PutColIndex(iCnt, iPositionIndex1+iCnt);
-	}	
+	if (bMultiplier) {
+		MultiplierAssJac(JacY, Y, dCoef, XCurr, XPrimeCurr);
+	} else {
+		PenaltyAssJac(JacY, Y, dCoef, XCurr, XPrimeCurr);
+	}
+}
 
-	for(int iCnt = 1; iCnt<=3; iCnt++){
-		WM.PutRowIndex(iCnt+3, iMomentumIndex2+iCnt);
-		WM.PutColIndex(iCnt+3, iPositionIndex2+iCnt);
+VariableSubMatrixHandler&
+Contactlaw::PenaltyAssJac(
+	VariableSubMatrixHandler& WorkMat,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	if (!pas.bAnyActive(pDataManager->dGetTime())) {
+		WorkMat.SetNullMatrix();
+		return WorkMat;
 	}
 
+	//node1, node2 current data
+	const integer iPositionIndex[2] = {
+		pNode1->iGetFirstPositionIndex(),
+		pNode2->iGetFirstPositionIndex()
+	};
+	const integer iMomentumIndex[2] = {
+		pNode1->iGetFirstMomentumIndex(),
+		pNode2->iGetFirstMomentumIndex()
+	};
+	Vec3 r[2], v[2];
+	for (int i = 0; i < 2; i++) {
+		r[i] = Vec3(XCurr(iPositionIndex[i]+1), XCurr(iPositionIndex[i]+2), XCurr(iPositionIndex[i]+3));
+		v[i] = Vec3(XPrimeCurr(iPositionIndex[i]+1), XPrimeCurr(iPositionIndex[i]+2), XPrimeCurr(iPositionIndex[i]+3));
+	}
 
-	//calculate forces
-	/*
-	doublereal g,Zs, nu1d, nu1s, nu2d, nu2s;
-	pSeabed->get(g, Zs, nu1d, nu1s, nu2d, nu2s);
-	doublereal A;
-	doublereal dc1_dx;
-	doublereal dF_dx;
-
-		doublereal z = XCurr(iPositionIndex+3) - Zs;
-		doublereal v = XPrimeCurr(iPositionIndex+3);
-		doublereal z = XCurr(iPositionIndex1+3) - Zs;
-		doublereal v = XPrimeCurr(iPositionIndex1+3);
-	if (z>0.0) {
-	dc1_dx = 0.0;
-	std::cout << "Jac00" << std::endl;
-	} else {
-	dc1_dx = 1.0;
-	std::cout << "Jac01" << std::endl;
+	//calculate Jacobian, A = -F_{\dot{y}} - dCoef F_{y}
+	doublereal Zs[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	Surface(0, r[0], Zs[0], normal_vec[0]);
+	Surface(1, r[1], Zs[1], normal_vec[1]);
+
+	//接触している節点の3x3ブロックだけを疎行列として組み込む
+	//(node1-node2間の連成ブロックは0, LawContactJacobian参照)
+	bool bContact[2];
+	integer iNumContact = 0;
+	for (int i = 0; i < 2; i++) {
+		bContact[i] = ((r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3) <= 0.0);
+		iNumContact += bContact[i] ? 1 : 0;
+	}
+	if (iNumContact == 0) {
+		WorkMat.SetNullMatrix();
+		return WorkMat;
 	}
 
-	A = (-c - dCoef*k)*dc1_dx;
+	CachedFrame(r[0], r[1], normal_vec, axial_unitvec, lateral_unitvec);
 
+	doublereal J[6][6];
+	ContactJacobian(r[0], v[0], r[1], v[1], Zs, normal_vec, axial_unitvec, lateral_unitvec, dCoef, J);
+	//差分で確かめるのはpenaltyのときだけ
+	if (bJacCheck) {
+		CheckJacobian(r[0], v[0], r[1], v[1], dCoef, J);
+	}
 
 	// set value
-	//どう計算すればよいのか相談
-	WM.PutCoef( 1,  1, A );
-	*/
+	SparseSubMatrixHandler& WM = WorkMat.SetSparse();
+	WM.ResizeReset(9*iNumContact, 1);
+	integer iEntry = 1;
+	for (int i = 0; i < 2; i++) {
+		if (!bContact[i]) {
+			continue;
+		}
+		for (int iRow = 1; iRow <= 3; iRow++) {
+			for (int iCol = 1; iCol <= 3; iCol++) {
+				const doublereal& d = J[3*i + iRow - 1][3*i + iCol - 1];
+				WM.PutItem(iEntry++, iMomentumIndex[i] + iRow, iPositionIndex[i] + iCol, d);
+				pjr.put(iMomentumIndex[i] + iRow, iPositionIndex[i] + iCol, d);
+			}
+		}
+	}
+
 	return WorkMat;
-	std ::cout << "16" << std::endl;
+}
+
+//PenaltyAssJacと同じ行列とYの積
+void
+Contactlaw::PenaltyAssJac(
+	VectorHandler& JacY,
+	const VectorHandler& Y,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	if (!pas.bAnyActive(pDataManager->dGetTime())) {
+		return;
+	}
+
+	const integer iPositionIndex[2] = {
+		pNode1->iGetFirstPositionIndex(),
+		pNode2->iGetFirstPositionIndex()
+	};
+	const integer iMomentumIndex[2] = {
+		pNode1->iGetFirstMomentumIndex(),
+		pNode2->iGetFirstMomentumIndex()
+	};
+	Vec3 r[2], v[2], y[2];
+	for (int i = 0; i < 2; i++) {
+		r[i] = Vec3(XCurr(iPositionIndex[i]+1), XCurr(iPositionIndex[i]+2), XCurr(iPositionIndex[i]+3));
+		v[i] = Vec3(XPrimeCurr(iPositionIndex[i]+1), XPrimeCurr(iPositionIndex[i]+2), XPrimeCurr(iPositionIndex[i]+3));
+		y[i] = Vec3(Y(iPositionIndex[i]+1), Y(iPositionIndex[i]+2), Y(iPositionIndex[i]+3));
+	}
+
+	doublereal Zs[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	Surface(0, r[0], Zs[0], normal_vec[0]);
+	Surface(1, r[1], Zs[1], normal_vec[1]);
+
+	bool bContact[2];
+	for (int i = 0; i < 2; i++) {
+		bContact[i] = ((r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3) <= 0.0);
+	}
+	if (!bContact[0] && !bContact[1]) {
+		return;
+	}
+
+	CachedFrame(r[0], r[1], normal_vec, axial_unitvec, lateral_unitvec);
+
+	Vec3 Jy[2];
+	ContactJacobianVector(r[0], v[0], r[1], v[1], Zs, normal_vec, axial_unitvec, lateral_unitvec, dCoef, y, Jy);
+	for (int i = 0; i < 2; i++) {
+		if (!bContact[i]) {
+			continue;
+		}
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			JacY.IncCoef(iMomentumIndex[i] + iCnt, Jy[i](iCnt));
+		}
+	}
 }
 
 
@@ -505,51 +1427,44 @@ Contactlaw::AssJac(
 unsigned int
 Contactlaw::iGetNumPrivData(void) const
 {
-	return 0;
-	std ::cout << "17" << std::endl;
+	return contactcounters::iGetNumPrivData() + contactsweep::iGetNumPrivData()
+		+ stablestep::iGetNumPrivData();
 }
 
-/*
 //set index of private data
 unsigned int
-Hydrostatic::iGetPrivDataIdx(const char *s) const
-{	
-	static const struct {
-		int index;
-		char name[3];
+Contactlaw::iGetPrivDataIdx(const char *s) const
+{
+	unsigned int i = pcc.iGetPrivDataIdx(s);
+	if (i == 0) {
+		//swept contact follows the counters
+		i = psw.iGetPrivDataIdx(s);
+		i = (i == 0) ? 0 : contactcounters::iGetNumPrivData() + i;
 	}
-
-	data[] = {
-			{ 1, "A"},
-			{ 2, "B"},
-			{ 3, "C"},
-	};
-
-	for (unsigned i = 0; i < sizeof(data) / sizeof(data[0]); ++i ) {
-		if (0 == strcmp(data[i].name,s)) {
-			return data[i].index;
-		}
+	if (i == 0) {
+		//stable step follows swept contact
+		i = pss.iGetPrivDataIdx(s);
+		i = (i == 0) ? 0 : contactcounters::iGetNumPrivData() + contactsweep::iGetNumPrivData() + i;
 	}
-
-	silent_cerr("Hydrostatic (" << GetLabel() << "): no private data \"" << s << "\"" << std::endl);
-
-	return 0;	
+	if (i == 0) {
+		silent_cerr("Contactlaw(" << GetLabel() << "): no private data \"" << s << "\"" << std::endl);
+	}
+	return i;
 }
 //function to get private data
 doublereal
-Hydrostatic::dGetPrivData(unsigned int i) const;
+Contactlaw::dGetPrivData(unsigned int i) const
 {
-	switch (i) {
-	case 1:
-		return a;
-	case 2:
-		return b;
-	case 3:
-		return c;
+	const unsigned int iSweep = contactcounters::iGetNumPrivData();
+	const unsigned int iStable = iSweep + contactsweep::iGetNumPrivData();
+	if (i > iStable) {
+		return pss.dGetPrivData(i - iStable);
 	}
-	throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+	if (i > iSweep) {
+		return psw.dGetPrivData(i - iSweep);
+	}
+	return pcc.dGetPrivData(i);
 }
-*/
 
 /*=======================================================================================
 * Configure runtime processing
@@ -559,7 +1474,6 @@ void
 Contactlaw::Update(const VectorHandler& XCurr, const VectorHandler& XPrimeCurr)
 {
 	return;
-	std ::cout << "18" << std::endl;
 }
 //process before each iteration
 void
@@ -569,21 +1483,122 @@ Contactlaw::BeforePredict(VectorHandler& /* X */ ,
 					VectorHandler& /* XPPrev */ ) const
 {
 	return;
-	std ::cout << "19" << std::endl;
 }
 //process after each iteration
 void
 Contactlaw::AfterPredict(VectorHandler& X, VectorHandler& XP)
 {
+	//確定した状態と予測位置から, 次ステップの接触状態と座標系を予測
+	const integer iPositionIndex1 = pNode1->iGetFirstPositionIndex();
+	const integer iPositionIndex2 = pNode2->iGetFirstPositionIndex();
+	const Vec3 r1 = Vec3(X(iPositionIndex1+1), X(iPositionIndex1+2), X(iPositionIndex1+3));
+	const Vec3 r2 = Vec3(X(iPositionIndex2+1), X(iPositionIndex2+2), X(iPositionIndex2+3));
+
+	doublereal Zs[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	Surface(0, r1, Zs[0], normal_vec[0]);
+	Surface(1, r2, Zs[1], normal_vec[1]);
+	doublereal gap[2] = {
+		(r1.dGet(3) - Zs[0])*normal_vec[0].dGet(3),
+		(r2.dGet(3) - Zs[1])*normal_vec[1].dGet(3)
+	};
+
+	//前回の収束解から予測解までの軌跡で衝突すれば, 予測解の貫入は衝突と整合する見積もりにする
+	//(通り抜けた予測解も接触として予測する)
+	if (psw.bGetEnabled()) {
+		const doublereal dt = pDataManager->pGetDrvHdl()->dGetTimeStep();
+		const Vec3 v[2] = {
+			Vec3(XP(iPositionIndex1+1), XP(iPositionIndex1+2), XP(iPositionIndex1+3)),
+			Vec3(XP(iPositionIndex2+1), XP(iPositionIndex2+2), XP(iPositionIndex2+3))
+		};
+		psw.beginPredict();
+		gap[0] = psw.predict(0, r1, v[0], gap[0], dt, &Contactlaw::SweepSurface, this);
+		gap[1] = psw.predict(1, r2, v[1], gap[1], dt, &Contactlaw::SweepSurface, this);
+	}
+	pcs.predict(0, gap[0]);
+	pcs.predict(1, gap[1]);
+
+	Frame(r1, r2, normal_vec, axial_unitvec, lateral_unitvec);
+	for (int i = 0; i < 2; i++) {
+		pcs.setFrame(i, normal_vec[i], axial_unitvec[i], lateral_unitvec[i]);
+	}
 	return;
-	std ::cout << "20" << std::endl;
 }
 //process after convergence (each time step)
 void
 Contactlaw::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 {
+	//浮いている節点の再評価時刻を更新
+	const doublereal t = pDataManager->dGetTime();
+	const doublereal dt = pDataManager->pGetDrvHdl()->dGetTimeStep();
+
+	const integer iPositionIndex[2] = {
+		pNode1->iGetFirstPositionIndex(),
+		pNode2->iGetFirstPositionIndex()
+	};
+	Vec3 r[2], v[2];
+	doublereal Zs[2];
+	Vec3 normal_vec[2], axial_unitvec[2], lateral_unitvec[2];
+	if (psw.bGetEnabled()) {
+		psw.begin(dt);
+	}
+	for (int i = 0; i < 2; i++) {
+		r[i] = Vec3(X(iPositionIndex[i]+1), X(iPositionIndex[i]+2), X(iPositionIndex[i]+3));
+		v[i] = Vec3(XP(iPositionIndex[i]+1), XP(iPositionIndex[i]+2), XP(iPositionIndex[i]+3));
+
+		//法線方向の隙間と接近速度
+		Surface(i, r[i], Zs[i], normal_vec[i]);
+		doublereal gap = (r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3);
+		pas.update(i, r[i], v[i], t, dt, Seabed::UpperBound, pSeabed);
+
+		//このステップの軌跡での衝突(海底面の探索の起点は終点に戻す)
+		if (psw.bGetEnabled()) {
+			Sweep(i, r[i], v[i], gap, dt);
+			psw.commit(i, r[i], v[i], gap);
+			Surface(i, r[i], Zs[i], normal_vec[i]);
+		}
+
+		//接触状態(接触の有無, 貫入量, 座標系, すべり方向)を確定
+		pcs.update(i, gap);
+		pcs.setSlip(i, v[i]);
+	}
+
+	//収束解の反力(lagrange multiplier)
+	doublereal dReaction[2] = { 0.0, 0.0 };
+	if (bMultiplier) {
+		const integer iFirstIndex = iGetFirstIndex();
+		for (int i = 0; i < 2; i++) {
+			dLambda[i] = X(iFirstIndex + 1 + i);
+			const doublereal gap = (r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3);
+			dReaction[i] = bMultiplierActive(gap, dLambda[i]) ? dLambda[i] : 0.0;
+		}
+	}
+
+	//収束解での固着/すべりと固着点を確定
+	Vec3 f[2];
+	frictionstate fs[2];
+	CachedFrame(r[0], r[1], normal_vec, axial_unitvec, lateral_unitvec);
+	ContactForce(r[0], v[0], r[1], v[1], Zs, normal_vec, axial_unitvec, lateral_unitvec, f[0], f[1], fs,
+		bMultiplier ? dReaction : 0);
+	for (int i = 0; i < 2; i++) {
+		pcs.setFriction(i, fs[i]);
+	}
+	pcs.commit();
+
+	//収束解の接触力から次の時間刻みの目安
+	if (pss.bGetEnabled()) {
+		pss.begin();
+		for (int i = 0; i < 2; i++) {
+			doublereal ks, cs;
+			frictionparam fp;
+			Soil(i, r[i], ks, cs, fp);
+			const doublereal gap = (r[i].dGet(3) - Zs[i])*normal_vec[i].dGet(3);
+			const doublereal nu = std::max(std::max(fp.nu1d, fp.nu1s), std::max(fp.nu2d, fp.nu2s));
+			pss.update(i, (i == 0 ? pNode1 : pNode2)->GetLabel(), r[i], v[i], gap,
+				ks, cs, kt, ct, f[i].Dot(normal_vec[i]), nu, fp.vt, Seabed::UpperBound, pSeabed);
+		}
+	}
 	return;
-	std ::cout << "21" << std::endl;
 }
 
 /*=======================================================================================
@@ -595,11 +1610,24 @@ Contactlaw::Output(OutputHandler& OH) const
 {
 	if (bToBeOutput()) {
 		if (OH.UseText(OutputHandler::LOADABLE)) {
+			//label, contact1, contact2, flips(last step), predicted flips(last step), flips(total), stick1, stick2
+			//[, lambda1, lambda2 (lagrange multiplier)]
 			OH.Loadable() << GetLabel()
-				<< std::endl;
+				<< " " << pcs.getCommitted(0).bContact
+				<< " " << pcs.getCommitted(1).bContact
+				<< " " << pcs.iGetFlips()
+				<< " " << pcs.iGetPredicted()
+				<< " " << pcs.iGetFlipsTotal()
+				<< " " << pcs.getCommitted(0).friction.bStick
+				<< " " << pcs.getCommitted(1).friction.bStick;
+			if (bMultiplier) {
+				//normal reactions
+				OH.Loadable() << " " << dLambda[0] << " " << dLambda[1];
+			}
+			OH.Loadable() << std::endl;
 		}
 	}
-	std ::cout << "22" << std::endl;
+	CONTACT_TRACE(CONTACT_TRACE_VERBOSE, TRACE_OUTPUT, "Contactlaw output", GetLabel(), pDataManager->dGetTime());
 }
 
 
@@ -612,20 +1640,17 @@ int
 Contactlaw::iGetNumConnectedNodes(void) const
 {
 	return 0;
-	std ::cout << "23" << std::endl;
 }
 void
 Contactlaw::GetConnectedNodes(std::vector<const Node *>& connectedNodes) const
 {
 	return;
-	std ::cout << "24" << std::endl;
 }
 //output restart file
 std::ostream&
 Contactlaw::Restart(std::ostream& out) const
 {
 	return out << "# Contactlaw (" << GetLabel() << "): not implemented yet" << std::endl;
-	std ::cout << "25" << std::endl;
 }
 
 /* ----------------------------- Contactlaw end -------------------------------------- */
@@ -645,6 +1670,18 @@ int module_init(const char *module_name, void *pdm, void *php)
 		return false;
 	}
 
+	rf = new UDERead<ContactChain>;
+	if (!SetUDE("ContactChain", rf)) {
+		delete rf;
+		return false;
+	}
+
+	rf = new UDERead<LineContact>;
+	if (!SetUDE("LineContact", rf)) {
+		delete rf;
+		return false;
+	}
+
 	if (!UDEset) {
 		silent_cerr("Contactlaw: "
 			"module_init(" << module_name << ") "
@@ -653,5 +1690,4 @@ int module_init(const char *module_name, void *pdm, void *php)
 	}
 
 	return 0;
-	std ::cout << "26" << std::endl;
 }
\ No newline at end of file
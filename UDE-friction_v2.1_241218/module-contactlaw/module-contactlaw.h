@@ -39,12 +39,25 @@
 #ifndef MODULE_CONTACTLAW_H
 #define MODULE_CONTACTLAW_H
 
+#include <string>
+
 #include "dataman.h"
 #include "userelem.h"
 #include "module-seabed.h"
-#include "exchangevector.h"
-#include "tanhfunc.h"
+#include "contactpolicy.h"
+#include "activeset.h"
+#include "contactstate.h"
+#include "contactcounters.h"
+#include "jacobianreuse.h"
+#include "contactsweep.h"
+#include "stablestep.h"
 
+/*
+ * 並列の組み込み(MBDynが要素をスレッドに分けて組み込む場合)
+ *  AssRes, AssJacが書き換えるのはこの要素のメンバ(状態, 座標系, hint, カウンタ)だけで,
+ *  Seabedはconstの参照(地形, 土質の探索位置はhintとして要素が持つ)しか使わない.
+ *  組み込み中に標準出力へは書かない(記録はcontacttraceのスレッドごとのバッファ).
+ */
 class Contactlaw
 : virtual public Elem, public UserDefinedElem 
 {
@@ -56,12 +69,133 @@ private:
 	const StructNode *pNode1;
 	const StructNode *pNode2;
 	const Seabed 			*pSeabed;
-	const tanhfunc 			ptanhf;
-	const exchangevector	pexv; 
+	const DataManager 		*pDataManager;
 	doublereal 				k;
 	doublereal 				c;
+	//tangential stiffness and damping of the stick anchor (stick slip friction)
+	doublereal 				kt;
+	doublereal 				ct;
+	//Stribeck velocity (stribeck regularization)
+	doublereal 				vs;
+	//non-penetration enforced by Lagrange multipliers (private DOFs) instead of penalty
+	bool 					bMultiplier;
+	//normal reactions at the last converged step (multiplier mode)
+	doublereal 				dLambda[2];
+	//finite difference check of AssJac
+	bool 					bJacCheck;
+	doublereal 				dJacCheckTol;
+	//airborne node culling
+	activeset 				pas;
+	//contact state cache
+	contactstate 			pcs;
+	//last triangle of each node (triangle mesh seabed)
+	mutable trimeshhint 	pHint[2];
+	//last soil zone of each node
+	mutable soilhint 		pSoilHint[2];
+	//performance counters (private data)
+	mutable contactcounters pcc;
+	//entries of the last AssJac (unchanged flag)
+	jacobianreuse 			pjr;
+	//swept contact of each node between converged steps (time step hint)
+	contactsweep 			psw;
+	//time step bound from the contact stiffness and the nodal masses
+	stablestep 				pss;
+	//frame of each node reused while the segment direction does not change
+	mutable framecache 		pFrameCache[2];
+	//contact law selected at parse time (see SetLaw)
+	std::string 			sLaw;
+	void (Contactlaw::*pFrame)(const Vec3& r1, const Vec3& r2,
+		const Vec3 normal_vec[2], Vec3 axial_unitvec[2], Vec3 lateral_unitvec[2]) const;
+	void (Contactlaw::*pContactForce)(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		Vec3& f1, Vec3& f2, frictionstate fs[2], const doublereal *pReaction) const;
+	void (Contactlaw::*pContactJacobian)(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		doublereal dCoef, doublereal J[6][6], const doublereal *pReaction, Vec3 *pdf_dR) const;
+	void (Contactlaw::*pContactJacobianVector)(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		doublereal dCoef, const Vec3 y[2], Vec3 Jy[2], const doublereal *pReaction, Vec3 *pdf_dR) const;
 private:
-	
+	//select one of the pre-instantiated contact laws
+	template <class Law> void SetLaw(void);
+	//bAutomatic: Jacobian by forward-mode automatic differentiation (contactdual.h)
+	template <class Law> void SetLaw(bool bAutomatic);
+	template <class NormalModel, class FrictionModel>
+	void SetLaw(int iRegularization, bool bAutomatic);
+	template <class NormalModel>
+	void SetLaw(int iFriction, int iRegularization, bool bAutomatic);
+	//instantiations of Frame, ContactForce, ContactJacobian and ContactJacobianVector for each law
+	template <class Law>
+	void LawFrame(const Vec3& r1, const Vec3& r2,
+		const Vec3 normal_vec[2], Vec3 axial_unitvec[2], Vec3 lateral_unitvec[2]) const;
+	template <class Law>
+	void LawContactForce(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		Vec3& f1, Vec3& f2, frictionstate fs[2], const doublereal *pReaction) const;
+	template <class Law>
+	void LawContactJacobian(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		doublereal dCoef, doublereal J[6][6], const doublereal *pReaction, Vec3 *pdf_dR) const;
+	template <class Law>
+	void LawContactJacobianVector(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		doublereal dCoef, const Vec3 y[2], Vec3 Jy[2], const doublereal *pReaction, Vec3 *pdf_dR) const;
+
+	//seabed height and unit normal below the node
+	void Surface(int i, const Vec3& r, doublereal& Zs, Vec3& normal_vec) const;
+	//same, as a callback for contactsweep (pCtx: the Contactlaw)
+	static void SweepSurface(const void *pCtx, std::size_t i, const Vec3& r,
+		doublereal& Zs, Vec3& normal_vec);
+	//soil constants (k, c) and friction parameters below the node
+	void Soil(int i, const Vec3& r, doublereal& ks, doublereal& cs, frictionparam& fp) const;
+	//calculate local frame of node1 and node2 from the seabed normals
+	void Frame(const Vec3& r1, const Vec3& r2,
+		const Vec3 normal_vec[2], Vec3 axial_unitvec[2], Vec3 lateral_unitvec[2]) const;
+	//local frame reused until the contact state flips
+	void CachedFrame(const Vec3& r1, const Vec3& r2,
+		Vec3 normal_vec[2], Vec3 axial_unitvec[2], Vec3 lateral_unitvec[2]);
+	//calculate contact forces of node1 and node2 (fs: friction state to be committed)
+	void ContactForce(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		Vec3& f1, Vec3& f2, frictionstate fs[2] = 0, const doublereal *pReaction = 0) const;
+	//calculate 6x6 Jacobian, J = -(df/dv + dCoef*df/dr)
+	//(pReaction: normal reactions given, pdf_dR: df_i/dR_i in multiplier mode)
+	void ContactJacobian(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		doublereal dCoef, doublereal J[6][6], const doublereal *pReaction = 0, Vec3 *pdf_dR = 0) const;
+	//Jy_i = J_ii y_i without forming J (y_i: increments of the position of node i)
+	void ContactJacobianVector(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		const doublereal Zs[2],
+		const Vec3 normal_vec[2], const Vec3 axial_unitvec[2], const Vec3 lateral_unitvec[2],
+		doublereal dCoef, const Vec3 y[2], Vec3 Jy[2], const doublereal *pReaction = 0, Vec3 *pdf_dR = 0) const;
+	//node i is in the active set of the multiplier mode
+	bool bMultiplierActive(const doublereal& gap, const doublereal& lambda) const;
+	//Jacobian of the penalty mode (3x3 blocks of the nodes in contact)
+	VariableSubMatrixHandler& PenaltyAssJac(VariableSubMatrixHandler& WorkMat, doublereal dCoef,
+		const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+	//residual and Jacobian of the multiplier mode (8 rows: node1, node2, constraints)
+	SubVectorHandler& MultiplierAssRes(SubVectorHandler& WorkVec, doublereal dCoef,
+		const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+	VariableSubMatrixHandler& MultiplierAssJac(VariableSubMatrixHandler& WorkMat, doublereal dCoef,
+		const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+	//JacY += A Y of the penalty and multiplier modes
+	void PenaltyAssJac(VectorHandler& JacY, const VectorHandler& Y, doublereal dCoef,
+		const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+	void MultiplierAssJac(VectorHandler& JacY, const VectorHandler& Y, doublereal dCoef,
+		const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+	//first impact of node i on the path of the last step (r, v, gap: end of the step)
+	void Sweep(int i, const Vec3& r, const Vec3& v, const doublereal& gap, const doublereal& dt);
+	//compare J with central differences of ContactForce
+	void CheckJacobian(const Vec3& r1, const Vec3& v1, const Vec3& r2, const Vec3& v2,
+		doublereal dCoef, const doublereal J[6][6]) const;
 
 
 public:
@@ -111,6 +245,8 @@ public:
 	virtual unsigned int iGetNumDof(void) const;
 	//set DOF type
 	virtual DofOrder::Order GetDofType(unsigned int i) const;
+	//set equation type
+	virtual DofOrder::Order GetEqType(unsigned int i) const;
 	//set initial value
 	void SetValue(DataManager *pDM, VectorHandler& X, VectorHandler& XP,
 		SimulationEntity::Hints *ph);
@@ -140,6 +276,14 @@ public:
 		doublereal dCoef, 
 		const VectorHandler& XCurr,
 		const VectorHandler& XPrimeCurr);
+	//calculate JacY += A Y without assembling A (matrix-free solvers)
+	virtual void
+	AssJac(VectorHandler& JacY,
+		const VectorHandler& Y,
+		doublereal dCoef,
+		const VectorHandler& XCurr,
+		const VectorHandler& XPrimeCurr,
+		VariableSubMatrixHandler& WorkMat);
 
 
 	/*===================================================================
@@ -150,12 +294,10 @@ public:
 	 *-------------------------------------------------------------------*/
 	//set number of private data
 	virtual unsigned int iGetNumPrivData(void) const;
-	/*
 	//set index of private data
 	virtual unsigned int iGetPrivDataIdx(const char *s) const;
 	//function to get private data
 	virtual doublereal dGetPrivData(unsigned int i) const;
-	*/
 
 	/*-------------------------------------------------------------------
 	 * Configure runtime processing
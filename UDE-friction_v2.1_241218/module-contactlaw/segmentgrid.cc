@@ -0,0 +1,143 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <stdint.h>
+#include <iostream>
+
+#include "except.h"
+#include "segmentgrid.h"
+
+/* ------------------------------ segmentgrid start ---------------------------------------*/
+segmentgrid::segmentgrid(void)
+: h(1.0), hinv(1.0)
+{
+	NO_OP;
+}
+
+segmentgrid::~segmentgrid(void)
+{
+	NO_OP;
+}
+
+/*--[0]setValue-------------------------------------------------------------------------*/
+void
+segmentgrid::setValue(const doublereal& h)
+{
+	if (!(h > 0.0)) {
+		silent_cerr("segmentgrid: cell size must be positive" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	this->h = h;
+	hinv = 1.0/h;
+}
+
+/*--[1]セルの番号---------------------------------------------------------------------*/
+inline long long
+segmentgrid::cell(const doublereal& x) const
+{
+	//32bitに収まらない座標は端のセルにまとめる
+	const doublereal dLim = 2147483647.0;
+	doublereal u = std::floor(x*hinv);
+	u = (u < -dLim) ? -dLim : ((u > dLim) ? dLim : u);
+	return (long long)u;
+}
+
+inline unsigned long long
+segmentgrid::key(long long ix, long long iy)
+{
+	return (static_cast<unsigned long long>(static_cast<uint32_t>(static_cast<int32_t>(ix))) << 32)
+		| static_cast<unsigned long long>(static_cast<uint32_t>(static_cast<int32_t>(iy)));
+}
+
+inline std::size_t
+segmentgrid::bucket(unsigned long long iKey, std::size_t iMask)
+{
+	//Fibonacci hashing (上位のbitを使う)
+	return std::size_t((iKey*0x9E3779B97F4A7C15ULL) >> 32) & iMask;
+}
+
+/*--[2]pairs(箱の登録と候補の組)------------------------------------------------------*/
+void
+segmentgrid::pairs(std::size_t n, const Vec3 *lo, const Vec3 *hi,
+	std::vector<std::pair<std::size_t, std::size_t> >& out)
+{
+	out.clear();
+
+	//箱ごとのセルの範囲と登録数
+	ixlo.resize(n); iylo.resize(n); ixhi.resize(n); iyhi.resize(n);
+	std::size_t iNumEntries = 0;
+	for (std::size_t i = 0; i < n; i++) {
+		ixlo[i] = cell(lo[i].dGet(1));
+		iylo[i] = cell(lo[i].dGet(2));
+		ixhi[i] = cell(hi[i].dGet(1));
+		iyhi[i] = cell(hi[i].dGet(2));
+		iNumEntries += std::size_t((ixhi[i] - ixlo[i] + 1)*(iyhi[i] - iylo[i] + 1));
+	}
+
+	//登録数の2倍以上の2のべき乗のbucket
+	std::size_t iNumBuckets = 16;
+	while (iNumBuckets < 2*iNumEntries) {
+		iNumBuckets *= 2;
+	}
+	const std::size_t iMask = iNumBuckets - 1;
+
+	//bucketごとに数えて並べる(counting sort)
+	iStart.assign(iNumBuckets + 1, 0);
+	for (std::size_t i = 0; i < n; i++) {
+		for (long long ix = ixlo[i]; ix <= ixhi[i]; ix++) {
+			for (long long iy = iylo[i]; iy <= iyhi[i]; iy++) {
+				iStart[bucket(key(ix, iy), iMask) + 1]++;
+			}
+		}
+	}
+	for (std::size_t b = 0; b < iNumBuckets; b++) {
+		iStart[b + 1] += iStart[b];
+	}
+	entries.resize(iNumEntries);
+	std::vector<std::size_t> iFill(iStart.begin(), iStart.end() - 1);
+	for (std::size_t i = 0; i < n; i++) {
+		for (long long ix = ixlo[i]; ix <= ixhi[i]; ix++) {
+			for (long long iy = iylo[i]; iy <= iyhi[i]; iy++) {
+				const unsigned long long iKey = key(ix, iy);
+				entry& e = entries[iFill[bucket(iKey, iMask)]++];
+				e.iSeg = i;
+				e.iKey = iKey;
+			}
+		}
+	}
+
+	//同じセルの箱どうし(bucketには別のセルも入りうる)
+	for (std::size_t b = 0; b < iNumBuckets; b++) {
+		for (std::size_t p = iStart[b]; p < iStart[b + 1]; p++) {
+			const std::size_t i = entries[p].iSeg;
+			for (std::size_t q = p + 1; q < iStart[b + 1]; q++) {
+				const std::size_t j = entries[q].iSeg;
+				if (entries[q].iKey != entries[p].iKey) {
+					continue;
+				}
+
+				//3次元の箱の重なり
+				bool bOverlap = true;
+				for (unsigned short k = 1; k <= 3; k++) {
+					if (lo[i].dGet(k) > hi[j].dGet(k) || lo[j].dGet(k) > hi[i].dGet(k)) {
+						bOverlap = false;
+						break;
+					}
+				}
+				if (!bOverlap) {
+					continue;
+				}
+
+				//重なりの最小の角を含むセルでだけ報告する
+				const long long ix = (ixlo[i] > ixlo[j]) ? ixlo[i] : ixlo[j];
+				const long long iy = (iylo[i] > iylo[j]) ? iylo[i] : iylo[j];
+				if (key(ix, iy) != entries[p].iKey) {
+					continue;
+				}
+				out.push_back((i < j) ? std::make_pair(i, j) : std::make_pair(j, i));
+			}
+		}
+	}
+}
+
+/* ------------------------------ segmentgrid end -----------------------------------------*/
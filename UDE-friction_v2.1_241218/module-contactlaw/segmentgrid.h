@@ -0,0 +1,58 @@
+#ifndef SEGMENTGRID_H
+#define SEGMENTGRID_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Segment Grid
+ *  線分(capsuleの外接箱)どうしの接触候補を求める(broadphase).
+ *  海底面に沿った(x, y)平面の等間隔格子(セルの大きさh)を毎回作り直すハッシュ表に
+ *  線分の箱を登録し, 同じセルに入った箱のうち重なるものだけを組にする.
+ *  セルがhより大きい線分の数程度なら, 1本の線分が調べる相手は近くの線分だけで,
+ *  線分の総数や本数には(ほぼ)よらない.
+ *
+ *  同じ組が複数のセルに入るときは, 2つの箱の重なりの(x, y)最小の角を含むセルでだけ
+ *  報告する(重複を取り除くための並べ替えが要らない).
+ *  組の順序はセルの登録順で決まり, 同じ入力からは同じ順序になる.
+ * ================================================= */
+class segmentgrid
+{
+private:
+    struct entry
+    {
+        std::size_t iSeg;
+        unsigned long long iKey;
+    };
+
+    doublereal h;
+    doublereal hinv;
+    //entries grouped by bucket (CSR)
+    std::vector<std::size_t> iStart;
+    std::vector<entry> entries;
+    //cell range of each box
+    std::vector<long long> ixlo, iylo, ixhi, iyhi;
+
+    long long cell(const doublereal& x) const;
+    static unsigned long long key(long long ix, long long iy);
+    static std::size_t bucket(unsigned long long iKey, std::size_t iMask);
+
+public:
+    segmentgrid(void);
+    virtual ~segmentgrid(void);
+
+    //cell size (> 0)
+    virtual void setValue(const doublereal& h);
+    doublereal getCellSize(void) const { return h; };
+
+    //candidate pairs (i < j) of n boxes lo[i] ... hi[i] overlapping in 3D
+    void pairs(std::size_t n, const Vec3 *lo, const Vec3 *hi,
+        std::vector<std::pair<std::size_t, std::size_t> >& out);
+};
+
+#endif // SEGMENTGRID_H
@@ -26,18 +26,26 @@ tanhfunc::~tanhfunc(void)
 doublereal
 tanhfunc::tanh(doublereal& x, doublereal& d_crit) const
 {
-    doublereal exp2x = std::exp(2 * x);
-    doublereal func_tanh = (exp2x - 1) / (exp2x + 1); 
+    //飽和領域ではexpを計算しない
     if (x < -1.0*d_crit) {
         return -1.0;
     }
     else if (x > d_crit) {
         return 1.0;
     }
-    else{
-        return func_tanh;
+    doublereal exp2x = std::exp(2 * x);
+    return (exp2x - 1) / (exp2x + 1);
+}
+
+/*tanh()の導関数定義(飽和領域では0)-----------------*/
+doublereal
+tanhfunc::dtanh(doublereal& x, doublereal& d_crit) const
+{
+    if (x < -1.0*d_crit || x > d_crit) {
+        return 0.0;
     }
-     
+    doublereal func_tanh = tanh(x, d_crit);
+    return 1.0 - func_tanh*func_tanh;
 }
 
 /* ------------------------------ tanhfunc end -----------------------------------------*/
\ No newline at end of file
@@ -3,7 +3,8 @@
 #define TANHFUNC_H
 
 #include <mbconfig.h>
-#include "dataman.h"
+#include "myassert.h"
+#include "matvec3.h"
 
 /* =================================================
  * class Calc Tanh(x)
@@ -15,6 +16,7 @@ public:
     ~tanhfunc(void);
 
     virtual doublereal tanh(doublereal& x, doublereal& d_crit) const;
+    virtual doublereal dtanh(doublereal& x, doublereal& d_crit) const;
 
 };
 
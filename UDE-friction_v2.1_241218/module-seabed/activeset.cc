@@ -0,0 +1,130 @@
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+
+
+#include "activeset.h"
+
+/* ------------------------------ activeset start ---------------------------------------*/
+activeset::activeset(void)
+: dAccMax(0.0), dMargin(0.0), bEnabled(false)
+{
+	NO_OP;
+}
+
+activeset::~activeset(void)
+{
+	NO_OP;
+}
+
+void
+activeset::setValue(std::size_t n, bool bEnable,
+	const doublereal& acc, const doublereal& margin)
+{
+	//最初の収束までは全節点を評価する
+	dRecheckTime.assign(n, -std::numeric_limits<doublereal>::max());
+	bEnabled 	= bEnable;
+	dAccMax 	= acc;
+	dMargin 	= margin;
+}
+
+bool
+activeset::bAnyActive(const doublereal& t) const
+{
+	for (std::size_t i = 0; i < dRecheckTime.size(); i++) {
+		if (bActive(i, t)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::size_t
+activeset::iGetNumActive(const doublereal& t) const
+{
+	std::size_t iNumActive = 0;
+	for (std::size_t i = 0; i < dRecheckTime.size(); i++) {
+		if (bActive(i, t)) {
+			iNumActive++;
+		}
+	}
+	return iNumActive;
+}
+
+/*
+ * gap = vdown*tau + 0.5*a*tau^2 を満たす最短到達時間tauを求める.
+ * (桁落ちを避けるため tau = 2*gap/(vdown + sqrt(vdown^2 + 2*a*gap)) の形で計算)
+ */
+static doublereal
+ReachTime(const doublereal& gap, const doublereal& vdown, const doublereal& acc)
+{
+	const doublereal den = vdown + std::sqrt(vdown*vdown + 2.0*acc*gap);
+	if (den <= 0.0) {
+		//下向き速度も加速度もない
+		return std::numeric_limits<doublereal>::max();
+	}
+	return 2.0*gap/den;
+}
+
+/*
+ * 真下の海底面の上限から到達時間tau0を見積もり, tau0の間に水平に動ける
+ * 範囲 R = |v_h|*tau0 + 0.5*a*tau0^2 の海底面の上限zbで到達時間tau1を求め直す.
+ * zbは真下の上限以上なので tau1 <= tau0 となり, tau1の間に動ける範囲は
+ * tau0の範囲に含まれるので, tau1までは海底面に届かないことが保証される.
+ */
+doublereal
+activeset::dReachTime(const Vec3& r, const Vec3& v,
+	const doublereal& acc, const doublereal& margin, Bound bound, const void *pCtx)
+{
+	const doublereal x = r.dGet(1);
+	const doublereal y = r.dGet(2);
+	const doublereal vdown = std::max(-v.dGet(3), 0.0);
+
+	doublereal d = r.dGet(3) - bound(pCtx, x, y, x, y) - margin;
+	if (d <= 0.0) {
+		return 0.0;
+	}
+	const doublereal tau0 = ReachTime(d, vdown, acc);
+	if (tau0 == std::numeric_limits<doublereal>::max()) {
+		//水平に動いても高さは変わらない
+		return tau0;
+	}
+
+	const doublereal vh = std::sqrt(v.dGet(1)*v.dGet(1) + v.dGet(2)*v.dGet(2));
+	const doublereal R = (vh + 0.5*acc*tau0)*tau0;
+	d = r.dGet(3) - bound(pCtx, x - R, y - R, x + R, y + R) - margin;
+	if (d <= 0.0) {
+		return 0.0;
+	}
+	return std::min(tau0, ReachTime(d, vdown, acc));
+}
+
+void
+activeset::update(std::size_t i, const Vec3& r, const Vec3& v,
+	const doublereal& t, const doublereal& dt, Bound bound, const void *pCtx)
+{
+	if (!bEnabled) {
+		return;
+	}
+
+	//次のステップ終了時刻までは届かないことが保証されている節点は再計算しない
+	if (t + dt < dRecheckTime[i]) {
+		return;
+	}
+
+	const doublereal tau = dReachTime(r, v, dAccMax, dMargin, bound, pCtx);
+	if (tau == std::numeric_limits<doublereal>::max()) {
+		dRecheckTime[i] = tau;
+		return;
+	}
+	dRecheckTime[i] = t + tau;
+}
+
+/* ------------------------------ activeset end -----------------------------------------*/
@@ -0,0 +1,59 @@
+#ifndef ACTIVESET_H
+#define ACTIVESET_H
+
+#include <vector>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * class Active Set
+ *  海底面に届かない(浮いている)節点を計算から外す.
+ *  収束後に, 下向き速度と加速度の上限から海底面に届くまでの
+ *  最短時間を求め, その時刻までは節点を評価しない.
+ *  海底面の高さは真下ではなく, その時間に水平に動ける範囲
+ *  (半径 |v_h|*tau + 0.5*a*tau^2)での上限(Seabed::dUpperBound)を使う.
+ *  (斜面や盛り上がりに水平に近づく節点, タイルの上限だけを返す
+ *   タイル海底でも到達時刻を過大に見積もらない)
+ * ================================================= */
+class activeset
+{
+public:
+    //upper bound of the seabed height in [xlo, xhi] x [ylo, yhi] (e.g. Seabed::UpperBound)
+    typedef doublereal (*Bound)(const void *pCtx, const doublereal& xlo, const doublereal& ylo,
+        const doublereal& xhi, const doublereal& yhi);
+private:
+    //node is guaranteed to stay above the seabed until this time
+    std::vector<doublereal> dRecheckTime;
+    //upper bound of downward acceleration
+    doublereal dAccMax;
+    //extra clearance added to the gap
+    doublereal dMargin;
+    bool bEnabled;
+public:
+    activeset(void);
+    ~activeset(void);
+
+    virtual void setValue(std::size_t n, bool bEnable,
+        const doublereal& acc, const doublereal& margin);
+
+    //node i has to be evaluated at time t
+    bool bActive(std::size_t i, const doublereal& t) const {
+        return !bEnabled || t >= dRecheckTime[i];
+    };
+    //at least one node has to be evaluated at time t
+    virtual bool bAnyActive(const doublereal& t) const;
+    virtual std::size_t iGetNumActive(const doublereal& t) const;
+
+    //shortest time for a node at r moving with v to come within margin of the seabed
+    //(acc: upper bound of the acceleration, 0 when it is already there)
+    static doublereal dReachTime(const Vec3& r, const Vec3& v,
+        const doublereal& acc, const doublereal& margin, Bound bound, const void *pCtx);
+
+    //re-check node i after convergence at time t (next step dt)
+    virtual void update(std::size_t i, const Vec3& r, const Vec3& v,
+        const doublereal& t, const doublereal& dt, Bound bound, const void *pCtx);
+};
+
+#endif // ACTIVESET_H
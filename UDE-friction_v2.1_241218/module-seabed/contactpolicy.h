@@ -0,0 +1,873 @@
+#ifndef CONTACTPOLICY_H
+#define CONTACTPOLICY_H
+
+#include <cmath>
+#include <limits>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+
+/* =================================================
+ * Contact Law Policies
+ *  節点1個分の接触力を, 法線方向の反力(NormalModel), 摩擦力の向きと大きさ(FrictionModel),
+ *  すべり速度による摩擦の立ち上がり(Regularization), 局所座標系(FrameBuilder)に分け,
+ *  contactlaw<...>で組み合わせる. すべてinlineの静的関数なので,
+ *  組み合わせごとに節点1個分の計算が1つの関数にまとまる(仮想関数を通らない).
+ *
+ *  z  = (r_z - Zs)*n_z  : 法線方向の隙間(z <= 0で接触)
+ *  vz = v.n             : 法線方向の速度
+ *  F  = F(z, vz)        : 反力の大きさ
+ *  f  = F*n + ft(r, v, F) : 節点に働く力 (ftは固着点など前ステップの状態にもよる)
+ *
+ *  Seabedのcontact manager(seabedcontact)とmodule-contactlawの要素の両方が使うので
+ *  module-seabedに置く(module-contactlawはmodule-seabedに依存し, 逆はない).
+ * ================================================= */
+
+/*--NormalModel---------------------------------------------------------------------*/
+//F = k|z| - c vz (Kelvin-Voigt, 離れる向きの速度では引っ張ることがある)
+struct kelvinnormal
+{
+    //T: doublereal or dual (contactdual.h)
+    template <class T>
+    static inline T F(const T& z, const T& vz,
+        const doublereal& k, const doublereal& c)
+    {
+        return k*((z < 0.0) ? -z : z) - c*vz;
+    };
+    //dF/dz, dF/dvz (z <= 0)
+    static inline void dF(const doublereal& z, const doublereal& vz,
+        const doublereal& k, const doublereal& c, doublereal& dF_dz, doublereal& dF_dvz)
+    {
+        dF_dz = -k;
+        dF_dvz = -c;
+    };
+};
+
+//F = max(0, k|z| - c vz) (海底面が節点を引っ張らない)
+struct clampednormal
+{
+    template <class T>
+    static inline T F(const T& z, const T& vz,
+        const doublereal& k, const doublereal& c)
+    {
+        T F = k*((z < 0.0) ? -z : z) - c*vz;
+        return (F > 0.0) ? F : T(0.0);
+    };
+    static inline void dF(const doublereal& z, const doublereal& vz,
+        const doublereal& k, const doublereal& c, doublereal& dF_dz, doublereal& dF_dvz)
+    {
+        bool bPush = (k*std::abs(z) - c*vz > 0.0);
+        dF_dz = bPush ? -k : 0.0;
+        dF_dvz = bPush ? -c : 0.0;
+    };
+};
+
+/*--friction parameters---------------------------------------------------------------*/
+//摩擦の立ち上がり |v|/vt を飽和させる値 (tanh(2.5) = 0.987, すべての要素で共通)
+static const doublereal CONTACTPOLICY_DCRIT = 2.5;
+
+//friction coefficients and parameters of a node
+struct frictionparam
+{
+    //axial (1) and lateral (2), dynamic (d) and static (s)
+    doublereal nu1d, nu1s, nu2d, nu2s;
+    //regularization velocity and saturation
+    doublereal vt, dcrit;
+    //tangential stiffness and damping of the stick anchor
+    doublereal kt, ct;
+    //Stribeck velocity (stribeck regularization)
+    doublereal vs;
+
+    //frictionless, saturation CONTACTPOLICY_DCRIT (vt and vs have to be set)
+    frictionparam(void) : nu1d(0.0), nu1s(0.0), nu2d(0.0), nu2s(0.0),
+        vt(0.0), dcrit(CONTACTPOLICY_DCRIT), kt(0.0), ct(0.0), vs(0.0) {};
+};
+
+/*--Regularization(T(x): 奇関数, |x| -> ∞で±1, T'(0) = 1)---------------------------*/
+/*
+ * Td(x, fp, T, dT): 値T(x)と導関数dT/dxを同時に返す. x = |v|/vt.
+ * ヤコビ行列には同じ近似式の導関数を使う(差分と一致させるため).
+ * 誤差はtanh(x)に対する |x| <= dcrit = CONTACTPOLICY_DCRIT での最大値(実測).
+ * 分岐は飽和の判定だけで, 条件演算子(cmov/blend)になる.
+ */
+//tanh(x), |x| > dcritでは±1 (tanhfuncと同じ計算, expは飽和しないときだけ)
+struct tanhregularization
+{
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        if (x < -fp.dcrit || x > fp.dcrit) {
+            T = (x < 0.0) ? -1.0 : 1.0;
+            dT = 0.0;
+            return;
+        }
+        doublereal exp2x = std::exp(2*x);
+        T = (exp2x - 1)/(exp2x + 1);
+        dT = 1.0 - T*T;
+    };
+};
+
+//min(max(x, -1), 1)
+struct linearregularization
+{
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        T = (x < -1.0) ? -1.0 : ((x > 1.0) ? 1.0 : x);
+        dT = (x < -1.0 || x > 1.0) ? 0.0 : 1.0;
+    };
+};
+
+//tanhの連分数(Lambert)の[7/6]有理近似, |x| > dcritでは±1 (誤差: 値 1.4e-7, 導関数 6.0e-7. expなし)
+struct rationalregularization
+{
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        const doublereal x2 = x*x;
+        const doublereal N = 135135.0 + x2*(17325.0 + x2*(378.0 + x2));
+        const doublereal D = 135135.0 + x2*(62370.0 + x2*(3150.0 + x2*28.0));
+        const doublereal dN = 2.0*x*(17325.0 + x2*(756.0 + x2*3.0));
+        const doublereal dD = 2.0*x*(62370.0 + x2*(6300.0 + x2*84.0));
+        const doublereal invD = 1.0/D;
+        const bool bSat = (x < -fp.dcrit || x > fp.dcrit);
+        T = bSat ? ((x < 0.0) ? -1.0 : 1.0) : x*N*invD;
+        dT = bSat ? 0.0 : (N*D + x*(dN*D - N*dD))*invD*invD;
+    };
+};
+
+/*
+ * tanhの表引き(区間幅1/64の3次Hermite補間, 節点でtanhとその導関数に一致)
+ * 区間ごとの多項式の係数を表にする. |x| > dcritでは±1 (誤差: 値 6.3e-10, 導関数 1.2e-7).
+ * 表は最初の呼び出しで作る.
+ */
+struct tableregularization
+{
+    static const int N = 512;
+    struct table {
+        //T = c[0] + s (c[1] + s (c[2] + s c[3])), s = x/h - i
+        doublereal c[N][4];
+        table(void) {
+            const doublereal h = 1.0/64.0;
+            for (int i = 0; i < N; i++) {
+                const doublereal y0 = std::tanh(i*h), y1 = std::tanh((i + 1)*h);
+                const doublereal m0 = h*(1.0 - y0*y0), m1 = h*(1.0 - y1*y1);
+                c[i][0] = y0;
+                c[i][1] = m0;
+                c[i][2] = 3.0*(y1 - y0) - 2.0*m0 - m1;
+                c[i][3] = 2.0*(y0 - y1) + m0 + m1;
+            }
+        };
+    };
+    static const table& get(void) { static const table t; return t; };
+
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        const table& t = get();
+        const doublereal ax = std::abs(x);
+        const bool bSat = (ax > fp.dcrit || ax >= N/64.0);
+        const doublereal q = bSat ? 0.0 : ax*64.0;
+        const int i = int(q);
+        const doublereal s = q - i;
+        const doublereal *c = t.c[i];
+        const doublereal y = c[0] + s*(c[1] + s*(c[2] + s*c[3]));
+        const doublereal dy = 64.0*(c[1] + s*(2.0*c[2] + s*3.0*c[3]));
+        T = bSat ? 1.0 : y;
+        T = (x < 0.0) ? -T : T;
+        dT = bSat ? 0.0 : dy;
+    };
+};
+
+//区分3次: y = x/1.5, |y| < 1で y(3 - y^2)/2, それ以外は±1 (C1, x = ±1.5で飽和)
+struct cubicregularization
+{
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        const doublereal y = x/1.5;
+        const bool bSat = (y < -1.0 || y > 1.0);
+        T = bSat ? ((y < 0.0) ? -1.0 : 1.0) : 0.5*y*(3.0 - y*y);
+        dT = bSat ? 0.0 : (1.0 - y*y);
+    };
+};
+
+//smoothstep(5次): y = x/1.875, |y| < 1で y(15 - 10y^2 + 3y^4)/8, それ以外は±1 (C2)
+struct smoothstepregularization
+{
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        const doublereal y = x/1.875;
+        const doublereal y2 = y*y;
+        const bool bSat = (y < -1.0 || y > 1.0);
+        T = bSat ? ((y < 0.0) ? -1.0 : 1.0) : 0.125*y*(15.0 + y2*(-10.0 + 3.0*y2));
+        dT = bSat ? 0.0 : (1.0 - y2)*(1.0 - y2);
+    };
+};
+
+//(2/pi) atan(pi x/2) (飽和しない, 動摩擦に近づくのが遅い)
+struct arctanregularization
+{
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        static const doublereal dPi2 = 1.57079632679489661923;
+        const doublereal y = dPi2*x;
+        T = std::atan(y)/dPi2;
+        dT = 1.0/(1.0 + y*y);
+    };
+};
+
+/*
+ * Stribeck曲線: T(x) = tanh(x) (1 + (nu1s/nu1d - 1) exp(-(v/vs)^2)), v = x vt
+ *  低速では静摩擦係数, 高速では動摩擦係数に近づく(tanhは飽和させない).
+ *  正則化を使う摩擦(projected, coulomb)は接線方向に等方でnu1dだけを使うので,
+ *  比もaxial方向の組(nu1s, nu1d)で決める(lateral方向の係数はstick slipだけが使う).
+ *  nu1d = 0 では摩擦力が0なので比を1とする(0での割り算を避ける).
+ */
+struct stribeckregularization
+{
+    static inline void Td(const doublereal& x, const frictionparam& fp,
+        doublereal& T, doublereal& dT)
+    {
+        const doublereal th = std::tanh(x);
+        const doublereal q = x*fp.vt/fp.vs;
+        const doublereal ratio = (fp.nu1d > 0.0) ? fp.nu1s/fp.nu1d : 1.0;
+        const doublereal e = (ratio - 1.0)*std::exp(-q*q);
+        T = th*(1.0 + e);
+        dT = (1.0 - th*th)*(1.0 + e) - th*e*2.0*q*fp.vt/fp.vs;
+    };
+};
+
+/*--FrictionModel------------------------------------------------------------------*/
+/*
+ * force:    ft(摩擦力)と, 収束時に確定する摩擦の状態fs (fs0: 前ステップで確定した状態)
+ * jacobian: dft/dF, dft/dr, dft/dv (Fを固定)
+ * 状態を持たないモデルはfs0をそのまま返し, nu1d(axial方向の動摩擦係数)を使う.
+ */
+//friction state of a node (committed after convergence)
+struct frictionstate
+{
+    //anchor is set (the node was in contact at the last converged step)
+    bool bAnchor;
+    bool bStick;
+    Vec3 anchor;
+
+    frictionstate(void) : bAnchor(false), bStick(false), anchor(0.0, 0.0, 0.0) {};
+};
+
+//u = P v = a (a.v) + l (l.v) (接線方向の速度成分, a, lはFrameBuilderが作る正規直交基底)
+static inline Vec3
+contactpolicy_tangent(const Vec3& v, const Vec3& a, const Vec3& l)
+{
+    return a*v.Dot(a) + l*v.Dot(l);
+}
+
+static inline void
+contactpolicy_zero(doublereal A[3][3])
+{
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            A[i][j] = 0.0;
+        }
+    }
+}
+
+//ft = -T(|v|/vt) nu F P v (元のContactlawの摩擦力. 大きさは接線速度に比例する)
+struct projectedfriction
+{
+    template <class Regularization>
+    static inline void force(Vec3& ft, frictionstate& fs,
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        Vec3 u = contactpolicy_tangent(v, a, l);
+        doublereal T, dT;
+        Regularization::Td(v.Norm()/fp.vt, fp, T, dT);
+        ft = u*(-(T*fp.nu1d*F));
+        fs = fs0;
+    };
+
+    /*
+     * dft/dF = -T nu u
+     * dft/dv = -nu F (u (dT/dv)^T + T P),  dT/dv = T'(|v|/vt) v^T/(|v| vt)
+     */
+    template <class Regularization>
+    static inline void jacobian(Vec3& dft_dF, doublereal dft_dr[3][3], doublereal dft_dv[3][3],
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        const doublereal& nu = fp.nu1d;
+        const doublereal& vt = fp.vt;
+        const doublereal v_abs = v.Norm();
+        doublereal T, dT;
+        Regularization::Td(v_abs/vt, fp, T, dT);
+        const Vec3 u = contactpolicy_tangent(v, a, l);
+        dft_dF = u*(-T*nu);
+
+        //|v| -> 0 では u (dT/dv)^T -> 0
+        Vec3 dT_dv(0.0, 0.0, 0.0);
+        if (v_abs > std::numeric_limits<doublereal>::epsilon()*vt) {
+            dT_dv = v*(dT/(v_abs*vt));
+        }
+
+        contactpolicy_zero(dft_dr);
+        for (int i = 1; i <= 3; i++) {
+            for (int j = 1; j <= 3; j++) {
+                doublereal P_ij = a(i)*a(j) + l(i)*l(j);
+                dft_dv[i - 1][j - 1] = -nu*F*(u(i)*dT_dv(j) + T*P_ij);
+            }
+        }
+    };
+
+    //dft = dft/dr dr + dft/dv dv (3x3の行列を作らない, Jacobian-vector product用)
+    template <class Regularization>
+    static inline void directional(Vec3& dft, Vec3& dft_dF, const Vec3& dr, const Vec3& dv,
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        const doublereal& nu = fp.nu1d;
+        const doublereal& vt = fp.vt;
+        const doublereal v_abs = v.Norm();
+        doublereal T, dT;
+        Regularization::Td(v_abs/vt, fp, T, dT);
+        const Vec3 u = contactpolicy_tangent(v, a, l);
+        dft_dF = u*(-T*nu);
+
+        //(dT/dv) dv
+        doublereal dT_dv = 0.0;
+        if (v_abs > std::numeric_limits<doublereal>::epsilon()*vt) {
+            dT_dv = v.Dot(dv)*dT/(v_abs*vt);
+        }
+        dft = (u*dT_dv + contactpolicy_tangent(dv, a, l)*T)*(-nu*F);
+    };
+};
+
+//ft = -nu F T(|u|/vt) u/|u| (クーロン摩擦. 大きさはnu Fを超えない)
+struct coulombfriction
+{
+    //g(w) = T(w/vt)/w とその導関数 (w -> 0 では g -> T'(0)/vt, g' -> 0)
+    template <class Regularization>
+    static inline void g(const doublereal& w, const frictionparam& fp,
+        doublereal& gw, doublereal& dgw)
+    {
+        const doublereal& vt = fp.vt;
+        doublereal T, dT;
+        if (w > std::numeric_limits<doublereal>::epsilon()*vt) {
+            Regularization::Td(w/vt, fp, T, dT);
+            gw = T/w;
+            dgw = (dT/vt - gw)/w;
+        } else {
+            Regularization::Td(0.0, fp, T, dT);
+            gw = dT/vt;
+            dgw = 0.0;
+        }
+    };
+
+    template <class Regularization>
+    static inline void force(Vec3& ft, frictionstate& fs,
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        Vec3 u = contactpolicy_tangent(v, a, l);
+        doublereal gw, dgw;
+        g<Regularization>(u.Norm(), fp, gw, dgw);
+        ft = u*(-fp.nu1d*F*gw);
+        fs = fs0;
+    };
+
+    /*
+     * dft/dF = -nu g u
+     * dft/dv = -nu F (g P + g' u u^T/|u|)   (P u = u)
+     */
+    template <class Regularization>
+    static inline void jacobian(Vec3& dft_dF, doublereal dft_dr[3][3], doublereal dft_dv[3][3],
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        const doublereal& nu = fp.nu1d;
+        const Vec3 u = contactpolicy_tangent(v, a, l);
+        const doublereal w = u.Norm();
+        doublereal gw, dgw;
+        g<Regularization>(w, fp, gw, dgw);
+        dft_dF = u*(-nu*gw);
+
+        const doublereal duu = (w > 0.0) ? dgw/w : 0.0;
+        contactpolicy_zero(dft_dr);
+        for (int i = 1; i <= 3; i++) {
+            for (int j = 1; j <= 3; j++) {
+                doublereal P_ij = a(i)*a(j) + l(i)*l(j);
+                dft_dv[i - 1][j - 1] = -nu*F*(gw*P_ij + duu*u(i)*u(j));
+            }
+        }
+    };
+
+    template <class Regularization>
+    static inline void directional(Vec3& dft, Vec3& dft_dF, const Vec3& dr, const Vec3& dv,
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        const doublereal& nu = fp.nu1d;
+        const Vec3 u = contactpolicy_tangent(v, a, l);
+        const doublereal w = u.Norm();
+        doublereal gw, dgw;
+        g<Regularization>(w, fp, gw, dgw);
+        dft_dF = u*(-nu*gw);
+
+        const doublereal duu = (w > 0.0) ? dgw/w : 0.0;
+        dft = (contactpolicy_tangent(dv, a, l)*gw + u*(duu*u.Dot(dv)))*(-nu*F);
+    };
+};
+
+/*
+ * 固着/すべり (stick-slip)
+ *  接触中の節点は海底面上の固着点(anchor)と接線方向のばね(kt)・ダンパ(ct)でつながる.
+ *  d = P (r - anchor) (前ステップで確定した固着点からの接線方向の変位, (a, l)成分)
+ *  固着: ft = -kt d - ct P v
+ *  すべり: 摩擦力は楕円 (ft_a/nu1)^2 + (ft_l/nu2)^2 = F^2 の上にあり, 向きは
+ *          w = M^-1 kt d, M = diag(nu1d, nu2d) の向き (return mapping)
+ *          ft = -F M w/|w|, 収束時に固着点を ft = -kt d となる位置へ引きずる
+ *  固着中は静摩擦係数(nu1s, nu2s), すべり中は動摩擦係数(nu1d, nu2d)で判定する.
+ *  着底した節点はその位置を固着点とする. Regularizationは使わない.
+ *
+ *  静摩擦係数か動摩擦係数が0の方向は摩擦のない方向とし, ばね, ダンパ, 判定のどれにも
+ *  含めない(d, Pのその方向の成分を0とする). 両方向とも0なら摩擦力は0.
+ */
+struct stickslipfriction
+{
+    //1: direction a (l) has friction, 0: frictionless (one of its coefficients is 0)
+    static inline void mask(const frictionparam& fp, doublereal& ma, doublereal& ml)
+    {
+        ma = (fp.nu1s > 0.0 && fp.nu1d > 0.0) ? 1.0 : 0.0;
+        ml = (fp.nu2s > 0.0 && fp.nu2d > 0.0) ? 1.0 : 0.0;
+    };
+
+    //x/nu in a direction with friction, 0 in a frictionless one
+    static inline doublereal ratio(const doublereal& x, const doublereal& nu, const doublereal& m)
+    {
+        return (m > 0.0) ? x/nu : 0.0;
+    };
+
+    //P v without the frictionless directions
+    static inline Vec3 tangent(const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& ma, const doublereal& ml)
+    {
+        return a*(ma*v.Dot(a)) + l*(ml*v.Dot(l));
+    };
+
+    //d = (da, dl) (0 in the frictionless directions); true: stick
+    static inline bool stick(const Vec3& r, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0,
+        doublereal& da, doublereal& dl)
+    {
+        if (!fs0.bAnchor) {
+            da = dl = 0.0;
+            return true;
+        }
+        doublereal ma, ml;
+        mask(fp, ma, ml);
+        const Vec3 d = r - fs0.anchor;
+        da = ma*d.Dot(a);
+        dl = ml*d.Dot(l);
+        const doublereal qa = ratio(fp.kt*da, fs0.bStick ? fp.nu1s : fp.nu1d, ma);
+        const doublereal ql = ratio(fp.kt*dl, fs0.bStick ? fp.nu2s : fp.nu2d, ml);
+        const doublereal Fn = (F > 0.0) ? F : 0.0;
+        return qa*qa + ql*ql <= Fn*Fn;
+    };
+
+    //slip direction e = w/|w| (e = 0 if w = 0)
+    static inline doublereal slip(const doublereal& da, const doublereal& dl, const frictionparam& fp,
+        doublereal& ea, doublereal& el)
+    {
+        doublereal ma, ml;
+        mask(fp, ma, ml);
+        const doublereal wa = ratio(fp.kt*da, fp.nu1d, ma);
+        const doublereal wl = ratio(fp.kt*dl, fp.nu2d, ml);
+        const doublereal w = std::sqrt(wa*wa + wl*wl);
+        ea = (w > 0.0) ? wa/w : 0.0;
+        el = (w > 0.0) ? wl/w : 0.0;
+        return w;
+    };
+
+    template <class Regularization>
+    static inline void force(Vec3& ft, frictionstate& fs,
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        doublereal ma, ml;
+        mask(fp, ma, ml);
+        doublereal da, dl;
+        fs.bAnchor = true;
+        if (stick(r, a, l, F, fp, fs0, da, dl)) {
+            ft = (a*da + l*dl)*(-fp.kt) - tangent(v, a, l, ma, ml)*fp.ct;
+            fs.bStick = true;
+            fs.anchor = fs0.bAnchor ? fs0.anchor : r;
+            return;
+        }
+
+        doublereal ea, el;
+        slip(da, dl, fp, ea, el);
+        const doublereal Fn = (F > 0.0) ? F : 0.0;
+        ft = (a*(fp.nu1d*ea) + l*(fp.nu2d*el))*(-Fn);
+        fs.bStick = false;
+        fs.anchor = r + ft/fp.kt;
+    };
+
+    /*
+     * 固着: dft/dr = -kt P (着底したステップでは0), dft/dv = -ct P, dft/dF = 0
+     * すべり: dft/dF = -M e, dft/dv = 0,
+     *         dft/dr = B K B^T, B = [a l], K = -F kt M (I - e e^T) M^-1/|w|
+     * (P, M^-1は摩擦のない方向の成分を0とする)
+     */
+    template <class Regularization>
+    static inline void jacobian(Vec3& dft_dF, doublereal dft_dr[3][3], doublereal dft_dv[3][3],
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        doublereal ma, ml;
+        mask(fp, ma, ml);
+        doublereal da, dl;
+        if (stick(r, a, l, F, fp, fs0, da, dl)) {
+            dft_dF = Vec3(0.0, 0.0, 0.0);
+            for (int i = 1; i <= 3; i++) {
+                for (int j = 1; j <= 3; j++) {
+                    doublereal P_ij = ma*a(i)*a(j) + ml*l(i)*l(j);
+                    dft_dr[i - 1][j - 1] = fs0.bAnchor ? -fp.kt*P_ij : 0.0;
+                    dft_dv[i - 1][j - 1] = -fp.ct*P_ij;
+                }
+            }
+            return;
+        }
+
+        doublereal ea, el;
+        const doublereal w = slip(da, dl, fp, ea, el);
+        const doublereal Fn = (F > 0.0) ? F : 0.0;
+        dft_dF = (F > 0.0) ? (a*(fp.nu1d*ea) + l*(fp.nu2d*el))*(-1.0) : Vec3(0.0, 0.0, 0.0);
+
+        const doublereal M[2] = { fp.nu1d, fp.nu2d };
+        const doublereal m[2] = { ma, ml };
+        const doublereal e[2] = { ea, el };
+        doublereal K[2][2];
+        for (int p = 0; p < 2; p++) {
+            for (int q = 0; q < 2; q++) {
+                K[p][q] = (w > 0.0) ? ratio(-Fn*fp.kt*M[p]*((p == q ? 1.0 : 0.0) - e[p]*e[q]), M[q]*w, m[q]) : 0.0;
+            }
+        }
+        const Vec3 B[2] = { a, l };
+        for (int i = 1; i <= 3; i++) {
+            for (int j = 1; j <= 3; j++) {
+                doublereal BKB = 0.0;
+                for (int p = 0; p < 2; p++) {
+                    for (int q = 0; q < 2; q++) {
+                        BKB += B[p](i)*K[p][q]*B[q](j);
+                    }
+                }
+                dft_dr[i - 1][j - 1] = BKB;
+                dft_dv[i - 1][j - 1] = 0.0;
+            }
+        }
+    };
+
+    template <class Regularization>
+    static inline void directional(Vec3& dft, Vec3& dft_dF, const Vec3& dr, const Vec3& dv,
+        const Vec3& r, const Vec3& v, const Vec3& a, const Vec3& l,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        doublereal ma, ml;
+        mask(fp, ma, ml);
+        doublereal da, dl;
+        if (stick(r, a, l, F, fp, fs0, da, dl)) {
+            dft_dF = Vec3(0.0, 0.0, 0.0);
+            dft = tangent(dv, a, l, ma, ml)*(-fp.ct);
+            if (fs0.bAnchor) {
+                dft -= tangent(dr, a, l, ma, ml)*fp.kt;
+            }
+            return;
+        }
+
+        doublereal ea, el;
+        const doublereal w = slip(da, dl, fp, ea, el);
+        const doublereal Fn = (F > 0.0) ? F : 0.0;
+        dft_dF = (F > 0.0) ? (a*(fp.nu1d*ea) + l*(fp.nu2d*el))*(-1.0) : Vec3(0.0, 0.0, 0.0);
+
+        //B K B^T dr
+        const doublereal M[2] = { fp.nu1d, fp.nu2d };
+        const doublereal m[2] = { ma, ml };
+        const doublereal e[2] = { ea, el };
+        const doublereal x[2] = { a.Dot(dr), l.Dot(dr) };
+        doublereal Kx[2] = { 0.0, 0.0 };
+        if (w > 0.0) {
+            for (int p = 0; p < 2; p++) {
+                for (int q = 0; q < 2; q++) {
+                    Kx[p] += ratio(-Fn*fp.kt*M[p]*((p == q ? 1.0 : 0.0) - e[p]*e[q]), M[q]*w, m[q])*x[q];
+                }
+            }
+        }
+        dft = a*Kx[0] + l*Kx[1];
+    };
+};
+
+/*--FrameBuilder(build: falseは縮退して代わりの座標系を使った)------------------------*/
+/*
+ * 海底面の接線方向の正規直交基底 (axial, lateral)
+ *   lateral = (n x t)/|n x t|, axial = n x lateral
+ * nが単位ベクトルならaxialも単位ベクトルなので, 平方根は1回で済む.
+ * n // t (鉛直な節点間など)ではlateralが決まらないので, nと最も直交に近い座標軸から作る.
+ * 摩擦力は P = a a^T + l l^T = I - n n^T にしかよらないので, 基底の向きは力に影響しない.
+ */
+struct framecache
+{
+    //direction of the internode vector and the normal used for the cached frame
+    Vec3 t;
+    Vec3 normal_vec;
+    Vec3 axial_unitvec;
+    Vec3 lateral_unitvec;
+    bool bValid;
+
+    framecache(void) : bValid(false) {};
+};
+
+//毎回作る
+struct segmentframe
+{
+    static inline bool build(const Vec3& normal_vec, const Vec3& internode_vec, framecache& cache,
+        Vec3& axial_unitvec, Vec3& lateral_unitvec)
+    {
+        const Vec3& n = normal_vec;
+        Vec3 lateral_vec = n.Cross(internode_vec);
+        const doublereal dL2 = lateral_vec.Dot();
+        bool bOk = (dL2 > std::numeric_limits<doublereal>::epsilon()*internode_vec.Dot());
+        if (!bOk) {
+            //nと最も直交に近い座標軸
+            const doublereal nx = std::abs(n(1)), ny = std::abs(n(2)), nz = std::abs(n(3));
+            const Vec3 e = (nx <= ny && nx <= nz) ? Vec3(1.0, 0.0, 0.0)
+                : ((ny <= nz) ? Vec3(0.0, 1.0, 0.0) : Vec3(0.0, 0.0, 1.0));
+            lateral_vec = n.Cross(e);
+        }
+        lateral_unitvec = lateral_vec*(1.0/std::sqrt(bOk ? dL2 : lateral_vec.Dot()));
+        axial_unitvec = n.Cross(lateral_unitvec);
+        return bOk;
+    };
+};
+
+//節点間の向きと法線の変化が許容値(約1e-3 rad)より小さい間は前回の座標系を使う
+struct cachedframe
+{
+    static inline doublereal dCos2Tol(void) { return 1.0 - 1.0e-6; };
+
+    static inline bool build(const Vec3& normal_vec, const Vec3& internode_vec, framecache& cache,
+        Vec3& axial_unitvec, Vec3& lateral_unitvec)
+    {
+        //cos^2 = (t.t0)^2/(|t|^2 |t0|^2) を平方根なしで比べる (|t0| = 1, |n| = 1)
+        if (cache.bValid) {
+            const doublereal dt = internode_vec.Dot(cache.t);
+            const doublereal dn = normal_vec.Dot(cache.normal_vec);
+            if (dt*dt >= dCos2Tol()*internode_vec.Dot() && dn*dn >= dCos2Tol()) {
+                axial_unitvec = cache.axial_unitvec;
+                lateral_unitvec = cache.lateral_unitvec;
+                return true;
+            }
+        }
+
+        bool bOk = segmentframe::build(normal_vec, internode_vec, cache, axial_unitvec, lateral_unitvec);
+        const doublereal dT2 = internode_vec.Dot();
+        cache.t = (dT2 > 0.0) ? internode_vec*(1.0/std::sqrt(dT2)) : normal_vec;
+        cache.normal_vec = normal_vec;
+        cache.axial_unitvec = axial_unitvec;
+        cache.lateral_unitvec = lateral_unitvec;
+        cache.bValid = true;
+        return bOk;
+    };
+};
+
+/* =================================================
+ * class Contact Law
+ *  contactlaw<NormalModel, FrictionModel, Regularization, FrameBuilder>
+ *  policyを組み合わせた節点1個分の接触力とヤコビ行列 J = -(df/dv + dCoef*df/dr)
+ *    df/dr = (n + dft/dF) dF/dz n^T + dft/dr   (dz/dr = n, 海底面の曲率は省略)
+ *    df/dv = (n + dft/dF) dF/dvz n^T + dft/dv
+ * ================================================= */
+template <class NormalModel, class FrictionModel, class Regularization, class FrameBuilder>
+class contactlaw
+{
+public:
+    typedef NormalModel normalmodel;
+    typedef FrictionModel frictionmodel;
+    typedef Regularization regularization;
+    typedef FrameBuilder framebuilder;
+
+    //fs: friction state to be committed if this is the converged solution
+    static inline void force(Vec3& f, frictionstate& fs, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const frictionparam& fp, const frictionstate& fs0)
+    {
+        const doublereal z = (r.dGet(3) - Zs)*normal_vec.dGet(3);
+        gapforce(f, fs, z, r, v, normal_vec, axial_unitvec, lateral_unitvec, k, c, fp, fs0);
+    };
+
+    static inline void jacobian(doublereal J[3][3], const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const frictionparam& fp, const frictionstate& fs0, const doublereal& dCoef)
+    {
+        const doublereal z = (r.dGet(3) - Zs)*normal_vec.dGet(3);
+        gapjacobian(J, z, r, v, normal_vec, axial_unitvec, lateral_unitvec, k, c, fp, fs0, dCoef);
+    };
+
+    /*
+     * 隙間zを与える場合(線材どうしの接触など, dz/dr = n^T となる量なら何でもよい)
+     *  r, vは接触点の相対位置と相対速度
+     */
+    static inline void gapforce(Vec3& f, frictionstate& fs, const doublereal& z,
+        const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& k, const doublereal& c,
+        const frictionparam& fp, const frictionstate& fs0)
+    {
+        if (z > 0.0) {
+            f = Vec3(0.0, 0.0, 0.0);
+            fs = frictionstate();
+            return;
+        }
+        const doublereal F = NormalModel::F(z, v.Dot(normal_vec), k, c);
+        Vec3 ft;
+        FrictionModel::template force<Regularization>(ft, fs, r, v, axial_unitvec, lateral_unitvec, F, fp, fs0);
+        f = ft + normal_vec*F;
+    };
+
+    static inline void gapjacobian(doublereal J[3][3], const doublereal& z,
+        const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& k, const doublereal& c,
+        const frictionparam& fp, const frictionstate& fs0, const doublereal& dCoef)
+    {
+        if (z > 0.0) {
+            contactpolicy_zero(J);
+            return;
+        }
+
+        const doublereal vz = v.Dot(normal_vec);
+        const doublereal F = NormalModel::F(z, vz, k, c);
+        doublereal dF_dz, dF_dvz;
+        NormalModel::dF(z, vz, k, c, dF_dz, dF_dvz);
+
+        Vec3 dft_dF;
+        doublereal dft_dr[3][3], dft_dv[3][3];
+        FrictionModel::template jacobian<Regularization>(dft_dF, dft_dr, dft_dv,
+            r, v, axial_unitvec, lateral_unitvec, F, fp, fs0);
+
+        //df/dF
+        const Vec3 df_dF = normal_vec + dft_dF;
+        for (int i = 1; i <= 3; i++) {
+            for (int j = 1; j <= 3; j++) {
+                doublereal df_dr = df_dF(i)*dF_dz*normal_vec(j) + dft_dr[i - 1][j - 1];
+                doublereal df_dv = df_dF(i)*dF_dvz*normal_vec(j) + dft_dv[i - 1][j - 1];
+                J[i - 1][j - 1] = -(df_dv + dCoef*df_dr);
+            }
+        }
+    };
+
+    /*
+     * Jy = J y (行列を作らない方向微分, dr = dCoef y, dv = y)
+     *  df = (n + dft/dF) (dF/dz n.dr + dF/dvz n.dv) + dft/dr dr + dft/dv dv
+     */
+    static inline void jacobianvector(Vec3& Jy, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& Zs, const doublereal& k, const doublereal& c,
+        const frictionparam& fp, const frictionstate& fs0, const Vec3& y, const doublereal& dCoef)
+    {
+        const doublereal z = (r.dGet(3) - Zs)*normal_vec.dGet(3);
+        if (z > 0.0) {
+            Jy = Vec3(0.0, 0.0, 0.0);
+            return;
+        }
+
+        const doublereal vz = v.Dot(normal_vec);
+        const doublereal F = NormalModel::F(z, vz, k, c);
+        doublereal dF_dz, dF_dvz;
+        NormalModel::dF(z, vz, k, c, dF_dz, dF_dvz);
+
+        const Vec3 dr = y*dCoef;
+        Vec3 dft, dft_dF;
+        FrictionModel::template directional<Regularization>(dft, dft_dF, dr, y,
+            r, v, axial_unitvec, lateral_unitvec, F, fp, fs0);
+
+        const doublereal dF = normal_vec.Dot(y)*(dF_dz*dCoef + dF_dvz);
+        Jy = ((normal_vec + dft_dF)*dF + dft)*(-1.0);
+    };
+
+    /*
+     * 法線方向の反力Fを与える場合(Lagrange乗数): f = F n + ft(F)
+     *  J = -(dft/dv + dCoef*dft/dr), df/dF = n + dft/dF
+     *  F <= 0では摩擦力を0とし, 摩擦の状態を初期化する.
+     */
+    static inline void multiplierforce(Vec3& f, frictionstate& fs, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0)
+    {
+        f = normal_vec*F;
+        if (F <= 0.0) {
+            fs = frictionstate();
+            return;
+        }
+        Vec3 ft;
+        FrictionModel::template force<Regularization>(ft, fs, r, v, axial_unitvec, lateral_unitvec, F, fp, fs0);
+        f += ft;
+    };
+
+    static inline void multiplierjacobian(doublereal J[3][3], Vec3& df_dF, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0, const doublereal& dCoef)
+    {
+        df_dF = normal_vec;
+        if (F <= 0.0) {
+            contactpolicy_zero(J);
+            return;
+        }
+
+        Vec3 dft_dF;
+        doublereal dft_dr[3][3], dft_dv[3][3];
+        FrictionModel::template jacobian<Regularization>(dft_dF, dft_dr, dft_dv,
+            r, v, axial_unitvec, lateral_unitvec, F, fp, fs0);
+        df_dF += dft_dF;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                J[i][j] = -(dft_dv[i][j] + dCoef*dft_dr[i][j]);
+            }
+        }
+    };
+
+    //Jy = -(dft/dv + dCoef*dft/dr) y
+    static inline void multiplierjacobianvector(Vec3& Jy, Vec3& df_dF, const Vec3& r, const Vec3& v,
+        const Vec3& normal_vec, const Vec3& axial_unitvec, const Vec3& lateral_unitvec,
+        const doublereal& F, const frictionparam& fp, const frictionstate& fs0,
+        const Vec3& y, const doublereal& dCoef)
+    {
+        df_dF = normal_vec;
+        if (F <= 0.0) {
+            Jy = Vec3(0.0, 0.0, 0.0);
+            return;
+        }
+
+        Vec3 dft, dft_dF;
+        FrictionModel::template directional<Regularization>(dft, dft_dF, y*dCoef, y,
+            r, v, axial_unitvec, lateral_unitvec, F, fp, fs0);
+        df_dF += dft_dF;
+        Jy = dft*(-1.0);
+    };
+
+    //local frame of a node from the seabed normal and the internode vector
+    static inline bool frame(const Vec3& normal_vec, const Vec3& internode_vec, framecache& cache,
+        Vec3& axial_unitvec, Vec3& lateral_unitvec)
+    {
+        return FrameBuilder::build(normal_vec, internode_vec, cache, axial_unitvec, lateral_unitvec);
+    };
+};
+
+//元のContactlawと同じ組み合わせ
+typedef contactlaw<kelvinnormal, projectedfriction, tanhregularization, cachedframe> contactlawdefault;
+
+#endif // CONTACTPOLICY_H
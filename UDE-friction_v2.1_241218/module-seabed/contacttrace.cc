@@ -0,0 +1,175 @@
+#include "mbconfig.h"
+
+#include "contacttrace.h"
+
+#if CONTACT_TRACE_LEVEL > 0
+
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* ------------------------------ contacttrace start ---------------------------------------*/
+
+//records per thread (power of 2)
+static const std::size_t CONTACTTRACE_BUFFER_SIZE = 4096;
+//drain interval of the writer thread [ms]
+static const int CONTACTTRACE_DRAIN_MS = 20;
+
+/*--記録----------------------------------------------------------------------------*/
+struct contacttracerecord
+{
+	double dTime;
+	int iLevel;
+	int iCat;
+	const char *sWhat;
+	unsigned uLabel;
+	double dValue;
+};
+
+/*--スレッドごとのリングバッファ(producer: 記録するスレッド, consumer: 書き出しスレッド)---*/
+struct contacttracebuffer
+{
+	unsigned uThread;
+	std::atomic<std::size_t> iHead; 	//next slot to write (producer)
+	std::atomic<std::size_t> iTail; 	//next slot to read (consumer)
+	std::atomic<unsigned long> iDropped;
+	contacttracerecord ring[CONTACTTRACE_BUFFER_SIZE];
+
+	contacttracebuffer(unsigned u) : uThread(u), iHead(0), iTail(0), iDropped(0) {};
+};
+
+/*--バッファの登録と書き出しスレッド-------------------------------------------------*/
+class contacttracewriter
+{
+private:
+	std::mutex mtx;
+	std::vector<contacttracebuffer *> buffers;
+	std::thread writer;
+	std::atomic<bool> bStop;
+	std::FILE *fp;
+	int iMask;
+	std::chrono::steady_clock::time_point t0;
+
+	void drain(void)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		for (std::size_t b = 0; b < buffers.size(); b++) {
+			contacttracebuffer& buf = *buffers[b];
+			std::size_t iTail = buf.iTail.load(std::memory_order_relaxed);
+			const std::size_t iHead = buf.iHead.load(std::memory_order_acquire);
+			for (; iTail != iHead; iTail++) {
+				const contacttracerecord& r = buf.ring[iTail & (CONTACTTRACE_BUFFER_SIZE - 1)];
+				std::fprintf(fp, "%.6f %u %d %d %u %s %.16e\n",
+					r.dTime, buf.uThread, r.iCat, r.iLevel, r.uLabel, r.sWhat, r.dValue);
+			}
+			buf.iTail.store(iTail, std::memory_order_release);
+
+			unsigned long iDropped = buf.iDropped.exchange(0, std::memory_order_relaxed);
+			if (iDropped > 0) {
+				std::fprintf(fp, "# thread %u: %lu records dropped\n", buf.uThread, iDropped);
+			}
+		}
+		std::fflush(fp);
+	}
+
+	void run(void)
+	{
+		while (!bStop.load(std::memory_order_acquire)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(CONTACTTRACE_DRAIN_MS));
+			drain();
+		}
+	}
+
+public:
+	contacttracewriter(void)
+	: bStop(false), fp(0), iMask(~0), t0(std::chrono::steady_clock::now())
+	{
+		const char *sFile = std::getenv("CONTACT_TRACE_FILE");
+		fp = std::fopen(sFile ? sFile : "contacttrace.log", "w");
+		if (fp == 0) {
+			fp = stderr;
+		}
+		const char *sMask = std::getenv("CONTACT_TRACE_MASK");
+		if (sMask != 0) {
+			iMask = int(std::strtol(sMask, 0, 0));
+		}
+		std::fprintf(fp, "# time thread category level label what value\n");
+		writer = std::thread(&contacttracewriter::run, this);
+	}
+
+	~contacttracewriter(void)
+	{
+		bStop.store(true, std::memory_order_release);
+		writer.join();
+		drain();
+		for (std::size_t b = 0; b < buffers.size(); b++) {
+			delete buffers[b];
+		}
+		if (fp != stderr) {
+			std::fclose(fp);
+		}
+	}
+
+	bool bEnabled(int iCat) const
+	{
+		return (iCat & iMask) != 0;
+	}
+
+	double dTime(void) const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	//buffers live until the end of the program (records of exited threads are still written)
+	contacttracebuffer *pRegister(void)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		contacttracebuffer *p = new contacttracebuffer(unsigned(buffers.size()));
+		buffers.push_back(p);
+		return p;
+	}
+};
+
+static contacttracewriter&
+contacttrace_writer(void)
+{
+	static contacttracewriter w;
+	return w;
+}
+
+void
+contacttrace::push(int iLevel, int iCat, const char *sWhat, unsigned uLabel, double dValue)
+{
+	contacttracewriter& w = contacttrace_writer();
+	if (!w.bEnabled(iCat)) {
+		return;
+	}
+
+	static thread_local contacttracebuffer *pBuf = 0;
+	if (pBuf == 0) {
+		pBuf = w.pRegister();
+	}
+
+	const std::size_t iHead = pBuf->iHead.load(std::memory_order_relaxed);
+	if (iHead - pBuf->iTail.load(std::memory_order_acquire) >= CONTACTTRACE_BUFFER_SIZE) {
+		pBuf->iDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	contacttracerecord& r = pBuf->ring[iHead & (CONTACTTRACE_BUFFER_SIZE - 1)];
+	r.dTime 	= w.dTime();
+	r.iLevel 	= iLevel;
+	r.iCat 		= iCat;
+	r.sWhat 	= sWhat;
+	r.uLabel 	= uLabel;
+	r.dValue 	= dValue;
+	pBuf->iHead.store(iHead + 1, std::memory_order_release);
+}
+
+/* ------------------------------ contacttrace end -----------------------------------------*/
+
+#endif // CONTACT_TRACE_LEVEL
@@ -0,0 +1,63 @@
+#ifndef CONTACTTRACE_H
+#define CONTACTTRACE_H
+
+/* =================================================
+ * Contact Trace
+ *  デバッグ用のトレース. CONTACT_TRACE_LEVELが0(既定)のときは何も生成しない.
+ *  有効にするときはmodule-seabed, module-contactlawの両方を
+ *  -DCONTACT_TRACE_LEVEL=<1|2|3> でコンパイルする.
+ *
+ *  記録はスレッドごとのリングバッファ(lock-free, 1 producer / 1 consumer)に入れ,
+ *  別スレッドが定期的にファイルへ書き出す. バッファが一杯のときは記録を捨てて数える.
+ *
+ *  環境変数
+ *    CONTACT_TRACE_FILE    出力先 (既定: contacttrace.log)
+ *    CONTACT_TRACE_MASK    記録する分類のビット和 (既定: すべて)
+ *
+ *  usage
+ *    CONTACT_TRACE(CONTACT_TRACE_DEBUG, TRACE_CONTACT, "contact", GetLabel(), gap);
+ *  what は文字列リテラル(記録時に複写しない)
+ * ================================================= */
+
+//levels
+#define CONTACT_TRACE_INFO 		1
+#define CONTACT_TRACE_DEBUG 	2
+#define CONTACT_TRACE_VERBOSE 	3
+
+#ifndef CONTACT_TRACE_LEVEL
+#define CONTACT_TRACE_LEVEL 0
+#endif
+
+//categories
+enum contacttracecat {
+    TRACE_ASSEMBLY      = 1,    //AssRes/AssJac
+    TRACE_CONTACT       = 2,    //contact transitions
+    TRACE_OUTPUT        = 4,    //Output
+    TRACE_LIFECYCLE     = 8     //construction, destruction
+};
+
+#if CONTACT_TRACE_LEVEL > 0
+
+class contacttrace
+{
+public:
+    //append a record to the buffer of the calling thread
+    static void push(int iLevel, int iCat, const char *sWhat, unsigned uLabel, double dValue);
+};
+
+#define CONTACT_TRACE(level, cat, what, label, value) \
+    do { \
+        if ((level) <= CONTACT_TRACE_LEVEL) { \
+            contacttrace::push((level), (cat), (what), (label), (value)); \
+        } \
+    } while (0)
+
+#else // CONTACT_TRACE_LEVEL == 0
+
+//arguments are not evaluated
+#define CONTACT_TRACE(level, cat, what, label, value) \
+    do { } while (0)
+
+#endif // CONTACT_TRACE_LEVEL
+
+#endif // CONTACTTRACE_H
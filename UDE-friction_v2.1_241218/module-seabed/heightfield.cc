@@ -0,0 +1,420 @@
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "heightfield.h"
+
+/*
+ * Catmull-Rom補間の値が参照点の範囲[zmin, zmax]から外れる量の上限
+ * (1次元で負の重みの和 >= -1/8 より, 2次元では (9/8)^2 + (1/8)^2 - 1 = 0.28125)
+ */
+static const doublereal HEIGHTFIELD_BICUBIC_OVERSHOOT = 0.28125;
+static const char HEIGHTFIELD_TILE_MAGIC[8] = { 'S', 'B', 'T', 'I', 'L', 'E', '0', '1' };
+
+/* ------------------------------ heightfield start ---------------------------------------*/
+heightfield::heightfield(void)
+: interp(INTERP_BILINEAR), iNx(0), iNy(0), x0(0.0), y0(0.0), dx(1.0), dy(1.0),
+iTx(0), iTy(0), iNtx(0), iNty(0), pMap(0), iMapSize(0), pRange(0), pTiles(0)
+{
+	NO_OP;
+}
+
+heightfield::~heightfield(void)
+{
+	unmap();
+}
+
+/*--[0]load(格子データの読み込み)-----------------------------------------------------*/
+void
+heightfield::load(const char *sFileName)
+{
+	//先頭がmagicならタイル形式
+	char magic[sizeof(HEIGHTFIELD_TILE_MAGIC)];
+	bool bTile = false;
+	FILE *fp = std::fopen(sFileName, "rb");
+	if (fp != 0) {
+		bTile = (std::fread(magic, 1, sizeof(magic), fp) == sizeof(magic))
+			&& (std::memcmp(magic, HEIGHTFIELD_TILE_MAGIC, sizeof(magic)) == 0);
+		std::fclose(fp);
+	}
+
+	if (bTile) {
+		mapTiles(sFileName);
+	} else {
+		loadGrid(sFileName);
+	}
+}
+
+void
+heightfield::loadGrid(const char *sFileName)
+{
+	FILE *fp = std::fopen(sFileName, "rb");
+	if (fp == 0) {
+		silent_cerr("heightfield: unable to open bathymetry file \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	int32_t n[2];
+	doublereal h[4];
+	bool bOk = (std::fread(n, sizeof(int32_t), 2, fp) == 2)
+		&& (std::fread(h, sizeof(doublereal), 4, fp) == 4);
+
+	if (bOk && (n[0] < 2 || n[1] < 2 || !(h[2] > 0.0) || !(h[3] > 0.0))) {
+		std::fclose(fp);
+		silent_cerr("heightfield: invalid grid in \"" << sFileName << "\""
+			" (nx=" << n[0] << ", ny=" << n[1] << ", dx=" << h[2] << ", dy=" << h[3] << ")" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	std::vector<doublereal> zz;
+	if (bOk) {
+		zz.resize(std::size_t(n[0])*std::size_t(n[1]));
+		bOk = (std::fread(&zz[0], sizeof(doublereal), zz.size(), fp) == zz.size());
+	}
+	std::fclose(fp);
+
+	if (!bOk) {
+		silent_cerr("heightfield: bathymetry file \"" << sFileName << "\" is truncated" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	unmap();
+	iNx = n[0];
+	iNy = n[1];
+	x0 	= h[0];
+	y0 	= h[1];
+	dx 	= h[2];
+	dy 	= h[3];
+	z.swap(zz);
+}
+
+/*
+ * タイル形式はヘッダだけを検査してファイル全体をmmapする.
+ * 標本はnode()で参照されたときにOSがページ単位で読み込むので,
+ * 読み込み時間は海域の広さによらず, 常駐メモリは係留索が通ったタイルの分だけになる.
+ */
+void
+heightfield::mapTiles(const char *sFileName)
+{
+	int fd = ::open(sFileName, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || ::fstat(fd, &st) != 0) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+		silent_cerr("heightfield: unable to open bathymetry file \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	std::size_t iSize = std::size_t(st.st_size);
+	void *p = (iSize > 0) ? ::mmap(0, iSize, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	::close(fd);
+	if (p == MAP_FAILED) {
+		silent_cerr("heightfield: unable to map bathymetry file \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	//header
+	const std::size_t iHeader = sizeof(HEIGHTFIELD_TILE_MAGIC) + 4*sizeof(int32_t) + 4*sizeof(doublereal);
+	int32_t n[4];
+	doublereal h[4];
+	bool bOk = (iSize >= iHeader);
+	if (bOk) {
+		const char *c = static_cast<const char *>(p) + sizeof(HEIGHTFIELD_TILE_MAGIC);
+		std::memcpy(n, c, sizeof(n));
+		std::memcpy(h, c + sizeof(n), sizeof(h));
+		bOk = n[0] >= 2 && n[1] >= 2 && n[2] >= 2 && n[3] >= 2 && h[2] > 0.0 && h[3] > 0.0;
+	}
+
+	std::size_t iNt = 0, iTile = 0;
+	if (bOk) {
+		iNt 	= std::size_t((n[0] + n[2] - 1)/n[2])*std::size_t((n[1] + n[3] - 1)/n[3]);
+		iTile 	= std::size_t(n[2])*std::size_t(n[3]);
+		bOk = (iSize == iHeader + iNt*sizeof(tilerange) + iNt*iTile*sizeof(doublereal));
+	}
+	if (!bOk) {
+		::munmap(p, iSize);
+		silent_cerr("heightfield: invalid tiled bathymetry file \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	//参照は局所的だが順番は不定
+	::madvise(p, iSize, MADV_RANDOM);
+
+	unmap();
+	z.clear();
+	pMap 	= p;
+	iMapSize = iSize;
+	iNx 	= n[0];
+	iNy 	= n[1];
+	iTx 	= n[2];
+	iTy 	= n[3];
+	iNtx 	= (iNx + iTx - 1)/iTx;
+	iNty 	= (iNy + iTy - 1)/iTy;
+	x0 		= h[0];
+	y0 		= h[1];
+	dx 		= h[2];
+	dy 		= h[3];
+	pRange 	= reinterpret_cast<const tilerange *>(static_cast<const char *>(p) + iHeader);
+	pTiles 	= reinterpret_cast<const doublereal *>(pRange + iNt);
+}
+
+void
+heightfield::unmap(void)
+{
+	if (pMap != 0) {
+		::munmap(pMap, iMapSize);
+	}
+	pMap 	= 0;
+	iMapSize = 0;
+	pRange 	= 0;
+	pTiles 	= 0;
+	iTx = iTy = iNtx = iNty = 0;
+}
+
+void
+heightfield::setInterp(Interp i)
+{
+	interp = i;
+}
+
+heightfield::Interp
+heightfield::getInterp(void) const
+{
+	return interp;
+}
+
+bool
+heightfield::bLoaded(void) const
+{
+	return !z.empty() || pMap != 0;
+}
+
+bool
+heightfield::bTiled(void) const
+{
+	return pMap != 0;
+}
+
+/*--[0B]bUpperBound(タイルの高さの上限)-----------------------------------------------*/
+bool
+heightfield::bUpperBound(const doublereal& x, const doublereal& y, doublereal& zb) const
+{
+	if (pMap == 0) {
+		return false;
+	}
+
+	int i, j;
+	doublereal tx, ty, sx, sy;
+	locate(x, y, i, j, tx, ty, sx, sy);
+
+	const tilerange& r = pRange[std::size_t(j/iTy)*std::size_t(iNtx) + std::size_t(i/iTx)];
+	zb = r.zmax;
+	if (interp == INTERP_BICUBIC) {
+		zb += HEIGHTFIELD_BICUBIC_OVERSHOOT*(r.zmax - r.zmin);
+	}
+	return true;
+}
+
+//upper bound of the seabed height in a rectangle
+doublereal
+heightfield::dUpperBound(const doublereal& xlo, const doublereal& ylo,
+	const doublereal& xhi, const doublereal& yhi) const
+{
+	//補間で参照する格子点(両側に1点ずつ広げる)を格子内に丸める
+	const doublereal dNx = doublereal(iNx - 1), dNy = doublereal(iNy - 1);
+	const int ilo = int(std::max(0.0, std::min(dNx, std::floor((xlo - x0)/dx) - 1.0)));
+	const int ihi = int(std::max(0.0, std::min(dNx, std::floor((xhi - x0)/dx) + 2.0)));
+	const int jlo = int(std::max(0.0, std::min(dNy, std::floor((ylo - y0)/dy) - 1.0)));
+	const int jhi = int(std::max(0.0, std::min(dNy, std::floor((yhi - y0)/dy) + 2.0)));
+
+	doublereal zmin = std::numeric_limits<doublereal>::max();
+	doublereal zmax = -std::numeric_limits<doublereal>::max();
+	if (pMap == 0) {
+		for (int j = jlo; j <= jhi; j++) {
+			for (int i = ilo; i <= ihi; i++) {
+				const doublereal zij = z[std::size_t(j)*std::size_t(iNx) + std::size_t(i)];
+				zmin = std::min(zmin, zij);
+				zmax = std::max(zmax, zij);
+			}
+		}
+	} else {
+		//タイルの範囲だけを使う(標本は読まない)
+		for (int tj = jlo/iTy; tj <= jhi/iTy; tj++) {
+			for (int ti = ilo/iTx; ti <= ihi/iTx; ti++) {
+				const tilerange& r = pRange[std::size_t(tj)*std::size_t(iNtx) + std::size_t(ti)];
+				zmin = std::min(zmin, r.zmin);
+				zmax = std::max(zmax, r.zmax);
+			}
+		}
+	}
+
+	if (interp == INTERP_BICUBIC) {
+		zmax += HEIGHTFIELD_BICUBIC_OVERSHOOT*(zmax - zmin);
+	}
+	return zmax;
+}
+
+/*--[1]locate(格子セルの探索)---------------------------------------------------------*/
+/*
+ * (x, y)を含むセル(i, j)とセル内の局所座標(tx, ty) in [0, 1]を求める.
+ * 格子の外側では端に丸め, 勾配の係数(sx, sy)を0にする.
+ */
+void
+heightfield::locate(const doublereal& x, const doublereal& y,
+	int& i, int& j, doublereal& tx, doublereal& ty,
+	doublereal& sx, doublereal& sy) const
+{
+	doublereal u 	= (x - x0)/dx;
+	doublereal w 	= (y - y0)/dy;
+
+	sx = 1.0;
+	if (!(u > 0.0)) {
+		u = 0.0;
+		sx = 0.0;
+	} else if (u > doublereal(iNx - 1)) {
+		u = doublereal(iNx - 1);
+		sx = 0.0;
+	}
+	sy = 1.0;
+	if (!(w > 0.0)) {
+		w = 0.0;
+		sy = 0.0;
+	} else if (w > doublereal(iNy - 1)) {
+		w = doublereal(iNy - 1);
+		sy = 0.0;
+	}
+
+	i = std::min(int(u), iNx - 2);
+	j = std::min(int(w), iNy - 2);
+	tx = u - i;
+	ty = w - j;
+}
+
+inline doublereal
+heightfield::node(int i, int j) const
+{
+	i = std::max(0, std::min(i, iNx - 1));
+	j = std::max(0, std::min(j, iNy - 1));
+	if (pMap == 0) {
+		return z[std::size_t(j)*std::size_t(iNx) + std::size_t(i)];
+	}
+
+	int ti = i/iTx, tj = j/iTy;
+	const doublereal *pz = pTiles
+		+ (std::size_t(tj)*std::size_t(iNtx) + std::size_t(ti))*std::size_t(iTx)*std::size_t(iTy);
+	return pz[std::size_t(j - tj*iTy)*std::size_t(iTx) + std::size_t(i - ti*iTx)];
+}
+
+/*--[2]eval(海底高さと勾配の補間)-----------------------------------------------------*/
+void
+heightfield::eval(const doublereal& x, const doublereal& y,
+	doublereal& h, doublereal& hx, doublereal& hy) const
+{
+	int i, j;
+	doublereal tx, ty, sx, sy;
+	locate(x, y, i, j, tx, ty, sx, sy);
+
+	if (interp == INTERP_BILINEAR) {
+		doublereal z00 	= node(i, j);
+		doublereal z10 	= node(i + 1, j);
+		doublereal z01 	= node(i, j + 1);
+		doublereal z11 	= node(i + 1, j + 1);
+
+		h 	= (1.0 - ty)*((1.0 - tx)*z00 + tx*z10) + ty*((1.0 - tx)*z01 + tx*z11);
+		hx 	= sx*((1.0 - ty)*(z10 - z00) + ty*(z11 - z01))/dx;
+		hy 	= sy*((1.0 - tx)*(z01 - z00) + tx*(z11 - z10))/dy;
+		return;
+	}
+
+	//Catmull-Rom(4x4点, 格子点で勾配が連続)
+	doublereal wx[4], dwx[4], wy[4], dwy[4];
+	{
+		doublereal t = tx, t2 = tx*tx, t3 = tx*tx*tx;
+		wx[0] 	= 0.5*(-t3 + 2.0*t2 - t);
+		wx[1] 	= 0.5*(3.0*t3 - 5.0*t2 + 2.0);
+		wx[2] 	= 0.5*(-3.0*t3 + 4.0*t2 + t);
+		wx[3] 	= 0.5*(t3 - t2);
+		dwx[0] 	= 0.5*(-3.0*t2 + 4.0*t - 1.0);
+		dwx[1] 	= 0.5*(9.0*t2 - 10.0*t);
+		dwx[2] 	= 0.5*(-9.0*t2 + 8.0*t + 1.0);
+		dwx[3] 	= 0.5*(3.0*t2 - 2.0*t);
+	}
+	{
+		doublereal t = ty, t2 = ty*ty, t3 = ty*ty*ty;
+		wy[0] 	= 0.5*(-t3 + 2.0*t2 - t);
+		wy[1] 	= 0.5*(3.0*t3 - 5.0*t2 + 2.0);
+		wy[2] 	= 0.5*(-3.0*t3 + 4.0*t2 + t);
+		wy[3] 	= 0.5*(t3 - t2);
+		dwy[0] 	= 0.5*(-3.0*t2 + 4.0*t - 1.0);
+		dwy[1] 	= 0.5*(9.0*t2 - 10.0*t);
+		dwy[2] 	= 0.5*(-9.0*t2 + 8.0*t + 1.0);
+		dwy[3] 	= 0.5*(3.0*t2 - 2.0*t);
+	}
+
+	h = hx = hy = 0.0;
+	for (int b = 0; b < 4; b++) {
+		doublereal r = 0.0, dr = 0.0;
+		for (int a = 0; a < 4; a++) {
+			doublereal zab = node(i - 1 + a, j - 1 + b);
+			r 	+= wx[a]*zab;
+			dr 	+= dwx[a]*zab;
+		}
+		h 	+= wy[b]*r;
+		hx 	+= wy[b]*dr;
+		hy 	+= dwy[b]*r;
+	}
+	hx *= sx/dx;
+	hy *= sy/dy;
+}
+
+/*--[3]height, surface(海底高さと法線ベクトル)----------------------------------------*/
+doublereal
+heightfield::height(const doublereal& x, const doublereal& y) const
+{
+	doublereal h, hx, hy;
+	eval(x, y, h, hx, hy);
+	return h;
+}
+
+void
+heightfield::surface(const doublereal& x, const doublereal& y,
+	doublereal& h, Vec3& normal_vec) const
+{
+	doublereal hx, hy;
+	eval(x, y, h, hx, hy);
+
+	//n = (-hx, -hy, 1)/|(-hx, -hy, 1)|
+	doublereal s = 1.0/std::sqrt(1.0 + hx*hx + hy*hy);
+	normal_vec = Vec3(-hx*s, -hy*s, s);
+}
+
+void
+heightfield::surface(std::size_t n, const doublereal *x, const doublereal *y,
+	doublereal *h, doublereal *nx, doublereal *ny, doublereal *nz) const
+{
+	for (std::size_t p = 0; p < n; p++) {
+		doublereal hx, hy;
+		eval(x[p], y[p], h[p], hx, hy);
+
+		doublereal s = 1.0/std::sqrt(1.0 + hx*hx + hy*hy);
+		nx[p] = -hx*s;
+		ny[p] = -hy*s;
+		nz[p] = s;
+	}
+}
+
+/* ------------------------------ heightfield end -----------------------------------------*/
@@ -0,0 +1,111 @@
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <cstddef>
+#include <vector>
+
+#include <mbconfig.h>
+#include "dataman.h"
+
+/* =================================================
+ * class Height Field
+ *  等間隔格子の海底地形(bathymetry)
+ *  任意の(x, y)に対して海底高さと法線ベクトルを補間で求める.
+ *  格子の外側では端の値で延長する(勾配0).
+ *
+ *  binary file (little endian)
+ *    int32   nx, ny        : 格子点数 (>= 2)
+ *    float64 x0, y0        : 原点(格子点(0, 0))の座標
+ *    float64 dx, dy        : 格子間隔 (> 0)
+ *    float64 z[ny][nx]     : 海底高さ(xが速く変わる順)
+ *
+ *  tiled binary file (little endian, mmapで開き必要なタイルだけ読み込まれる)
+ *    char    magic[8]      : "SBTILE01"
+ *    int32   nx, ny        : 格子点数 (>= 2)
+ *    int32   tx, ty        : 1タイルの格子点数 (>= 2)
+ *    float64 x0, y0        : 原点(格子点(0, 0))の座標
+ *    float64 dx, dy        : 格子間隔 (> 0)
+ *    float64 zmin, zmax    : タイルごとの高さの範囲 [nty][ntx]
+ *    float64 z[ty][tx]     : タイルごとの海底高さ [nty][ntx]
+ *  ntx = ceil(nx/tx), nty = ceil(ny/ty). 端のタイルの格子外は任意の値で埋める.
+ *  タイル(ti, tj)のzmin, zmaxは格子点 i = ti*tx-1 ... (ti+1)*tx+1
+ *  (jも同様, 格子内に丸める)を含むこと(補間で参照する範囲).
+ * ================================================= */
+class heightfield
+{
+public:
+    enum Interp {
+        INTERP_BILINEAR,
+        INTERP_BICUBIC      //Catmull-Rom, C1連続
+    };
+
+private:
+    //tile metadata (as stored in the tiled file)
+    struct tilerange
+    {
+        doublereal zmin;
+        doublereal zmax;
+    };
+
+    Interp interp;
+    int iNx, iNy;
+    doublereal x0, y0;
+    doublereal dx, dy;
+    //in-memory grid
+    std::vector<doublereal> z;
+
+    //tiled grid (memory mapped)
+    int iTx, iTy;
+    int iNtx, iNty;
+    void *pMap;
+    std::size_t iMapSize;
+    const tilerange *pRange;
+    const doublereal *pTiles;
+
+    //not copyable (owns the mapping)
+    heightfield(const heightfield&);
+    heightfield& operator = (const heightfield&);
+
+    void loadGrid(const char *sFileName);
+    void mapTiles(const char *sFileName);
+    void unmap(void);
+
+    //cell index and local coordinate of (x, y)
+    void locate(const doublereal& x, const doublereal& y,
+        int& i, int& j, doublereal& tx, doublereal& ty,
+        doublereal& sx, doublereal& sy) const;
+    doublereal node(int i, int j) const;
+    //height and gradient at (x, y)
+    void eval(const doublereal& x, const doublereal& y,
+        doublereal& h, doublereal& hx, doublereal& hy) const;
+
+public:
+    heightfield(void);
+    ~heightfield(void);
+
+    //load grid or map tiled grid from binary file (throws ErrGeneric on failure)
+    void load(const char *sFileName);
+    void setInterp(Interp i);
+    Interp getInterp(void) const;
+    bool bLoaded(void) const;
+    bool bTiled(void) const;
+
+    //upper bound of the seabed height around (x, y) without reading samples;
+    //returns false when no bound is available (untiled grid)
+    bool bUpperBound(const doublereal& x, const doublereal& y, doublereal& zb) const;
+    //upper bound of the seabed height in [xlo, xhi] x [ylo, yhi]
+    //(samples of the untiled grid, tile ranges of the tiled grid)
+    doublereal dUpperBound(const doublereal& xlo, const doublereal& ylo,
+        const doublereal& xhi, const doublereal& yhi) const;
+
+    //seabed height at (x, y)
+    doublereal height(const doublereal& x, const doublereal& y) const;
+    //seabed height and unit normal at (x, y)
+    void surface(const doublereal& x, const doublereal& y,
+        doublereal& h, Vec3& normal_vec) const;
+    //seabed height and unit normal of n points
+    void surface(std::size_t n, const doublereal *x, const doublereal *y,
+        doublereal *h, doublereal *nx, doublereal *ny, doublereal *nz) const;
+};
+
+#endif // HEIGHTFIELD_H
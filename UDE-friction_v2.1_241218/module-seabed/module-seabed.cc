@@ -45,12 +45,18 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
+#include <cstring>
 
 #include "module-seabed.h"
 #include "seabedprop.h"
+#include "contacttrace.h"
 
 /* ----------------------------- Seabed start --------------------------------------*/
 
+//lower bound of n_z of mesh faces (steeper faces are treated as this slope)
+static const doublereal SEABED_MESH_NZ_MIN = 1.0e-3;
+
 /*=======================================================================================
  * Constructor and Destructor
  *=======================================================================================*/
@@ -71,7 +77,28 @@ Seabed::Seabed (
 			"- Note: \n"
 			"\tTest, \n"
 			"- Usage: \n"
-			"\tSeabed, g, z, nu1d, nu1s, nu2d, nu2s, vt;\n"
+			"\tSeabed, g, z, nu1d, nu1s, nu2d, nu2s, vt\n"
+			"\t\t[, bathymetry, \"<file>\" [, interpolation, {bilinear | bicubic}]];\n"
+			"\tbathymetry file: int32 nx, ny; float64 x0, y0, dx, dy; float64 z[ny][nx]\n"
+			"\t\tor tiled (\"SBTILE01\", memory mapped, see heightfield.h)\n"
+			"\tSeabed, g, z, nu1d, nu1s, nu2d, nu2s, vt, mesh, \"<binary STL file>\";\n"
+			"\toptional soil zones (after bathymetry/mesh):\n"
+			"\t\t, soil, <n>, <id>, k, c, nu1d, nu1s, nu2d, nu2s, ...,\n"
+			"\t\t{raster | polygons}, \"<file>\"\n"
+			"\t\toutside the zones the values given to Seabed and Contactlaw are used\n"
+			"\toptional contact manager (after soil zones):\n"
+			"\t\t, contact, k, <k>, c, <c>,\n"
+			"\t\tnodes, { all [, region, <xmin>, <ymin>, <xmax>, <ymax>] |\n"
+			"\t\t  <num_nodes>, <node_label_1>, ... |\n"
+			"\t\t  label range, <first_node_label>, <last_node_label> }\n"
+			"\t\t[, cell, <cell_size>] [, margin, <margin>]\n"
+			"\t\t[, stable step, { mass, <node_mass> | masses, <mass_1>, ..., <mass_N> } [, factor, <factor>]]\n"
+			"\t\tSeabed assembles the contact of these nodes itself (no Contactlaw needed);\n"
+			"\t\tregion selects by the initial position, cell is the broadphase grid size;\n"
+			"\t\tstable step masses follow the order of the selected nodes\n"
+			"- Private data: \n"
+			"\tcandidates, contacts, cells (contact manager, last residual),\n"
+			"\tstable_step, stable_step_node (contact manager, after convergence)\n"
 			<< std::endl);
 		
 		if (!HP.IsArg()) {
@@ -88,25 +115,383 @@ Seabed::Seabed (
 	doublereal nu2s = HP.GetReal();
 	doublereal vt 	= HP.GetReal();
 	pSeabedprop.setValue(g, z, nu1d, nu1s, nu2d, nu2s,vt);
-	//pExchangevector
-	
+	//pHeightfield
+	if (HP.IsKeyWord("bathymetry")) {
+		const char *sFileName = HP.GetFileName();
+		pHeightfield.load(sFileName);
 
+		if (HP.IsKeyWord("interpolation")) {
+			if (HP.IsKeyWord("bilinear")) {
+				pHeightfield.setInterp(heightfield::INTERP_BILINEAR);
+			} else if (HP.IsKeyWord("bicubic")) {
+				pHeightfield.setInterp(heightfield::INTERP_BICUBIC);
+			} else {
+				silent_cerr("Seabed(" << uLabel << "): unknown interpolation "
+					"at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	} else if (HP.IsKeyWord("mesh")) {
+		const char *sFileName = HP.GetFileName();
+		pTrimesh.load(sFileName);
+	}
+	//pSoilmap
+	if (HP.IsKeyWord("soil")) {
+		int nZones = HP.GetInt();
+		if (nZones <= 0) {
+			silent_cerr("Seabed(" << uLabel << "): invalid number of soil zones "
+				"at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		for (int i = 0; i < nZones; i++) {
+			soilprop p;
+			p.iZone = HP.GetInt();
+			p.k 	= HP.GetReal();
+			p.c 	= HP.GetReal();
+			p.nu1d 	= HP.GetReal();
+			p.nu1s 	= HP.GetReal();
+			p.nu2d 	= HP.GetReal();
+			p.nu2s 	= HP.GetReal();
+			pSoilmap.addZone(p);
+		}
+		if (HP.IsKeyWord("raster")) {
+			pSoilmap.loadRaster(HP.GetFileName());
+		} else if (HP.IsKeyWord("polygons")) {
+			pSoilmap.loadPolygons(HP.GetFileName());
+		} else {
+			silent_cerr("Seabed(" << uLabel << "): \"raster\" or \"polygons\" expected "
+				"at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	//pContact
+	if (HP.IsKeyWord("contact")) {
+		ReadContact(pDM, HP);
+	}
 
 	//output flag
 	SetOutputFlag(pDM->fReadOutput(HP, Elem::LOADABLE));
 	//export log file
 	pDM->GetLogFile()
 		<< "Seabed: " << uLabel
+		<< " " << (pTrimesh.bLoaded() ? "mesh" : (pHeightfield.bTiled() ? "tiled" : (pHeightfield.bLoaded() ? "bathymetry" : "flat")))
+		<< " " << pContact.getNodes().size()
 		<< std::endl;
-	std ::cout << "30" << std::endl;
+	CONTACT_TRACE(CONTACT_TRACE_INFO, TRACE_LIFECYCLE, "Seabed created", uLabel, 0.0);
 }
 
 //destructor
 Seabed::~Seabed (void)
 {
 	NO_OP;
-	std ::cout << "31" << std::endl;
+	CONTACT_TRACE(CONTACT_TRACE_INFO, TRACE_LIFECYCLE, "Seabed destroyed", GetLabel(), 0.0);
+}
+
+//read the managed nodes and contact parameters
+void
+Seabed::ReadContact(DataManager* pDM, MBDynParser& HP)
+{
+	// read k, c
+	if (!HP.IsKeyWord("k")) {
+		silent_cerr("Seabed(" << GetLabel() << "): keyword \"k\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	doublereal k = HP.GetReal();
+	if (!HP.IsKeyWord("c")) {
+		silent_cerr("Seabed(" << GetLabel() << "): keyword \"c\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	doublereal c = HP.GetReal();
+
+	// read nodes
+	if (!HP.IsKeyWord("nodes")) {
+		silent_cerr("Seabed(" << GetLabel() << "): keyword \"nodes\" expected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	std::vector<const StructNode *> pNodes;
+	if (HP.IsKeyWord("all")) {
+		//節点ごとにReadNodeを呼ばず, 読み込み済みの構造節点から選ぶ
+		bool bRegion = false;
+		doublereal xmin = 0.0, ymin = 0.0, xmax = 0.0, ymax = 0.0;
+		if (HP.IsKeyWord("region")) {
+			bRegion = true;
+			xmin = HP.GetReal();
+			ymin = HP.GetReal();
+			xmax = HP.GetReal();
+			ymax = HP.GetReal();
+			if (xmax < xmin || ymax < ymin) {
+				silent_cerr("Seabed(" << GetLabel() << "): invalid region at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		const DataManager::NodeContainerType& nodes = pDM->GetNodes();
+		for (DataManager::NodeContainerType::const_iterator i = nodes.begin(); i != nodes.end(); ++i) {
+			const StructNode *pNode = dynamic_cast<const StructNode *>(*i);
+			//dummy nodeは自由度を持たない
+			if (pNode == 0 || pNode->GetStructNodeType() == StructNode::DUMMY) {
+				continue;
+			}
+			const Vec3& X = pNode->GetXCurr();
+			if (bRegion && (X.dGet(1) < xmin || X.dGet(1) > xmax || X.dGet(2) < ymin || X.dGet(2) > ymax)) {
+				continue;
+			}
+			pNodes.push_back(pNode);
+		}
+
+	} else if (HP.IsKeyWord("label" "range")) {
+		integer iFirst = HP.GetInt();
+		integer iLast = HP.GetInt();
+		if (iLast < iFirst) {
+			silent_cerr("Seabed(" << GetLabel() << "): invalid label range " << iFirst << ":" << iLast << " at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		pNodes.resize(iLast - iFirst + 1);
+		for (integer l = iFirst; l <= iLast; l++) {
+			const StructNode *pNode = dynamic_cast<const StructNode *>(pDM->pFindNode(Node::STRUCTURAL, l));
+			if (pNode == 0) {
+				silent_cerr("Seabed(" << GetLabel() << "): StructNode(" << l << ") not found at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+			pNodes[l - iFirst] = pNode;
+		}
+
+	} else {
+		integer iNumNodes = HP.GetInt();
+		if (iNumNodes < 1) {
+			silent_cerr("Seabed(" << GetLabel() << "): at least 1 node expected at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		pNodes.resize(iNumNodes);
+		for (integer i = 0; i < iNumNodes; i++) {
+			pNodes[i] = dynamic_cast<const StructNode *>(pDM->ReadNode(HP, Node::STRUCTURAL));
+		}
+	}
+	if (pNodes.empty()) {
+		silent_cerr("Seabed(" << GetLabel() << "): no structural node selected at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	// read cell, margin (optional)
+	//既定のセルは10(節点間隔の数倍, 1セルに数十節点)
+	doublereal h = 10.0;
+	if (HP.IsKeyWord("cell")) {
+		h = HP.GetReal();
+		if (!(h > 0.0)) {
+			silent_cerr("Seabed(" << GetLabel() << "): cell size must be positive at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	doublereal dMargin = 0.0;
+	if (HP.IsKeyWord("margin")) {
+		dMargin = HP.GetReal();
+		if (dMargin < 0.0) {
+			silent_cerr("Seabed(" << GetLabel() << "): margin must be non-negative at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+
+	// read stable step (optional)
+	//接触の剛性, 減衰と節点の質量から次の時間刻みの目安をprivate dataに出す
+	//(浮いている節点の下向き加速度の上限は2|g|)
+	const std::size_t N = pNodes.size();
+	bool bStable = false;
+	std::vector<doublereal> dMass(N, 0.0);
+	doublereal dFactor = 0.1;
+	if (HP.IsKeyWord("stable" "step")) {
+		bStable = true;
+		if (HP.IsKeyWord("mass")) {
+			dMass.assign(N, HP.GetReal());
+		} else if (HP.IsKeyWord("masses")) {
+			for (std::size_t i = 0; i < N; i++) {
+				dMass[i] = HP.GetReal();
+			}
+		} else {
+			silent_cerr("Seabed(" << GetLabel() << "): keyword \"mass\" or \"masses\" expected at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		for (std::size_t i = 0; i < N; i++) {
+			if (dMass[i] <= 0.0) {
+				silent_cerr("Seabed(" << GetLabel() << "): mass of node " << pNodes[i]->GetLabel()
+					<< " must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+		if (HP.IsKeyWord("factor")) {
+			dFactor = HP.GetReal();
+			if (dFactor <= 0.0) {
+				silent_cerr("Seabed(" << GetLabel() << "): factor must be positive at line " << HP.GetLineData() << std::endl);
+				throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+			}
+		}
+	}
+	doublereal g, z, nu1d, nu1s, nu2d, nu2s, vt;
+	get(g, z, nu1d, nu1s, nu2d, nu2s, vt);
+	pss.setValue(N, bStable, 0.0, 2.0*std::abs(g), dFactor);
+	for (std::size_t i = 0; i < N; i++) {
+		pss.setMass(i, dMass[i]);
+	}
+
+	pContact.setValue(pNodes, k, c, h, dMargin);
 }
+/*=======================================================================================
+ * Seabed Surface
+ *=======================================================================================*/
+bool
+Seabed::bBathymetry(void) const
+{
+	return pHeightfield.bLoaded() || pTrimesh.bLoaded();
+}
+
+//seabed height and unit normal at (x, y)
+void
+Seabed::surface(
+	const doublereal& x, const doublereal& y,
+	doublereal& zs, Vec3& normal_vec) const
+{
+	if (pHeightfield.bLoaded()) {
+		pHeightfield.surface(x, y, zs, normal_vec);
+		return;
+	}
+	//メッシュの最も高い面(メッシュの範囲外は平らな海底面)
+	if (pTrimesh.bLoaded() && pTrimesh.top(x, y, zs, normal_vec)) {
+		return;
+	}
+
+	//平らな海底面
+	doublereal g, nu1d, nu1s, nu2d, nu2s, vt;
+	get(g, zs, nu1d, nu1s, nu2d, nu2s, vt);
+	normal_vec = Vec3(0., 0., 1.);
+}
+
+//seabed height and unit normal below the point r
+void
+Seabed::surface(const Vec3& r, doublereal& zs, Vec3& normal_vec) const
+{
+	/*
+	 * タイルの高さの上限より上にある節点は標本を読まずに棄却する.
+	 * 上限を海底高さとして返すので隙間は小さめ(安全側)に評価される.
+	 */
+	doublereal zb;
+	if (pHeightfield.bUpperBound(r.dGet(1), r.dGet(2), zb) && r.dGet(3) > zb) {
+		zs = zb;
+		normal_vec = Vec3(0., 0., 1.);
+		return;
+	}
+
+	if (pTrimesh.bLoaded()) {
+		trimeshhint hint;
+		surface(r, zs, normal_vec, hint);
+		return;
+	}
+
+	surface(r.dGet(1), r.dGet(2), zs, normal_vec);
+}
+
+//seabed height and unit normal below the point r (triangle mesh)
+void
+Seabed::surface(const Vec3& r, doublereal& zs, Vec3& normal_vec, trimeshhint& hint) const
+{
+	if (!pTrimesh.bLoaded()) {
+		surface(r, zs, normal_vec);
+		return;
+	}
+
+	//メッシュより上にある節点は探索しない
+	if (r.dGet(3) > pTrimesh.dGetZMax()) {
+		zs = pTrimesh.dGetZMax();
+		normal_vec = Vec3(0., 0., 1.);
+		return;
+	}
+
+	/*
+	 * 最近接点qを含む三角形の平面を(x, y)での高さに直す.
+	 * (r_z - zs)*n_z = n.(r - q) となり, 接触力の隙間は最近接面からの符号付き距離になる.
+	 * 鉛直な面(n_z -> 0)は扱えないので n_z に下限を設ける.
+	 */
+	Vec3 q;
+	int iTri;
+	pTrimesh.closest(r, hint, q, iTri);
+	normal_vec = pTrimesh.normal(iTri);
+	doublereal nz = std::max(normal_vec.dGet(3), SEABED_MESH_NZ_MIN);
+	zs = q.dGet(3) - (normal_vec.dGet(1)*(r.dGet(1) - q.dGet(1))
+		+ normal_vec.dGet(2)*(r.dGet(2) - q.dGet(2)))/nz;
+}
+
+//upper bound of the seabed height in a rectangle
+doublereal
+Seabed::dUpperBound(
+	const doublereal& xlo, const doublereal& ylo,
+	const doublereal& xhi, const doublereal& yhi) const
+{
+	if (pHeightfield.bLoaded()) {
+		return pHeightfield.dUpperBound(xlo, ylo, xhi, yhi);
+	}
+
+	if (pTrimesh.bLoaded()) {
+		/*
+		 * 節点の最近接面は真下の面とは限らないので, 矩形を各方向に矩形の大きさだけ広げる.
+		 * 重なる面がなければメッシュ全体の上限(surfaceの棄却と同じ).
+		 */
+		const doublereal w = std::max(xhi - xlo, yhi - ylo);
+		doublereal zb;
+		if (pTrimesh.bUpperBound(xlo - w, ylo - w, xhi + w, yhi + w, zb)) {
+			return zb;
+		}
+		return pTrimesh.dGetZMax();
+	}
+
+	doublereal g, z, nu1d, nu1s, nu2d, nu2s, vt;
+	get(g, z, nu1d, nu1s, nu2d, nu2s, vt);
+	return z;
+}
+
+doublereal
+Seabed::UpperBound(const void *pCtx, const doublereal& xlo, const doublereal& ylo,
+	const doublereal& xhi, const doublereal& yhi)
+{
+	return static_cast<const Seabed *>(pCtx)->dUpperBound(xlo, ylo, xhi, yhi);
+}
+
+//soil property at (x, y)
+const soilprop *
+Seabed::soil(const doublereal& x, const doublereal& y, soilhint& hint) const
+{
+	return pSoilmap.get(x, y, hint);
+}
+
+//seabed height and unit normal of n points
+void
+Seabed::surface(
+	std::size_t n, const doublereal *x, const doublereal *y, const doublereal *z,
+	const std::size_t *iNode, trimeshhint *pHint,
+	doublereal *zs, doublereal *nx, doublereal *ny, doublereal *nz) const
+{
+	if (pHeightfield.bLoaded()) {
+		pHeightfield.surface(n, x, y, zs, nx, ny, nz);
+		return;
+	}
+	//メッシュは節点ごとの最近接点(Contactlawと同じ定義, 前回の三角形から探す)
+	if (pTrimesh.bLoaded()) {
+		for (std::size_t i = 0; i < n; i++) {
+			Vec3 normal_vec;
+			surface(Vec3(x[i], y[i], z[i]), zs[i], normal_vec, pHint[iNode[i]]);
+			nx[i] = normal_vec.dGet(1);
+			ny[i] = normal_vec.dGet(2);
+			nz[i] = normal_vec.dGet(3);
+		}
+		return;
+	}
+
+	doublereal g, Zs, nu1d, nu1s, nu2d, nu2s, vt;
+	get(g, Zs, nu1d, nu1s, nu2d, nu2s, vt);
+	for (std::size_t i = 0; i < n; i++) {
+		zs[i] = Zs;
+		nx[i] = 0.;
+		ny[i] = 0.;
+		nz[i] = 1.;
+	}
+}
+
 /*=======================================================================================
  * Intial Assembly Process
  *=======================================================================================*/
@@ -115,7 +500,6 @@ unsigned int
 Seabed::iGetInitialNumDof(void) const
 {
 	return 0;
-	std ::cout << "32" << std::endl;
 }
 
 //set initial value
@@ -123,7 +507,6 @@ void
 Seabed::SetInitialValue(VectorHandler& XCurr)
 {
 	return;
-	std ::cout << "33" << std::endl;
 }
 
 //set initial assembly matrix dimension
@@ -132,7 +515,6 @@ Seabed::InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) const
 {
 	*piNumRows = 0;
 	*piNumCols = 0;
-	std ::cout << "34" << std::endl;
 }
 
 //calculate residual vector for initial assembly analysis
@@ -143,7 +525,6 @@ Seabed::InitialAssRes(
 {
 	WorkVec.ResizeReset(0);
 	return WorkVec;
-	std ::cout << "35" << std::endl;
 }
 //calculate Jaconbian for initial assembly analysis
 VariableSubMatrixHandler&
@@ -153,7 +534,6 @@ Seabed::InitialAssJac(
 {
 	WorkMat.SetNullMatrix();
 	return WorkMat;
-	std ::cout << "36" << std::endl;
 }
 /*=======================================================================================
  * Initial Value Problem
@@ -163,7 +543,6 @@ unsigned int
 Seabed::iGetNumDof(void) const
 {
 	return 0;
-	std ::cout << "37" << std::endl;
 }
 
 //set DOF type
@@ -172,7 +551,6 @@ Seabed::GetDofType(unsigned int i) const
 {
 
 	return DofOrder::DIFFERENTIAL;
-	std ::cout << "38" << std::endl;
 }
 
 //set initial value
@@ -184,7 +562,6 @@ Seabed::SetValue(
 	SimulationEntity::Hints *ph)
 {
 	return;
-	std ::cout << "39" << std::endl;
 }
 
 /*
@@ -203,9 +580,10 @@ Sea::DescribeEq(std::ostream& out, const char *prefix, bool bInitial) const
 void
 Seabed::WorkSpaceDim(integer* piNumRows, integer* piNumCols) const
 {
-	*piNumRows = 0;
-	*piNumCols = 0;	
-	std ::cout << "40" << std::endl;
+	//residual: 3 rows per managed node
+	//Jacobian: 3x3 block per node in contact (sparse, 3 columns per row)
+	*piNumRows = 3*pContact.getNodes().size();
+	*piNumCols = pContact.bActive() ? 3 : 0;
 }
 
 //calculate residual vector
@@ -216,9 +594,16 @@ Seabed::AssRes(
 	const VectorHandler& XCurr, 
 	const VectorHandler& XPrimeCurr)
 {
-	WorkVec.ResizeReset(0);
+	if (!pContact.bActive()) {
+		WorkVec.ResizeReset(0);
+		return WorkVec;
+	}
+
+	//海底面に届きうる節点だけ接触を調べる
+	pContact.find(*this, XCurr, XPrimeCurr);
+	CONTACT_TRACE(CONTACT_TRACE_VERBOSE, TRACE_ASSEMBLY, "Seabed contact candidates", GetLabel(), double(pContact.iGetNumCandidates()));
+	pContact.force(WorkVec);
 	return WorkVec;
-	std ::cout << "41" << std::endl;
 }
 
 //calculate Jacobian matrix
@@ -229,9 +614,14 @@ Seabed::AssJac(
 	const VectorHandler& XCurr,
 	const VectorHandler& XPrimeCurr)
 {
-	WorkMat.SetNullMatrix();
+	if (!pContact.bActive()) {
+		WorkMat.SetNullMatrix();
+		return WorkMat;
+	}
+
+	pContact.find(*this, XCurr, XPrimeCurr);
+	pContact.jacobian(WorkMat, dCoef);
 	return WorkMat;
-	std ::cout << "42" << std::endl;
 }
 /*=======================================================================================
  * Private Data
@@ -240,51 +630,55 @@ Seabed::AssJac(
 unsigned int
 Seabed::iGetNumPrivData(void) const
 {
-	return 0;
-	std ::cout << "43" << std::endl;
+	return 3 + stablestep::iGetNumPrivData();
 }
 
-/*
 //set index of private data
 unsigned int
-Sea::iGetPrivDataIdx(const char *s) const
-{	
+Seabed::iGetPrivDataIdx(const char *s) const
+{
 	static const struct {
-		int index;
-		char name[3];
-	}
-
-	data[] = {
-			{ 1, "A"},
-			{ 2, "B"},
-			{ 3, "C"},
+		unsigned int index;
+		const char *name;
+	} data[] = {
+		{ 1, "candidates" },
+		{ 2, "contacts" },
+		{ 3, "cells" },
 	};
 
-	for (unsigned i = 0; i < sizeof(data) / sizeof(data[0]); ++i ) {
-		if (0 == strcmp(data[i].name,s)) {
+	for (unsigned i = 0; i < sizeof(data)/sizeof(data[0]); i++) {
+		if (std::strcmp(data[i].name, s) == 0) {
 			return data[i].index;
 		}
 	}
+	//stable step follows
+	const unsigned int i = pss.iGetPrivDataIdx(s);
+	if (i != 0) {
+		return 3 + i;
+	}
 
-	silent_cerr("Sea (" << GetLabel() << "): no private data \"" << s << "\"" << std::endl);
-
-	return 0;	
+	silent_cerr("Seabed(" << GetLabel() << "): no private data \"" << s << "\"" << std::endl);
+	return 0;
 }
+
 //function to get private data
 doublereal
-Sea::dGetPrivData(unsigned int i) const;
+Seabed::dGetPrivData(unsigned int i) const
 {
 	switch (i) {
 	case 1:
-		return a;
+		return doublereal(pContact.iGetNumCandidates());
 	case 2:
-		return b;
+		return doublereal(pContact.iGetNumContacts());
 	case 3:
-		return c;
+		return doublereal(pContact.iGetNumCells());
 	}
-	throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+	if (i > 3 && i <= iGetNumPrivData()) {
+		return pss.dGetPrivData(i - 3);
+	}
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 }
-*/
+
 /*=======================================================================================
  * Configure runtime processing
  *=======================================================================================*/
@@ -293,7 +687,6 @@ void
 Seabed::Update(const VectorHandler& XCurr, const VectorHandler& XPrimeCurr)
 {
 	return;
-	std ::cout << "44" << std::endl;
 }
 //process before each iteration
 void
@@ -303,21 +696,22 @@ Seabed::BeforePredict(VectorHandler& /* X */ ,
 					VectorHandler& /* XPPrev */ ) const
 {
 	return;
-	std ::cout << "45" << std::endl;
 }
 //process after each iteration
 void
 Seabed::AfterPredict(VectorHandler& X, VectorHandler& XP)
 {
 	return;
-	std ::cout << "46" << std::endl;
 }
 //process after convergence (each time step)
 void
 Seabed::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 {
-	return;
-	std ::cout << "47" << std::endl;
+	//収束解の接触から次の時間刻みの目安
+	if (pContact.bActive() && pss.bGetEnabled()) {
+		pContact.find(*this, X, XP);
+		pContact.stable(pss, *this, X, XP);
+	}
 }
 /*=======================================================================================
  * Output
@@ -332,31 +726,32 @@ Seabed::Output(OutputHandler& OH) const
 				<< std::endl;
 		}
 	}
-	std ::cout << "48" << std::endl;
+	CONTACT_TRACE(CONTACT_TRACE_VERBOSE, TRACE_OUTPUT, "Seabed output", GetLabel(), 0.0);
 }
 
 /*=======================================================================================
  * etc
  *=======================================================================================*/
-/*
 //print information of connected nodes
 int
-Sea::iGetNumConnectedNodes(void) const
+Seabed::iGetNumConnectedNodes(void) const
 {
-	return 0;
+	return pContact.getNodes().size();
 }
 void
-Sea::GetConnectedNodes(std::vector<const Node *>& connectedNodes) const
+Seabed::GetConnectedNodes(std::vector<const Node *>& connectedNodes) const
 {
-	return;
+	const std::vector<const StructNode *>& pNodes = pContact.getNodes();
+	connectedNodes.resize(pNodes.size());
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		connectedNodes[i] = pNodes[i];
+	}
 }
-*/
 //output restart file
 std::ostream&
 Seabed::Restart(std::ostream& out) const
 {
    	return out << "# Seabed (" << GetLabel() << "): not implemented yet" << std::endl;
-	std ::cout << "49" << std::endl;
 }
 /* ----------------------------- Seabed end -------------------------------------- */
 
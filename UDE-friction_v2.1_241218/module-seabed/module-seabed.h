@@ -42,10 +42,29 @@
 #include "dataman.h"
 #include "userelem.h"
 #include "seabedprop.h"
+#include "heightfield.h"
+#include "trimesh.h"
+#include "soilmap.h"
+#include "seabedcontact.h"
 
 class Seabed
 : virtual public Elem, public UserDefinedElem, public seabedpropowner
 {
+private:
+	//bathymetry (flat seabed at z when not loaded)
+	heightfield 	pHeightfield;
+	//triangle mesh (instead of the bathymetry)
+	trimesh 		pTrimesh;
+	//soil zones (k, c and friction per zone)
+	soilmap 		pSoilmap;
+	//nodes whose contact is assembled by this element (contact manager)
+	seabedcontact 	pContact;
+	//time step hint of the managed nodes (contact manager)
+	stablestep 		pss;
+
+	//read the managed nodes and contact parameters
+	void ReadContact(DataManager* pDM, MBDynParser& HP);
+
 public:
 	/*===================================================================
 	 * Constructor and Destructor
@@ -57,6 +76,34 @@ public:
 	virtual ~Seabed(void);
 
 
+	/*===================================================================
+	 * Seabed Surface
+	 *===================================================================*/
+	//true when a bathymetry grid or a triangle mesh is loaded
+	bool bBathymetry(void) const;
+	//seabed height and unit normal at (x, y)
+	void surface(const doublereal& x, const doublereal& y,
+		doublereal& zs, Vec3& normal_vec) const;
+	//seabed height and unit normal below the point r; when r is above the
+	//height range of its tile, zs is that upper bound and no samples are read
+	void surface(const Vec3& r, doublereal& zs, Vec3& normal_vec) const;
+	//same, with the per-node hint for triangle mesh queries
+	void surface(const Vec3& r, doublereal& zs, Vec3& normal_vec, trimeshhint& hint) const;
+	//soil property at (x, y), 0 outside the soil zones (default soil)
+	const soilprop *soil(const doublereal& x, const doublereal& y, soilhint& hint) const;
+	//upper bound of the seabed height in [xlo, xhi] x [ylo, yhi]
+	doublereal dUpperBound(const doublereal& xlo, const doublereal& ylo,
+		const doublereal& xhi, const doublereal& yhi) const;
+	//same, as a callback for the active set (pCtx: the Seabed)
+	static doublereal UpperBound(const void *pCtx, const doublereal& xlo, const doublereal& ylo,
+		const doublereal& xhi, const doublereal& yhi);
+	//seabed height and unit normal of n points (x, y, z); a triangle mesh uses the
+	//closest point like surface(r, zs, normal_vec, hint) with the hint pHint[iNode[i]]
+	void surface(std::size_t n, const doublereal *x, const doublereal *y, const doublereal *z,
+		const std::size_t *iNode, trimeshhint *pHint,
+		doublereal *zs, doublereal *nx, doublereal *ny, doublereal *nz) const;
+
+
 	/*===================================================================
 	 * Intial Assembly Process
 	 *===================================================================*/
@@ -133,12 +180,10 @@ public:
 	 *-------------------------------------------------------------------*/
 	//set number of private data
 	virtual unsigned int iGetNumPrivData(void) const;
-	/*
 	//set index of private data
 	virtual unsigned int iGetPrivDataIdx(const char *s) const;
 	//function to get private data
 	virtual doublereal dGetPrivData(unsigned int i) const;
-	*/
 
 	/*-------------------------------------------------------------------
 	 * Configure runtime processing
@@ -171,8 +216,8 @@ public:
 	 * etc
 	 *===================================================================*/
 	//print information of connected nodes
-	//virtual int iGetNumConnectedNodes(void) const;
-	//virtual void GetConnectedNodes(std::vector<const Node *>& connectedNodes) const;
+	virtual int iGetNumConnectedNodes(void) const;
+	virtual void GetConnectedNodes(std::vector<const Node *>& connectedNodes) const;
 	//output restart file
 	virtual std::ostream& Restart(std::ostream& out) const;
 };
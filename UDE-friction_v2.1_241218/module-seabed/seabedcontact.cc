@@ -0,0 +1,189 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+#include "seabedcontact.h"
+#include "module-seabed.h"
+
+/* ------------------------------ seabedcontact start ---------------------------------------*/
+seabedcontact::seabedcontact(void)
+: k(0.0), c(0.0), dMargin(0.0), iCandidates(0)
+{
+	NO_OP;
+}
+
+seabedcontact::~seabedcontact(void)
+{
+	NO_OP;
+}
+
+/*--[0]setValue-------------------------------------------------------------------------*/
+void
+seabedcontact::setValue(const std::vector<const StructNode *>& pNodes,
+	const doublereal& k, const doublereal& c,
+	const doublereal& h, const doublereal& dMargin)
+{
+	this->pNodes = pNodes;
+	this->k = k;
+	this->c = c;
+	this->dMargin = dMargin;
+	pGrid.setValue(h);
+
+	const std::size_t N = pNodes.size();
+	iCell.assign(N, 0);
+	zCell.assign(N, 0.0);
+	bCell.assign(N, 0);
+	dGap.assign(N, 0.0);
+	pHint.assign(N, trimeshhint());
+	pSoilHint.assign(N, soilhint());
+	pFrameCache.assign(N, framecache());
+	contacts.reserve(N);
+}
+
+/*--[1]find(broadphaseとnarrowphase)--------------------------------------------------*/
+void
+seabedcontact::find(const Seabed& sb, const VectorHandler& XCurr, const VectorHandler& XPrimeCurr)
+{
+	doublereal g, z, nu1d, nu1s, nu2d, nu2s, vt;
+	sb.get(g, z, nu1d, nu1s, nu2d, nu2s, vt);
+
+	iCandidates = 0;
+	contacts.clear();
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+		const Vec3 r(XCurr(iPos + 1), XCurr(iPos + 2), XCurr(iPos + 3));
+
+		//broadphase: セルの海底高さの上限(セルが変わらなければ前回の値)
+		const unsigned long long iKey = pGrid.key(r.dGet(1), r.dGet(2));
+		if (!bCell[i] || iCell[i] != iKey) {
+			doublereal zb;
+			if (!pGrid.find(iKey, zb)) {
+				doublereal xlo, ylo, xhi, yhi;
+				pGrid.rect(iKey, xlo, ylo, xhi, yhi);
+				zb = sb.dUpperBound(xlo, ylo, xhi, yhi);
+				pGrid.insert(iKey, zb);
+			}
+			iCell[i] = iKey;
+			zCell[i] = zb;
+			bCell[i] = 1;
+		}
+		if (r.dGet(3) > zCell[i] + dMargin) {
+			dGap[i] = r.dGet(3) - zCell[i];
+			continue;
+		}
+		iCandidates++;
+
+		//narrowphase: 節点の下の海底面
+		contactpoint p;
+		sb.surface(r, p.Zs, p.normal_vec, pHint[i]);
+		dGap[i] = (r.dGet(3) - p.Zs)*p.normal_vec.dGet(3);
+		if (dGap[i] > 0.0) {
+			continue;
+		}
+
+		//土質区分の外はSeabedとcontactの値
+		p.k = k;
+		p.c = c;
+		p.fp.nu1d = nu1d; p.fp.nu1s = nu1s;
+		p.fp.nu2d = nu2d; p.fp.nu2s = nu2s;
+		p.fp.vt = vt;
+		p.fp.dcrit = CONTACTPOLICY_DCRIT;
+		p.fp.kt = 0.0; p.fp.ct = 0.0; p.fp.vs = 0.0;
+		const soilprop *pSoil = sb.soil(r.dGet(1), r.dGet(2), pSoilHint[i]);
+		if (pSoil != 0) {
+			p.k = pSoil->k;
+			p.c = pSoil->c;
+			p.fp.nu1d = pSoil->nu1d; p.fp.nu1s = pSoil->nu1s;
+			p.fp.nu2d = pSoil->nu2d; p.fp.nu2s = pSoil->nu2s;
+		}
+
+		//接線方向の基底はx軸から作る(鉛直な面ではcachedframeの代わりの軸)
+		contactlawdefault::frame(p.normal_vec, Vec3(1.0, 0.0, 0.0), pFrameCache[i],
+			p.axial_unitvec, p.lateral_unitvec);
+
+		p.iNode = i;
+		p.iPositionIndex = iPos;
+		p.iMomentumIndex = pNodes[i]->iGetFirstMomentumIndex();
+		p.r = r;
+		p.v = Vec3(XPrimeCurr(iPos + 1), XPrimeCurr(iPos + 2), XPrimeCurr(iPos + 3));
+		contacts.push_back(p);
+	}
+}
+
+/*--[2]force, jacobian------------------------------------------------------------------*/
+void
+seabedcontact::force(SubVectorHandler& WorkVec) const
+{
+	WorkVec.ResizeReset(3*contacts.size());
+	for (std::size_t i = 0; i < contacts.size(); i++) {
+		const contactpoint& p = contacts[i];
+		Vec3 f;
+		frictionstate fs;
+		contactlawdefault::force(f, fs, p.r, p.v, p.normal_vec, p.axial_unitvec, p.lateral_unitvec,
+			p.Zs, p.k, p.c, p.fp, frictionstate());
+
+		const integer iRow = 3*i;
+		for (int iCnt = 1; iCnt <= 3; iCnt++) {
+			WorkVec.PutRowIndex(iRow + iCnt, p.iMomentumIndex + iCnt);
+			WorkVec.PutCoef(iRow + iCnt, f(iCnt));
+		}
+	}
+}
+
+void
+seabedcontact::jacobian(VariableSubMatrixHandler& WorkMat, const doublereal& dCoef) const
+{
+	if (contacts.empty()) {
+		WorkMat.SetNullMatrix();
+		return;
+	}
+
+	SparseSubMatrixHandler& WM = WorkMat.SetSparse();
+	WM.ResizeReset(9*contacts.size(), 1);
+
+	integer iEntry = 1;
+	for (std::size_t i = 0; i < contacts.size(); i++) {
+		const contactpoint& p = contacts[i];
+		doublereal J[3][3];
+		contactlawdefault::jacobian(J, p.r, p.v, p.normal_vec, p.axial_unitvec, p.lateral_unitvec,
+			p.Zs, p.k, p.c, p.fp, frictionstate(), dCoef);
+
+		for (int iRow = 1; iRow <= 3; iRow++) {
+			for (int iCol = 1; iCol <= 3; iCol++) {
+				WM.PutItem(iEntry++, p.iMomentumIndex + iRow, p.iPositionIndex + iCol, J[iRow - 1][iCol - 1]);
+			}
+		}
+	}
+}
+
+/*--[3]stable(時間刻みの目安)---------------------------------------------------------*/
+void
+seabedcontact::stable(stablestep& pss, const Seabed& sb, const VectorHandler& XCurr, const VectorHandler& XPrimeCurr) const
+{
+	//contactsは節点の順に並んでいる
+	pss.begin();
+	std::size_t n = 0;
+	for (std::size_t i = 0; i < pNodes.size(); i++) {
+		if (n < contacts.size() && contacts[n].iNode == i) {
+			//接触している節点: 節点の下の土質の値と反力
+			const contactpoint& p = contacts[n++];
+			const doublereal z = (p.r.dGet(3) - p.Zs)*p.normal_vec.dGet(3);
+			const doublereal fn = std::max(-p.k*z - p.c*p.v.Dot(p.normal_vec), 0.0);
+			const doublereal nu = std::max(std::max(p.fp.nu1d, p.fp.nu1s), std::max(p.fp.nu2d, p.fp.nu2s));
+			pss.update(i, pNodes[i]->GetLabel(), p.r, p.v, z, p.k, p.c, 0.0, 0.0, fn, nu, p.fp.vt,
+				&Seabed::UpperBound, &sb);
+			continue;
+		}
+
+		//浮いている節点(隙間 > 0): 既定のk, cと海底面に届くまでの時間
+		const integer iPos = pNodes[i]->iGetFirstPositionIndex();
+		const Vec3 r(XCurr(iPos + 1), XCurr(iPos + 2), XCurr(iPos + 3));
+		const Vec3 v(XPrimeCurr(iPos + 1), XPrimeCurr(iPos + 2), XPrimeCurr(iPos + 3));
+		pss.update(i, pNodes[i]->GetLabel(), r, v, dGap[i], k, c, 0.0, 0.0, 0.0, 0.0, 0.0,
+			&Seabed::UpperBound, &sb);
+	}
+}
+
+/* ------------------------------ seabedcontact end -----------------------------------------*/
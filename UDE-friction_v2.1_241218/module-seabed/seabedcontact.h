@@ -0,0 +1,94 @@
+#ifndef SEABEDCONTACT_H
+#define SEABEDCONTACT_H
+
+#include <cstddef>
+#include <vector>
+
+#include <mbconfig.h>
+#include "dataman.h"
+#include "trimesh.h"
+#include "soilmap.h"
+#include "seabedgrid.h"
+#include "contactpolicy.h"
+#include "stablestep.h"
+
+class Seabed;
+
+/* =================================================
+ * class Seabed Contact
+ *  Seabedが管理する節点の集合と海底面の接触(contact manager).
+ *  節点ごとにContactlawを並べる代わりに, Seabed 1要素で接触力を組み込む.
+ *
+ *  broadphase : 節点をseabedgridのセルに振り分け, セルの海底高さの上限より
+ *               上にある節点は海底面を探索しない(セルが変わらない節点は前回の上限を使う).
+ *  narrowphase: 残った節点だけ海底面(高さ, 法線, 土質)を求め, 接触力を計算する.
+ *
+ *  接触力は元のContactlawと同じ(contactlawdefault). 節点の間の向きがないので
+ *  接線方向の基底は任意の向きから作る(摩擦力は P = I - n n^T にしかよらない).
+ *  摩擦係数は1方向目(nu1d)を使う.
+ *
+ *  stable: 収束後に全節点の時間刻みの目安を求める. 接触している節点は接触の値,
+ *  浮いている節点は海底面に届くまでの時間(Seabed::dUpperBound)を使う.
+ * ================================================= */
+class seabedcontact
+{
+private:
+    //node in contact at the last pass
+    struct contactpoint
+    {
+        std::size_t iNode;
+        integer iPositionIndex;
+        integer iMomentumIndex;
+        Vec3 r, v;
+        Vec3 normal_vec, axial_unitvec, lateral_unitvec;
+        doublereal Zs, k, c;
+        frictionparam fp;
+    };
+
+    std::vector<const StructNode *> pNodes;
+    doublereal k;
+    doublereal c;
+    doublereal dMargin;
+    seabedgrid pGrid;
+
+    //cell and bound of each node at the last pass
+    std::vector<unsigned long long> iCell;
+    std::vector<doublereal> zCell;
+    std::vector<char> bCell;
+    //gap of each node at the last pass (cell bound for the nodes left out by the broadphase)
+    std::vector<doublereal> dGap;
+
+    //per node hints of the seabed queries
+    std::vector<trimeshhint> pHint;
+    std::vector<soilhint> pSoilHint;
+    std::vector<framecache> pFrameCache;
+
+    std::size_t iCandidates;
+    std::vector<contactpoint> contacts;
+
+public:
+    seabedcontact(void);
+    virtual ~seabedcontact(void);
+
+    //managed nodes, default k and c, cell size of the grid and margin above the bound
+    virtual void setValue(const std::vector<const StructNode *>& pNodes,
+        const doublereal& k, const doublereal& c,
+        const doublereal& h, const doublereal& dMargin);
+    bool bActive(void) const { return !pNodes.empty(); };
+    const std::vector<const StructNode *>& getNodes(void) const { return pNodes; };
+
+    //broadphase and narrowphase of all managed nodes
+    void find(const Seabed& sb, const VectorHandler& XCurr, const VectorHandler& XPrimeCurr);
+    //nodes passed to the narrowphase, nodes in contact and cells of the grid (last pass)
+    std::size_t iGetNumCandidates(void) const { return iCandidates; };
+    std::size_t iGetNumContacts(void) const { return contacts.size(); };
+    std::size_t iGetNumCells(void) const { return pGrid.iGetNumCells(); };
+
+    //contact forces and 3x3 blocks of the nodes in contact
+    void force(SubVectorHandler& WorkVec) const;
+    void jacobian(VariableSubMatrixHandler& WorkMat, const doublereal& dCoef) const;
+    //time step hint of all managed nodes (after find)
+    void stable(stablestep& pss, const Seabed& sb, const VectorHandler& XCurr, const VectorHandler& XPrimeCurr) const;
+};
+
+#endif // SEABEDCONTACT_H
@@ -0,0 +1,120 @@
+#include "mbconfig.h"
+
+#include <cmath>
+#include <stdint.h>
+#include <iostream>
+
+#include "seabedgrid.h"
+
+//initial number of slots (power of 2)
+static const std::size_t SEABEDGRID_INITIAL_SLOTS = 1024;
+
+/* ------------------------------ seabedgrid start ---------------------------------------*/
+seabedgrid::seabedgrid(void)
+: h(1.0), hinv(1.0), cells(SEABEDGRID_INITIAL_SLOTS), iCount(0)
+{
+	NO_OP;
+}
+
+seabedgrid::~seabedgrid(void)
+{
+	NO_OP;
+}
+
+/*--[0]setValue-------------------------------------------------------------------------*/
+void
+seabedgrid::setValue(const doublereal& h)
+{
+	if (!(h > 0.0)) {
+		silent_cerr("seabedgrid: cell size must be positive" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	this->h = h;
+	hinv = 1.0/h;
+	std::vector<cell>(SEABEDGRID_INITIAL_SLOTS).swap(cells);
+	iCount = 0;
+}
+
+/*--[1]key(セルの番号)----------------------------------------------------------------*/
+unsigned long long
+seabedgrid::key(const doublereal& x, const doublereal& y) const
+{
+	//32bitに収まらない座標は端のセルにまとめる(上限は安全側のまま)
+	const doublereal dLim = 2147483647.0;
+	doublereal u = std::floor(x*hinv);
+	doublereal w = std::floor(y*hinv);
+	u = (u < -dLim) ? -dLim : ((u > dLim) ? dLim : u);
+	w = (w < -dLim) ? -dLim : ((w > dLim) ? dLim : w);
+	return (static_cast<unsigned long long>(static_cast<uint32_t>(static_cast<int32_t>(u))) << 32)
+		| static_cast<unsigned long long>(static_cast<uint32_t>(static_cast<int32_t>(w)));
+}
+
+void
+seabedgrid::rect(unsigned long long iKey,
+	doublereal& xlo, doublereal& ylo, doublereal& xhi, doublereal& yhi) const
+{
+	const int32_t ix = static_cast<int32_t>(static_cast<uint32_t>(iKey >> 32));
+	const int32_t iy = static_cast<int32_t>(static_cast<uint32_t>(iKey & 0xffffffffULL));
+	xlo = ix*h;
+	ylo = iy*h;
+	xhi = xlo + h;
+	yhi = ylo + h;
+}
+
+/*--[2]ハッシュ表--------------------------------------------------------------------*/
+inline std::size_t
+seabedgrid::slot(unsigned long long iKey) const
+{
+	//Fibonacci hashing (上位のbitを使う)
+	const unsigned long long iHash = iKey*0x9E3779B97F4A7C15ULL;
+	return std::size_t(iHash >> 32) & (cells.size() - 1);
+}
+
+bool
+seabedgrid::find(unsigned long long iKey, doublereal& zb) const
+{
+	const std::size_t iMask = cells.size() - 1;
+	for (std::size_t s = slot(iKey); cells[s].bUsed; s = (s + 1) & iMask) {
+		if (cells[s].iKey == iKey) {
+			zb = cells[s].zb;
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+seabedgrid::insert(unsigned long long iKey, const doublereal& zb)
+{
+	if (2*(iCount + 1) > cells.size()) {
+		grow();
+	}
+
+	const std::size_t iMask = cells.size() - 1;
+	std::size_t s = slot(iKey);
+	for (; cells[s].bUsed; s = (s + 1) & iMask) {
+		if (cells[s].iKey == iKey) {
+			cells[s].zb = zb;
+			return;
+		}
+	}
+	cells[s].iKey = iKey;
+	cells[s].zb = zb;
+	cells[s].bUsed = true;
+	iCount++;
+}
+
+void
+seabedgrid::grow(void)
+{
+	std::vector<cell> old(2*cells.size());
+	old.swap(cells);
+	iCount = 0;
+	for (std::size_t i = 0; i < old.size(); i++) {
+		if (old[i].bUsed) {
+			insert(old[i].iKey, old[i].zb);
+		}
+	}
+}
+
+/* ------------------------------ seabedgrid end -----------------------------------------*/
@@ -0,0 +1,61 @@
+#ifndef SEABEDGRID_H
+#define SEABEDGRID_H
+
+#include <cstddef>
+#include <vector>
+
+#include <mbconfig.h>
+#include "dataman.h"
+
+/* =================================================
+ * class Seabed Grid
+ *  (x, y)平面の等間隔格子(セルの大きさh)を, 使われたセルだけハッシュ表に持つ.
+ *  セルごとに海底高さの上限zbを保持し, 節点がzb(+ margin)より上にあれば
+ *  海底面を探索せずに接触しないと判定する(broadphase).
+ *  海底面は動かないので, zbは最初に節点が入ったときに1回だけ求める.
+ *
+ *  key = (ix, iy), ix = floor(x/h), iy = floor(y/h) (各32bit)
+ *  開番地法(線形探索), 使用率が1/2を超えたら2倍に広げる.
+ * ================================================= */
+class seabedgrid
+{
+private:
+    struct cell
+    {
+        unsigned long long iKey;
+        doublereal zb;
+        bool bUsed;
+
+        cell(void) : iKey(0), zb(0.0), bUsed(false) {};
+    };
+
+    doublereal h;
+    doublereal hinv;
+    std::vector<cell> cells;
+    std::size_t iCount;
+
+    std::size_t slot(unsigned long long iKey) const;
+    void grow(void);
+
+public:
+    seabedgrid(void);
+    virtual ~seabedgrid(void);
+
+    //cell size (> 0)
+    virtual void setValue(const doublereal& h);
+    doublereal getCellSize(void) const { return h; };
+    //number of cells with a bound
+    std::size_t iGetNumCells(void) const { return iCount; };
+
+    //cell containing (x, y)
+    unsigned long long key(const doublereal& x, const doublereal& y) const;
+    //extent of a cell
+    void rect(unsigned long long iKey,
+        doublereal& xlo, doublereal& ylo, doublereal& xhi, doublereal& yhi) const;
+
+    //upper bound of the seabed height in a cell; false if not set yet
+    bool find(unsigned long long iKey, doublereal& zb) const;
+    void insert(unsigned long long iKey, const doublereal& zb);
+};
+
+#endif // SEABEDGRID_H
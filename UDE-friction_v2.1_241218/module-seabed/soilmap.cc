@@ -0,0 +1,242 @@
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+#include "soilmap.h"
+
+/* ------------------------------ soilmap start ---------------------------------------*/
+soilmap::soilmap(void)
+: iNx(0), iNy(0), x0(0.0), y0(0.0), dx(1.0), dy(1.0)
+{
+	NO_OP;
+}
+
+soilmap::~soilmap(void)
+{
+	NO_OP;
+}
+
+/*--[0]特性表と区分図の読み込み-------------------------------------------------------*/
+void
+soilmap::addZone(const soilprop& p)
+{
+	for (std::size_t i = 0; i < table.size(); i++) {
+		if (table[i].iZone == p.iZone) {
+			silent_cerr("soilmap: zone " << p.iZone << " defined twice" << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	table.push_back(p);
+}
+
+void
+soilmap::loadRaster(const char *sFileName)
+{
+	FILE *fp = std::fopen(sFileName, "rb");
+	if (fp == 0) {
+		silent_cerr("soilmap: unable to open soil raster \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	int32_t n[2];
+	doublereal h[4];
+	bool bOk = (std::fread(n, sizeof(int32_t), 2, fp) == 2)
+		&& (std::fread(h, sizeof(doublereal), 4, fp) == 4)
+		&& n[0] >= 1 && n[1] >= 1 && h[2] > 0.0 && h[3] > 0.0;
+
+	std::vector<int32_t> ids;
+	if (bOk) {
+		ids.resize(std::size_t(n[0])*std::size_t(n[1]));
+		bOk = (std::fread(&ids[0], sizeof(int32_t), ids.size(), fp) == ids.size());
+	}
+	std::fclose(fp);
+
+	if (!bOk) {
+		silent_cerr("soilmap: invalid or truncated soil raster \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	iNx = n[0];
+	iNy = n[1];
+	x0 	= h[0];
+	y0 	= h[1];
+	dx 	= h[2];
+	dy 	= h[3];
+	id.assign(ids.begin(), ids.end());
+}
+
+void
+soilmap::loadPolygons(const char *sFileName)
+{
+	std::ifstream in(sFileName);
+	if (!in) {
+		silent_cerr("soilmap: unable to open soil polygons \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	iPolyZone.clear();
+	iPolyStart.assign(1, 0);
+	px.clear();
+	py.clear();
+
+	std::string line;
+	int iLine = 0;
+	while (std::getline(in, line)) {
+		iLine++;
+		//comment, blank line
+		std::string::size_type iComment = line.find('#');
+		if (iComment != std::string::npos) {
+			line.erase(iComment);
+		}
+		std::replace(line.begin(), line.end(), ',', ' ');
+		std::istringstream ls(line);
+		int iZone, nv;
+		if (!(ls >> iZone)) {
+			continue;
+		}
+		bool bOk = bool(ls >> nv) && nv >= 3;
+		for (int v = 0; bOk && v < nv; v++) {
+			doublereal x, y;
+			bOk = bool(ls >> x >> y);
+			px.push_back(x);
+			py.push_back(y);
+		}
+		if (!bOk) {
+			silent_cerr("soilmap: invalid polygon at line " << iLine
+				<< " of \"" << sFileName << "\"" << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		iPolyZone.push_back(iZone);
+		iPolyStart.push_back(int(px.size()));
+	}
+}
+
+bool
+soilmap::bLoaded(void) const
+{
+	return !id.empty() || !iPolyZone.empty();
+}
+
+const soilprop *
+soilmap::find(int iZone) const
+{
+	for (std::size_t i = 0; i < table.size(); i++) {
+		if (table[i].iZone == iZone) {
+			return &table[i];
+		}
+	}
+	return 0;
+}
+
+/*--[1]get(節点位置の土質, 区分が変わらない範囲では前回の結果を使う)------------------*/
+const soilprop *
+soilmap::get(const doublereal& x, const doublereal& y, soilhint& hint) const
+{
+	if (x >= hint.xlo && x < hint.xhi && y >= hint.ylo && y < hint.yhi) {
+		return hint.pProp;
+	}
+
+	if (!id.empty()) {
+		return resolveRaster(x, y, hint);
+	}
+	if (!iPolyZone.empty()) {
+		return resolvePolygon(x, y, hint);
+	}
+
+	//区分図なし
+	const doublereal dMax = std::numeric_limits<doublereal>::max();
+	hint.pProp 	= 0;
+	hint.xlo 	= hint.ylo = -dMax;
+	hint.xhi 	= hint.yhi = dMax;
+	return 0;
+}
+
+/*--[1A]raster(セルの範囲を保持)-----------------------------------------------------*/
+const soilprop *
+soilmap::resolveRaster(const doublereal& x, const doublereal& y, soilhint& hint) const
+{
+	const doublereal dMax = std::numeric_limits<doublereal>::max();
+	doublereal u = std::floor((x - x0)/dx);
+	doublereal w = std::floor((y - y0)/dy);
+
+	//格子の外側は, 外側にいる間は既定値
+	if (u < 0.0 || u >= doublereal(iNx)) {
+		hint.pProp 	= 0;
+		hint.xlo 	= (u < 0.0) ? -dMax : x0 + iNx*dx;
+		hint.xhi 	= (u < 0.0) ? x0 : dMax;
+		hint.ylo 	= -dMax;
+		hint.yhi 	= dMax;
+		return 0;
+	}
+	if (w < 0.0 || w >= doublereal(iNy)) {
+		hint.pProp 	= 0;
+		hint.xlo 	= -dMax;
+		hint.xhi 	= dMax;
+		hint.ylo 	= (w < 0.0) ? -dMax : y0 + iNy*dy;
+		hint.yhi 	= (w < 0.0) ? y0 : dMax;
+		return 0;
+	}
+
+	int i = int(u), j = int(w);
+	hint.pProp 	= find(id[std::size_t(j)*std::size_t(iNx) + std::size_t(i)]);
+	hint.xlo 	= x0 + i*dx;
+	hint.xhi 	= hint.xlo + dx;
+	hint.ylo 	= y0 + j*dy;
+	hint.yhi 	= hint.ylo + dy;
+	return hint.pProp;
+}
+
+/*--[1B]polygon(最も近い辺までの距離の内側の正方形を保持)----------------------------*/
+const soilprop *
+soilmap::resolvePolygon(const doublereal& x, const doublereal& y, soilhint& hint) const
+{
+	int iZone = -1;
+	bool bFound = false;
+	doublereal d2 = std::numeric_limits<doublereal>::max();
+
+	for (std::size_t p = 0; p + 1 < iPolyStart.size(); p++) {
+		bool bIn = false;
+		const int iFirst = iPolyStart[p], iLast = iPolyStart[p + 1];
+		for (int a = iFirst, b = iLast - 1; a < iLast; b = a++) {
+			//even-odd rule
+			if ((py[a] > y) != (py[b] > y)
+				&& x < (px[b] - px[a])*(y - py[a])/(py[b] - py[a]) + px[a]) {
+				bIn = !bIn;
+			}
+			//distance to edge ab
+			doublereal ex = px[b] - px[a], ey = py[b] - py[a];
+			doublereal l2 = ex*ex + ey*ey;
+			doublereal t = (l2 > 0.0) ? ((x - px[a])*ex + (y - py[a])*ey)/l2 : 0.0;
+			t = std::max(0.0, std::min(1.0, t));
+			doublereal qx = px[a] + t*ex - x, qy = py[a] + t*ey - y;
+			d2 = std::min(d2, qx*qx + qy*qy);
+		}
+		if (bIn && !bFound) {
+			iZone = iPolyZone[p];
+			bFound = true;
+		}
+	}
+
+	//辺から離れている間は区分が変わらない
+	doublereal h = std::sqrt(d2)/std::sqrt(2.0);
+	hint.pProp 	= bFound ? find(iZone) : 0;
+	hint.xlo 	= x - h;
+	hint.xhi 	= x + h;
+	hint.ylo 	= y - h;
+	hint.yhi 	= y + h;
+	return hint.pProp;
+}
+
+/* ------------------------------ soilmap end -----------------------------------------*/
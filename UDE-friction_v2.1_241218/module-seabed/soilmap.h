@@ -0,0 +1,89 @@
+#ifndef SOILMAP_H
+#define SOILMAP_H
+
+#include <cstddef>
+#include <vector>
+
+#include <mbconfig.h>
+#include "dataman.h"
+
+/* =================================================
+ * struct Soil Property
+ *  土質区分(zone)ごとの弾性床定数と摩擦係数
+ * ================================================= */
+struct soilprop
+{
+    int iZone;
+    doublereal k;
+    doublereal c;
+    doublereal nu1d;
+    doublereal nu1s;
+    doublereal nu2d;
+    doublereal nu2s;
+};
+
+/* =================================================
+ * struct Soil Hint
+ *  節点ごとに前回の土質区分を保持する(呼び出し側が持つ).
+ *  [xlo, xhi] x [ylo, yhi] の中では区分が変わらないことが分かっている.
+ * ================================================= */
+struct soilhint
+{
+    const soilprop *pProp;
+    doublereal xlo, xhi;
+    doublereal ylo, yhi;
+
+    soilhint(void) : pProp(0), xlo(1.0), xhi(-1.0), ylo(1.0), yhi(-1.0) {};
+};
+
+/* =================================================
+ * class Soil Map
+ *  海底面の土質区分図. 区分はraster(格子ごとの区分番号)か
+ *  polygon(多角形ごとの区分番号)で与え, 区分番号を特性表で土質定数に変換する.
+ *  範囲外や特性表にない区分番号は既定値(0を返す)とする.
+ *
+ *  raster file (binary, little endian)
+ *    int32   nx, ny        : セル数
+ *    float64 x0, y0        : 原点(セル(0, 0)の角)の座標
+ *    float64 dx, dy        : セルの大きさ (> 0)
+ *    int32   id[ny][nx]    : 区分番号(xが速く変わる順)
+ *
+ *  polygon file (text)
+ *    id, n, x1, y1, ..., xn, yn   (多角形ごとに1行, 先に書いたものを優先)
+ * ================================================= */
+class soilmap
+{
+private:
+    std::vector<soilprop> table;
+
+    //raster
+    int iNx, iNy;
+    doublereal x0, y0;
+    doublereal dx, dy;
+    std::vector<int> id;
+
+    //polygons (vertices of polygon p: x[iStart[p]] ... x[iStart[p+1]-1])
+    std::vector<int> iPolyZone;
+    std::vector<int> iPolyStart;
+    std::vector<doublereal> px, py;
+
+    const soilprop *find(int iZone) const;
+    const soilprop *resolveRaster(const doublereal& x, const doublereal& y, soilhint& hint) const;
+    const soilprop *resolvePolygon(const doublereal& x, const doublereal& y, soilhint& hint) const;
+
+public:
+    soilmap(void);
+    ~soilmap(void);
+
+    void addZone(const soilprop& p);
+    //load zone map (throws ErrGeneric on failure)
+    void loadRaster(const char *sFileName);
+    void loadPolygons(const char *sFileName);
+    bool bLoaded(void) const;
+
+    //soil property at (x, y); 0 for the default soil.
+    //the hint is reused while (x, y) stays in the region where the zone is known
+    const soilprop *get(const doublereal& x, const doublereal& y, soilhint& hint) const;
+};
+
+#endif // SOILMAP_H
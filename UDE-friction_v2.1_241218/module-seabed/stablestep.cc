@@ -0,0 +1,125 @@
+#include "mbconfig.h"
+
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+#include "except.h"
+#include "stablestep.h"
+
+/* ------------------------------ stablestep start ---------------------------------------*/
+static const struct {
+	unsigned int index;
+	const char *name;
+} stablestep_data[] = {
+	{ 1, "stable_step" },
+	{ 2, "stable_step_node" },
+};
+
+stablestep::stablestep(void)
+: bEnabled(false), dAccMax(0.0), dFactor(1.0),
+dStep(std::numeric_limits<doublereal>::max()), uNode(0)
+{
+	NO_OP;
+}
+
+stablestep::~stablestep(void)
+{
+	NO_OP;
+}
+
+/*--[0]setValue-------------------------------------------------------------------------*/
+void
+stablestep::setValue(std::size_t n, bool bEnable, const doublereal& m,
+	const doublereal& acc, const doublereal& factor)
+{
+	dMass.assign(n, m);
+	bEnabled = bEnable;
+	dAccMax = acc;
+	dFactor = factor;
+}
+
+/*--[1]1自由度系の安定限界------------------------------------------------------------*/
+doublereal
+stablestep::dLimit(const doublereal& m, const doublereal& k, const doublereal& c)
+{
+	const doublereal dMax = std::numeric_limits<doublereal>::max();
+	if (!(m > 0.0)) {
+		return dMax;
+	}
+	if (!(k > 0.0)) {
+		return (c > 0.0) ? 2.0*m/c : dMax;
+	}
+	const doublereal w = std::sqrt(k/m);
+	const doublereal z = (c > 0.0) ? c/(2.0*m*w) : 0.0;
+	//z が大きいときの桁落ちを避ける: sqrt(1 + z^2) - z = 1/(sqrt(1 + z^2) + z)
+	return 2.0/(w*(std::sqrt(1.0 + z*z) + z));
+}
+
+/*--[2]時間刻みの目安------------------------------------------------------------------*/
+void
+stablestep::begin(void)
+{
+	dStep = std::numeric_limits<doublereal>::max();
+	uNode = 0;
+}
+
+void
+stablestep::update(std::size_t i, unsigned uLabel, const Vec3& r, const Vec3& v, const doublereal& gap,
+	const doublereal& k, const doublereal& c, const doublereal& kt, const doublereal& ct,
+	const doublereal& fn, const doublereal& nu, const doublereal& vt,
+	activeset::Bound bound, const void *pCtx)
+{
+	const doublereal m = dMass[i];
+
+	//法線方向と接線方向(摩擦の正則化は傾き nu*F/vt の減衰)
+	const doublereal cr = (fn > 0.0 && vt > 0.0) ? nu*fn/vt : 0.0;
+	doublereal dt = std::min(dLimit(m, k, c), dLimit(m, kt, ct + cr));
+	if (dt < std::numeric_limits<doublereal>::max()) {
+		dt *= dFactor;
+	}
+
+	//浮いている節点は海底面に届くまでの最短時間(activesetと同じ見積もり)
+	if (gap > 0.0) {
+		dt = std::max(dt, activeset::dReachTime(r, v, dAccMax, 0.0, bound, pCtx));
+	}
+
+	if (dt < dStep) {
+		dStep = dt;
+		uNode = uLabel;
+	}
+}
+
+/*--[3]private data-------------------------------------------------------------------*/
+unsigned int
+stablestep::iGetNumPrivData(void)
+{
+	return sizeof(stablestep_data)/sizeof(stablestep_data[0]);
+}
+
+unsigned int
+stablestep::iGetPrivDataIdx(const char *s)
+{
+	for (unsigned int i = 0; i < iGetNumPrivData(); i++) {
+		if (std::strcmp(stablestep_data[i].name, s) == 0) {
+			return stablestep_data[i].index;
+		}
+	}
+	return 0;
+}
+
+doublereal
+stablestep::dGetPrivData(unsigned int i) const
+{
+	switch (i) {
+	case 1:
+		return dStep;
+	case 2:
+		return doublereal(uNode);
+	}
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+}
+
+/* ------------------------------ stablestep end -----------------------------------------*/
@@ -0,0 +1,77 @@
+#ifndef STABLESTEP_H
+#define STABLESTEP_H
+
+#include <cstddef>
+#include <vector>
+
+#include <mbconfig.h>
+#include "myassert.h"
+#include "matvec3.h"
+#include "activeset.h"
+
+/* =================================================
+ * class Stable Step
+ *  接触の剛性, 減衰と節点の質量から時間刻みの目安を求める.
+ *  節点ごとに質量m, 剛性k, 減衰cの1自由度系とみなし, 陽解法の安定限界
+ *    dt = 2/w (sqrt(1 + z^2) - z),  w = sqrt(k/m), z = c/(2 m w)
+ *  (k = 0 では 2m/c) に係数(factor)をかけたものを精度の目安とする.
+ *    法線方向: k, c
+ *    接線方向: kt, ct (stick slip) と摩擦の正則化の傾き nu*F/vt
+ *
+ *  浮いている節点は, 下向き速度と加速度の上限から求めた海底面に届くまでの
+ *  時間(activeset::dReachTime, 水平に動ける範囲の海底面の上限を使う)が
+ *  接触の目安より長ければその時間を目安とする(海底面に近づくほど小さくなる).
+ *  収束後に全節点の最小値と, それを決めた節点のラベルを更新する.
+ *
+ *  private data
+ *    1 stable_step       時間刻みの目安(最小値, 節点がなければ最大の実数)
+ *    2 stable_step_node  目安を決めた節点のラベル
+ *
+ *  Seabedのcontact managerとmodule-contactlawの要素の両方が使うので
+ *  module-seabedに置く(activesetも同じ).
+ * ================================================= */
+class stablestep
+{
+private:
+    //mass of each node
+    std::vector<doublereal> dMass;
+    bool bEnabled;
+    //upper bound of downward acceleration (airborne nodes)
+    doublereal dAccMax;
+    //ratio to the stability limit
+    doublereal dFactor;
+
+    //last step
+    doublereal dStep;
+    unsigned uNode;
+
+    //stability limit of a single DOF system
+    static doublereal dLimit(const doublereal& m, const doublereal& k, const doublereal& c);
+
+public:
+    stablestep(void);
+    ~stablestep(void);
+
+    virtual void setValue(std::size_t n, bool bEnable, const doublereal& m,
+        const doublereal& acc, const doublereal& factor);
+    bool bGetEnabled(void) const { return bEnabled; };
+    //mass of node i (default: m of setValue)
+    void setMass(std::size_t i, const doublereal& m) { dMass[i] = m; };
+
+    //begin the estimate of the next step (after convergence)
+    void begin(void);
+    //node i (label uLabel) at r with velocity v and gap, contact constants k, c,
+    //tangential kt, ct and normal force fn (nu, vt: friction coefficient and
+    //regularization velocity, bound: seabed upper bound for airborne nodes)
+    void update(std::size_t i, unsigned uLabel, const Vec3& r, const Vec3& v, const doublereal& gap,
+        const doublereal& k, const doublereal& c, const doublereal& kt, const doublereal& ct,
+        const doublereal& fn, const doublereal& nu, const doublereal& vt,
+        activeset::Bound bound, const void *pCtx);
+
+    //private data (index 1 ... iGetNumPrivData(), 0 if the name is unknown)
+    static unsigned int iGetNumPrivData(void);
+    static unsigned int iGetPrivDataIdx(const char *s);
+    doublereal dGetPrivData(unsigned int i) const;
+};
+
+#endif // STABLESTEP_H
@@ -0,0 +1,552 @@
+#include "mbconfig.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+#include "trimesh.h"
+
+//max triangles in a BVH leaf
+static const int TRIMESH_LEAF_SIZE = 4;
+//max depth of the traversal stack
+static const int TRIMESH_STACK_SIZE = 128;
+//max triangles of a patch (about 13 for a regular mesh with 6 triangles per vertex)
+static const int TRIMESH_PATCH_SIZE = 64;
+
+/*--頂点統合のための並べ替え(x, y, zの辞書順)--------------------------------------*/
+struct trimeshvertexless
+{
+	const std::vector<float>& raw;
+	trimeshvertexless(const std::vector<float>& r) : raw(r) {};
+	bool operator () (int a, int b) const {
+		for (int k = 0; k < 3; k++) {
+			if (raw[3*a + k] != raw[3*b + k]) {
+				return raw[3*a + k] < raw[3*b + k];
+			}
+		}
+		return false;
+	};
+};
+
+/*--BVH分割のための並べ替え(重心の座標)----------------------------------------------*/
+struct trimeshcentroidless
+{
+	const std::vector<doublereal>& centroid;
+	int axis;
+	trimeshcentroidless(const std::vector<doublereal>& c, int a) : centroid(c), axis(a) {};
+	bool operator () (int a, int b) const {
+		return centroid[3*a + axis] < centroid[3*b + axis];
+	};
+};
+
+/* ------------------------------ trimesh start ---------------------------------------*/
+trimesh::trimesh(void)
+{
+	NO_OP;
+}
+
+trimesh::~trimesh(void)
+{
+	NO_OP;
+}
+
+/*--[0]load(binary STLの読み込み)-----------------------------------------------------*/
+void
+trimesh::load(const char *sFileName)
+{
+	FILE *fp = std::fopen(sFileName, "rb");
+	if (fp == 0) {
+		silent_cerr("trimesh: unable to open mesh file \"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	//80 byte header, uint32 number of triangles, 50 byte records
+	char header[80];
+	uint32_t n = 0;
+	bool bOk = (std::fread(header, 1, sizeof(header), fp) == sizeof(header))
+		&& (std::fread(&n, sizeof(n), 1, fp) == 1)
+		&& (n > 0);
+
+	long iSize = -1;
+	if (bOk && std::fseek(fp, 0, SEEK_END) == 0) {
+		iSize = std::ftell(fp);
+		std::fseek(fp, 84, SEEK_SET);
+	}
+	if (bOk && iSize != 84 + 50*long(n)) {
+		std::fclose(fp);
+		silent_cerr("trimesh: \"" << sFileName << "\" is not a binary STL file "
+			"(ASCII STL is not supported)" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	std::vector<float> raw;
+	if (bOk) {
+		raw.resize(9*std::size_t(n));
+		char rec[50];
+		for (uint32_t t = 0; bOk && t < n; t++) {
+			bOk = (std::fread(rec, 1, sizeof(rec), fp) == sizeof(rec));
+			//rec: normal(3 float), vertices(9 float), attribute(uint16)
+			std::memcpy(&raw[9*std::size_t(t)], rec + 3*sizeof(float), 9*sizeof(float));
+		}
+	}
+	std::fclose(fp);
+
+	if (!bOk) {
+		silent_cerr("trimesh: mesh file \"" << sFileName << "\" is truncated" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	weld(raw);
+	if (tri.empty()) {
+		silent_cerr("trimesh: mesh file \"" << sFileName << "\" has no valid triangles" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+	buildRing();
+
+	//BVH
+	const int nt = int(tri.size()/3);
+	std::vector<doublereal> centroid(3*std::size_t(nt));
+	for (int t = 0; t < nt; t++) {
+		for (int k = 0; k < 3; k++) {
+			centroid[3*t + k] = (vtx[3*tri[3*t] + k] + vtx[3*tri[3*t + 1] + k] + vtx[3*tri[3*t + 2] + k])/3.0;
+		}
+	}
+	order.resize(nt);
+	for (int t = 0; t < nt; t++) {
+		order[t] = t;
+	}
+	nodes.clear();
+	nodes.reserve(2*(nt/TRIMESH_LEAF_SIZE + 1));
+	nodes.push_back(bvhnode());
+	build(0, 0, nt, centroid);
+}
+
+/*--[0A]weld(同じ座標の頂点を統合し, 面の法線を計算)----------------------------------*/
+void
+trimesh::weld(const std::vector<float>& raw)
+{
+	const int nv = int(raw.size()/3);
+	std::vector<int> idx(nv);
+	for (int i = 0; i < nv; i++) {
+		idx[i] = i;
+	}
+	std::sort(idx.begin(), idx.end(), trimeshvertexless(raw));
+
+	std::vector<int> id(nv);
+	vtx.clear();
+	for (int i = 0; i < nv; i++) {
+		if (i == 0 || trimeshvertexless(raw)(idx[i - 1], idx[i])) {
+			for (int k = 0; k < 3; k++) {
+				vtx.push_back(raw[3*idx[i] + k]);
+			}
+		}
+		id[idx[i]] = int(vtx.size()/3) - 1;
+	}
+
+	tri.clear();
+	fn.clear();
+	for (int t = 0; t < nv/3; t++) {
+		int a = id[3*t], b = id[3*t + 1], c = id[3*t + 2];
+		doublereal u[3], v[3];
+		for (int k = 0; k < 3; k++) {
+			u[k] = vtx[3*b + k] - vtx[3*a + k];
+			v[k] = vtx[3*c + k] - vtx[3*a + k];
+		}
+		doublereal n[3] = {
+			u[1]*v[2] - u[2]*v[1],
+			u[2]*v[0] - u[0]*v[2],
+			u[0]*v[1] - u[1]*v[0]
+		};
+		doublereal s = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+		//面積0の三角形は除く
+		if (a == b || b == c || c == a || !(s > 0.0)) {
+			continue;
+		}
+		//海底面の法線は上向き
+		if (n[2] < 0.0) {
+			s = -s;
+		}
+		tri.push_back(a);
+		tri.push_back(b);
+		tri.push_back(c);
+		for (int k = 0; k < 3; k++) {
+			fn.push_back(n[k]/s);
+		}
+	}
+}
+
+/*--[0B]buildRing(頂点を共有する三角形の一覧)----------------------------------------*/
+void
+trimesh::buildRing(void)
+{
+	const int nv = int(vtx.size()/3);
+	iRingStart.assign(nv + 1, 0);
+	for (std::size_t i = 0; i < tri.size(); i++) {
+		iRingStart[tri[i] + 1]++;
+	}
+	for (int v = 0; v < nv; v++) {
+		iRingStart[v + 1] += iRingStart[v];
+	}
+	iRing.resize(tri.size());
+	std::vector<int> iPos(iRingStart.begin(), iRingStart.end() - 1);
+	for (std::size_t i = 0; i < tri.size(); i++) {
+		iRing[iPos[tri[i]]++] = int(i/3);
+	}
+}
+
+/*--[0C]build(BVHの構築, 重心の中央値で最長軸を2分割)--------------------------------*/
+void
+trimesh::build(int iNode, int iFirst, int iCount, std::vector<doublereal>& centroid)
+{
+	bvhnode node;
+	doublereal clo[3], chi[3];
+	for (int k = 0; k < 3; k++) {
+		node.lo[k] = clo[k] = std::numeric_limits<doublereal>::max();
+		node.hi[k] = chi[k] = -std::numeric_limits<doublereal>::max();
+	}
+	for (int i = iFirst; i < iFirst + iCount; i++) {
+		const int t = order[i];
+		for (int j = 0; j < 3; j++) {
+			for (int k = 0; k < 3; k++) {
+				node.lo[k] = std::min(node.lo[k], vtx[3*tri[3*t + j] + k]);
+				node.hi[k] = std::max(node.hi[k], vtx[3*tri[3*t + j] + k]);
+			}
+		}
+		for (int k = 0; k < 3; k++) {
+			clo[k] = std::min(clo[k], centroid[3*t + k]);
+			chi[k] = std::max(chi[k], centroid[3*t + k]);
+		}
+	}
+
+	if (iCount <= TRIMESH_LEAF_SIZE) {
+		node.iFirst = iFirst;
+		node.iCount = iCount;
+		nodes[iNode] = node;
+		return;
+	}
+
+	int axis = 0;
+	for (int k = 1; k < 3; k++) {
+		if (chi[k] - clo[k] > chi[axis] - clo[axis]) {
+			axis = k;
+		}
+	}
+	const int iHalf = iCount/2;
+	std::nth_element(order.begin() + iFirst, order.begin() + iFirst + iHalf,
+		order.begin() + iFirst + iCount, trimeshcentroidless(centroid, axis));
+
+	const int iChild = int(nodes.size());
+	node.iFirst = iChild;
+	node.iCount = 0;
+	nodes[iNode] = node;
+	nodes.push_back(bvhnode());
+	nodes.push_back(bvhnode());
+	build(iChild, iFirst, iHalf, centroid);
+	build(iChild + 1, iFirst + iHalf, iCount - iHalf, centroid);
+}
+
+bool
+trimesh::bLoaded(void) const
+{
+	return !tri.empty();
+}
+
+std::size_t
+trimesh::iGetNumTriangles(void) const
+{
+	return tri.size()/3;
+}
+
+doublereal
+trimesh::dGetZMax(void) const
+{
+	return nodes.empty() ? 0.0 : nodes[0].hi[2];
+}
+
+Vec3
+trimesh::normal(int iTri) const
+{
+	return Vec3(fn[3*iTri], fn[3*iTri + 1], fn[3*iTri + 2]);
+}
+
+/*--[1]closestOnTri(三角形上の最近接点, Ericson, Real-Time Collision Detection 5.1.5)---*/
+doublereal
+trimesh::closestOnTri(int t, const Vec3& p, Vec3& q) const
+{
+	const doublereal *a = &vtx[3*tri[3*t]];
+	const doublereal *b = &vtx[3*tri[3*t + 1]];
+	const doublereal *c = &vtx[3*tri[3*t + 2]];
+
+	doublereal ab[3], ac[3], ap[3], bp[3], cp[3];
+	for (int k = 0; k < 3; k++) {
+		ab[k] = b[k] - a[k];
+		ac[k] = c[k] - a[k];
+		ap[k] = p(k + 1) - a[k];
+		bp[k] = p(k + 1) - b[k];
+		cp[k] = p(k + 1) - c[k];
+	}
+	doublereal d1 = ab[0]*ap[0] + ab[1]*ap[1] + ab[2]*ap[2];
+	doublereal d2 = ac[0]*ap[0] + ac[1]*ap[1] + ac[2]*ap[2];
+	doublereal d3 = ab[0]*bp[0] + ab[1]*bp[1] + ab[2]*bp[2];
+	doublereal d4 = ac[0]*bp[0] + ac[1]*bp[1] + ac[2]*bp[2];
+	doublereal d5 = ab[0]*cp[0] + ab[1]*cp[1] + ab[2]*cp[2];
+	doublereal d6 = ac[0]*cp[0] + ac[1]*cp[1] + ac[2]*cp[2];
+
+	//barycentric (1 - v - w, v, w)
+	doublereal v, w;
+	doublereal vc = d1*d4 - d3*d2;
+	doublereal vb = d5*d2 - d1*d6;
+	doublereal va = d3*d6 - d5*d4;
+	if (d1 <= 0.0 && d2 <= 0.0) {
+		v = 0.0; w = 0.0;
+	} else if (d3 >= 0.0 && d4 <= d3) {
+		v = 1.0; w = 0.0;
+	} else if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+		v = d1/(d1 - d3); w = 0.0;
+	} else if (d6 >= 0.0 && d5 <= d6) {
+		v = 0.0; w = 1.0;
+	} else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+		v = 0.0; w = d2/(d2 - d6);
+	} else if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+		w = (d4 - d3)/((d4 - d3) + (d5 - d6)); v = 1.0 - w;
+	} else {
+		doublereal denom = 1.0/(va + vb + vc);
+		v = vb*denom; w = vc*denom;
+	}
+
+	q = Vec3(a[0] + ab[0]*v + ac[0]*w, a[1] + ab[1]*v + ac[1]*w, a[2] + ab[2]*v + ac[2]*w);
+	Vec3 d = p - q;
+	return d.Dot();
+}
+
+/*--[2]patch(頂点を共有する三角形)---------------------------------------------------*/
+/*
+ * 周囲が上限を超えるとき(頂点に多数の三角形が集まる扇形)は最初の上限個だけを使う.
+ * 同じtには同じ集合を返すので, dOutとclosestの判定が同じ集合を使い, 結果は正しい.
+ */
+int
+trimesh::patch(int t, int *p) const
+{
+	int n = 0;
+	for (int j = 0; j < 3; j++) {
+		const int v = tri[3*t + j];
+		for (int r = iRingStart[v]; r < iRingStart[v + 1] && n < TRIMESH_PATCH_SIZE; r++) {
+			if (std::find(p, p + n, iRing[r]) == p + n) {
+				p[n++] = iRing[r];
+			}
+		}
+	}
+	std::sort(p, p + n);
+	return n;
+}
+
+/*--[3]search(BVHによる最近接三角形の探索)--------------------------------------------*/
+inline doublereal
+trimesh::boxDist2(const bvhnode& node, const Vec3& p) const
+{
+	doublereal b2 = 0.0;
+	for (int k = 0; k < 3; k++) {
+		doublereal e = std::max(std::max(node.lo[k] - p(k + 1), p(k + 1) - node.hi[k]), 0.0);
+		b2 += e*e;
+	}
+	return b2;
+}
+
+int
+trimesh::search(const Vec3& p, const int *ex, int iNumEx, doublereal& d2, Vec3& q) const
+{
+	int iBest = -1;
+	int stack[TRIMESH_STACK_SIZE];
+	int iTop = 0;
+	stack[iTop++] = 0;
+
+	while (iTop > 0) {
+		const bvhnode& node = nodes[stack[--iTop]];
+
+		//AABBまでの距離が現在の最短距離以上なら枝刈り
+		if (boxDist2(node, p) >= d2) {
+			continue;
+		}
+
+		if (node.iCount > 0) {
+			for (int i = node.iFirst; i < node.iFirst + node.iCount; i++) {
+				const int t = order[i];
+				if (std::binary_search(ex, ex + iNumEx, t)) {
+					continue;
+				}
+				Vec3 qt;
+				doublereal dt2 = closestOnTri(t, p, qt);
+				if (dt2 < d2) {
+					d2 = dt2;
+					q = qt;
+					iBest = t;
+				}
+			}
+			continue;
+		}
+
+		//近い方の子を先にたどる
+		int iNear = node.iFirst, iFar = node.iFirst + 1;
+		if (boxDist2(nodes[iFar], p) < boxDist2(nodes[iNear], p)) {
+			std::swap(iNear, iFar);
+		}
+		assert(iTop + 2 <= TRIMESH_STACK_SIZE);
+		stack[iTop++] = iFar;
+		stack[iTop++] = iNear;
+	}
+
+	return iBest;
+}
+
+/*--[4]closest(前回の三角形の周囲から始める最近接点探索)------------------------------*/
+void
+trimesh::closest(const Vec3& p, trimeshhint& hint, Vec3& q, int& iTri) const
+{
+	int p0[TRIMESH_PATCH_SIZE];
+
+	//周囲の三角形だけで確定できるか
+	if (hint.iTri >= 0) {
+		const int n = patch(hint.iTri, p0);
+		doublereal d2 = std::numeric_limits<doublereal>::max();
+		for (int i = 0; i < n; i++) {
+			Vec3 qt;
+			doublereal dt2 = closestOnTri(p0[i], p, qt);
+			if (dt2 < d2) {
+				d2 = dt2;
+				q = qt;
+				iTri = p0[i];
+			}
+		}
+		doublereal dMove = (p - hint.p0).Norm();
+		if (std::sqrt(d2) <= hint.dOut - dMove) {
+			return;
+		}
+	}
+
+	//全探索
+	doublereal d2 = std::numeric_limits<doublereal>::max();
+	iTri = search(p, 0, 0, d2, q);
+
+	//次回のために周囲の外までの距離を求める
+	const int n = patch(iTri, p0);
+	doublereal dOut2 = std::numeric_limits<doublereal>::max();
+	Vec3 qOut;
+	hint.iTri 	= iTri;
+	hint.p0 	= p;
+	hint.dOut 	= (search(p, p0, n, dOut2, qOut) < 0)
+		? std::numeric_limits<doublereal>::max() : std::sqrt(dOut2);
+}
+
+/*--[5]top((x, y)の真下/真上で最も高い面)----------------------------------------------*/
+bool
+trimesh::top(const doublereal& x, const doublereal& y, doublereal& h, Vec3& normal_vec) const
+{
+	int iBest = -1;
+	int stack[TRIMESH_STACK_SIZE];
+	int iTop = 0;
+	if (!nodes.empty()) {
+		stack[iTop++] = 0;
+	}
+
+	while (iTop > 0) {
+		const bvhnode& node = nodes[stack[--iTop]];
+		if (x < node.lo[0] || x > node.hi[0] || y < node.lo[1] || y > node.hi[1]
+			|| (iBest >= 0 && node.hi[2] <= h)) {
+			continue;
+		}
+
+		if (node.iCount > 0) {
+			for (int i = node.iFirst; i < node.iFirst + node.iCount; i++) {
+				const int t = order[i];
+				const doublereal *a = &vtx[3*tri[3*t]];
+				const doublereal *b = &vtx[3*tri[3*t + 1]];
+				const doublereal *c = &vtx[3*tri[3*t + 2]];
+
+				//xy平面への投影で(x, y)を含むか(重心座標)
+				doublereal det = (b[0] - a[0])*(c[1] - a[1]) - (c[0] - a[0])*(b[1] - a[1]);
+				if (std::abs(det) <= std::numeric_limits<doublereal>::min()) {
+					continue;
+				}
+				doublereal v = ((x - a[0])*(c[1] - a[1]) - (c[0] - a[0])*(y - a[1]))/det;
+				doublereal w = ((b[0] - a[0])*(y - a[1]) - (x - a[0])*(b[1] - a[1]))/det;
+				if (v < 0.0 || w < 0.0 || v + w > 1.0) {
+					continue;
+				}
+				doublereal z = a[2] + (b[2] - a[2])*v + (c[2] - a[2])*w;
+				if (iBest < 0 || z > h) {
+					h = z;
+					iBest = t;
+				}
+			}
+			continue;
+		}
+
+		assert(iTop + 2 <= TRIMESH_STACK_SIZE);
+		stack[iTop++] = node.iFirst + 1;
+		stack[iTop++] = node.iFirst;
+	}
+
+	if (iBest < 0) {
+		return false;
+	}
+	normal_vec = normal(iBest);
+	return true;
+}
+
+/*--[6]bUpperBound(矩形に重なる三角形の最も高い頂点)---------------------------------*/
+bool
+trimesh::bUpperBound(const doublereal& xlo, const doublereal& ylo,
+	const doublereal& xhi, const doublereal& yhi, doublereal& zb) const
+{
+	bool bFound = false;
+	int stack[TRIMESH_STACK_SIZE];
+	int iTop = 0;
+	if (!nodes.empty()) {
+		stack[iTop++] = 0;
+	}
+
+	while (iTop > 0) {
+		const bvhnode& node = nodes[stack[--iTop]];
+		//重ならない箱と, 既に見つけた高さより低い箱は枝刈り
+		if (xhi < node.lo[0] || xlo > node.hi[0] || yhi < node.lo[1] || ylo > node.hi[1]
+			|| (bFound && node.hi[2] <= zb)) {
+			continue;
+		}
+
+		if (node.iCount > 0) {
+			for (int i = node.iFirst; i < node.iFirst + node.iCount; i++) {
+				const int t = order[i];
+				const doublereal *a = &vtx[3*tri[3*t]];
+				const doublereal *b = &vtx[3*tri[3*t + 1]];
+				const doublereal *c = &vtx[3*tri[3*t + 2]];
+
+				//三角形の外接矩形で判定する(上限なので大きめでよい)
+				if (xhi < std::min(a[0], std::min(b[0], c[0])) || xlo > std::max(a[0], std::max(b[0], c[0]))
+					|| yhi < std::min(a[1], std::min(b[1], c[1])) || ylo > std::max(a[1], std::max(b[1], c[1]))) {
+					continue;
+				}
+				doublereal z = std::max(a[2], std::max(b[2], c[2]));
+				if (!bFound || z > zb) {
+					zb = z;
+					bFound = true;
+				}
+			}
+			continue;
+		}
+
+		assert(iTop + 2 <= TRIMESH_STACK_SIZE);
+		stack[iTop++] = node.iFirst + 1;
+		stack[iTop++] = node.iFirst;
+	}
+
+	return bFound;
+}
+
+/* ------------------------------ trimesh end -----------------------------------------*/
@@ -0,0 +1,98 @@
+#ifndef TRIMESH_H
+#define TRIMESH_H
+
+#include <cstddef>
+#include <vector>
+
+#include <mbconfig.h>
+#include "dataman.h"
+
+/* =================================================
+ * struct Triangle Mesh Hint
+ *  節点ごとに前回の探索結果を保持する(呼び出し側が持つ).
+ *  iTri         : 前回の最近接三角形
+ *  p0           : 全探索をした位置
+ *  dOut         : p0からiTriの周囲(頂点を共有する三角形)以外の三角形までの最短距離
+ * ================================================= */
+struct trimeshhint
+{
+    int iTri;
+    Vec3 p0;
+    doublereal dOut;
+
+    trimeshhint(void) : iTri(-1), p0(0.0, 0.0, 0.0), dOut(-1.0) {};
+};
+
+/* =================================================
+ * class Triangle Mesh
+ *  三角形メッシュの海底地形(binary STL)
+ *  読み込み時に頂点を統合し, 三角形のBVH(AABB木)を作る.
+ *  面の法線は上向き(nz >= 0)にそろえる.
+ *
+ *  最近接点の探索は前回の三角形の周囲から始める.
+ *  距離関数は1-Lipschitzなので, 周囲の三角形までの距離 d が
+ *  dOut - |p - p0| 以下なら周囲の外に最近接点はなく, BVHをたどらずに済む(O(1)).
+ *  周囲は固定長の配列に置く(探索ごとにメモリを確保しない).
+ * ================================================= */
+class trimesh
+{
+private:
+    //BVH node (leaf: iCount > 0, triangles order[iFirst ... iFirst+iCount-1];
+    //internal: iCount == 0, children iFirst and iFirst+1)
+    struct bvhnode
+    {
+        doublereal lo[3];
+        doublereal hi[3];
+        int iFirst;
+        int iCount;
+    };
+
+    //welded vertices (x, y, z)
+    std::vector<doublereal> vtx;
+    //triangles (3 vertex indices) and unit face normals
+    std::vector<int> tri;
+    std::vector<doublereal> fn;
+    //triangles around each vertex (CSR)
+    std::vector<int> iRingStart;
+    std::vector<int> iRing;
+    //BVH
+    std::vector<bvhnode> nodes;
+    std::vector<int> order;
+
+    void weld(const std::vector<float>& raw);
+    void buildRing(void);
+    void build(int iNode, int iFirst, int iCount, std::vector<doublereal>& centroid);
+    //triangles sharing a vertex with triangle t, sorted, into p[TRIMESH_PATCH_SIZE]
+    //(the first TRIMESH_PATCH_SIZE found when more triangles share a vertex); returns the count
+    int patch(int t, int *p) const;
+    //closest point on triangle t to p (squared distance)
+    doublereal closestOnTri(int t, const Vec3& p, Vec3& q) const;
+    //squared distance from p to the box of node
+    doublereal boxDist2(const bvhnode& node, const Vec3& p) const;
+    //closest triangle to p excluding the iNumEx triangles in ex (sorted), within sqrt(d2)
+    int search(const Vec3& p, const int *ex, int iNumEx, doublereal& d2, Vec3& q) const;
+
+public:
+    trimesh(void);
+    ~trimesh(void);
+
+    //load binary STL (throws ErrGeneric on failure)
+    void load(const char *sFileName);
+    bool bLoaded(void) const;
+    std::size_t iGetNumTriangles(void) const;
+    //highest point of the mesh
+    doublereal dGetZMax(void) const;
+
+    //closest point q on the mesh to p and its triangle, starting from the hint
+    void closest(const Vec3& p, trimeshhint& hint, Vec3& q, int& iTri) const;
+    //unit face normal (nz >= 0)
+    Vec3 normal(int iTri) const;
+    //highest surface below (x, y); false if the mesh does not cover (x, y)
+    bool top(const doublereal& x, const doublereal& y, doublereal& h, Vec3& normal_vec) const;
+    //highest vertex of the triangles overlapping [xlo, xhi] x [ylo, yhi] in the xy plane;
+    //false if no triangle overlaps
+    bool bUpperBound(const doublereal& xlo, const doublereal& ylo,
+        const doublereal& xhi, const doublereal& yhi, doublereal& zb) const;
+};
+
+#endif // TRIMESH_H